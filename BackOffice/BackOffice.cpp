@@ -1,6 +1,10 @@
 // Copyright (c) 2022 Metrological. All rights reserved.
 #include "BackOffice.h"
 
+#ifdef BACKOFFICE_GZIP
+#include <zlib.h>
+#endif
+
 namespace Thunder {
 
     ENUM_CONVERSION_BEGIN(Plugin::BackOffice::reportstate)
@@ -70,7 +74,10 @@ namespace Plugin {
         else if ((config.ServerAddress.IsSet() == false) || (config.ServerAddress.Value().empty() == true) || (config.ServerPort.IsSet() == false)) {
             result = _T("Server address or port not specified!");
         }
-        else if (_requestSender.Configure(Core::NodeId(config.ServerAddress.Value().c_str(), config.ServerPort.Value()), config.UserAgent.Value(), queryParameters) != Core::ERROR_NONE) {
+        else if ((Core::File(service->PersistentPath()).IsDirectory() == false) && (Core::Directory(service->PersistentPath().c_str()).CreatePath() == false)) {
+            result = _T("Could not create the spool directory");
+        }
+        else if (_requestSender.Configure(Core::NodeId(config.ServerAddress.Value().c_str(), config.ServerPort.Value()), config.UserAgent.Value(), queryParameters, config.Upload, service->PersistentPath() + _T("events.json")) != Core::ERROR_NONE) {
             result = _T("Client connection could not be configured correctly!");
         }
 
@@ -80,7 +87,7 @@ namespace Plugin {
     {
         ASSERT(service != nullptr);
         _stateChangeObserver.Deinitialize(service);
-        _requestSender.Close(Core::infinite);
+        _requestSender.Stop(Core::infinite);
     }
     string BackOffice::Information() const
     {
@@ -124,5 +131,294 @@ namespace Plugin {
         }
         return result;
     }
+    uint32_t BackOffice::WebClient::Configure(const Core::NodeId& remoteNode, const string& userAgent, const QueryParameters& queryParameters, const Config::UploadConfig& upload, const string& spool)
+    {
+        _hostAddress = remoteNode.HostAddress();
+        _userAgent = userAgent;
+
+        BaseClass::Link().LocalNode(remoteNode.AnyInterface());
+        BaseClass::Link().RemoteNode(remoteNode.AnyInterface());
+
+        for (const auto& entry : queryParameters) {
+            _queryParameters += Core::Format("%s=%s&", entry.first.c_str(), entry.second.c_str());
+        }
+
+        ASSERT(!_queryParameters.empty());
+
+        if (_queryParameters.empty() == false) {
+            _queryParameters.pop_back();
+        }
+
+        _batch = std::max(upload.Batch.Value(), static_cast<uint16_t>(1));
+        _linger = upload.Linger.Value();
+        _keepAlive = upload.KeepAlive.Value();
+        _compress = upload.Compress.Value();
+        _spoolSize = std::max(upload.Spool.Value(), _batch);
+        _minimumBackoff = std::max(upload.MinimumBackoff.Value(), static_cast<uint32_t>(1));
+        _maximumBackoff = std::max(upload.MaximumBackoff.Value(), _minimumBackoff);
+        _spool = spool;
+
+#ifndef BACKOFFICE_GZIP
+        if (_compress == true) {
+            TRACE(Trace::Information, (_T("Built without zlib, events are uploaded uncompressed")));
+        }
+#endif
+
+        _lock.Lock();
+
+        Load();
+
+        if (_queue.empty() == false) {
+            // Left over from a previous run. Every box may just have come up, so spread the upload.
+            TRACE(Trace::Information, (_T("Found %d spooled events"), static_cast<uint32_t>(_queue.size())));
+
+            _state = state::BACKOFF;
+            _job.Reschedule(Core::Time::Now().Add(Backoff()));
+        }
+
+        _lock.Unlock();
+
+        return (_queryParameters.empty() ? Core::ERROR_UNKNOWN_TABLE : Core::ERROR_NONE);
+    }
+    void BackOffice::WebClient::Received(Core::ProxyType<Thunder::Web::Response>& element)
+    {
+        _lock.Lock();
+        const bool sending = (_state == state::SENDING);
+        _lock.Unlock();
+
+        // A response that arrives after the request was given up on, or that was never asked for,
+        // is of no interest anymore, and must leave the pending retry or linger alone.
+        if (sending == false) {
+            return;
+        }
+
+        // The timeout of the request, it must not run while the response is handled. Revoked
+        // outside the lock, the timeout takes it as well.
+        _job.Revoke();
+
+        _lock.Lock();
+
+        if (_state == state::BACKOFF) {
+            // The timeout ran just before it was revoked, and its retry was revoked with it.
+            _job.Reschedule(Core::Time::Now().Add(Backoff()));
+        } else if (_state == state::SENDING) {
+            const uint32_t code = element->ErrorCode;
+            const bool delivered = ((code >= 200) && (code < 300));
+
+            // Server errors, 408 (request timeout) and 429 (too many requests) are worth another try.
+            if ((delivered == false) && ((code < 400) || (code >= 500) || (code == 408) || (code == 429))) {
+                SYSLOG(Logging::Error, (_T("Received error code: %d for stats reporting"), code));
+                Failed();
+            } else {
+                if (delivered == false) {
+                    // Sending them again will not make it any better.
+                    SYSLOG(Logging::Error, (_T("Received error code: %d for stats reporting, dropping %d events"), code, _inflight));
+                }
+
+                _queue.erase(_queue.begin(), _queue.begin() + _inflight);
+                _inflight = 0;
+                _attempt = 0;
+
+                Persist();
+
+                if (_queue.empty() == false) {
+                    // Whatever was spooled, goes out back to back on this connection.
+                    Submit();
+                } else {
+                    _state = state::IDLE;
+                    _job.Reschedule(Core::Time::Now().Add(_keepAlive));
+                }
+            }
+        }
+
+        _lock.Unlock();
+    }
+    void BackOffice::WebClient::Dispatch()
+    {
+        _lock.Lock();
+
+        switch (_state) {
+        case state::CONNECTING:
+        case state::SENDING:
+            // No connection or no response in time.
+            Failed();
+            break;
+        case state::LINGER:
+        case state::BACKOFF:
+            if (_queue.empty() == true) {
+                _state = state::IDLE;
+            } else if (BaseClass::IsOpen() == true) {
+                Submit();
+            } else {
+                // The StateChange continues from here.
+                _state = state::CONNECTING;
+                _job.Reschedule(Core::Time::Now().Add(MaximumWaitTime));
+                BaseClass::Open(0);
+            }
+            break;
+        case state::IDLE:
+            // Nothing to send for a while, no need to hold on to the connection.
+            if (BaseClass::IsOpen() == true) {
+                BaseClass::Close(0);
+            }
+            break;
+        }
+
+        _lock.Unlock();
+    }
+    void BackOffice::WebClient::Submit()
+    {
+        Core::JSON::ArrayType<Report> reports;
+        string body;
+
+        _inflight = static_cast<uint16_t>(std::min(_queue.size(), static_cast<size_t>(_batch)));
+
+        Fill(reports, _inflight);
+        reports.ToString(body);
+
+        _message.Clear();
+        _message.Verb       = Web::Request::HTTP_POST;
+        _message.Query      = _queryParameters;
+        _message.Host       = _hostAddress;
+        _message.Accept     = _T("*/*");
+        _message.UserAgent  = _userAgent;
+        _message.Connection = Web::Request::CONNECTION_KEEPALIVE;
+        _message.ContentType = Web::MIME_JSON;
+
+        bool compressed = false;
+
+#ifdef BACKOFFICE_GZIP
+        compressed = (_compress == true) && (body.length() >= CompressThreshold) && (Deflate(body, *_body) == true);
+#endif
+
+        if (compressed == true) {
+            _message.ContentEncoding = Web::ENCODING_GZIP;
+        } else {
+            _body->assign(body);
+        }
+
+        _message.Body(Core::ProxyType<Web::IBody>(Core::ProxyType<Web::TextBody>(_body)));
+
+        _state = state::SENDING;
+        _job.Reschedule(Core::Time::Now().Add(MaximumWaitTime));
+
+        BaseClass::Submit(Core::ProxyType<Thunder::Web::Request>(_message));
+    }
+    void BackOffice::WebClient::Failed()
+    {
+        _inflight = 0;
+
+        if (_attempt < 32) {
+            _attempt++;
+        }
+
+        _state = state::BACKOFF;
+
+        const uint32_t delay = Backoff();
+
+        TRACE(Trace::Warning, (_T("Upload of %d events failed, retry %d in %d ms"), static_cast<uint32_t>(_queue.size()), _attempt, delay));
+
+        _job.Reschedule(Core::Time::Now().Add(delay));
+
+        BaseClass::Close(0);
+    }
+    uint32_t BackOffice::WebClient::Backoff() const
+    {
+        // Doubles on every failed attempt, up to the maximum. Only the lower half of the wait is
+        // fixed, the upper half is random, so retries from many boxes do not line up.
+        const uint64_t ceiling = static_cast<uint64_t>(_minimumBackoff) << std::min(_attempt, static_cast<uint8_t>(20));
+        const uint32_t delay = static_cast<uint32_t>(std::min(ceiling, static_cast<uint64_t>(_maximumBackoff)));
+        uint32_t result;
+
+        Crypto::Random(result, delay / 2, delay);
+
+        return (result);
+    }
+    void BackOffice::WebClient::Fill(Core::JSON::ArrayType<Report>& reports, const uint32_t count) const
+    {
+        for (uint32_t index = 0; index < count; ++index) {
+            const Entry& entry(_queue[index]);
+            Report& report(reports.Add());
+
+            report.Event = entry.Name;
+            report.Id = entry.Id;
+            report.Time = entry.Time;
+        }
+    }
+    void BackOffice::WebClient::Persist()
+    {
+        _unspooled = 0;
+
+        if (_spool.empty() == false) {
+            const string staged(_spool + _T(".new"));
+            Core::JSON::ArrayType<Report> reports;
+            Core::File file(staged);
+
+            Fill(reports, static_cast<uint32_t>(_queue.size()));
+
+            // Write aside and move it in place, a power cut halfway leaves the previous spool.
+            if (file.Create() == false) {
+                TRACE(Trace::Error, (_T("Could not create spool file %s"), staged.c_str()));
+            } else {
+                const bool written = reports.IElement::ToFile(file);
+
+                file.Close();
+
+                if ((written == false) || (::rename(staged.c_str(), _spool.c_str()) != 0)) {
+                    TRACE(Trace::Error, (_T("Could not update spool file %s"), _spool.c_str()));
+                }
+            }
+        }
+    }
+    void BackOffice::WebClient::Load()
+    {
+        Core::File file(_spool);
+
+        if (file.Open(true) == true) {
+            Core::JSON::ArrayType<Report> reports;
+            Core::OptionalType<Core::JSON::Error> error;
+
+            reports.IElement::FromFile(file, error);
+            file.Close();
+
+            if (error.IsSet() == true) {
+                SYSLOG(Logging::ParsingError, (_T("Parsing spool failed with %s"), ErrorDisplayMessage(error.Value()).c_str()));
+            } else {
+                Core::JSON::ArrayType<Report>::ConstIterator index(reports.Elements());
+
+                while ((index.Next() == true) && (_queue.size() < _spoolSize)) {
+                    _queue.push_back({ index.Current().Time.Value(), index.Current().Event.Value(), index.Current().Id.Value() });
+                }
+            }
+        }
+    }
+#ifdef BACKOFFICE_GZIP
+    /* static */ bool BackOffice::WebClient::Deflate(const string& input, string& output)
+    {
+        z_stream stream;
+        bool result = false;
+
+        ::memset(&stream, 0, sizeof(stream));
+
+        // 15 bits of window, plus 16 for a gzip instead of a zlib wrapper.
+        if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+            output.resize(deflateBound(&stream, static_cast<uLong>(input.length())));
+
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+            stream.avail_in = static_cast<uInt>(input.length());
+            stream.next_out = reinterpret_cast<Bytef*>(&(output[0]));
+            stream.avail_out = static_cast<uInt>(output.length());
+
+            if (deflate(&stream, Z_FINISH) == Z_STREAM_END) {
+                output.resize(stream.total_out);
+                result = true;
+            }
+
+            deflateEnd(&stream);
+        }
+
+        return (result);
+    }
+#endif
 }
 }
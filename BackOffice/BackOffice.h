@@ -4,6 +4,8 @@
 
 #include "Module.h"
 
+#include <deque>
+
 namespace Thunder {
 namespace Plugin {
     class BackOffice : public PluginHost::IPlugin {
@@ -20,6 +22,42 @@ namespace Plugin {
         using QueryParameters = std::list<std::pair<string, string>>;
 
         class Config : public Core::JSON::Container {
+        public:
+            class UploadConfig : public Core::JSON::Container {
+            public:
+                UploadConfig(const UploadConfig&) = delete;
+                UploadConfig& operator=(const UploadConfig&) = delete;
+
+                UploadConfig()
+                    : Core::JSON::Container()
+                    , Batch(32)
+                    , Linger(2000)
+                    , KeepAlive(30000)
+                    , Compress(true)
+                    , Spool(1024)
+                    , MinimumBackoff(2000)
+                    , MaximumBackoff(600000)
+                {
+                    Add(_T("batch"), &Batch);
+                    Add(_T("linger"), &Linger);
+                    Add(_T("keepalive"), &KeepAlive);
+                    Add(_T("compress"), &Compress);
+                    Add(_T("spool"), &Spool);
+                    Add(_T("minimumbackoff"), &MinimumBackoff);
+                    Add(_T("maximumbackoff"), &MaximumBackoff);
+                }
+                ~UploadConfig() override = default;
+
+            public:
+                Core::JSON::DecUInt16 Batch; // events per request
+                Core::JSON::DecUInt32 Linger; // ms to wait for more events before sending
+                Core::JSON::DecUInt32 KeepAlive; // ms an idle connection stays open
+                Core::JSON::Boolean Compress;
+                Core::JSON::DecUInt16 Spool; // events kept on disk, the oldest go first
+                Core::JSON::DecUInt32 MinimumBackoff; // ms
+                Core::JSON::DecUInt32 MaximumBackoff; // ms
+            };
+
         public:
             Config(const Config&) = delete;
             Config& operator=(const Config&) = delete;
@@ -35,6 +73,7 @@ namespace Plugin {
                 , Type()
                 , Session()
                 , CallsignMapping()
+                , Upload()
             {
                 Add(_T("server"), &ServerAddress);
                 Add(_T("port"), &ServerPort);
@@ -45,6 +84,7 @@ namespace Plugin {
                 Add(_T("type"), &Type);
                 Add(_T("session"), &Session);
                 Add(_T("callsign_mapping"), &CallsignMapping);
+                Add(_T("upload"), &Upload);
             }
 
             ~Config() override = default;
@@ -59,13 +99,69 @@ namespace Plugin {
             Core::JSON::String Type;
             Core::JSON::DecUInt16 Session;
             Core::JSON::ArrayType<Core::JSON::String> CallsignMapping;
+            UploadConfig Upload;
         };
+
+        // Events are collected and sent in batches, as a JSON array in the body of a POST, over a
+        // connection that is kept open for a while. Until the server acknowledged them, they are
+        // kept in a spool file, so they survive a restart or an outage. The spool is rewritten once
+        // per batch of new events, on an acknowledgement and on stop, not per event. Failed uploads are retried
+        // with an exponential backoff and jitter, so a fleet of boxes coming back after an outage
+        // does not hit the server all at once.
         class WebClient : public Web::WebLinkType<Crypto::SecureSocketPort, Web::Response, Web::Request, WebClient&> {
         private:
             using BaseClass = Web::WebLinkType<Crypto::SecureSocketPort, Web::Response, Web::Request, WebClient&>;
-            using Queue = std::list<std::pair<string, string>>;
 
             static constexpr uint32_t MaximumWaitTime = 5 * 1000; // 5 Seconds waiting time
+            static constexpr uint16_t CompressThreshold = 256; // bytes, smaller bodies go as they are
+
+            enum class state : uint8_t {
+                IDLE, // nothing to send, the connection may be open
+                LINGER, // waiting for more events to join the batch
+                CONNECTING,
+                SENDING, // waiting for the response on a batch
+                BACKOFF // waiting to retry
+            };
+
+            struct Entry {
+                string Time;
+                string Name;
+                string Id;
+            };
+
+            using Queue = std::deque<Entry>;
+
+            class Report : public Core::JSON::Container {
+            public:
+                Report& operator=(const Report&) = delete;
+
+                Report()
+                    : Core::JSON::Container()
+                    , Event()
+                    , Id()
+                    , Time()
+                {
+                    Add(_T("event"), &Event);
+                    Add(_T("id"), &Id);
+                    Add(_T("time"), &Time);
+                }
+                Report(const Report& copy)
+                    : Core::JSON::Container()
+                    , Event(copy.Event)
+                    , Id(copy.Id)
+                    , Time(copy.Time)
+                {
+                    Add(_T("event"), &Event);
+                    Add(_T("id"), &Id);
+                    Add(_T("time"), &Time);
+                }
+                ~Report() override = default;
+
+            public:
+                Core::JSON::String Event;
+                Core::JSON::String Id;
+                Core::JSON::String Time;
+            };
 
         public:
             WebClient(const WebClient& copy) = delete;
@@ -75,68 +171,75 @@ namespace Plugin {
                 : BaseClass(5, *this, Core::SocketPort::STREAM, Core::NodeId(), Core::NodeId(), 2048, 2048)
                 , _lock()
                 , _queue()
+                , _queryParameters()
                 , _hostAddress()
                 , _userAgent()
+                , _spool()
+                , _batch(32)
+                , _linger(2000)
+                , _keepAlive(30000)
+                , _compress(true)
+                , _spoolSize(1024)
+                , _minimumBackoff(2000)
+                , _maximumBackoff(600000)
+                , _state(state::IDLE)
+                , _inflight(0)
+                , _unspooled(0)
+                , _attempt(0)
                 , _message()
+                , _body()
                 , _job(*this)
             {
             }
             ~WebClient() override {
-                _job.Revoke();
-                BaseClass::Close(1000);
+                Stop(1000);
             }
 
         public:
-            uint32_t Configure(const Core::NodeId& remoteNode, const string& userAgent, const QueryParameters& queryParameters) {
-                _hostAddress = remoteNode.HostAddress();
-                _userAgent = userAgent;
-
-                BaseClass::Link().LocalNode(remoteNode.AnyInterface());
-                BaseClass::Link().RemoteNode(remoteNode.AnyInterface());
+            uint32_t Configure(const Core::NodeId& remoteNode, const string& userAgent, const QueryParameters& queryParameters, const Config::UploadConfig& upload, const string& spool);
+            void Stop(const uint32_t waitTime) {
+                _job.Revoke();
 
-                for (const auto& entry : queryParameters) {
-                    _queryParameters += Core::Format("%s=%s&", entry.first.c_str(), entry.second.c_str());
+                // Whatever is not acknowledged yet, is in the spool for the next time.
+                _lock.Lock();
+                _state = state::IDLE;
+                _inflight = 0;
+                if (_unspooled > 0) {
+                    Persist();
                 }
+                _lock.Unlock();
 
-                ASSERT(!_queryParameters.empty());
-
-                return (_queryParameters.empty() ? Core::ERROR_UNKNOWN_TABLE : Core::ERROR_NONE);
+                BaseClass::Close(waitTime);
             }
+
             void Send(const string& event, const string& id) {
                 _lock.Lock();
-                _queue.emplace_back(event, id);
-                _lock.Unlock();
 
-                // We have data to send, see if we are capable of sending
-                if (BaseClass::IsClosed()) {
-                    // Nope there is no connection, lets open it, the StateChange will trigger continuation
-                    BaseClass::Open(0);
+                // Whatever is on its way to the server stays, the oldest of the rest make room.
+                if ((_queue.size() >= _spoolSize) && (_queue.size() > _inflight)) {
+                    TRACE(Trace::Warning, (_T("Spool full, dropping the %s event for %s"), _queue[_inflight].Name.c_str(), _queue[_inflight].Id.c_str()));
+                    _queue.erase(_queue.begin() + _inflight);
                 }
-            }
-            // Notification of a Partial Request received, time to attach a body..
-            void LinkBody(Core::ProxyType<Thunder::Web::Response>& element VARIABLE_IS_NOT_USED) override {
-                // We are not expected to receive Bodies with the incoming message, so drop it...
-            }
-            void Received(Core::ProxyType<Thunder::Web::Response>& element) override {
 
-                _job.Revoke();
+                _queue.push_back({ Core::Time::Now().ToISO8601(true), event, id });
 
-                _lock.Lock();
-
-                // Oke a request has been completed, it has to be the first one in the queue.
-                if (element->ErrorCode != Web::STATUS_OK) {
-                    SYSLOG(Logging::Error, (_T("Received error code: %d for stats reporting"), element->ErrorCode));
+                // The whole spool is rewritten, so not for every single event.
+                if (++_unspooled >= _batch) {
+                    Persist();
                 }
 
-                if (_queue.empty() == false) {
-                    Submit();
-                }
-                else {
-                    Close(0);
+                if ((_state == state::IDLE) || ((_state == state::LINGER) && (_queue.size() >= _batch))) {
+                    _state = state::LINGER;
+                    _job.Reschedule(Core::Time::Now().Add(_queue.size() >= _batch ? 0 : _linger));
                 }
 
                 _lock.Unlock();
             }
+            // Notification of a Partial Request received, time to attach a body..
+            void LinkBody(Core::ProxyType<Thunder::Web::Response>& element VARIABLE_IS_NOT_USED) override {
+                // We are not expected to receive Bodies with the incoming message, so drop it...
+            }
+            void Received(Core::ProxyType<Thunder::Web::Response>& element) override;
             void Send(const Core::ProxyType<Thunder::Web::Request>& request VARIABLE_IS_NOT_USED) override
             {
                 // Oke the request has been send, lets wait for the response..
@@ -145,11 +248,14 @@ namespace Plugin {
             {
                 _lock.Lock();
 
-                if ((IsOpen() == false) || (_queue.empty() == true)) {
-                    Close(0);
+                if (IsOpen() == true) {
+                    if (_state == state::CONNECTING) {
+                        Submit();
+                    }
                 }
-                else {
-                    Submit();
+                else if ((_state == state::CONNECTING) || (_state == state::SENDING)) {
+                    // Refused, or dropped before the response came in.
+                    Failed();
                 }
 
                 _lock.Unlock();
@@ -161,37 +267,37 @@ namespace Plugin {
 
         private:
             friend class Core::ThreadPool::JobType<WebClient&>;
-            void Dispatch() {
-                // We got a time out.. Might be an error or a restart after an error. Retry/Connect
-                if (BaseClass::IsOpen() == true) {
-                    BaseClass::Close(1000);
-                    if (_queue.empty() == false) {
-                        Open(0);
-                    }
-                }
-            }
-            void Submit() {
-                std::pair<string, string> entry = _queue.back();
-                _queue.pop_back();
-
-                _message.Verb       = Web::Request::HTTP_GET;
-                _message.Query      = Core::Format("%sevent=%s&id=%s", _queryParameters.c_str(), entry.first.c_str(), entry.second.c_str());
-                _message.Host       = _hostAddress;
-                _message.Accept     = _T("*/*");
-                _message.UserAgent  = _userAgent;
-                _message.Connection = Web::Request::CONNECTION_KEEPALIVE;
-
-                BaseClass::Submit(Core::ProxyType<Thunder::Web::Request>(_message));
-                _job.Reschedule(Core::Time::Now().Add(MaximumWaitTime));
-            }
+            void Dispatch();
+            void Submit();
+            void Failed();
+            void Persist();
+            void Load();
+            void Fill(Core::JSON::ArrayType<Report>& reports, const uint32_t count) const;
+            uint32_t Backoff() const;
+#ifdef BACKOFFICE_GZIP
+            static bool Deflate(const string& input, string& output);
+#endif
 
         private:
-            Core::CriticalSection _lock;
+            mutable Core::CriticalSection _lock;
             Queue _queue;
             string _queryParameters;
             string _hostAddress;
             string _userAgent;
+            string _spool;
+            uint16_t _batch;
+            uint32_t _linger;
+            uint32_t _keepAlive;
+            bool _compress;
+            uint16_t _spoolSize;
+            uint32_t _minimumBackoff;
+            uint32_t _maximumBackoff;
+            state _state;
+            uint16_t _inflight; // events at the front of the queue, in the request on its way
+            uint16_t _unspooled; // events queued since the spool was last written
+            uint8_t _attempt;
             Core::ProxyObject<Thunder::Web::Request> _message;
+            Core::ProxyObject<Web::TextBody> _body;
             Core::ThreadPool::JobType<WebClient&> _job;
         };
         class Observer : public PluginHost::IPlugin::INotification {
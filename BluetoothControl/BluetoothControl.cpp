@@ -38,6 +38,12 @@ namespace Plugin {
 
     static Core::ProxyPoolType<Web::JSONBodyType<BluetoothControl::DeviceImpl::Data>> jsonResponseFactoryDevice(1);
     static Core::ProxyPoolType<Web::JSONBodyType<BluetoothControl::Status>> jsonResponseFactoryStatus(1);
+#if defined(BLUETOOTH_DEVELOPMENT)
+    static Core::ProxyPoolType<Web::JSONBodyType<BluetoothControl::ReplayReport>> jsonResponseFactoryReplay(1);
+#endif
+
+    // Number of least recently seen devices examined for eviction on each advertisement.
+    static constexpr uint16_t EvictionBudget = 4;
 
     //
     // PluginHost::IPlugin override
@@ -53,6 +59,9 @@ namespace Plugin {
 
         _config.FromString(service->ConfigLine());
 
+        _devices.Configure(_config.Registry.Coalescing.Value(), _config.Registry.RSSIThreshold.Value(),
+                           _config.Registry.Capacity.Value(), _config.Registry.StaleTime.Value());
+
         const char* driverMessage = ::construct_bluetooth_driver(service->ConfigLine().c_str());
 
         // First see if we can bring up the Driver....
@@ -451,6 +460,15 @@ namespace Plugin {
                     Scan(lowEnergy, duration);
                     result->ErrorCode = Web::STATUS_OK;
                     result->Message = _T("Requested scan start.");
+#if defined(BLUETOOTH_DEVELOPMENT)
+                } else if (index.Current() == _T("Replay")) {
+                    Core::URL::KeyValue options(request.Query.Value());
+                    Core::ProxyType<Web::JSONBodyType<ReplayReport>> response(jsonResponseFactoryReplay.Element());
+                    Replay(options.Number<uint32_t>(_T("Reports"), 100000), options.Number<uint16_t>(_T("Devices"), 200), *response);
+                    result->ErrorCode = Web::STATUS_OK;
+                    result->Message = _T("Replayed synthetic advertising reports.");
+                    result->Body(response);
+#endif
                 } else if ((index.Current() == _T("Pair")) || (index.Current() == _T("Connect"))) {
                     bool pair = (index.Current() == _T("Pair"));
                     string destination;
@@ -658,7 +676,13 @@ namespace Plugin {
 
     /* virtual */ Exchange::IBluetooth::IDevice::IIterator* BluetoothControl::Devices()
     {
-        return (Core::ServiceType<DeviceImpl::IteratorImpl>::Create<IBluetooth::IDevice::IIterator>(_devices));
+        _adminLock.Lock();
+
+        IBluetooth::IDevice::IIterator* result = Core::ServiceType<DeviceImpl::IteratorImpl>::Create<IBluetooth::IDevice::IIterator>(_devices.List());
+
+        _adminLock.Unlock();
+
+        return (result);
     }
 
     /* virtual */ uint32_t BluetoothControl::ForgetDevice(const string& address, const IBluetooth::IDevice::type type)
@@ -705,7 +729,7 @@ namespace Plugin {
 
             ASSERT(impl != nullptr);
 
-            _devices.push_back(impl);
+            _devices.Add(impl);
             Update(impl);
         }
 
@@ -714,18 +738,157 @@ namespace Plugin {
         return (impl);
     }
 
+    BluetoothControl::DeviceImpl* BluetoothControl::Advertised(const Bluetooth::Address& address, const bool discover, const bool response, const uint32_t signature, const int8_t rssi, bool& process)
+    {
+        const uint64_t now = Core::Time::Now().Ticks();
+        std::list<DeviceImpl*> evicted;
+
+        _adminLock.Lock();
+
+        DeviceImpl* impl = _devices.Find(address, true);
+
+        if ((impl == nullptr) && (discover == true)) {
+            impl = Discovered(true, address);
+        }
+
+        if (impl != nullptr) {
+            process = (_devices.Advertised(impl, response, signature, rssi, now) != DeviceRegistry::REPEATED);
+
+            if (process == false) {
+                _coalesced++;
+            }
+        }
+
+        // Keep the registry bounded, paired, connected or busy devices are never evicted.
+        _evicted += _devices.Evict(now, EvictionBudget, [impl](const DeviceImpl* device) -> bool {
+            return ((device != impl) && (device->IsPaired() == false) && (device->IsConnected() == false) && (device->IsBusy() == false));
+        }, evicted);
+
+        _adminLock.Unlock();
+
+        for (DeviceImpl* device : evicted) {
+            TRACE(Trace::Information, (_T("Evicted %s device %s, not seen recently"), (device->LowEnergy() ? "BLE" : "BR/EDR"), device->RemoteId().c_str()));
+            device->Release();
+        }
+
+        return (impl);
+    }
+
+    void BluetoothControl::Connection(DeviceImpl* device, const uint16_t previous, const uint16_t handle)
+    {
+        _adminLock.Lock();
+        _devices.Connection(device, previous, handle);
+        _adminLock.Unlock();
+    }
+
+#if defined(BLUETOOTH_DEVELOPMENT)
+    void BluetoothControl::Replay(const uint32_t reports, const uint16_t devices, ReplayReport& report)
+    {
+        // Synthetic devices use a locally administered address range, so they can be told apart
+        // from (and cleaned up without touching) the real ones.
+        static constexpr uint8_t Prefix[] = { 0x02, 0x54, 0x48 };
+        static constexpr uint8_t MaxData = 31;
+
+        const uint16_t population = std::max(devices, static_cast<uint16_t>(1));
+        uint8_t buffer[sizeof(le_advertising_info) + MaxData + 1 /* rssi */];
+        le_advertising_info& info = *reinterpret_cast<le_advertising_info*>(buffer);
+
+        _adminLock.Lock();
+        const uint32_t coalesced = _coalesced;
+        const uint32_t evicted = _evicted;
+        _adminLock.Unlock();
+
+        struct timespec cpuStart, cpuEnd;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+        const uint64_t start = Core::Time::Now().Ticks();
+
+        for (uint32_t index = 0; index < reports; index++) {
+            const uint16_t id = static_cast<uint16_t>(index % population);
+            const bool response = ((index / population) % 4) == 0;
+            const string name = _T("Replay-") + Core::ToString(id);
+            uint8_t length = 0;
+
+            ::memset(buffer, 0, sizeof(buffer));
+
+            // Busy room pattern: every device alternates advertising and scan response data with a
+            // jittering RSSI and once in a while a payload change.
+            info.evt_type = (response ? 4 /* SCAN_RESPONSE */ : 0 /* CONNECTABLE_UNDIRECTED */);
+            info.bdaddr_type = 0; /* public */
+            info.bdaddr.b[0] = static_cast<uint8_t>(id & 0xFF);
+            info.bdaddr.b[1] = static_cast<uint8_t>(id >> 8);
+            info.bdaddr.b[2] = 0;
+            info.bdaddr.b[3] = Prefix[2];
+            info.bdaddr.b[4] = Prefix[1];
+            info.bdaddr.b[5] = Prefix[0];
+
+            if (response == true) {
+                const uint8_t size = static_cast<uint8_t>(std::min(name.length(), static_cast<size_t>(MaxData - 2)));
+                info.data[length++] = size + 1;
+                info.data[length++] = 0x09; /* complete local name */
+                ::memcpy(&info.data[length], name.c_str(), size);
+                length += size;
+            } else {
+                info.data[length++] = 2;
+                info.data[length++] = 0x01; /* flags */
+                info.data[length++] = 0x06;
+                info.data[length++] = 4;
+                info.data[length++] = 0xFF; /* manufacturer specific */
+                info.data[length++] = 0xFF;
+                info.data[length++] = 0xFF;
+                info.data[length++] = static_cast<uint8_t>(index / (population * 64));
+            }
+
+            info.length = length;
+            info.data[length] = static_cast<uint8_t>(-60 - static_cast<int8_t>((index * 7) % 5));
+
+            Connector().Replay(info);
+        }
+
+        const uint64_t duration = ((Core::Time::Now().Ticks() - start) * 1000) / Core::Time::TicksPerMillisecond;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+
+        const uint64_t cpu = ((static_cast<uint64_t>(cpuEnd.tv_sec - cpuStart.tv_sec) * 1000000000ULL) + cpuEnd.tv_nsec) - cpuStart.tv_nsec;
+
+        _adminLock.Lock();
+        report.Coalesced = (_coalesced - coalesced);
+        report.Evicted = (_evicted - evicted);
+        _adminLock.Unlock();
+
+        report.Reports = reports;
+        report.Devices = population;
+        report.Processed = reports - report.Coalesced.Value();
+        report.CPUTime = (cpu / 1000);
+        report.Duration = duration;
+        report.PerReport = (reports != 0 ? static_cast<uint32_t>(cpu / reports) : 0);
+
+        const uint16_t removed = RemoveDevices([](DeviceImpl* device) -> bool {
+            const bdaddr_t* address = device->Locator().Data();
+            return ((address->b[5] == Prefix[0]) && (address->b[4] == Prefix[1]) && (address->b[3] == Prefix[2]));
+        });
+
+        TRACE(Trace::Information, (_T("Replayed %u reports over %u devices: %llu us CPU, %u ns/report, %u coalesced, %u evicted, %u removed"),
+            reports, population, static_cast<unsigned long long>(cpu / 1000), report.PerReport.Value(), report.Coalesced.Value(), report.Evicted.Value(), removed));
+    }
+#endif
+
     uint16_t BluetoothControl::RemoveDevices(std::function<bool(DeviceImpl*)> filter)
     {
         uint16_t count = 0;
 
         _adminLock.Lock();
 
-        for (std::list<DeviceImpl*>::iterator index = _devices.begin(), end = _devices.end(); index != end; ++index) {
+        DeviceRegistry::iterator index = _devices.begin();
+
+        while (index != _devices.end()) {
             // call the function passed into findMatchingAddresses and see if it matches
             if (filter(*index) == true) {
-                (*index)->Release();
-                index = _devices.erase(index);
+                // The registry still needs the device to find its entries, release it once it is out.
+                DeviceImpl* device = *index;
+                index = _devices.Remove(index);
+                device->Release();
                 count++;
+            } else {
+                index++;
             }
         }
 
@@ -751,46 +914,22 @@ namespace Plugin {
 
     BluetoothControl::DeviceImpl* BluetoothControl::Find(const Bluetooth::Address& search, const bool lowEnergy)
     {
-        std::list<DeviceImpl*>::iterator index = _devices.begin();
-
-        while ((index != _devices.end()) && ((*index)->operator==(std::make_pair(search, lowEnergy)) == false)) {
-            index++;
-        }
-
-        return (index != _devices.end() ? (*index) : nullptr);
+        return (_devices.Find(search, lowEnergy));
     }
 
     const BluetoothControl::DeviceImpl* BluetoothControl::Find(const Bluetooth::Address& search, const bool lowEnergy) const
     {
-        std::list<DeviceImpl*>::const_iterator index = _devices.cbegin();
-
-        while ((index != _devices.cend()) && ((*index)->operator==(std::make_pair(search, lowEnergy)) == false)) {
-            index++;
-        }
-
-        return (index != _devices.cend() ? (*index) : nullptr);
+        return (_devices.Find(search, lowEnergy));
     }
 
     BluetoothControl::DeviceImpl* BluetoothControl::Find(const uint16_t handle)
     {
-        std::list<DeviceImpl*>::iterator index = _devices.begin();
-
-        while ((index != _devices.end()) && ((*index)->ConnectionId() != handle)) {
-            index++;
-        }
-
-        return (index != _devices.end() ? (*index) : nullptr);
+        return (_devices.Find(handle));
     }
 
     const BluetoothControl::DeviceImpl* BluetoothControl::Find(const uint16_t handle) const
     {
-        std::list<DeviceImpl*>::const_iterator index = _devices.cbegin();
-
-        while ((index != _devices.cend()) && ((*index)->ConnectionId() != handle)) {
-            index++;
-        }
-
-        return (index != _devices.cend() ? (*index) : nullptr);
+        return (_devices.Find(handle));
     }
 
     uint32_t BluetoothControl::LoadDevices(const string& devicePath, Bluetooth::ManagementSocket& administrator)
@@ -815,7 +954,7 @@ namespace Plugin {
                 }
             }
 
-            TRACE(Trace::Information, (_T("Loaded %i previously bonded device(s): %i LKs, %i LTKs, %i IRKs"), _devices.size(), lks.Entries(), ltks.Entries(), irks.Entries()));
+            TRACE(Trace::Information, (_T("Loaded %i previously bonded device(s): %i LKs, %i LTKs, %i IRKs"), _devices.Count(), lks.Entries(), ltks.Entries(), irks.Entries()));
 
             if (administrator.LinkKey(lks) != Core::ERROR_NONE) {
                 result = Core::ERROR_UNAVAILABLE;
@@ -888,7 +1027,7 @@ namespace Plugin {
 
                         if (device != nullptr) {
 
-                            _devices.push_back(device);
+                            _devices.Add(device);
 
                             result = Core::ERROR_NONE;
                         }
@@ -24,6 +24,7 @@
 #include <interfaces/json/JBluetoothControl.h>
 
 #include "Tracing.h"
+#include "DeviceRegistry.h"
 
 namespace Thunder {
 
@@ -79,6 +80,35 @@ class BluetoothControl : public PluginHost::IPlugin
                 Core::JSON::DecUInt16 Latency;
             };
 
+            class RegistryConfig : public Core::JSON::Container {
+            public:
+                // Default settings for the discovered device administration
+                RegistryConfig()
+                    : Core::JSON::Container()
+                    , Coalescing(1000 /* ms */)
+                    , RSSIThreshold(6 /* dB */)
+                    , Capacity(128)
+                    , StaleTime(300 /* s */)
+                {
+                    Add(_T("coalescing"), &Coalescing);
+                    Add(_T("rssithreshold"), &RSSIThreshold);
+                    Add(_T("capacity"), &Capacity);
+                    Add(_T("staletime"), &StaleTime);
+                }
+                ~RegistryConfig() = default;
+
+                RegistryConfig(const RegistryConfig&) = delete;
+                RegistryConfig(RegistryConfig&&) = delete;
+                RegistryConfig& operator=(const RegistryConfig&) = delete;
+                RegistryConfig& operator=(RegistryConfig&&) = delete;
+
+            public:
+                Core::JSON::DecUInt16 Coalescing;
+                Core::JSON::DecUInt8 RSSIThreshold;
+                Core::JSON::DecUInt16 Capacity;
+                Core::JSON::DecUInt32 StaleTime;
+            };
+
             class UUIDConfig : public Core::JSON::Container {
             public:
                 UUIDConfig& operator=(const UUIDConfig&) = delete;
@@ -138,6 +168,7 @@ class BluetoothControl : public PluginHost::IPlugin
                 Add(_T("persistmac"), &PersistMAC);
                 Add(_T("uuids"), &UUIDs);
                 Add(_T("lowenergy"), &LowEnergy);
+                Add(_T("registry"), &Registry);
             }
             ~Config() = default;
 
@@ -152,6 +183,7 @@ class BluetoothControl : public PluginHost::IPlugin
             Core::JSON::Boolean PersistMAC;
             Core::JSON::ArrayType<UUIDConfig> UUIDs;
             LowEnergyConfig LowEnergy;
+            RegistryConfig Registry;
         }; // class Config
 
         class Data : public Core::JSON::Container {
@@ -486,6 +518,13 @@ class BluetoothControl : public PluginHost::IPlugin
             ManagementSocket& Administrator() {
                 return (_administrator);
             }
+#if defined(BLUETOOTH_DEVELOPMENT)
+            // Feeds a (synthetic) advertising report through the regular path, for profiling.
+            void Replay(const le_advertising_info& info)
+            {
+                Update(info);
+            }
+#endif
 
         public:
             uint32_t Open(BluetoothControl& parent)
@@ -1046,15 +1085,17 @@ class BluetoothControl : public PluginHost::IPlugin
 
                     if ((info.evt_type == SCAN_RESPONSE) || (info.evt_type == CONNECTABLE_UNDIRECTED) || (info.evt_type == CONNECTABLE_DIRECTED)) {
                         const Bluetooth::Address address(info.bdaddr);
-                        DeviceImpl* device = Application()->Find(address, true);
+                        const bool discover = ((info.evt_type == SCAN_RESPONSE) || (_continuousBackgroundScan == true));
+                        // The RSSI is reported in the octet directly following the advertising data.
+                        const int8_t rssi = static_cast<int8_t>(info.data[info.length]);
+                        bool process = false;
 
-                        if ((device == nullptr) && ((info.evt_type == SCAN_RESPONSE) || (_continuousBackgroundScan == true))) {
-                            device = Application()->Discovered(true, info.bdaddr);
-                        }
+                        DeviceImpl* device = Application()->Advertised(address, discover, (info.evt_type == SCAN_RESPONSE), Signature(info), rssi, process);
 
                         if (device != nullptr) {
-                            // Let's see if the adv packet contains extra information we could update our data with.
-                            if (info.length > 0) {
+                            // Let's see if the adv packet contains extra information we could update our data with,
+                            // repeated reports of the same payload within the coalescing window are not parsed again.
+                            if ((process == true) && (info.length > 0)) {
                                 Bluetooth::EIR eir(info.data, info.length);
                                 device->Update(eir);
                             }
@@ -1083,6 +1124,18 @@ class BluetoothControl : public PluginHost::IPlugin
                 }
             }
 
+            static uint32_t Signature(const le_advertising_info& info)
+            {
+                // FNV-1a over the advertising data, enough to tell repeated reports apart from new content.
+                uint32_t hash = 2166136261UL;
+
+                for (uint8_t index = 0; index < info.length; index++) {
+                    hash = (hash ^ info.data[index]) * 16777619UL;
+                }
+
+                return (hash);
+            }
+
         public:
             void Update(const hci_event_hdr& header) override
             {
@@ -1611,6 +1664,10 @@ class BluetoothControl : public PluginHost::IPlugin
             {
                 return (_autoConnect);
             }
+            bool IsBusy() const
+            {
+                return ((_state & ACTION_MASK) != 0);
+            }
 
         public:
             // IBluetooth::IDevice overrides
@@ -1994,6 +2051,8 @@ class BluetoothControl : public PluginHost::IPlugin
 
                 _state.Lock();
 
+                const uint16_t previous = _handle;
+
                 if ( (_handle == static_cast<uint16_t>(~0)) ^ (handle == static_cast<uint16_t>(~0)) ) {
 
                     TRACE(DeviceFlow, (_T("The connection state changed to: %d"), handle));
@@ -2009,6 +2068,10 @@ class BluetoothControl : public PluginHost::IPlugin
 
                 _state.Unlock();
 
+                if (previous != handle) {
+                    _parent->Connection(this, previous, handle);
+                }
+
                 if (updated == true) {
                     UpdateListener();
                     DeviceStateChanged(JBluetoothControl::devicestate::CONNECTED);
@@ -2024,11 +2087,16 @@ class BluetoothControl : public PluginHost::IPlugin
                 TRACE(DeviceFlow, (_T("Disconnected connection %d, reason: %d"), _handle, reason));
 
                 _state.Lock();
+                const uint16_t previous = _handle;
                 ClearState(CONNECTING);
                 ClearState(DISCONNECTING);
                 _handle = ~0;
                 _state.Unlock();
 
+                if (previous != static_cast<uint16_t>(~0)) {
+                    _parent->Connection(this, previous, static_cast<uint16_t>(~0));
+                }
+
                 JBluetoothControl::disconnectreason disconnReason;
                 if (reason == HCI_CONNECTION_TIMEOUT) {
                     disconnReason = JBluetoothControl::disconnectreason::CONNECTION_TIMEOUT;
@@ -2730,6 +2798,8 @@ class BluetoothControl : public PluginHost::IPlugin
             Bluetooth::IdentityKey _irk;
         }; // class DeviceLowEnergy
 
+        using DeviceRegistry = DeviceRegistryType<DeviceImpl>;
+
     public:
         class Status : public Core::JSON::Container {
         public:
@@ -2819,6 +2889,43 @@ class BluetoothControl : public PluginHost::IPlugin
             Core::JSON::ArrayType<Property> Properties;
         }; // class Status
 
+        class ReplayReport : public Core::JSON::Container {
+        public:
+            ReplayReport(const ReplayReport&) = delete;
+            ReplayReport& operator=(const ReplayReport&) = delete;
+            ReplayReport()
+                : Core::JSON::Container()
+                , Reports(0)
+                , Devices(0)
+                , Processed(0)
+                , Coalesced(0)
+                , Evicted(0)
+                , CPUTime(0)
+                , Duration(0)
+                , PerReport(0)
+            {
+                Add(_T("reports"), &Reports);
+                Add(_T("devices"), &Devices);
+                Add(_T("processed"), &Processed);
+                Add(_T("coalesced"), &Coalesced);
+                Add(_T("evicted"), &Evicted);
+                Add(_T("cputime"), &CPUTime);
+                Add(_T("duration"), &Duration);
+                Add(_T("perreport"), &PerReport);
+            }
+            ~ReplayReport() = default;
+
+        public:
+            Core::JSON::DecUInt32 Reports;
+            Core::JSON::DecUInt16 Devices;
+            Core::JSON::DecUInt32 Processed;
+            Core::JSON::DecUInt32 Coalesced;
+            Core::JSON::DecUInt32 Evicted;
+            Core::JSON::DecUInt64 CPUTime; // us, consumed by the replaying thread
+            Core::JSON::DecUInt64 Duration; // us, wall clock
+            Core::JSON::DecUInt32 PerReport; // ns of CPU time per report
+        }; // class ReplayReport
+
     public:
         class ClassicImpl : public Exchange::IBluetooth::IClassic {
         public:
@@ -3582,6 +3689,8 @@ class BluetoothControl : public PluginHost::IPlugin
             , _btInterface(0)
             , _btAddress()
             , _devices()
+            , _coalesced(0)
+            , _evicted(0)
             , _observers()
             , _uuids()
         {
@@ -3729,6 +3838,11 @@ POP_WARNING()
     private:
         uint16_t RemoveDevices(std::function<bool(DeviceImpl*)> filter);
         DeviceImpl* Discovered(const bool lowEnergy, const Bluetooth::Address& address);
+        DeviceImpl* Advertised(const Bluetooth::Address& address, const bool discover, const bool response, const uint32_t signature, const int8_t rssi, bool& process);
+        void Connection(DeviceImpl* device, const uint16_t previous, const uint16_t handle);
+#if defined(BLUETOOTH_DEVELOPMENT)
+        void Replay(const uint32_t reports, const uint16_t devices, ReplayReport& report);
+#endif
         void Notification(const uint8_t subEvent, const uint16_t length, const uint8_t* dataFrame);
         void Capabilities(const Bluetooth::Address& device, const uint8_t capability, const uint8_t authentication, const uint8_t oobData);
         void LoadController(const string& pathName, Data& data) const;
@@ -3766,7 +3880,9 @@ POP_WARNING()
         std::list<uint16_t> _adapters;
         uint16_t _btInterface;
         Bluetooth::Address _btAddress;
-        std::list<DeviceImpl*> _devices;
+        DeviceRegistry _devices;
+        uint32_t _coalesced;
+        uint32_t _evicted;
         std::list<IBluetooth::INotification*> _observers;
         std::list<std::tuple<string /* callsign */, Bluetooth::UUID, uint8_t /* service-bit */>> _uuids;
     }; // class BluetoothControl
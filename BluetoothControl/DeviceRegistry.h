@@ -0,0 +1,269 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <unordered_map>
+
+namespace Thunder {
+
+namespace Plugin {
+
+    // Keeps the devices known to BluetoothControl. The list holds the devices in least-recently-seen
+    // order (front is the oldest), the maps give O(1) access by address/type and by connection handle.
+    // The registry is not thread safe, the owner is expected to hold its own lock around every call.
+    template<typename DEVICE>
+    class DeviceRegistryType {
+    public:
+        using Container = std::list<DEVICE*>;
+        using iterator = typename Container::iterator;
+        using const_iterator = typename Container::const_iterator;
+
+        enum advertisement : uint8_t {
+            REPEATED, // same payload, signal within threshold and inside the coalescing window
+            PAYLOAD,  // new advertising/scan response data
+            SIGNAL,   // same payload, but the RSSI moved beyond the threshold
+            REFRESH   // same payload, but the coalescing window expired
+        };
+
+        static constexpr int8_t RSSI_UNKNOWN = 127; // as reported by the controller if not available
+
+    private:
+        struct Entry {
+            iterator Position;
+            uint64_t Seen;
+            uint64_t Reported;
+            uint32_t Signature[2]; // advertising data, scan response data
+            int8_t RSSI;
+        };
+
+        using AddressMap = std::unordered_map<uint64_t, Entry>;
+        using HandleMap = std::unordered_map<uint16_t, DEVICE*>;
+
+    public:
+        DeviceRegistryType(const DeviceRegistryType&) = delete;
+        DeviceRegistryType& operator=(const DeviceRegistryType&) = delete;
+
+        DeviceRegistryType()
+            : _devices()
+            , _addresses()
+            , _handles()
+            , _window(0)
+            , _threshold(0)
+            , _capacity(~0)
+            , _stale(0)
+        {
+        }
+        ~DeviceRegistryType() = default;
+
+    public:
+        void Configure(const uint16_t window /* ms */, const uint8_t threshold /* dB */, const uint16_t capacity, const uint32_t stale /* s */)
+        {
+            _window = static_cast<uint64_t>(window) * Core::Time::TicksPerMillisecond;
+            _threshold = threshold;
+            _capacity = (capacity == 0 ? static_cast<uint16_t>(~0) : capacity);
+            _stale = static_cast<uint64_t>(stale) * Core::Time::MilliSecondsPerSecond * Core::Time::TicksPerMillisecond;
+        }
+        const Container& List() const
+        {
+            return (_devices);
+        }
+        iterator begin()
+        {
+            return (_devices.begin());
+        }
+        iterator end()
+        {
+            return (_devices.end());
+        }
+        const_iterator begin() const
+        {
+            return (_devices.cbegin());
+        }
+        const_iterator end() const
+        {
+            return (_devices.cend());
+        }
+        uint32_t Count() const
+        {
+            return (static_cast<uint32_t>(_devices.size()));
+        }
+        bool IsFull() const
+        {
+            return (_devices.size() >= _capacity);
+        }
+
+        DEVICE* Find(const Bluetooth::Address& address, const bool lowEnergy) const
+        {
+            typename AddressMap::const_iterator index = _addresses.find(Key(address, lowEnergy));
+            return (index != _addresses.cend() ? *(index->second.Position) : nullptr);
+        }
+        DEVICE* Find(const uint16_t handle) const
+        {
+            typename HandleMap::const_iterator index = _handles.find(handle);
+            return (index != _handles.cend() ? index->second : nullptr);
+        }
+
+        void Add(DEVICE* device)
+        {
+            ASSERT(device != nullptr);
+
+            const uint64_t key = Key(device->Locator(), device->LowEnergy());
+
+            ASSERT(_addresses.find(key) == _addresses.end());
+
+            // Newly added devices have not been seen (yet), so they are the first candidates for eviction.
+            _devices.push_front(device);
+            _addresses.emplace(key, Entry { _devices.begin(), 0, 0, { 0, 0 }, RSSI_UNKNOWN });
+
+            if (device->ConnectionId() != static_cast<uint16_t>(~0)) {
+                _handles[device->ConnectionId()] = device;
+            }
+        }
+        iterator Remove(iterator position)
+        {
+            DEVICE* device = *position;
+
+            _addresses.erase(Key(device->Locator(), device->LowEnergy()));
+
+            typename HandleMap::iterator handle = _handles.begin();
+            while ((handle != _handles.end()) && (handle->second != device)) {
+                handle++;
+            }
+            if (handle != _handles.end()) {
+                _handles.erase(handle);
+            }
+
+            return (_devices.erase(position));
+        }
+        void Connection(DEVICE* device, const uint16_t previous, const uint16_t handle)
+        {
+            if (previous != static_cast<uint16_t>(~0)) {
+                typename HandleMap::iterator index = _handles.find(previous);
+                if ((index != _handles.end()) && (index->second == device)) {
+                    _handles.erase(index);
+                }
+            }
+            if (handle != static_cast<uint16_t>(~0)) {
+                _handles[handle] = device;
+            }
+        }
+
+        // Marks the device as seen and tells if this advertisement carries anything that was not
+        // processed recently. The signature is a hash over the advertising data, so repeated
+        // reports of the same payload can be skipped without parsing the EIR again. Advertising
+        // and scan response data are tracked apart, as most devices alternate between the two.
+        advertisement Advertised(DEVICE* device, const bool response, const uint32_t signature, const int8_t rssi, const uint64_t now)
+        {
+            advertisement result = REPEATED;
+
+            typename AddressMap::iterator index = _addresses.find(Key(device->Locator(), device->LowEnergy()));
+
+            ASSERT(index != _addresses.end());
+
+            if (index != _addresses.end()) {
+                Entry& entry(index->second);
+
+                _devices.splice(_devices.end(), _devices, entry.Position);
+                entry.Seen = now;
+
+                if (entry.Signature[response ? 1 : 0] != signature) {
+                    entry.Signature[response ? 1 : 0] = signature;
+                    result = PAYLOAD;
+                } else if ((_threshold != 0) && (rssi != RSSI_UNKNOWN) && (std::abs(static_cast<int16_t>(rssi) - static_cast<int16_t>(entry.RSSI)) >= _threshold)) {
+                    result = SIGNAL;
+                } else if ((now - entry.Reported) >= _window) {
+                    result = REFRESH;
+                }
+
+                if (result != REPEATED) {
+                    entry.RSSI = rssi;
+                    entry.Reported = now;
+                }
+            }
+
+            return (result);
+        }
+        int8_t RSSI(const DEVICE* device) const
+        {
+            typename AddressMap::const_iterator index = _addresses.find(Key(device->Locator(), device->LowEnergy()));
+            return (index != _addresses.cend() ? index->second.RSSI : RSSI_UNKNOWN);
+        }
+
+        // Walks a bounded number of entries from the least recently seen end and removes the ones the
+        // filter allows to go, if the registry is over capacity or the entry has not been seen for the
+        // configured stale time. Entries that may not be evicted are rotated to the back, their "seen"
+        // stamp is left as is. Returns the evicted devices, the caller owns the reference.
+        template<typename FILTER>
+        uint16_t Evict(const uint64_t now, const uint16_t budget, FILTER&& evictable, std::list<DEVICE*>& evicted)
+        {
+            uint16_t count = 0;
+            size_t visits = std::min(static_cast<size_t>(budget), _devices.size());
+
+            while ((visits-- != 0) && (_devices.empty() == false)) {
+                DEVICE* device = _devices.front();
+                typename AddressMap::const_iterator index = _addresses.find(Key(device->Locator(), device->LowEnergy()));
+
+                ASSERT(index != _addresses.cend());
+
+                const uint64_t seen = index->second.Seen;
+                const bool stale = ((_stale != 0) && (seen != 0) && ((now - seen) >= _stale));
+
+                if ((stale == false) && (_devices.size() <= _capacity)) {
+                    break;
+                } else if (evictable(device) == true) {
+                    Remove(_devices.begin());
+                    evicted.push_back(device);
+                    count++;
+                } else {
+                    _devices.splice(_devices.end(), _devices, _devices.begin());
+                }
+            }
+
+            return (count);
+        }
+
+    private:
+        static uint64_t Key(const Bluetooth::Address& address, const bool lowEnergy)
+        {
+            const uint8_t* raw = reinterpret_cast<const uint8_t*>(address.Data());
+            uint64_t key = (lowEnergy ? (1ULL << 48) : 0);
+
+            for (uint8_t index = 0; index < sizeof(bdaddr_t); index++) {
+                key |= (static_cast<uint64_t>(raw[index]) << (index * 8));
+            }
+
+            return (key);
+        }
+
+    private:
+        Container _devices;
+        AddressMap _addresses;
+        HandleMap _handles;
+        uint64_t _window;
+        uint8_t _threshold;
+        size_t _capacity;
+        uint64_t _stale;
+    };
+
+} // namespace Plugin
+
+}
@@ -532,23 +532,38 @@ namespace Plugin {
 
         if (_transmission == true) {
 
-            const uint32_t chunkSize = ((_firstAudioChunkSize != 0) && (_sequence == 0)? _firstAudioChunkSize : _audioChunkSize);
+            uint32_t chunkSize = ChunkSize();
 
             if (chunkSize != 0) {
                 ASSERT(_buffer != nullptr);
 
-                if (_buffer->Free() < length) {
-                    const uint32_t newSize = std::max((_buffer->Capacity() * 2), (_buffer->Capacity() + length));
-                    TRACE(Trace::Warning, (_T("Ring buffer size is too small, resizing from %d to %d bytes!"), _buffer->Capacity(), newSize));
-                    _buffer->Resize(newSize);
+                uint16_t offset = 0;
+
+                // Nothing pending, so complete chunks can be handed out straight from the decoded frame.
+                while ((_buffer->Used() == 0) && ((length - offset) >= chunkSize)) {
+                    SendOut(_sequence, chunkSize, &(dataBuffer[offset]));
+                    _sequence++;
+                    offset += chunkSize;
+                    chunkSize = NextChunkSize(chunkSize);
                 }
 
-                const uint32_t written = _buffer->Push(length, dataBuffer);
-                DEBUG_VARIABLE(written);
-                ASSERT(written == length);
+                const uint16_t remaining = (length - offset);
+
+                if (remaining != 0) {
+                    if (_buffer->Free() < remaining) {
+                        const uint32_t newSize = std::max((_buffer->Capacity() * 2), (_buffer->Capacity() + remaining));
+                        TRACE(Trace::Warning, (_T("Ring buffer size is too small, resizing from %d to %d bytes!"), _buffer->Capacity(), newSize));
+                        _buffer->Resize(newSize);
+                    }
+
+                    const uint32_t written = _buffer->Push(remaining, &(dataBuffer[offset]));
+                    DEBUG_VARIABLE(written);
+                    ASSERT(written == remaining);
 
-                while (_buffer->Used() >= chunkSize) {
-                    SendOut(chunkSize);
+                    while (_buffer->Used() >= chunkSize) {
+                        SendOut(chunkSize);
+                        chunkSize = NextChunkSize(chunkSize);
+                    }
                 }
             }
             else if (length > 0) {
@@ -589,17 +604,27 @@ namespace Plugin {
     void BluetoothRemoteControl::SendOut(const uint32_t length)
     {
         if (length != 0) {
-            uint8_t* const buffer = static_cast<uint8_t*>(ALLOCA(length));
-            ASSERT(buffer != nullptr);
-
-            const uint32_t read = _buffer->Pop(length, buffer);
+            const uint8_t* data = nullptr;
 
-            if (read > 0) {
-                SendOut(_sequence, read, buffer);
+            if (_buffer->Peek(data) >= length) {
+                // The chunk does not wrap, send it from where it is.
+                SendOut(_sequence, length, data);
+                _buffer->Skip(length);
                 _sequence++;
             }
-            else if (read < length) {
-                ASSERT(!"not enough data");
+            else {
+                uint8_t* const buffer = static_cast<uint8_t*>(ALLOCA(length));
+                ASSERT(buffer != nullptr);
+
+                const uint32_t read = _buffer->Pop(length, buffer);
+
+                if (read > 0) {
+                    SendOut(_sequence, read, buffer);
+                    _sequence++;
+                }
+                else if (read < length) {
+                    ASSERT(!"not enough data");
+                }
             }
         }
     }
@@ -25,6 +25,8 @@
 #include "WAVRecorder.h"
 #include "HID.h"
 
+#include <atomic>
+
 #include <interfaces/IBluetooth.h>
 #include <interfaces/IKeyHandler.h>
 #include <interfaces/IBluetoothRemoteControl.h>
@@ -175,6 +177,27 @@ namespace Plugin {
 
             return (count);
         }
+        // Contiguous view on the oldest data, so it can be consumed in place rather than popped into a copy.
+        SIZE Peek(const uint8_t*& data) const
+        {
+            data = _tail;
+            return (_used == 0 ? 0 : static_cast<SIZE>((_head <= _tail ? _bufferEnd : _head) - _tail));
+        }
+        SIZE Skip(const SIZE length)
+        {
+            const SIZE count = std::min(length, _used);
+            const SIZE first = std::min(count, static_cast<SIZE>(_bufferEnd - _tail));
+
+            _tail = (first == count ? (_tail + count) : (_buffer + (count - first)));
+
+            if (_tail == _bufferEnd) {
+                _tail = _buffer;
+            }
+
+            _used -= count;
+
+            return (count);
+        }
 
     private:
         uint8_t* _buffer;
@@ -318,43 +341,90 @@ namespace Plugin {
 
             class Decoupling : public Core::Thread {
             private:
-                class Slot {
+                // Notifications are copied once, from the GATT socket into a preallocated slot, and are
+                // handled from there. There is no heap traffic per notification.
+                struct Slot {
+                    uint16_t Handle;
+                    uint8_t Length;
+                    uint8_t Data[255];
+                };
+
+                // Single producer (the GATT socket thread), single consumer (the decoupling thread).
+                template<const uint8_t CAPACITY>
+                class SlotRingType {
                 public:
-                    Slot() = delete;
-                    Slot& operator= (const Slot&) = delete;
-                    Slot(const uint16_t handle, const uint8_t length, const uint8_t data[])
-                        : _handle(handle)
-                        , _data(reinterpret_cast<const char*>(data), length) {
+                    SlotRingType(const SlotRingType<CAPACITY>&) = delete;
+                    SlotRingType<CAPACITY>& operator=(const SlotRingType<CAPACITY>&) = delete;
+                    SlotRingType()
+                        : _head(0)
+                        , _tail(0)
+                        , _dropped(0)
+                    {
                     }
-                    Slot(const Slot& copy)
-                        : _handle(copy._handle)
-                        , _data(copy._data) {
+                    ~SlotRingType() = default;
+
+                public:
+                    bool Push(const uint16_t handle, const uint8_t length, const uint8_t data[])
+                    {
+                        const uint8_t head = _head.load(std::memory_order_relaxed);
+                        const uint8_t next = ((head + 1) % CAPACITY);
+                        bool pushed = false;
+
+                        if (next != _tail.load(std::memory_order_acquire)) {
+                            Slot& slot(_slots[head]);
+                            slot.Handle = handle;
+                            slot.Length = length;
+                            ::memcpy(slot.Data, data, length);
+                            _head.store(next, std::memory_order_release);
+                            pushed = true;
+                        }
+
+                        return (pushed);
                     }
-                    ~Slot() {
+                    const Slot* Front() const
+                    {
+                        const uint8_t tail = _tail.load(std::memory_order_relaxed);
+                        return (tail != _head.load(std::memory_order_acquire) ? &(_slots[tail]) : nullptr);
                     }
-                public:
-                    uint16_t Handle() const {
-                        return (_handle);
+                    void Pop()
+                    {
+                        const uint8_t tail = _tail.load(std::memory_order_relaxed);
+                        _tail.store(((tail + 1) % CAPACITY), std::memory_order_release);
                     }
-                    uint8_t Length() const {
-                        return (static_cast<uint8_t>(_data.length()));
+                    // By the producer, for a notification it gave up on.
+                    void Drop()
+                    {
+                        _dropped++;
                     }
-                    const uint8_t* Data() const {
-                        return (reinterpret_cast<const uint8_t*>(_data.c_str()));
+                    uint32_t Dropped() const
+                    {
+                        return (_dropped);
                     }
 
                 private:
-                    uint16_t _handle;
-                    std::string _data;
+                    std::atomic<uint8_t> _head;
+                    std::atomic<uint8_t> _tail;
+                    uint32_t _dropped;
+                    Slot _slots[CAPACITY];
                 };
 
+                // Voice runs at ~100 notifications/s, keep ~0.6s. Keys and battery reports get their own
+                // lane, so they never wait behind queued voice data.
+                using VoiceRing = SlotRingType<64>;
+                using ControlRing = SlotRingType<16>;
+
+                // A dropped key release leaves the key down, so a full control lane holds up the GATT
+                // socket until the worker made room. Only a worker stuck for this long costs a key.
+                static constexpr uint32_t ControlBackPressure = 1000; // ms
+
             public:
                 Decoupling(const Decoupling&) = delete;
                 Decoupling& operator=(const Decoupling&) = delete;
                 Decoupling(GATTRemote* parent)
                     : _parent(*parent)
-                    , _adminLock()
-                    , _queue()
+                    , _voice()
+                    , _control()
+                    , _space(false, true)
                 {
                     ASSERT(parent != nullptr);
                 }
@@ -367,9 +437,32 @@ namespace Plugin {
                 {
                     ASSERT (length > 0);
 
-                    _adminLock.Lock();
-                    _queue.emplace_back(Slot(handle, length, buffer));
-                    _adminLock.Unlock();
+                    // Start and stop of a voice session must stay in order with the voice data.
+                    const bool voice = _parent.IsVoice(handle);
+
+                    if (voice == true) {
+                        if (_voice.Push(handle, length, buffer) == false) {
+                            _voice.Drop();
+                            TRACE(Trace::Warning, (_T("Voice queue full, dropped notification on handle %d (%u dropped)"), handle, _voice.Dropped()));
+                        }
+                    } else {
+                        bool pushed;
+                        uint32_t result = Core::ERROR_NONE;
+
+                        // Reset before trying, so room made in between is not missed.
+                        _space.ResetEvent();
+
+                        while (((pushed = _control.Push(handle, length, buffer)) == false) && (result == Core::ERROR_NONE)) {
+                            Run();
+                            result = _space.Lock(ControlBackPressure);
+                            _space.ResetEvent();
+                        }
+
+                        if (pushed == false) {
+                            _control.Drop();
+                            TRACE(Trace::Error, (_T("Key queue stuck for %u ms, dropped notification on handle %d (%u dropped)"), ControlBackPressure, handle, _control.Dropped()));
+                        }
+                    }
 
                     Run();
                 }
@@ -377,22 +470,30 @@ namespace Plugin {
                 {
                     Block();
 
-                    while (_queue.size() > 0) {
+                    const Slot* slot;
 
-                        _adminLock.Lock();
-                        Slot entry (_queue.front());
-                        _queue.pop_front();
-                        _adminLock.Unlock();
-                        _parent.Message(entry.Handle(), entry.Length(), entry.Data());
-                    }
+                    do {
+                        while ((slot = _control.Front()) != nullptr) {
+                            _parent.Message(slot->Handle, slot->Length, slot->Data);
+                            _control.Pop();
+                            _space.SetEvent();
+                        }
+
+                        if ((slot = _voice.Front()) != nullptr) {
+                            _parent.Message(slot->Handle, slot->Length, slot->Data);
+                            _voice.Pop();
+                        }
+
+                    } while (slot != nullptr);
 
                     return (Core::infinite);
                 }
 
             private:
                 GATTRemote& _parent;
-                Core::CriticalSection _adminLock;
-                std::list<Slot> _queue;
+                VoiceRing _voice;
+                ControlRing _control;
+                Core::Event _space;
             };
 
 #ifdef USE_VOICE_API
@@ -910,6 +1011,10 @@ namespace Plugin {
                 // by the Message method!
                 _decoupling.Submit(handle, static_cast<uint8_t>(length), dataFrame);
             }
+            bool IsVoice(const uint16_t handle) const
+            {
+                return ((handle == _voiceDataHandle) || (handle == _voiceCommandHandle));
+            }
             void Message(const uint16_t handle, const uint8_t length, const uint8_t buffer[])
             {
                 TRACE(Flow, (handle, length, buffer));
@@ -1999,6 +2104,16 @@ namespace Plugin {
         {
             return (TimeToBytes(time, profile.sampleRate, profile.channels, profile.resolution));
         }
+        uint32_t ChunkSize() const
+        {
+            return ((_firstAudioChunkSize != 0) && (_sequence == 0) ? _firstAudioChunkSize : _audioChunkSize);
+        }
+        uint32_t NextChunkSize(const uint32_t current) const
+        {
+            // Without a regular chunk size, the rest of this frame is cut in chunks of the current size.
+            const uint32_t next = ChunkSize();
+            return (next != 0 ? next : current);
+        }
 
     private:
         mutable Core::CriticalSection _adminLock;
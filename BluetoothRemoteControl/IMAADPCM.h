@@ -0,0 +1,178 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Thunder {
+
+namespace Decoders {
+
+    // IMA ADPCM to 16 bit PCM. Instead of working out the step, difference and index adjustment for
+    // every nibble, all 89 x 16 outcomes are calculated once, so decoding a nibble is a single table
+    // lookup followed by the clamp of the predicted value.
+    class IMAADPCM {
+    public:
+        static constexpr uint8_t Steps = 89;
+
+    private:
+        struct Transition {
+            int32_t Delta;
+            uint8_t Next;
+        };
+
+        class Table {
+        public:
+            Table(const Table&) = delete;
+            Table& operator=(const Table&) = delete;
+
+            Table()
+            {
+                static const int8_t IndexLUT[] = {
+                    -1, -1, -1, -1, 2, 4, 6, 8,
+                    -1, -1, -1, -1, 2, 4, 6, 8
+                };
+
+                static const uint16_t StepSizeLUT[] = {
+                    7,     8,     9,     10,    11,    12,    13,    14,
+                    16,    17,    19,    21,    23,    25,    28,    31,
+                    34,    37,    41,    45,    50,    55,    60,    66,
+                    73,    80,    88,    97,    107,   118,   130,   143,
+                    157,   173,   190,   209,   230,   253,   279,   307,
+                    337,   371,   408,   449,   494,   544,   598,   658,
+                    724,   796,   876,   963,   1060,  1166,  1282,  1411,
+                    1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,
+                    3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,
+                    7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+                    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+                    32767
+                };
+
+                for (uint8_t index = 0; index < Steps; index++) {
+                    const int32_t step = StepSizeLUT[index];
+
+                    for (uint8_t nibble = 0; nibble < 16; nibble++) {
+                        int32_t difference = (step >> 3);
+
+                        if ((nibble & 4) != 0) {
+                            difference += step;
+                        }
+                        if ((nibble & 2) != 0) {
+                            difference += (step >> 1);
+                        }
+                        if ((nibble & 1) != 0) {
+                            difference += (step >> 2);
+                        }
+
+                        Transition& entry(_transitions[(index << 4) | nibble]);
+                        entry.Delta = ((nibble & 8) != 0 ? -difference : difference);
+                        entry.Next = static_cast<uint8_t>(std::min(std::max(index + IndexLUT[nibble], 0), Steps - 1));
+                    }
+                }
+            }
+            ~Table() = default;
+
+        public:
+            const Transition& operator()(const uint8_t index, const uint8_t nibble) const
+            {
+                return (_transitions[(index << 4) | nibble]);
+            }
+
+        private:
+            Transition _transitions[Steps * 16];
+        };
+
+    public:
+        IMAADPCM(const IMAADPCM&) = delete;
+        IMAADPCM& operator=(const IMAADPCM&) = delete;
+
+        IMAADPCM()
+            : _table(Instance())
+            , _predicted(0)
+            , _index(0)
+        {
+        }
+        ~IMAADPCM() = default;
+
+    public:
+        void Reset(const int16_t predicted = 0, const uint8_t index = 0)
+        {
+            _predicted = predicted;
+            _index = std::min(index, static_cast<uint8_t>(Steps - 1));
+        }
+        int16_t Predicted() const
+        {
+            return (static_cast<int16_t>(_predicted));
+        }
+        uint8_t Index() const
+        {
+            return (_index);
+        }
+
+        // Low nibble first. Every nibble is decoded, to keep the predictor in sync, but only as many
+        // samples as fit are stored. Returns the number of bytes written to dataOut.
+        uint16_t Decode(const uint16_t lengthIn, const uint8_t dataIn[], const uint16_t lengthOut, uint8_t dataOut[])
+        {
+            int16_t* output = reinterpret_cast<int16_t*>(dataOut);
+            uint32_t room = (lengthOut / sizeof(int16_t));
+            uint32_t stored = 0;
+
+            for (uint16_t index = 0; index < lengthIn; index++) {
+                const uint8_t byte = dataIn[index];
+                const int16_t low = Nibble(byte & 0x0F);
+                const int16_t high = Nibble(byte >> 4);
+
+                if (room >= 2) {
+                    output[stored++] = low;
+                    output[stored++] = high;
+                    room -= 2;
+                } else if (room == 1) {
+                    output[stored++] = low;
+                    room = 0;
+                }
+            }
+
+            return (static_cast<uint16_t>(stored * sizeof(int16_t)));
+        }
+
+    private:
+        static const Table& Instance()
+        {
+            static const Table table;
+            return (table);
+        }
+        inline int16_t Nibble(const uint8_t nibble)
+        {
+            const Transition& entry(_table(_index, nibble));
+
+            _predicted = std::min(std::max(_predicted + entry.Delta, static_cast<int32_t>(-32767)), static_cast<int32_t>(32767));
+            _index = entry.Next;
+
+            return (static_cast<int16_t>(_predicted));
+        }
+
+    private:
+        const Table& _table;
+        int32_t _predicted;
+        uint8_t _index;
+    };
+
+} } // namespace Thunder::Decoders
@@ -0,0 +1,180 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the table driven IMA ADPCM decoder against the nibble by nibble
+// decoder it replaced: the output must be bit exact, and it should be faster.
+
+#include <IMAADPCM.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// The decoder as it was used by the 4MOD and Tech4Home PCM decoders.
+class Reference {
+public:
+    void Reset(const int16_t predicted, const uint8_t index)
+    {
+        _PV_dec = predicted;
+        _SI_dec = index;
+    }
+    uint16_t Decode(const uint16_t lengthIn, const uint8_t dataIn[], const uint16_t lengthOut, uint8_t dataOut[])
+    {
+        uint16_t maxStorage = (lengthOut / 2);
+        int16_t* output = reinterpret_cast<int16_t*>(dataOut);
+        uint16_t stored = 0;
+
+        for (uint16_t index = 0; index < lengthIn; index++) {
+            uint8_t byte = dataIn[index];
+
+            int16_t dec1 = DecodeNibble(byte & 0xF);
+            int16_t dec2 = DecodeNibble((byte >> 4) & 0xF);
+
+            if (maxStorage >= 2) {
+                output[stored++] = dec1;
+                output[stored++] = dec2;
+                maxStorage -= 2;
+            } else if (maxStorage >= 1) {
+                output[stored++] = dec1;
+                maxStorage -= 1;
+            }
+        }
+
+        return (stored * sizeof(int16_t));
+    }
+
+private:
+    int16_t DecodeNibble(const uint8_t nibble)
+    {
+        static const int8_t IndexLUT[] = {
+            -1, -1, -1, -1, 2, 4, 6, 8,
+            -1, -1, -1, -1, 2, 4, 6, 8
+        };
+
+        static const uint16_t StepSizeLUT[] = {
+            7,     8,     9,     10,    11,    12,    13,    14,
+            16,    17,    19,    21,    23,    25,    28,    31,
+            34,    37,    41,    45,    50,    55,    60,    66,
+            73,    80,    88,    97,    107,   118,   130,   143,
+            157,   173,   190,   209,   230,   253,   279,   307,
+            337,   371,   408,   449,   494,   544,   598,   658,
+            724,   796,   876,   963,   1060,  1166,  1282,  1411,
+            1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,
+            3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,
+            7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+            15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+            32767
+        };
+
+        uint16_t step = StepSizeLUT[_SI_dec];
+        uint16_t cum_diff = step >> 3;
+
+        _SI_dec += IndexLUT[nibble];
+
+        if (_SI_dec < 0) {
+            _SI_dec = 0;
+        } else if (_SI_dec > 88) {
+            _SI_dec = 88;
+        }
+
+        if ((nibble & 4) != 0) {
+            cum_diff += step;
+        }
+        if ((nibble & 2) != 0) {
+            cum_diff += step >> 1;
+        }
+        if ((nibble & 1) != 0) {
+            cum_diff += step >> 2;
+        }
+        if ((nibble & 8) != 0) {
+            if (_PV_dec < (-32767 + cum_diff)) {
+                _PV_dec = -32767;
+            } else {
+                _PV_dec -= cum_diff;
+            }
+        } else {
+            if (_PV_dec > (0x7fff - cum_diff)) {
+                _PV_dec = 0x7fff;
+            } else {
+                _PV_dec += cum_diff;
+            }
+        }
+        return (_PV_dec);
+    }
+
+private:
+    int16_t _PV_dec;
+    int8_t _SI_dec;
+};
+
+// 4MOD frames carry 128 bytes of ADPCM, Tech4Home notifications 20 bytes.
+constexpr uint16_t FrameSize = 128;
+constexpr uint16_t Frames = 4096;
+constexpr uint8_t Rounds = 16;
+
+template<typename DECODER>
+double Run(DECODER& decoder, const std::vector<uint8_t>& input, std::vector<uint8_t>& output)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint8_t round = 0; round < Rounds; round++) {
+        for (uint16_t frame = 0; frame < Frames; frame++) {
+            const uint8_t* in = &(input[frame * FrameSize]);
+            // Every frame starts from the predictor/step index its header carries.
+            decoder.Reset(static_cast<int16_t>((in[0] << 8) | in[1]), in[2] % 89);
+            decoder.Decode(FrameSize, in, FrameSize * 4, &(output[frame * FrameSize * 4]));
+        }
+    }
+
+    return (std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (static_cast<double>(Rounds) * Frames * FrameSize * 2));
+}
+
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    std::vector<uint8_t> input(Frames * FrameSize);
+    std::vector<uint8_t> expected(Frames * FrameSize * 4);
+    std::vector<uint8_t> actual(Frames * FrameSize * 4);
+
+    // Random nibbles exercise every transition, including the clamps at both ends.
+    ::srand(0x4D4F44);
+    for (uint8_t& byte : input) {
+        byte = static_cast<uint8_t>(::rand());
+    }
+
+    Reference reference;
+    Thunder::Decoders::IMAADPCM decoder;
+
+    const double before = Run(reference, input, expected);
+    const double after = Run(decoder, input, actual);
+
+    const bool exact = (::memcmp(expected.data(), actual.data(), expected.size()) == 0);
+
+    printf("nibble decoder : %6.2f ns/sample\n", before);
+    printf("table decoder  : %6.2f ns/sample\n", after);
+    printf("speedup        : %6.2fx\n", before / after);
+    printf("output         : %s\n", (exact == true ? "bit exact" : "MISMATCH"));
+
+    return (exact == true ? 0 : 1);
+}
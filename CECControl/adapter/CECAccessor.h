@@ -28,6 +28,7 @@
 #include <CECAdapter.h>
 #include <CECMessage.h>
 #include <CECOperationFrame.h>
+#include <CECScheduler.h>
 #include <CECTypes.h>
 
 #include <cec_device_adapter.h>
@@ -61,9 +62,13 @@ namespace CEC {
             Config()
                 : Node()
                 , Roles()
+                , Retries(2)
+                , Backoff(20)
             {
                 Add(_T("node"), &Node);
                 Add(_T("roles"), &Roles);
+                Add(_T("retries"), &Retries);
+                Add(_T("backoff"), &Backoff);
             }
 
             ~Config() = default;
@@ -71,6 +76,8 @@ namespace CEC {
         public:
             Core::JSON::String Node;
             Core::JSON::ArrayType<Core::JSON::EnumType<cec_adapter_role_t>> Roles;
+            Core::JSON::DecUInt8 Retries; // transmit attempts after a bus error
+            Core::JSON::DecUInt16 Backoff; // ms before the first retry, doubles on every next one
         };
 
         class AdapterImplementation : public IDeviceAdapter {
@@ -114,6 +121,11 @@ namespace CEC {
                 , _roles()
                 , _observersLock()
                 , _observers()
+                , _scheduler(
+                      [this](const cec_adapter_role_t initiator, const logical_address_t follower, const uint8_t length, const uint8_t data[]) {
+                          return (Send(initiator, follower, length, data));
+                      },
+                      config.Retries.Value(), config.Backoff.Value())
             {
                 auto index(config.Roles.Elements());
 
@@ -144,6 +156,9 @@ namespace CEC {
             {
                 TRACE(Trace::Information, ("Exit %s", __FUNCTION__));
 
+                // The scheduler must be quiet before the adapter goes, what is still queued is aborted.
+                _scheduler.Close();
+
                 Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
 
                 cec_adapter_receive(_adapter, nullptr, nullptr);
@@ -159,13 +174,7 @@ namespace CEC {
 
             uint32_t Transmit(const cec_adapter_role_t initiator, const logical_address_t follower, const uint8_t length, const uint8_t data[]) override
             {
-                cec_adapter_error_t result = cec_adapter_transmit(_adapter, static_cast<cec_adapter_role_t>(initiator), static_cast<uint8_t>(follower), length, data);
-
-                string hexData;
-                Core::ToHexString(data, length, hexData);
-                TRACE(Trace::Information, ("%p transmitted[result=0x%04X]: \'%s\'", _adapter, result, hexData.c_str()));
-
-                return Convert(result);
+                return (_scheduler.Transmit(initiator, follower, length, data));
             }
 
             uint32_t Register(INotification* notification) override
@@ -211,6 +220,18 @@ namespace CEC {
             }
 
         private:
+            // Only called from the scheduler thread, so the bus sees one frame at a time.
+            uint32_t Send(const cec_adapter_role_t initiator, const logical_address_t follower, const uint8_t length, const uint8_t data[])
+            {
+                cec_adapter_error_t result = cec_adapter_transmit(_adapter, static_cast<cec_adapter_role_t>(initiator), static_cast<uint8_t>(follower), length, data);
+
+                string hexData;
+                Core::ToHexString(data, length, hexData);
+                TRACE(Trace::Information, ("%p transmitted[result=0x%04X]: \'%s\'", _adapter, result, hexData.c_str()));
+
+                return Convert(result);
+            }
+
             static void AdapterReceived(void* cb_data, const cec_adapter_role_t follower, const uint8_t initiator, const uint8_t length, const uint8_t data[])
             {
                 AdapterImplementation* implementation = reinterpret_cast<AdapterImplementation*>(cb_data);
@@ -266,9 +287,12 @@ namespace CEC {
 
                     Thunder::CEC::Processor::Instance().Process(msg, broadcast);
 
-                    uint32_t result = Transmit(follower, (!broadcast) ? initiator : CEC_LOGICAL_ADDRESS_BROADCAST, msg.Size(), msg.Data());
+                    // Queued, the receive callback should not wait for the bus.
+                    uint32_t result = _scheduler.Submit(follower, (!broadcast) ? initiator : CEC_LOGICAL_ADDRESS_BROADCAST, msg.Size(), msg.Data(), [](const uint32_t code) {
+                        TRACE_GLOBAL(Trace::Information, ("Received: Transmit[result=0x%04X]", code));
+                    });
 
-                    TRACE(Trace::Information, ("Received: Transmit[result=0x%04X]", result));
+                    TRACE(Trace::Information, ("Received: Submit[result=0x%04X]", result));
                 }
             }
 
@@ -279,6 +303,7 @@ namespace CEC {
             role_status_map_t _roles;
             mutable Core::CriticalSection _observersLock;
             std::list<INotification*> _observers; // Fix/Check lifetime
+            Scheduler _scheduler;
         };
 
         friend class Core::SingletonType<CECAccessor>;
@@ -9,20 +9,21 @@ namespace Thunder {
 namespace CEC {
     void Processor::Process(/*const cec_adapter_role_t role, */ Thunder::CEC::OperationFrame& operation, bool& broadcast)
     {
-        Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
+        // Counted before the lookup, so a Revoke that cleared the entry waits until this is out of the service.
+        _active.fetch_add(1);
 
-        auto index(_awnsers.find(operation.OpCode()));
+        Service* service(_awnsers[operation.OpCode()].load());
 
         uint8_t responseLength(0);
         uint8_t* payload(operation.LockParameters());
 
-        if (index != _awnsers.end()) {
-            responseLength = (index->second)->Handle(OperationFrame::MaxLength, operation.Size() - OperationFrame::OpCodeLength, payload);
+        if (service != nullptr) {
+            responseLength = service->Handle(OperationFrame::MaxLength, operation.Size() - OperationFrame::OpCodeLength, payload);
 
             if (responseLength != uint8_t(~0)) {
                 // Seems like it's a valid request and we have a response.
-                broadcast = (index->second)->IsBroadcast();
-                operation.OpCode((index->second)->ResponseOpCode());
+                broadcast = service->IsBroadcast();
+                operation.OpCode(service->ResponseOpCode());
             } else {
                 // Validation of payload failed...
                 broadcast = false;
@@ -38,6 +39,8 @@ namespace CEC {
             responseLength = 1;
         }
 
+        _active.fetch_sub(1, std::memory_order_release);
+
         operation.UnlockParameters(responseLength);
 
         TRACE(Trace::Information, ("Awnser operation: Length: %d, Opcode 0x%02x, %s.", operation.Size(), operation.OpCode(), broadcast ? "broadcast" : "direct"));
@@ -46,10 +49,10 @@ namespace CEC {
     uint32_t Processor::Announce(Service* service)
     {
         Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
-        auto index = _awnsers.find(service->RequestOpCode());
+        std::atomic<Service*>& entry(_awnsers[service->RequestOpCode()]);
 
-        if (index == _awnsers.end()) {
-            _awnsers.emplace(std::make_pair(service->RequestOpCode(), service));
+        if (entry.load(std::memory_order_relaxed) == nullptr) {
+            entry.store(service, std::memory_order_release);
             TRACE(Trace::Information, ("Announced opcode 0x%02X, %p", service->RequestOpCode(), service));
         } else {
             TRACE(Trace::Error, ("Skipped awnser id 0x%02x, it was allready annouced", service->RequestOpCode()));
@@ -61,10 +64,16 @@ namespace CEC {
     uint32_t Processor::Revoke(Service* service)
     {
         Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
-        auto index = _awnsers.find(service->RequestOpCode());
+        std::atomic<Service*>& entry(_awnsers[service->RequestOpCode()]);
 
-        if (index != _awnsers.end()) {
-            _awnsers.erase(index);
+        if (entry.load(std::memory_order_relaxed) == service) {
+            entry.store(nullptr);
+
+            // A frame that found it before it was cleared, may still be in it. Services go away when the
+            // library is unloaded, so waiting out the frames in flight is cheap.
+            while (_active.load() != 0) {
+                std::this_thread::yield();
+            }
         } else {
             TRACE(Trace::Error, ("Skipped awnser id 0x%02x, it was not found", service->RequestOpCode()));
         }
@@ -23,6 +23,10 @@
 
 #include <CECTypes.h>
 
+#include <array>
+#include <atomic>
+#include <thread>
+
 namespace Thunder {
 namespace CEC {
     class Service;
@@ -37,7 +41,11 @@ namespace CEC {
         Processor()
             : _adminLock()
             , _awnsers()
+            , _active(0)
         {
+            for (auto& entry : _awnsers) {
+                entry.store(nullptr, std::memory_order_relaxed);
+            }
         }
 
         ~Processor()
@@ -70,6 +78,10 @@ namespace CEC {
 
         /**
          * @brief Processes a received frame.
+         *        The service is looked up in a table indexed by opcode without
+         *        taking a lock, so the adapters answer frames concurrently. The
+         *        services keep no state of their own, or guard it themselves.
+         *        The admin lock only serializes Announce and Revoke.
          *        An anwser is always formulated in the message provided.
          *        So after calling this method you always will have a awnser
          *        and the orginal @message is overwritten.
@@ -83,7 +95,8 @@ namespace CEC {
 
     private:
         mutable Core::CriticalSection _adminLock;
-        std::map<uint8_t, Service*> _awnsers;
+        std::array<std::atomic<Service*>, 256> _awnsers;
+        std::atomic<uint32_t> _active; // frames being processed
 
     }; // class Processor
 } // namespace CEC
@@ -0,0 +1,354 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <CECTypes.h>
+
+#include "CECOperationFrame.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+
+namespace Thunder {
+namespace CEC {
+    /**
+     * @brief Outbound CEC traffic, queued per logical destination.
+     *
+     *        The destinations are served round robin, one frame per turn, so a
+     *        burst of key presses to the TV is not serialized behind polls to a
+     *        device that does not acknowledge. A frame that fails with a bus
+     *        error is retried with an exponential backoff, while it waits the
+     *        other destinations keep going. Frames to the same destination
+     *        leave in the order they were submitted.
+     *
+     *        A frame that is identical to one that is still pending for the
+     *        same destination is merged with it, both submitters get the result
+     *        of that single transmission. User control frames are never merged,
+     *        a repeated key press is a key repeat.
+     */
+    class Scheduler : public Core::Thread {
+    public:
+        using Transmitter = std::function<uint32_t(const cec_adapter_role_t initiator, const logical_address_t follower, const uint8_t length, const uint8_t data[])>;
+        using Completion = std::function<void(const uint32_t result)>;
+
+        static constexpr uint8_t Destinations = 16;
+
+    private:
+        struct Frame {
+            cec_adapter_role_t Initiator;
+            uint8_t Length;
+            uint8_t Data[OperationFrame::MaxLength];
+            uint8_t Attempts;
+            uint64_t Due;
+            Completion Done;
+        };
+
+        using Queue = std::list<Frame>;
+
+    public:
+        Scheduler() = delete;
+        Scheduler(const Scheduler&) = delete;
+        Scheduler& operator=(const Scheduler&) = delete;
+
+        Scheduler(const Transmitter& transmitter, const uint8_t retries, const uint16_t backoff /* ms */)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("CECScheduler"))
+            , _adminLock()
+            , _transmitter(transmitter)
+            , _retries(retries)
+            , _backoff(static_cast<uint64_t>(backoff) * Core::Time::TicksPerMillisecond)
+            , _queues()
+            , _active()
+            , _free()
+            , _next(0)
+            , _signal(false, true)
+            , _transmitted(0)
+            , _coalesced(0)
+            , _retried(0)
+        {
+            ASSERT(_transmitter != nullptr);
+
+            Run();
+        }
+        ~Scheduler() override
+        {
+            Close();
+        }
+
+    public:
+        /**
+         * @brief Stop transmitting and abort whatever is still queued.
+         *        Returns once the scheduler thread is no longer touching the
+         *        transmitter, so the owner can tear that down safely. Frames
+         *        submitted after this are refused.
+         */
+        void Close()
+        {
+            Queue aborted;
+
+            Stop();
+            // Wake up an idle worker, otherwise it never sees that it has to stop.
+            _signal.SetEvent();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+            _adminLock.Lock();
+            for (Queue& queue : _queues) {
+                aborted.splice(aborted.end(), queue);
+            }
+            _adminLock.Unlock();
+
+            // Whatever did not make it onto the bus is completed, nobody should be left waiting.
+            for (Frame& frame : aborted) {
+                if (frame.Done != nullptr) {
+                    frame.Done(Core::ERROR_ASYNC_ABORTED);
+                    frame.Done = nullptr;
+                }
+            }
+
+            _adminLock.Lock();
+            _free.splice(_free.end(), aborted);
+            _adminLock.Unlock();
+        }
+
+        /**
+         * @brief Queue a frame for transmission.
+         *
+         * @param initiator - Role the frame is sent from
+         * @param follower - Logical address of the destination
+         * @param length - Length of the opcode and operands, 0 for a poll
+         * @param data - The opcode and operands
+         * @param done - Called from the scheduler thread with the final result, may be empty
+         * @return  uint32_t possible error codes:
+         *  - ERROR_NONE - The frame is queued.
+         *  - ERROR_INVALID_RANGE - The destination or length is out of range.
+         *  - ERROR_ILLEGAL_STATE - The scheduler is shutting down.
+         */
+        uint32_t Submit(const cec_adapter_role_t initiator, const logical_address_t follower, const uint8_t length, const uint8_t data[], Completion&& done)
+        {
+            uint32_t result(Core::ERROR_NONE);
+
+            if ((follower >= Destinations) || (length > OperationFrame::MaxLength)) {
+                result = Core::ERROR_INVALID_RANGE;
+            } else {
+                Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
+
+                // Checked under the lock, so a frame is either refused or aborted by Close().
+                if (IsRunning() == false) {
+                    return (Core::ERROR_ILLEGAL_STATE);
+                }
+
+                Queue& queue(_queues[follower]);
+                Queue::iterator index(queue.end());
+
+                if (IsMergeable(length, data) == true) {
+                    index = std::find_if(queue.begin(), queue.end(), [&](const Frame& frame) {
+                        return ((frame.Initiator == initiator) && (frame.Length == length) && (::memcmp(frame.Data, data, length) == 0));
+                    });
+                }
+
+                if (index != queue.end()) {
+                    if (done != nullptr) {
+                        if (index->Done == nullptr) {
+                            index->Done = std::move(done);
+                        } else {
+                            Completion first(std::move(index->Done));
+                            index->Done = [first, done](const uint32_t code) { first(code); done(code); };
+                        }
+                    }
+                    _coalesced++;
+                } else {
+                    if (_free.empty() == true) {
+                        _free.emplace_back();
+                    }
+
+                    Frame& frame(_free.front());
+                    frame.Initiator = initiator;
+                    frame.Length = length;
+                    frame.Attempts = 0;
+                    frame.Due = 0;
+                    frame.Done = std::move(done);
+
+                    if (length > 0) {
+                        ::memcpy(frame.Data, data, length);
+                    }
+
+                    queue.splice(queue.end(), _free, _free.begin());
+
+                    _signal.SetEvent();
+                }
+            }
+
+            return (result);
+        }
+
+        /**
+         * @brief Queue a frame and wait until it is on the bus, or given up on.
+         *        Must not be called from a completion, that would block the
+         *        scheduler thread on itself.
+         *
+         * @return  uint32_t the result of the (last) transmission or the queuing error.
+         */
+        uint32_t Transmit(const cec_adapter_role_t initiator, const logical_address_t follower, const uint8_t length, const uint8_t data[])
+        {
+            // The completion may still be inside SetEvent when the waiter returns,
+            // so the outcome is shared rather than living on this stack.
+            struct Outcome {
+                Outcome()
+                    : Event(false, true)
+                    , Result(Core::ERROR_UNAVAILABLE)
+                {
+                }
+
+                Core::Event Event;
+                uint32_t Result;
+            };
+
+            std::shared_ptr<Outcome> outcome(std::make_shared<Outcome>());
+
+            uint32_t result = Submit(initiator, follower, length, data, [outcome](const uint32_t code) {
+                outcome->Result = code;
+                outcome->Event.SetEvent();
+            });
+
+            if (result == Core::ERROR_NONE) {
+                outcome->Event.Lock(Core::infinite);
+                result = outcome->Result;
+            }
+
+            return (result);
+        }
+
+        uint32_t Pending() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
+
+            uint32_t count(static_cast<uint32_t>(_active.size()));
+
+            for (const Queue& queue : _queues) {
+                count += static_cast<uint32_t>(queue.size());
+            }
+
+            return (count);
+        }
+        uint32_t Transmitted() const
+        {
+            return (_transmitted);
+        }
+        uint32_t Coalesced() const
+        {
+            return (_coalesced);
+        }
+        uint32_t Retried() const
+        {
+            return (_retried);
+        }
+
+    private:
+        static bool IsMergeable(const uint8_t length, const uint8_t data[])
+        {
+            return ((length == 0) || ((data[0] != USER_CONTROL_PRESSED) && (data[0] != USER_CONTROL_RELEASED)));
+        }
+        static bool IsRetryable(const uint32_t result)
+        {
+            return ((result == Core::ERROR_GENERAL) || (result == Core::ERROR_UNAVAILABLE));
+        }
+
+        uint32_t Worker() override
+        {
+            uint64_t now(Core::Time::Now().Ticks());
+            uint64_t wakeup(~0);
+            uint8_t destination(Destinations);
+
+            _adminLock.Lock();
+
+            for (uint8_t count = 0; (count < Destinations) && (destination == Destinations); count++) {
+                const uint8_t index((_next + count) % Destinations);
+                Queue& queue(_queues[index]);
+
+                if (queue.empty() == false) {
+                    if (queue.front().Due <= now) {
+                        // Taken off the queue, so nothing gets merged into a frame that is already on the bus.
+                        _active.splice(_active.end(), queue, queue.begin());
+                        destination = index;
+                        _next = (index + 1) % Destinations;
+                    } else {
+                        wakeup = std::min(wakeup, queue.front().Due);
+                    }
+                }
+            }
+
+            _adminLock.Unlock();
+
+            if (destination != Destinations) {
+                Frame& frame(_active.front());
+                Completion done;
+
+                const uint32_t result = _transmitter(frame.Initiator, static_cast<logical_address_t>(destination), frame.Length, frame.Data);
+
+                _transmitted++;
+
+                _adminLock.Lock();
+
+                if ((IsRetryable(result) == true) && (frame.Attempts < _retries) && (IsRunning() == true)) {
+                    frame.Due = Core::Time::Now().Ticks() + (_backoff << frame.Attempts);
+                    frame.Attempts++;
+                    _retried++;
+
+                    // Back in front, the frames behind it for this destination keep their order.
+                    _queues[destination].splice(_queues[destination].begin(), _active, _active.begin());
+                } else {
+                    done = std::move(frame.Done);
+                    frame.Done = nullptr;
+                    _free.splice(_free.end(), _active, _active.begin());
+                }
+
+                _adminLock.Unlock();
+
+                if (done != nullptr) {
+                    done(result);
+                }
+            } else if (IsRunning() == true) {
+                _signal.Lock(wakeup == static_cast<uint64_t>(~0) ? Core::infinite : static_cast<uint32_t>(((wakeup - now) + Core::Time::TicksPerMillisecond - 1) / Core::Time::TicksPerMillisecond));
+                _signal.ResetEvent();
+            }
+
+            return (0);
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        Transmitter _transmitter;
+        const uint8_t _retries;
+        const uint64_t _backoff;
+        std::array<Queue, Destinations> _queues;
+        Queue _active;
+        Queue _free;
+        uint8_t _next;
+        Core::Event _signal;
+        std::atomic<uint32_t> _transmitted;
+        uint32_t _coalesced;
+        uint32_t _retried;
+    }; // class Scheduler
+} // namespace CEC
+} // namespace Thunder
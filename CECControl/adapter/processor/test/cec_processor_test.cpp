@@ -4,22 +4,213 @@
 
 #include <CECOperationFrame.h>
 #include <CECProcessor.h>
+#include <CECScheduler.h>
 
 #include <localtracer/localtracer.h>
 #include <messaging/messaging.h>
 
+#include <algorithm>
 #include <chrono>
 #include <core/core.h>
+#include <mutex>
+#include <set>
 #include <stdarg.h>
 #include <thread>
 #include <time.h>
+#include <vector>
 
 using namespace Thunder::CEC;
 
 MODULE_NAME_DECLARATION(BUILD_REFERENCE)
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// CEC bit timing, a 4.5 ms start bit and 10 bits of 2.4 ms for every block, sped up so the
+// benchmark does not take seconds. A follower that is not there leaves the header unacknowledged.
+constexpr uint32_t Speedup = 20;
+constexpr uint8_t Retries = 2;
+constexpr uint16_t Backoff = 2; // ms
+
+class SimulatedBus {
+public:
+    SimulatedBus(const SimulatedBus&) = delete;
+    SimulatedBus& operator=(const SimulatedBus&) = delete;
+
+    SimulatedBus(const std::set<uint8_t>& absent)
+        : _lock()
+        , _absent(absent)
+        , _keys()
+    {
+    }
+    ~SimulatedBus() = default;
+
+public:
+    uint32_t Transmit(const cec_adapter_role_t /* initiator */, const logical_address_t follower, const uint8_t length, const uint8_t data[])
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+
+        const bool acknowledged = (_absent.find(follower) == _absent.end());
+        const uint32_t blocks = (acknowledged == true ? (1 + length) : 1);
+
+        std::this_thread::sleep_for(std::chrono::microseconds((4500 + (blocks * 24000)) / Speedup));
+
+        if ((acknowledged == true) && (length > 0) && ((data[0] == USER_CONTROL_PRESSED) || (data[0] == USER_CONTROL_RELEASED))) {
+            _keys.push_back((data[0] << 8) | (length > 1 ? data[1] : 0));
+        }
+
+        return (acknowledged == true ? uint32_t(Thunder::Core::ERROR_NONE) : uint32_t(Thunder::Core::ERROR_GENERAL));
+    }
+    const std::vector<uint16_t>& Keys() const
+    {
+        return (_keys);
+    }
+    void Clear()
+    {
+        _keys.clear();
+    }
+
+private:
+    std::mutex _lock;
+    const std::set<uint8_t> _absent;
+    std::vector<uint16_t> _keys;
+};
+
+struct Traffic {
+    logical_address_t Follower;
+    uint8_t Length;
+    uint8_t Data[2];
+    bool Key;
+};
+
+// Periodic polls to devices that went away, followed by a burst of key presses for the TV.
+std::vector<Traffic> Workload(const std::set<uint8_t>& absent, std::vector<uint16_t>& keys)
+{
+    std::vector<Traffic> traffic;
+
+    for (uint8_t round = 0; round < 3; round++) {
+        for (const uint8_t address : absent) {
+            traffic.push_back({ static_cast<logical_address_t>(address), 0, { 0, 0 }, false });
+        }
+    }
+
+    for (uint8_t key = 0; key < 8; key++) {
+        traffic.push_back({ CEC_LOGICAL_ADDRESS_TV, 2, { USER_CONTROL_PRESSED, key }, true });
+        traffic.push_back({ CEC_LOGICAL_ADDRESS_TV, 1, { USER_CONTROL_RELEASED, 0 }, true });
+        keys.push_back((USER_CONTROL_PRESSED << 8) | key);
+        keys.push_back(USER_CONTROL_RELEASED << 8);
+    }
+
+    return (traffic);
+}
+
+struct Result {
+    double Median; // ms
+    double Worst; // ms
+    double Total; // ms
+};
+
+Result Summarize(const std::vector<Traffic>& traffic, const Clock::time_point start, const std::vector<Clock::time_point>& completed)
+{
+    std::vector<double> latencies;
+    Clock::time_point last(start);
+
+    for (uint32_t index = 0; index < traffic.size(); index++) {
+        if (traffic[index].Key == true) {
+            latencies.push_back(std::chrono::duration<double, std::milli>(completed[index] - start).count());
+        }
+        last = std::max(last, completed[index]);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    return { latencies[latencies.size() / 2], latencies.back(), std::chrono::duration<double, std::milli>(last - start).count() };
+}
+
+// Every frame in submission order, retries inline, as the adapter transmitted before it had a scheduler.
+Result Serialized(SimulatedBus& bus, const std::vector<Traffic>& traffic)
+{
+    std::vector<Clock::time_point> completed(traffic.size());
+    const Clock::time_point start(Clock::now());
+
+    for (uint32_t index = 0; index < traffic.size(); index++) {
+        const Traffic& frame(traffic[index]);
+
+        for (uint8_t attempt = 0; bus.Transmit(CEC_DEVICE_PLAYBACK, frame.Follower, frame.Length, frame.Data) != Thunder::Core::ERROR_NONE && attempt < Retries; attempt++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(Backoff << attempt));
+        }
+
+        completed[index] = Clock::now();
+    }
+
+    return (Summarize(traffic, start, completed));
+}
+
+Result Scheduled(SimulatedBus& bus, const std::vector<Traffic>& traffic, uint32_t& transmitted, uint32_t& coalesced)
+{
+    std::vector<Clock::time_point> completed(traffic.size());
+    std::atomic<uint32_t> remaining(static_cast<uint32_t>(traffic.size()));
+    Thunder::Core::Event done(false, true);
+
+    Scheduler scheduler([&bus](const cec_adapter_role_t initiator, const logical_address_t follower, const uint8_t length, const uint8_t data[]) {
+        return (bus.Transmit(initiator, follower, length, data));
+    },
+        Retries, Backoff);
+
+    const Clock::time_point start(Clock::now());
+
+    for (uint32_t index = 0; index < traffic.size(); index++) {
+        const Traffic& frame(traffic[index]);
+
+        scheduler.Submit(CEC_DEVICE_PLAYBACK, frame.Follower, frame.Length, frame.Data, [&, index](const uint32_t) {
+            completed[index] = Clock::now();
+            if (remaining.fetch_sub(1) == 1) {
+                done.SetEvent();
+            }
+        });
+    }
+
+    done.Lock(Thunder::Core::infinite);
+
+    transmitted = scheduler.Transmitted();
+    coalesced = scheduler.Coalesced();
+
+    return (Summarize(traffic, start, completed));
+}
+
+// Nanoseconds per processed frame, with the given number of threads answering at the same time.
+double Dispatch(const uint8_t threads, const uint32_t frames)
+{
+    std::vector<std::thread> workers;
+    const Clock::time_point start(Clock::now());
+
+    for (uint8_t thread = 0; thread < threads; thread++) {
+        workers.emplace_back([frames]() {
+            for (uint32_t count = 0; count < frames; count++) {
+                OperationFrame operation;
+                bool broadcast;
+
+                operation.OpCode(((count & 1) == 0) ? GIVE_DEVICE_POWER_STATUS : GET_CEC_VERSION);
+
+                Processor::Instance().Process(operation, broadcast);
+            }
+        });
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    return (std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (static_cast<double>(threads) * frames));
+}
+
+} // namespace
+
 int main(int /*argc*/, const char* argv[])
 {
+    int result(0);
+
     {
         Messaging::LocalTracer& tracer = Messaging::LocalTracer::Open();
         Messaging::ConsolePrinter printer(false);
@@ -59,10 +250,56 @@ int main(int /*argc*/, const char* argv[])
             TRACE(Trace::Information, ("OpCode 0x%02x [%d] %s. raw data: \'%s\'", *ci, broadcast ? "Broadcast" : "Addressed", (operation.OpCode() != FEATURE_ABORT) ? "OK" : "NOK", sdata.c_str()));
         }
 
+        printf("dispatch 1 thread  : %7.1f ns/frame\n", Dispatch(1, 200000));
+        printf("dispatch 4 threads : %7.1f ns/frame\n", Dispatch(4, 200000));
+
+        const std::set<uint8_t> absent = { CEC_LOGICAL_ADDRESS_PLAYBACK_1, CEC_LOGICAL_ADDRESS_PLAYBACK_2, CEC_LOGICAL_ADDRESS_PLAYBACK_3 };
+        std::vector<uint16_t> keys;
+        const std::vector<Traffic> traffic(Workload(absent, keys));
+        SimulatedBus bus(absent);
+        uint32_t transmitted(0);
+        uint32_t coalesced(0);
+
+        const Result before(Serialized(bus, traffic));
+        const bool serializedInOrder = (bus.Keys() == keys);
+        bus.Clear();
+
+        const Result after(Scheduled(bus, traffic, transmitted, coalesced));
+        const bool scheduledInOrder = (bus.Keys() == keys);
+
+        printf("serialized : key latency median %6.1f ms, worst %6.1f ms, all frames done in %6.1f ms\n", before.Median, before.Worst, before.Total);
+        printf("scheduled  : key latency median %6.1f ms, worst %6.1f ms, all frames done in %6.1f ms\n", after.Median, after.Worst, after.Total);
+        printf("scheduled  : %u frames submitted, %u transmissions, %u coalesced\n", static_cast<uint32_t>(traffic.size()), transmitted, coalesced);
+        printf("key order  : %s\n", ((serializedInOrder == true) && (scheduledInOrder == true)) ? "preserved" : "BROKEN");
+
+        if ((serializedInOrder == false) || (scheduledInOrder == false)) {
+            result = 1;
+        }
+
+        {
+            // An idle scheduler is parked on its signal, closing it must still return.
+            Scheduler idle([](const cec_adapter_role_t, const logical_address_t, const uint8_t, const uint8_t[]) {
+                return (Core::ERROR_NONE);
+            },
+                Retries, Backoff);
+
+            SleepMs(10);
+            idle.Close();
+
+            const uint8_t poll[1] = { 0 };
+            const bool refused = (idle.Submit(CEC_DEVICE_PLAYBACK, CEC_LOGICAL_ADDRESS_TV, 0, poll, nullptr) == Core::ERROR_ILLEGAL_STATE);
+
+            printf("close      : %s\n", (refused == true) ? "ok" : "BROKEN");
+
+            if (refused == false) {
+                result = 1;
+            }
+        }
+
         tracer.Close();
 
         Thunder::Core::Singleton::Dispose();
     }
 
-    return 0;
+    return (result);
 }
\ No newline at end of file
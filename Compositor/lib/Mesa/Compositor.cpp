@@ -26,19 +26,24 @@
 
 #include <IBuffer.h>
 #include <IOutput.h>
+#include <FrameScheduler.h>
 #include <IRenderer.h>
+#include <Occlusion.h>
 #include <Transformation.h>
 
 #include <graphicsbuffer/GraphicsBufferType.h>
 
 #include <CompositorUtils.h>
+#include <DRM.h>
 
 #include <drm_fourcc.h>
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <iomanip>
+#include <thread>
 
 MODULE_NAME_DECLARATION(BUILD_REFERENCE)
 
@@ -47,6 +52,7 @@ namespace Plugin {
     const Compositor::Color pink = { 1.0f, 0.411f, 0.705f, 1.0f };
     const Compositor::Color black = { 0.f, 0.f, 0.f, 1.0f };
     constexpr char DefaultRenderNode[] = "/dev/dri/renderD128";
+    constexpr uint16_t DefaultRenderMargin = 1000; // us
 
     class CompositorImplementation
         : public Exchange::IComposition,
@@ -69,6 +75,8 @@ namespace Plugin {
                 , Modifier(DRM_FORMAT_MOD_INVALID) // auto select
                 , Output()
                 , AutoScale(true)
+                , RenderMargin(DefaultRenderMargin)
+                , ProgramCache()
             {
                 Add(_T("render"), &Render);
                 Add(_T("resolution"), &Resolution);
@@ -76,6 +84,8 @@ namespace Plugin {
                 Add(_T("modifier"), &Modifier);
                 Add(_T("output"), &Output);
                 Add(_T("autoscale"), &AutoScale);
+                Add(_T("rendermargin"), &RenderMargin);
+                Add(_T("programcache"), &ProgramCache);
             }
 
             ~Config() override = default;
@@ -86,6 +96,8 @@ namespace Plugin {
             Core::JSON::HexUInt64 Modifier;
             Core::JSON::String Output;
             Core::JSON::Boolean AutoScale;
+            Core::JSON::DecUInt16 RenderMargin;
+            Core::JSON::String ProgramCache; // relative to the persistent path, empty to compile the shaders on every start
         };
 
         class DisplayDispatcher : public RPC::Communicator {
@@ -553,6 +565,7 @@ namespace Plugin {
                 , _activeId(InvalidBufferId)
                 , _retiredId(InvalidBufferId)
                 , _stats()
+                , _projection()
             {
                 TRACE(Trace::Information, (_T("Client Constructed %s[%p] id:%d %dx%d"), _callsign.c_str(), this, _id, _width, _height));
             }
@@ -790,10 +803,32 @@ namespace Plugin {
                 return _geometryChanged;
             }
 
+            // Only touched by the render thread. Made again when the box it is rendered in, the transform or
+            // the output (the projection of the renderer) changed since the last frame, not on every frame.
+            const Compositor::Matrix& Projection(const Exchange::IComposition::Rectangle& box, const Compositor::Transformation::TransformType transform, const uint32_t output, const Compositor::Matrix& projection)
+            {
+                if ((_projection.Output != output) || (_projection.Transform != transform) || (_projection.Box.x != box.x) || (_projection.Box.y != box.y) || (_projection.Box.width != box.width) || (_projection.Box.height != box.height)) {
+                    Compositor::Transformation::ProjectBox(_projection.Matrix, box, transform, 0, projection);
+
+                    _projection.Box = box;
+                    _projection.Transform = transform;
+                    _projection.Output = output;
+                }
+
+                return (_projection.Matrix);
+            }
+
             Exchange::IComposition::Rectangle Geometry() const override
             {
                 return _geometry;
             }
+            // Nothing below shows through: a buffer without alpha, drawn fully opaque.
+            bool IsOpaque()
+            {
+                const uint8_t id = _currentId.load(std::memory_order_acquire);
+
+                return ((_opacity >= Exchange::IComposition::maxOpacity) && (id < _buffers.Count()) && (_buffers[id].IsValid() == true) && (Compositor::DRM::HasAlpha(_buffers[id]->Format()) == false));
+            }
             uint32_t ZOrder(const uint16_t index) override
             {
                 _zIndex = index;
@@ -878,6 +913,13 @@ namespace Plugin {
 
             Stats _stats;
 
+            struct alignas(16) {
+                Compositor::Matrix Matrix;
+                Exchange::IComposition::Rectangle Box;
+                Compositor::Transformation::TransformType Transform;
+                uint32_t Output; // 0, never projected
+            } _projection;
+
             static uint32_t _sequence;
         }; // class Client
 
@@ -1071,6 +1113,15 @@ namespace Plugin {
             , _frameTime(0)
             , _renderPending(false)
             , _terminated(false)
+            , _composition()
+            , _layers()
+            , _occluded(0)
+            , _clearsSkipped(0)
+            , _scheduler(new Compositor::FrameScheduler(DefaultRenderMargin))
+            , _target(0)
+            , _outputWidth(0)
+            , _outputHeight(0)
+            , _outputGeneration(0)
         {
         }
         ~CompositorImplementation() override
@@ -1118,6 +1169,7 @@ namespace Plugin {
             _service = service;
             _service->AddRef();
 
+            const uint64_t start(Core::Time::Now().Ticks());
             uint32_t result = Core::ERROR_NONE;
             Config config;
 
@@ -1146,13 +1198,25 @@ namespace Plugin {
                 return Core::ERROR_OPENING_FAILED;
             }
 
-            _renderer = Compositor::IRenderer::Instance(_renderDescriptor);
+            string programCache;
+
+            if (config.ProgramCache.IsSet() == false) {
+                programCache = _service->PersistentPath() + _T("programs");
+            } else if ((config.ProgramCache.Value().empty() == false) && (config.ProgramCache.Value()[0] != '/')) {
+                programCache = _service->PersistentPath() + config.ProgramCache.Value();
+            } else {
+                programCache = config.ProgramCache.Value();
+            }
+
+            _renderer = Compositor::IRenderer::Instance(_renderDescriptor, programCache);
             ASSERT(_renderer.IsValid());
 
             if (config.AutoScale.IsSet() == true) {
                 _autoScale = config.AutoScale.Value();
             }
 
+            _scheduler.reset(new Compositor::FrameScheduler(config.RenderMargin.Value()));
+
             if (config.Output.IsSet() == false) {
                 TRACE(Trace::Error, (_T("Output is not set in the configuration")));
                 return Core::ERROR_INCOMPLETE_CONFIG;
@@ -1187,6 +1251,9 @@ namespace Plugin {
 
             RenderOutput(); // guarantee that the output is rendered once.
 
+            // Compare a cold start (empty program cache) with a warm one.
+            TRACE(Trace::Information, (_T("First frame %u ms after configure, program cache %s"), static_cast<uint32_t>((Core::Time::Now().Ticks() - start) / Core::Time::TicksPerMillisecond), (programCache.empty() == true ? _T("off") : programCache.c_str())));
+
             string basePath;
             Core::SystemInfo::GetEnvironment(_T("XDG_RUNTIME_DIR"), basePath);
             basePath = Core::Directory::Normalize(basePath);
@@ -1350,12 +1417,14 @@ namespace Plugin {
         END_INTERFACE_MAP
 
     private:
-        void VSync(const Compositor::IOutput* output VARIABLE_IS_NOT_USED, const uint64_t sequence VARIABLE_IS_NOT_USED, const uint64_t pts VARIABLE_IS_NOT_USED /*usec since epoch*/)
+        void VSync(const Compositor::IOutput* output VARIABLE_IS_NOT_USED, const uint64_t sequence, const uint64_t pts /*usec, CLOCK_MONOTONIC*/)
         {
             if (_terminated.load(std::memory_order_acquire)) {
                 return;
             }
 
+            _scheduler->Presented(sequence, pts);
+
             // Signal Published to all clients - retired buffers can be released to GBM
             {
                 std::lock_guard<std::mutex> lock(_clientLock);
@@ -1385,6 +1454,27 @@ namespace Plugin {
             _present.Run();
         }
 
+        // Waits until composing can start as late as possible for the next vblank, false if stopped meanwhile.
+        bool Schedule()
+        {
+            // Composing before the previous frame is on screen only holds on to client buffers longer.
+            {
+                std::unique_lock<std::mutex> lock(_commitMutex);
+                _commitCV.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                    return (_canCommit.load(std::memory_order_acquire) || _terminated.load(std::memory_order_acquire));
+                });
+            }
+
+            const uint64_t now(Compositor::FrameScheduler::Now());
+            const uint64_t start(_scheduler->Start(now, _target));
+
+            if (start > now) {
+                std::this_thread::sleep_for(std::chrono::microseconds(start - now));
+            }
+
+            return (_terminated.load(std::memory_order_acquire) == false);
+        }
+
         IComposition::IClient* CreateClient(const string& name, const uint32_t width, const uint32_t height) override
         {
             IClient* client = nullptr;
@@ -1421,14 +1511,27 @@ namespace Plugin {
 
                     _renderer->Begin(buffer->Width(), buffer->Height()); // set viewport for render
 
-                    _renderer->Clear(_background);
+                    if ((buffer->Width() != _outputWidth) || (buffer->Height() != _outputHeight)) {
+                        _outputWidth = buffer->Width();
+                        _outputHeight = buffer->Height();
+                        _outputGeneration++;
+                    }
 
                     {
                         std::lock_guard<std::mutex> lock(_clientLock);
 
-                        _clients.Visit([&](const string& /*name*/, const Core::ProxyType<Client> client) {
-                            RenderClient(client); // ~500-900 uS rpi4
-                        });
+                        // Bottom to top, what is covered by opaque surfaces is not drawn at all.
+                        if (Compose(buffer->Width(), buffer->Height()) == true) {
+                            _renderer->Clear(_background);
+                        } else {
+                            _clearsSkipped.fetch_add(1, std::memory_order_relaxed);
+                        }
+
+                        for (uint16_t index = 0; index < _layers.size(); index++) {
+                            RenderClient(_composition[index], _layers[index].Area, _layers[index].Visible); // ~500-900 uS rpi4
+                        }
+
+                        _composition.clear();
                     }
 
                     _renderer->End(false);
@@ -1449,7 +1552,10 @@ namespace Plugin {
 
                     _renderer->Unbind(frameBuffer);
 
-                    _totalRenderTime.fetch_add((Core::Time::Now().Ticks() - start), std::memory_order_relaxed);
+                    const uint64_t rendered(Core::Time::Now().Ticks() - start);
+
+                    _totalRenderTime.fetch_add(rendered, std::memory_order_relaxed);
+                    _scheduler->Rendered(rendered);
 
                     // Block until VSync allows commit
                     {
@@ -1469,6 +1575,10 @@ namespace Plugin {
 
                         if (commit != Core::ERROR_NONE) {
                             TRACE(Trace::Error, (_T("Commit failed: %d"), commit));
+                        } else if (_target != 0) {
+                            const int64_t slack = _scheduler->Committed(Compositor::FrameScheduler::Now(), _target);
+
+                            TRACE(Trace::Scheduling, (_T("Frame committed %" PRId64 " us before its vblank"), slack));
                         }
                     }
 
@@ -1478,29 +1588,50 @@ namespace Plugin {
             }
         }
 
-        void RenderClient(const Core::ProxyType<Client> client)
+        // Orders the clients on their z-index and works out which of them can be seen.
+        bool Compose(const uint32_t width, const uint32_t height)
         {
-            ASSERT(client.IsValid() == true);
+            _composition.clear();
+            _layers.clear();
 
-            const uint64_t start(Core::Time::Now().Ticks());
+            _clients.Visit([&](const string& /*name*/, const Core::ProxyType<Client> client) {
+                _composition.push_back(client);
+            });
 
-            bool isNewFrame = false;
-            Core::ProxyType<Compositor::IRenderer::ITexture> texture = client->Acquire(isNewFrame);
+            // z-index 0 is on top.
+            std::stable_sort(_composition.begin(), _composition.end(), [](const Core::ProxyType<Client>& a, const Core::ProxyType<Client>& b) {
+                return (a->ZOrder() > b->ZOrder());
+            });
 
-            if ((texture.IsValid() == true)) {
+            for (const Core::ProxyType<Client>& client : _composition) {
                 Exchange::IComposition::Rectangle renderBox;
 
                 if ((_autoScale == true) && (client->GeometryChanged() == false)) {
-                    renderBox.x = 0;
-                    renderBox.y = 0;
-                    renderBox.width = _output->Width();
-                    renderBox.height = _output->Height();
+                    renderBox = { 0, 0, _output->Width(), _output->Height() };
                 } else {
                     renderBox = client->Geometry();
                 }
 
-                Compositor::Matrix clientProjection;
-                Compositor::Transformation::ProjectBox(clientProjection, renderBox, Compositor::Transformation::TRANSFORM_FLIPPED_180, 0, _renderer->Projection());
+                _layers.push_back({ renderBox, client->IsOpaque(), false });
+            }
+
+            return (Compositor::Occlusion::Resolve(_layers, { 0, 0, width, height }));
+        }
+
+        void RenderClient(const Core::ProxyType<Client> client, const Exchange::IComposition::Rectangle& renderBox, const bool visible)
+        {
+            ASSERT(client.IsValid() == true);
+
+            const uint64_t start(Core::Time::Now().Ticks());
+
+            bool isNewFrame = false;
+            Core::ProxyType<Compositor::IRenderer::ITexture> texture = client->Acquire(isNewFrame);
+
+            if ((texture.IsValid() == true) && ((visible == false) || (client->Opacity() == 0))) {
+                // Still taken and handed back, so the client keeps getting its frames released.
+                _occluded.fetch_add(1, std::memory_order_relaxed);
+            } else if ((texture.IsValid() == true)) {
+                const Compositor::Matrix& clientProjection = client->Projection(renderBox, Compositor::Transformation::TRANSFORM_FLIPPED_180, _outputGeneration, _renderer->Projection());
 
                 const Exchange::IComposition::Rectangle clientArea = { 0, 0, texture->Width(), texture->Height() };
 
@@ -1552,9 +1683,9 @@ namespace Plugin {
                     // Wait for signal
                     Core::Thread::Block();
 
-                    // Process one frame per wake-up
-                    bool expected = true;
-                    if (_parent._renderPending.compare_exchange_strong(expected, false, std::memory_order_acq_rel)) {
+                    // Process one frame per wake-up, what the clients commit until it starts goes along
+                    if ((_parent._renderPending.load(std::memory_order_acquire) == true) && (_parent.Schedule() == true)) {
+                        _parent._renderPending.store(false, std::memory_order_release);
                         _parent.RenderOutput();
 
                         // Print stats every 5 seconds
@@ -1613,7 +1744,13 @@ namespace Plugin {
                 uint64_t avgFrameTime = frameTime / frames; // microseconds per frame
                 double fps = 1000000.0 / avgFrameTime; // convert to FPS (1 second = 1,000,000 microseconds)
 
-                TRACE(Trace::Stats, (_T("Global: frames: %llu, avg: %llu µs , fps: %.2f"), frames, (totalRender / frames), fps));
+                TRACE(Trace::Stats, (_T("Global: frames: %llu, avg: %llu µs , fps: %.2f, occluded: %llu, clears skipped: %llu"), frames, (totalRender / frames), fps, _occluded.exchange(0), _clearsSkipped.exchange(0)));
+            }
+
+            const Compositor::FrameScheduler::Report report(_scheduler->Collect());
+
+            if (report.Frames > 0) {
+                TRACE(Trace::Stats, (_T("Scheduling: period: %u µs, predicted: %u µs, slack avg: %" PRId64 " µs, min: %" PRId64 " µs, late: %u/%u"), report.Period, report.Predicted, report.AverageSlack, report.MinimumSlack, report.Late, report.Frames));
             }
 
             std::lock_guard<std::mutex> lock(_clientLock);
@@ -1653,6 +1790,15 @@ namespace Plugin {
         std::unordered_map<std::string, Client::Stats> _clientStats;
         std::atomic<bool> _renderPending;
         std::atomic<bool> _terminated;
+        std::vector<Core::ProxyType<Client>> _composition;
+        std::vector<Compositor::Occlusion::Layer> _layers;
+        std::atomic<uint64_t> _occluded;
+        std::atomic<uint64_t> _clearsSkipped;
+        std::unique_ptr<Compositor::FrameScheduler> _scheduler;
+        uint64_t _target; // the vblank the frame being composed is for
+        uint32_t _outputWidth;
+        uint32_t _outputHeight;
+        uint32_t _outputGeneration; // changes with the projection of the renderer, the clients project again
     };
 
     SERVICE_REGISTRATION(CompositorImplementation, 1, 0)
@@ -60,5 +60,38 @@ namespace Trace {
     private:
         std::string _text;
     }; // class Stats
+
+    // Per frame, how far ahead of its vblank it was committed.
+    class Scheduling {
+    public:
+        ~Scheduling() = default;
+        Scheduling() = delete;
+        Scheduling(const Scheduling&) = delete;
+        Scheduling& operator=(const Scheduling&) = delete;
+        Scheduling(const TCHAR formatter[], ...)
+        {
+            va_list ap;
+            va_start(ap, formatter);
+            Thunder::Trace::Format(_text, formatter, ap);
+            va_end(ap);
+        }
+        explicit Scheduling(const string& text)
+            : _text(Thunder::Core::ToString(text))
+        {
+        }
+
+    public:
+        const char* Data() const
+        {
+            return (_text.c_str());
+        }
+        uint16_t Length() const
+        {
+            return (static_cast<uint16_t>(_text.length()));
+        }
+
+    private:
+        std::string _text;
+    }; // class Scheduling
 }
 }
\ No newline at end of file
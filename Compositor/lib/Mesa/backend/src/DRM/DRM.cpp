@@ -220,12 +220,8 @@ namespace Compositor {
                 if (_idle.compare_exchange_strong(idle, true) == true) {
                     _connectors.Visit([&](const string& name, const Core::ProxyType<Connector> connector) {
                         if (connector->CrtController().Id() == crtc) {
-                            struct timespec presentationTimestamp;
-
-                            presentationTimestamp.tv_sec = seconds;
-                            presentationTimestamp.tv_nsec = useconds * 1000;
-
-                            connector->Presented(sequence, Core::Time(presentationTimestamp).Ticks());
+                            // The kernel stamps page flip events on CLOCK_MONOTONIC, the clock the callback expects.
+                            connector->Presented(sequence, (static_cast<uint64_t>(seconds) * 1000000) + useconds);
 
                             TRACE(Trace::Backend, ("Pageflip finished for %s", name.c_str()));
                         }
@@ -32,6 +32,12 @@ namespace Compositor {
     namespace Backend {
         static const char* AppId = "com.thunder.compositor";
 
+        // Presentation times are reported on CLOCK_MONOTONIC, like the compositor's presentation clock.
+        static uint64_t MonotonicTime()
+        {
+            return (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()));
+        }
+
         class VSyncTimer {
         public:
             VSyncTimer(uint32_t mFps)
@@ -81,10 +87,7 @@ namespace Compositor {
                         break;
 
                     // Generate timestamp
-                    auto now = std::chrono::high_resolution_clock::now();
-                    auto timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
-                        now.time_since_epoch())
-                                            .count();
+                    const uint64_t timestamp_us = MonotonicTime();
 
                     // Call the presented callback - this triggers your existing vsync handling!
                     if (_callback) {
@@ -572,16 +575,13 @@ namespace Compositor {
             bool shouldThrottle = false;
 
             if (event != nullptr) {
-                struct timespec presentationTimestamp;
-                presentationTimestamp.tv_sec = event->tv_seconds;
-                presentationTimestamp.tv_nsec = event->tv_nseconds;
-
-                currentPts = Core::Time(presentationTimestamp).Ticks();
+                // On the presentation clock of the compositor, CLOCK_MONOTONIC unless it announced otherwise.
+                currentPts = (static_cast<uint64_t>(event->tv_seconds) * 1000000) + (event->tv_nseconds / 1000);
                 _sequenceCounter = event->sequence;
             } else {
                 // Feedback was discarded or came too fast - throttle this
                 shouldThrottle = true;
-                uint64_t now = Core::Time::Now().Ticks();
+                uint64_t now = MonotonicTime();
                 ASSERT(now > _lastPresentationTime);
                 _sequenceCounter++;
                 currentPts = now;
@@ -602,7 +602,7 @@ namespace Compositor {
 
                         // Update timing after sleep
                         now = std::chrono::high_resolution_clock::now();
-                        currentPts = Core::Time::Now().Ticks();
+                        currentPts = MonotonicTime();
                     }
                 }
 
@@ -0,0 +1,198 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CompositorTypes.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <time.h>
+
+namespace Thunder {
+namespace Compositor {
+
+    /**
+     * @brief Decides when to start composing a frame, as late as possible before the vblank it is for.
+     *
+     * The vblank period and phase follow from the presentation times the output reports, the cost
+     * of a frame is predicted from the slowest of the recent ones. A frame that can not make the
+     * next vblank anymore is started later, for the one after it: it is shown at the same time but
+     * with fresher content. All times are in microseconds on CLOCK_MONOTONIC, the clock the outputs
+     * stamp their presentation events with (see Now()).
+     */
+    class FrameScheduler {
+    public:
+        static constexpr uint8_t History = 8;
+        static constexpr uint32_t DefaultPeriod = 16667; // 60Hz, until the output told otherwise
+
+        struct Report {
+            uint32_t Frames;
+            int64_t AverageSlack;
+            int64_t MinimumSlack;
+            uint32_t Late; // committed after the vblank it was meant for
+            uint32_t Period;
+            uint32_t Predicted;
+        };
+
+        FrameScheduler(FrameScheduler&&) = delete;
+        FrameScheduler(const FrameScheduler&) = delete;
+        FrameScheduler& operator=(FrameScheduler&&) = delete;
+        FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+        FrameScheduler(const uint32_t margin)
+            : _lock()
+            , _margin(margin)
+            , _period(DefaultPeriod)
+            , _sequence(0)
+            , _vblank(0)
+            , _costs()
+            , _index(0)
+            , _samples(0)
+            , _frames(0)
+            , _slack(0)
+            , _minimum(0)
+            , _late(0)
+        {
+        }
+        ~FrameScheduler() = default;
+
+    public:
+        // The current time, on the clock of all other times in here.
+        static uint64_t Now()
+        {
+            struct timespec now;
+            ::clock_gettime(CLOCK_MONOTONIC, &now);
+
+            return ((static_cast<uint64_t>(now.tv_sec) * 1000000) + (now.tv_nsec / 1000));
+        }
+
+        // A frame went on screen, at the vblank with this sequence number.
+        void Presented(const uint64_t sequence, const uint64_t time)
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            if ((_vblank != 0) && (sequence > _sequence) && (time > _vblank)) {
+                const uint64_t period = (time - _vblank) / (sequence - _sequence);
+
+                // Smoothed, a late event should not shift the phase much.
+                if ((period > (DefaultPeriod / 4)) && (period < (DefaultPeriod * 4))) {
+                    _period = static_cast<uint32_t>(((_period * 7) + period) / 8);
+                }
+            }
+
+            _sequence = sequence;
+            _vblank = time;
+        }
+
+        // What composing the last frame took, up to the GPU being done.
+        void Rendered(const uint64_t duration)
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            _costs[_index] = static_cast<uint32_t>(std::min<uint64_t>(duration, ~static_cast<uint32_t>(0)));
+            _index = (_index + 1) % History;
+
+            if (_samples < History) {
+                _samples++;
+            }
+        }
+
+        // When to start composing, and the vblank that is aimed for.
+        uint64_t Start(const uint64_t now, uint64_t& target) const
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            const uint64_t cost = Predicted() + _margin;
+            uint64_t start = now;
+
+            if (_vblank == 0) {
+                // Nothing presented yet, no phase to aim for.
+                target = now + cost;
+            } else {
+                target = _vblank + (_period * (((now > _vblank) ? ((now - _vblank) / _period) : 0) + 1));
+
+                while ((target - cost) < now) {
+                    target += _period;
+                }
+
+                start = target - cost;
+            }
+
+            return (start);
+        }
+
+        // The frame was committed, returns by how much it was ahead of the vblank aimed for.
+        int64_t Committed(const uint64_t now, const uint64_t target)
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            const int64_t slack = static_cast<int64_t>(target) - static_cast<int64_t>(now);
+
+            _minimum = ((_frames == 0) ? slack : std::min(_minimum, slack));
+            _slack += slack;
+            _frames++;
+
+            if (slack < 0) {
+                _late++;
+            }
+
+            return (slack);
+        }
+
+        // Since the previous report.
+        Report Collect()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+
+            Report report = { _frames, ((_frames > 0) ? (_slack / _frames) : 0), _minimum, _late, _period, Predicted() };
+
+            _frames = 0;
+            _slack = 0;
+            _minimum = 0;
+            _late = 0;
+
+            return (report);
+        }
+
+    private:
+        uint32_t Predicted() const
+        {
+            // Until there is something to go on, half a frame.
+            return ((_samples == 0) ? (_period / 2) : *std::max_element(_costs.begin(), _costs.begin() + _samples));
+        }
+
+    private:
+        mutable std::mutex _lock;
+        const uint32_t _margin;
+        uint32_t _period;
+        uint64_t _sequence;
+        uint64_t _vblank;
+        std::array<uint32_t, History> _costs;
+        uint8_t _index;
+        uint8_t _samples;
+        uint32_t _frames;
+        int64_t _slack;
+        int64_t _minimum;
+        uint32_t _late;
+    };
+
+} // namespace Compositor
+} // namespace Thunder
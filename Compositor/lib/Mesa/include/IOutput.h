@@ -34,7 +34,7 @@ namespace Compositor {
              *
              * @param output Pointer to the output that triggered the callback.
              * @param sequence Commit sequence number that was presented.
-             * @param time Presentation time stamp, 0 means never presented/timeout.
+             * @param time Presentation time stamp in microseconds on CLOCK_MONOTONIC, 0 means never presented/timeout.
              */
             virtual void Presented(const IOutput* output, const uint64_t sequence, const uint64_t time) = 0;
 
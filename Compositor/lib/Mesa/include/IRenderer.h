@@ -61,6 +61,16 @@ namespace Compositor {
          */
         static Core::ProxyType<IRenderer> Instance(Identifier identifier);
 
+        /**
+         * @brief A factory for renderer that keeps its linked programs between starts, callee needs to call Release() when done.
+         *
+         * @param identifier ID for this Renderer, allows for reuse.
+         * @param programCache Directory for the program binaries, empty to compile them on every start.
+         *                     Only used by the call that creates the renderer for this identifier.
+         * @return Core::ProxyType<IRenderer>
+         */
+        static Core::ProxyType<IRenderer> Instance(Identifier identifier, const string& programCache);
+
         /**
          * @brief Binds a frame buffer to the renderer, all render related actions will be done using this buffer.
          *
@@ -0,0 +1,146 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "CompositorTypes.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Thunder {
+namespace Compositor {
+
+    /**
+     * @brief Works out which layers of a composition can be seen at all, before anything is drawn.
+     *
+     * A layer is hidden when the opaque layers on top of it cover it completely, the background
+     * is hidden when they cover the whole output. The covered area is tracked as a set of
+     * rectangles, past MaxFragments a layer is taken as visible, drawing too much is never wrong.
+     */
+    class Occlusion {
+    public:
+        using Box = Exchange::IComposition::Rectangle;
+
+        static constexpr uint8_t MaxFragments = 32;
+
+        struct Layer {
+            Box Area; // where it ends up on the output
+            bool Opaque; // no alpha in the buffer and fully opaque
+            bool Visible; // result
+        };
+
+        Occlusion() = delete;
+        Occlusion(Occlusion&&) = delete;
+        Occlusion(const Occlusion&) = delete;
+        Occlusion& operator=(Occlusion&&) = delete;
+        Occlusion& operator=(const Occlusion&) = delete;
+
+        /**
+         * @brief Marks the visible layers.
+         *
+         * @param layers The layers from the bottom to the top.
+         * @param output The area of the output.
+         * @return true if the background still shows somewhere and needs to be cleared.
+         */
+        static bool Resolve(std::vector<Layer>& layers, const Box& output)
+        {
+            std::vector<Box> covers;
+
+            covers.reserve(layers.size());
+
+            for (std::vector<Layer>::reverse_iterator index = layers.rbegin(); index != layers.rend(); index++) {
+                Box area;
+
+                index->Visible = (Intersect(index->Area, output, area) == true) && (IsCovered(area, covers) == false);
+
+                if ((index->Visible == true) && (index->Opaque == true)) {
+                    covers.push_back(area);
+                }
+            }
+
+            return (IsCovered(output, covers) == false);
+        }
+
+    private:
+        static bool Intersect(const Box& a, const Box& b, Box& result)
+        {
+            const int64_t left = std::max<int64_t>(a.x, b.x);
+            const int64_t top = std::max<int64_t>(a.y, b.y);
+            const int64_t right = std::min<int64_t>(static_cast<int64_t>(a.x) + a.width, static_cast<int64_t>(b.x) + b.width);
+            const int64_t bottom = std::min<int64_t>(static_cast<int64_t>(a.y) + a.height, static_cast<int64_t>(b.y) + b.height);
+
+            const bool overlap = ((left < right) && (top < bottom));
+
+            if (overlap == true) {
+                result = { static_cast<int32_t>(left), static_cast<int32_t>(top), static_cast<uint32_t>(right - left), static_cast<uint32_t>(bottom - top) };
+            }
+
+            return (overlap);
+        }
+
+        // What is left of area with cover cut out of it, at most four strips.
+        static void Subtract(const Box& area, const Box& cover, std::vector<Box>& remains)
+        {
+            Box overlap;
+
+            if (Intersect(area, cover, overlap) == false) {
+                remains.push_back(area);
+            } else {
+                const int64_t right = static_cast<int64_t>(area.x) + area.width;
+                const int64_t bottom = static_cast<int64_t>(area.y) + area.height;
+                const int64_t overlapRight = static_cast<int64_t>(overlap.x) + overlap.width;
+                const int64_t overlapBottom = static_cast<int64_t>(overlap.y) + overlap.height;
+
+                if (overlap.y > area.y) {
+                    remains.push_back({ area.x, area.y, area.width, static_cast<uint32_t>(overlap.y - area.y) });
+                }
+                if (overlapBottom < bottom) {
+                    remains.push_back({ area.x, static_cast<int32_t>(overlapBottom), area.width, static_cast<uint32_t>(bottom - overlapBottom) });
+                }
+                if (overlap.x > area.x) {
+                    remains.push_back({ area.x, overlap.y, static_cast<uint32_t>(overlap.x - area.x), overlap.height });
+                }
+                if (overlapRight < right) {
+                    remains.push_back({ static_cast<int32_t>(overlapRight), overlap.y, static_cast<uint32_t>(right - overlapRight), overlap.height });
+                }
+            }
+        }
+
+        static bool IsCovered(const Box& area, const std::vector<Box>& covers)
+        {
+            std::vector<Box> fragments(1, area);
+            std::vector<Box> remains;
+
+            for (std::vector<Box>::const_iterator cover = covers.cbegin(); (cover != covers.cend()) && (fragments.empty() == false) && (fragments.size() <= MaxFragments); cover++) {
+                remains.clear();
+
+                for (const Box& fragment : fragments) {
+                    Subtract(fragment, *cover, remains);
+                }
+
+                fragments.swap(remains);
+            }
+
+            return (fragments.empty() == true);
+        }
+    };
+
+} // namespace Compositor
+} // namespace Thunder
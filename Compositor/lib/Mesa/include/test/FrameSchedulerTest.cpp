@@ -0,0 +1,195 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME FrameSchedulerTest
+#endif
+
+#include <core/core.h>
+
+#include <FrameScheduler.h>
+
+#include <cstdio>
+
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+    uint32_t failures = 0;
+
+    void Check(const bool condition, const char label[], const int64_t actual, const int64_t expected)
+    {
+        if (condition == false) {
+            printf("FAIL %s: got %" PRId64 ", expected %" PRId64 "\n", label, actual, expected);
+            failures++;
+        }
+    }
+
+    void Equal(const char label[], const int64_t actual, const int64_t expected)
+    {
+        Check(actual == expected, label, actual, expected);
+    }
+
+    // A 60Hz output, vblank 100 at 1s.
+    constexpr uint64_t Vblank = 1000000;
+    constexpr uint32_t Period = Compositor::FrameScheduler::DefaultPeriod;
+
+    void Present(Compositor::FrameScheduler& scheduler, const uint64_t first, const uint8_t count, const uint32_t period)
+    {
+        for (uint8_t index = 0; index < count; index++) {
+            scheduler.Presented(100 + index, first + (index * period));
+        }
+    }
+
+    void NoPhase()
+    {
+        Compositor::FrameScheduler scheduler(1000);
+        uint64_t target = 0;
+
+        // Nothing presented, start right away and expect half a frame plus the margin.
+        Equal("no phase, start", scheduler.Start(Vblank, target), Vblank);
+        Equal("no phase, target", target, Vblank + (Period / 2) + 1000);
+    }
+
+    void Phase()
+    {
+        Compositor::FrameScheduler scheduler(1000);
+        uint64_t target = 0;
+
+        Present(scheduler, Vblank, 2, Period);
+        scheduler.Rendered(4000);
+
+        const uint64_t last = Vblank + Period;
+
+        // Early in the frame: aim for the next vblank, starting cost plus margin before it.
+        Equal("phase, start", scheduler.Start(last + 2000, target), last + Period - 5000);
+        Equal("phase, target", target, last + Period);
+
+        // The slowest of the recent frames is what is predicted.
+        scheduler.Rendered(2000);
+        Equal("slowest, start", scheduler.Start(last + 2000, target), last + Period - 5000);
+    }
+
+    void MissedVblank()
+    {
+        Compositor::FrameScheduler scheduler(1000);
+        uint64_t target = 0;
+
+        Present(scheduler, Vblank, 2, Period);
+        scheduler.Rendered(4000);
+
+        const uint64_t last = Vblank + Period;
+
+        // Too late to make the next vblank, aim for the one after it and start later.
+        Equal("missed, start", scheduler.Start(last + Period - 4000, target), last + (2 * Period) - 5000);
+        Equal("missed, target", target, last + (2 * Period));
+
+        // A flip event that did not come, the phase still holds two periods on.
+        Equal("no event, start", scheduler.Start(last + (2 * Period) + 100, target), last + (3 * Period) - 5000);
+    }
+
+    void Margin()
+    {
+        Compositor::FrameScheduler tight(500);
+        Compositor::FrameScheduler loose(3000);
+        uint64_t tightTarget = 0;
+        uint64_t looseTarget = 0;
+
+        Present(tight, Vblank, 2, Period);
+        Present(loose, Vblank, 2, Period);
+        tight.Rendered(4000);
+        loose.Rendered(4000);
+
+        const uint64_t now = Vblank + Period + 1000;
+        const uint64_t tightStart = tight.Start(now, tightTarget);
+        const uint64_t looseStart = loose.Start(now, looseTarget);
+
+        Equal("margin, same vblank", looseTarget, tightTarget);
+        Equal("margin, earlier start", tightStart - looseStart, 2500);
+
+        // Where the margin makes the vblank unreachable, the larger one moves on to the next.
+        const uint64_t late = tightTarget - 6000;
+        tight.Start(late, tightTarget);
+        loose.Start(late, looseTarget);
+        Equal("margin, tight still makes it", tightTarget, Vblank + (2 * Period));
+        Equal("margin, loose waits a vblank", looseTarget, Vblank + (3 * Period));
+    }
+
+    void PeriodTracking()
+    {
+        Compositor::FrameScheduler scheduler(1000);
+
+        // A 50Hz output, with one vblank that did not produce an event.
+        Present(scheduler, Vblank, 64, 20000);
+        scheduler.Presented(100 + 65, Vblank + (65 * 20000));
+
+        const Compositor::FrameScheduler::Report report(scheduler.Collect());
+        Check((report.Period > 19980) && (report.Period <= 20000), "50Hz period", report.Period, 20000);
+
+        // An event far off the period (suspend, mode switch) is not taken into account.
+        scheduler.Presented(100 + 66, Vblank + (65 * 20000) + 1000000);
+
+        const uint32_t period = scheduler.Collect().Period;
+        Check((period > 19980) && (period <= 20000), "outlier ignored", period, 20000);
+    }
+
+    void Slack()
+    {
+        Compositor::FrameScheduler scheduler(1000);
+
+        Equal("ahead", scheduler.Committed(Vblank, Vblank + 3000), 3000);
+        Equal("behind", scheduler.Committed(Vblank + 500, Vblank), -500);
+
+        const Compositor::FrameScheduler::Report report(scheduler.Collect());
+        Equal("frames", report.Frames, 2);
+        Equal("late", report.Late, 1);
+        Equal("minimum slack", report.MinimumSlack, -500);
+        Equal("average slack", report.AverageSlack, 1250);
+
+        // Collecting resets the statistics.
+        Equal("reset", scheduler.Collect().Frames, 0);
+    }
+
+    void Clock()
+    {
+        const uint64_t first = Compositor::FrameScheduler::Now();
+        const uint64_t second = Compositor::FrameScheduler::Now();
+
+        Check((first != 0) && (second >= first), "monotonic clock", static_cast<int64_t>(second), static_cast<int64_t>(first));
+    }
+}
+
+int main(int /*argc*/, const char* /*argv*/[])
+{
+    NoPhase();
+    Phase();
+    MissedVblank();
+    Margin();
+    PeriodTracking();
+    Slack();
+    Clock();
+
+    printf("%s\n", (failures == 0) ? "FrameScheduler: all checks passed" : "FrameScheduler: checks failed");
+
+    Core::Singleton::Dispose();
+
+    return (failures == 0 ? 0 : 1);
+}
@@ -361,6 +361,190 @@ namespace Compositor {
                 GLuint _glRenderBuffer;
             };
 
+            // Keeps the programs the way the driver linked them (GL_OES_get_program_binary) in a directory
+            // that survives a restart, so the next start loads them instead of compiling them again. A
+            // file is only used when it was made by the same driver from the same sources and the driver
+            // still accepts it, otherwise the program is compiled from source and the file replaced.
+            // Only used while the programs are created, on the thread that has the context current.
+            class ProgramCache {
+            private:
+                static constexpr uint32_t Magic = 0x4D475054; // "TPGM"
+                static constexpr uint16_t Version = 1;
+                static constexpr uint32_t MaximumLength = 4 * 1024 * 1024;
+
+                struct Header {
+                    uint32_t Magic;
+                    uint16_t Version;
+                    uint16_t Variant;
+                    uint64_t Key; // the driver and the sources it was made from
+                    uint32_t Format;
+                    uint32_t Length;
+                    uint64_t Checksum; // of the binary that follows
+                };
+
+            public:
+                ProgramCache(ProgramCache&&) = delete;
+                ProgramCache(const ProgramCache&) = delete;
+                ProgramCache& operator=(ProgramCache&&) = delete;
+                ProgramCache& operator=(const ProgramCache&) = delete;
+
+                ProgramCache(const string& path)
+                    : _path()
+                    , _driver()
+                    , _loaded(0)
+                    , _compiled(0)
+                {
+                    if (path.empty() == false) {
+                        const std::string extensions(String(GL_EXTENSIONS));
+                        GLint formats(0);
+
+                        if ((API::HasExtension(extensions, "GL_OES_get_program_binary") == true) && (_gles.glGetProgramBinaryOES != nullptr) && (_gles.glProgramBinaryOES != nullptr)) {
+                            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+                        }
+
+                        if (formats <= 0) {
+                            TRACE(Trace::GL, ("The driver has no program binaries, programs are compiled on every start"));
+                        } else if (Core::Directory(Core::Directory::Normalize(path).c_str()).CreatePath() == false) {
+                            TRACE(Trace::Error, ("Could not create program cache %s", path.c_str()));
+                        } else {
+                            _path = Core::Directory::Normalize(path);
+
+                            // A binary is only good for the driver, and the version of it, that made it.
+                            _driver = String(GL_VENDOR) + '\n' + String(GL_RENDERER) + '\n' + String(GL_VERSION);
+                        }
+                    }
+                }
+                ~ProgramCache() = default;
+
+            public:
+                uint32_t Loaded() const
+                {
+                    return (_loaded);
+                }
+                uint32_t Compiled() const
+                {
+                    return (_compiled);
+                }
+                uint64_t Key(const char vertex[], const std::string& fragment) const
+                {
+                    uint64_t key = Hash(reinterpret_cast<const uint8_t*>(_driver.c_str()), _driver.length() + 1);
+                    key = Hash(reinterpret_cast<const uint8_t*>(vertex), ::strlen(vertex) + 1, key);
+                    return (Hash(reinterpret_cast<const uint8_t*>(fragment.c_str()), fragment.length() + 1, key));
+                }
+
+                // Returns GL_FALSE if there is no usable binary, the program needs to be compiled.
+                GLuint Load(const uint8_t variant, const uint64_t key)
+                {
+                    GLuint result(GL_FALSE);
+
+                    if (_path.empty() == false) {
+                        Core::File file(FileName(variant));
+
+                        if ((file.Exists() == true) && (file.Open(true) == true)) {
+                            Header header;
+                            std::vector<uint8_t> binary;
+
+                            if ((file.Read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header))
+                                && (header.Magic == Magic) && (header.Version == Version) && (header.Variant == variant) && (header.Key == key)
+                                && (header.Length > 0) && (header.Length <= MaximumLength)) {
+
+                                binary.resize(header.Length);
+
+                                if ((file.Read(binary.data(), header.Length) == header.Length) && (Hash(binary.data(), binary.size()) == header.Checksum)) {
+                                    GLint status(GL_FALSE);
+
+                                    result = glCreateProgram();
+
+                                    _gles.glProgramBinaryOES(result, header.Format, binary.data(), header.Length);
+                                    glGetProgramiv(result, GL_LINK_STATUS, &status);
+
+                                    if (status == GL_FALSE) {
+                                        glDeleteProgram(result);
+                                        result = GL_FALSE;
+                                    }
+                                }
+                            }
+
+                            file.Close();
+
+                            if (result != GL_FALSE) {
+                                _loaded++;
+                            } else {
+                                TRACE(Trace::GL, ("Cached program %d is stale or rejected, compiling it", variant));
+                                file.Destroy();
+                            }
+                        }
+                    }
+
+                    return (result);
+                }
+
+                void Store(const uint8_t variant, const uint64_t key, const GLuint program)
+                {
+                    GLint length(0);
+
+                    _compiled++;
+
+                    if (_path.empty() == false) {
+                        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+                    }
+
+                    if ((length > 0) && (static_cast<uint32_t>(length) <= MaximumLength)) {
+                        std::vector<uint8_t> binary(length);
+                        GLsizei written(0);
+                        GLenum format(0);
+
+                        _gles.glGetProgramBinaryOES(program, length, &written, &format, binary.data());
+
+                        if (written > 0) {
+                            const Header header = { Magic, Version, variant, key, format, static_cast<uint32_t>(written), Hash(binary.data(), written) };
+                            const string fileName(FileName(variant));
+
+                            // Written next to it and then renamed, so a crash halfway never leaves a broken file behind.
+                            Core::File file(fileName + _T(".tmp"));
+
+                            if (file.Create() == true) {
+                                const bool complete = (file.Write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header))
+                                    && (file.Write(binary.data(), header.Length) == header.Length);
+
+                                file.Close();
+
+                                if ((complete == false) || (::rename(file.Name().c_str(), fileName.c_str()) != 0)) {
+                                    TRACE(Trace::Error, ("Could not store program %d in %s", variant, fileName.c_str()));
+                                    file.Destroy();
+                                }
+                            }
+                        }
+                    }
+                }
+
+            private:
+                string FileName(const uint8_t variant) const
+                {
+                    return (_path + _T("program-") + std::to_string(variant) + _T(".bin"));
+                }
+                static std::string String(const GLenum name)
+                {
+                    const char* value = reinterpret_cast<const char*>(glGetString(name));
+                    return (value != nullptr ? std::string(value) : std::string());
+                }
+                // FNV-1a
+                static uint64_t Hash(const uint8_t data[], const size_t length, uint64_t hash = 0xCBF29CE484222325ULL)
+                {
+                    for (size_t index = 0; index < length; ++index) {
+                        hash = (hash ^ data[index]) * 0x100000001B3ULL;
+                    }
+
+                    return (hash);
+                }
+
+            private:
+                string _path;
+                string _driver;
+                uint32_t _loaded;
+                uint32_t _compiled;
+            };
+
             class Program {
             public:
                 enum class Variant : uint8_t {
@@ -378,8 +562,8 @@ namespace Compositor {
 
                 using VariantType = Variant;
 
-                Program(const uint8_t variant)
-                    : _id(Create(variant))
+                Program(const uint8_t variant, ProgramCache& cache)
+                    : _id(Create(variant, cache))
                     , _projection(glGetUniformLocation(_id, "projection"))
                     , _position(glGetAttribLocation(_id, "position"))
                 {
@@ -418,7 +602,7 @@ namespace Compositor {
                     return handle;
                 }
 
-                GLuint Create(const uint8_t variant)
+                GLuint Create(const uint8_t variant, ProgramCache& cache)
                 {
                     GLES_DEBUG_SCOPE("Create");
 
@@ -430,12 +614,17 @@ namespace Compositor {
 
                     TRACE(Trace::Information, ("Creating Program for %s", VariantStr[variant]));
 
-                    std::stringstream fragmentShaderSource;
-                    fragmentShaderSource << "#define VARIANT " << static_cast<uint16_t>(variant) << std::endl
-                                         << ::GLES::fragment_shader;
+                    const std::string fragmentShaderSource("#define VARIANT " + std::to_string(variant) + "\n" + ::GLES::fragment_shader);
+                    const uint64_t key(cache.Key(::GLES::vertex_shader, fragmentShaderSource));
+
+                    handle = cache.Load(variant, key);
+
+                    if (handle != GL_FALSE) {
+                        return handle;
+                    }
 
                     GLuint vs = Compile(GL_VERTEX_SHADER, ::GLES::vertex_shader);
-                    GLuint fs = Compile(GL_FRAGMENT_SHADER, fragmentShaderSource.str().c_str());
+                    GLuint fs = Compile(GL_FRAGMENT_SHADER, fragmentShaderSource.c_str());
 
                     if ((vs != GL_FALSE) && (fs != GL_FALSE)) {
                         handle = glCreateProgram();
@@ -457,6 +646,8 @@ namespace Compositor {
                             TRACE(Trace::Error, ("Program linking failed: %s", API::GL::ProgramInfoLog(handle).c_str()));
                             glDeleteProgram(handle);
                             handle = GL_FALSE;
+                        } else {
+                            cache.Store(variant, key, handle);
                         }
 
                     } else {
@@ -491,8 +682,8 @@ namespace Compositor {
                 enum { ID = static_cast<std::underlying_type<VariantType>::type>(Variant::SOLID) };
 
             public:
-                ColorProgram()
-                    : Program(ID)
+                ColorProgram(ProgramCache& cache)
+                    : Program(ID, cache)
                     , _color(glGetUniformLocation(Id(), "color"))
                 {
                     TRACE(Trace::Information, ("Created Color Program: id=%d, projection=%d, position=%d color=%d", Id(), Projection(), Position(), Color()));
@@ -542,8 +733,8 @@ namespace Compositor {
                 enum { ID = static_cast<std::underlying_type<VariantType>::type>(VARIANT) };
 
             public:
-                TextureProgramType()
-                    : Program(ID)
+                TextureProgramType(ProgramCache& cache)
+                    : Program(ID, cache)
                     , _textureIds()
                     , _coordinates(glGetAttribLocation(Id(), "texcoord"))
                     , _alpha(glGetUniformLocation(Id(), "alpha"))
@@ -650,11 +841,11 @@ namespace Compositor {
                 }
 
                 template <typename PROGRAM>
-                void Announce()
+                void Announce(ProgramCache& cache)
                 {
                     _programs.emplace(std::piecewise_construct,
                         std::forward_as_tuple(static_cast<Program::VariantType>(PROGRAM::ID)),
-                        std::forward_as_tuple(new PROGRAM()));
+                        std::forward_as_tuple(new PROGRAM(cache)));
                 }
 
                 template <typename PROGRAM>
@@ -1016,7 +1207,7 @@ namespace Compositor {
             GLES(GLES const&) = delete;
             GLES& operator=(GLES const&) = delete;
 
-            GLES(int drmDevFd)
+            GLES(int drmDevFd, const string& programCache)
                 : _egl(drmDevFd)
                 , _viewportWidth(0)
                 , _viewportHeight(0)
@@ -1048,14 +1239,19 @@ namespace Compositor {
                 }
 #endif
 
-                _programs.Announce<ColorProgram>();
-                _programs.Announce<ExternalProgram>();
-                _programs.Announce<RGBAProgram>();
-                _programs.Announce<RGBXProgram>();
-                // _programs.Announce<XYUVProgram>();
-                // _programs.Announce<Y_UVProgram>();
-                // _programs.Announce<Y_U_VProgram>();
-                // _programs.Announce<Y_XUXVProgram>();
+                const uint64_t start(Core::Time::Now().Ticks());
+                ProgramCache cache(programCache);
+
+                _programs.Announce<ColorProgram>(cache);
+                _programs.Announce<ExternalProgram>(cache);
+                _programs.Announce<RGBAProgram>(cache);
+                _programs.Announce<RGBXProgram>(cache);
+                // _programs.Announce<XYUVProgram>(cache);
+                // _programs.Announce<Y_UVProgram>(cache);
+                // _programs.Announce<Y_U_VProgram>(cache);
+                // _programs.Announce<Y_XUXVProgram>(cache);
+
+                TRACE(Trace::Information, ("Programs ready in %u us: %u loaded, %u compiled", static_cast<uint32_t>(Core::Time::Now().Ticks() - start), cache.Loaded(), cache.Compiled()));
 
                 _egl.ResetCurrent();
             }
@@ -1130,11 +1326,13 @@ namespace Compositor {
 
                 glViewport(0, 0, width, height);
 
-                _viewportWidth = width;
-                _viewportHeight = height;
+                // The projection only changes with the size of the viewport.
+                if ((width != _viewportWidth) || (height != _viewportHeight)) {
+                    _viewportWidth = width;
+                    _viewportHeight = height;
 
-                // refresh projection matrix
-                Transformation::Projection(_projection, _viewportWidth, _viewportHeight, Transformation::TRANSFORM_NORMAL);
+                    Transformation::Projection(_projection, _viewportWidth, _viewportHeight, Transformation::TRANSFORM_NORMAL);
+                }
 
                 glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -1269,10 +1467,9 @@ namespace Compositor {
                 Core::ProxyType<GLESTexture> glesTexture = _textures.Find(id);
 
                 if (glesTexture.IsValid()) {
+                    // The transformation is already projected, multiplying it with the identity would not change it.
                     Matrix gl_matrix;
-                    Transformation::Multiply(gl_matrix, _projection, transformation);
-                    Transformation::Multiply(gl_matrix, Transformation::Transformations[Transformation::TRANSFORM_NORMAL], transformation);
-                    Transformation::Transpose(gl_matrix, gl_matrix);
+                    Transformation::Transpose(gl_matrix, transformation);
 
                     const GLfloat x1 = region.x / glesTexture->Width();
                     const GLfloat y1 = region.y / glesTexture->Height();
@@ -1298,7 +1495,6 @@ namespace Compositor {
                 ASSERT((_rendering == true) && (_egl.IsCurrent() == true));
 
                 Matrix gl_matrix;
-                Transformation::Multiply(gl_matrix, _projection, transformation);
                 Transformation::Multiply(gl_matrix, Transformation::Transformations[Transformation::TRANSFORM_FLIPPED_180], transformation);
                 Transformation::Transpose(gl_matrix, gl_matrix);
 
@@ -1411,12 +1607,17 @@ namespace Compositor {
     } // namespace Renderer
 
     Core::ProxyType<IRenderer> IRenderer::Instance(Identifier identifier)
+    {
+        return (Instance(identifier, string()));
+    }
+
+    Core::ProxyType<IRenderer> IRenderer::Instance(Identifier identifier, const string& programCache)
     {
         ASSERT(int(identifier) >= 0); // this should be a valid file descriptor.
 
         static Core::ProxyMapType<Identifier, IRenderer> glRenderers;
 
-        return glRenderers.Instance<Renderer::GLES>(identifier, static_cast<int>(identifier));
+        return glRenderers.Instance<Renderer::GLES>(identifier, static_cast<int>(identifier), programCache);
     }
 
 } // namespace Compositor
@@ -237,6 +237,8 @@ namespace API {
             , glPopDebugGroupKHR(nullptr)
             , glPushDebugGroupKHR(nullptr)
             , glGetGraphicsResetStatusKHR(nullptr)
+            , glGetProgramBinaryOES(nullptr)
+            , glProgramBinaryOES(nullptr)
         {
             glEGLImageTargetTexture2DOES = reinterpret_cast<PFNGLEGLIMAGETARGETTEXTURE2DOESPROC>(eglGetProcAddress("glEGLImageTargetTexture2DOES"));
             glEGLImageTargetRenderbufferStorageOES = reinterpret_cast<PFNGLEGLIMAGETARGETRENDERBUFFERSTORAGEOESPROC>(eglGetProcAddress("glEGLImageTargetRenderbufferStorageOES"));
@@ -245,6 +247,8 @@ namespace API {
             glPopDebugGroupKHR = reinterpret_cast<PFNGLPOPDEBUGGROUPKHRPROC>(eglGetProcAddress("glPopDebugGroupKHR"));
             glPushDebugGroupKHR = reinterpret_cast<PFNGLPUSHDEBUGGROUPKHRPROC>(eglGetProcAddress("glPushDebugGroupKHR"));
             glGetGraphicsResetStatusKHR = reinterpret_cast<PFNGLGETGRAPHICSRESETSTATUSKHRPROC>(eglGetProcAddress("glGetGraphicsResetStatusKHR"));
+            glGetProgramBinaryOES = reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(eglGetProcAddress("glGetProgramBinaryOES"));
+            glProgramBinaryOES = reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(eglGetProcAddress("glProgramBinaryOES"));
         }
 
         PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES;
@@ -254,6 +258,8 @@ namespace API {
         PFNGLPOPDEBUGGROUPKHRPROC glPopDebugGroupKHR;
         PFNGLPUSHDEBUGGROUPKHRPROC glPushDebugGroupKHR;
         PFNGLGETGRAPHICSRESETSTATUSKHRPROC glGetGraphicsResetStatusKHR;
+        PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOES;
+        PFNGLPROGRAMBINARYOESPROC glProgramBinaryOES;
     }; // class GL
 
     class EGL {
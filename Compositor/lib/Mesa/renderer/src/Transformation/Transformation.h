@@ -23,6 +23,14 @@
 #include <array>
 #include <math.h>
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define __TRANSFORMATION_NEON__
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define __TRANSFORMATION_SSE__
+#endif
+
 namespace Thunder {
 namespace Compositor {
     namespace Transformation {
@@ -117,6 +125,38 @@ namespace Compositor {
          */
         static inline void Multiply(Matrix& matrix, const Matrix& a, const Matrix& b)
         {
+            // Every row of the result is the rows of b, scaled by a row of a and summed. The rows of b
+            // are not loaded in one go: when b was just written by a Multiply, a load wider than the
+            // stores that wrote it can not be forwarded and stalls, which costs more than it gains.
+#if defined(__TRANSFORMATION_NEON__)
+            const float32x2_t zero = vdup_n_f32(0.0f);
+            const float32x4_t b0 = vcombine_f32(vld1_f32(&b[0]), vld1_lane_f32(&b[2], zero, 0));
+            const float32x4_t b1 = vcombine_f32(vld1_f32(&b[3]), vld1_lane_f32(&b[5], zero, 0));
+            const float32x4_t b2 = vcombine_f32(vld1_f32(&b[6]), vld1_lane_f32(&b[8], zero, 0));
+
+            const float32x4_t r0 = vaddq_f32(vaddq_f32(vmulq_n_f32(b0, a[0]), vmulq_n_f32(b1, a[1])), vmulq_n_f32(b2, a[2]));
+            const float32x4_t r1 = vaddq_f32(vaddq_f32(vmulq_n_f32(b0, a[3]), vmulq_n_f32(b1, a[4])), vmulq_n_f32(b2, a[5]));
+            const float32x4_t r2 = vaddq_f32(vaddq_f32(vmulq_n_f32(b0, a[6]), vmulq_n_f32(b1, a[7])), vmulq_n_f32(b2, a[8]));
+
+            // In this order, the spare lane of a row is overwritten by the next row.
+            vst1q_f32(&matrix[0], r0);
+            vst1q_f32(&matrix[3], r1);
+            vst1_f32(&matrix[6], vget_low_f32(r2));
+            matrix[8] = vgetq_lane_f32(r2, 2);
+#elif defined(__TRANSFORMATION_SSE__)
+            const __m128 b0 = _mm_setr_ps(b[0], b[1], b[2], 0.0f);
+            const __m128 b1 = _mm_setr_ps(b[3], b[4], b[5], 0.0f);
+            const __m128 b2 = _mm_setr_ps(b[6], b[7], b[8], 0.0f);
+
+            const __m128 r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(a[0])), _mm_mul_ps(b1, _mm_set1_ps(a[1]))), _mm_mul_ps(b2, _mm_set1_ps(a[2])));
+            const __m128 r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(a[3])), _mm_mul_ps(b1, _mm_set1_ps(a[4]))), _mm_mul_ps(b2, _mm_set1_ps(a[5])));
+            const __m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(a[6])), _mm_mul_ps(b1, _mm_set1_ps(a[7]))), _mm_mul_ps(b2, _mm_set1_ps(a[8])));
+
+            _mm_storeu_ps(&matrix[0], r0);
+            _mm_storeu_ps(&matrix[3], r1);
+            _mm_storel_pi(reinterpret_cast<__m64*>(&matrix[6]), r2);
+            _mm_store_ss(&matrix[8], _mm_movehl_ps(r2, r2));
+#else
             Matrix multiply = {
                 (a[0] * b[0]) + (a[1] * b[3]) + (a[2] * b[6]), //
                 (a[0] * b[1]) + (a[1] * b[4]) + (a[2] * b[7]), //
@@ -130,6 +170,7 @@ namespace Compositor {
             };
 
             matrix = multiply;
+#endif
         }
 
         /**
@@ -165,13 +206,10 @@ namespace Compositor {
          */
         static inline void Translate(Matrix& matrix, const float x, const float y)
         {
-            Matrix translate = {
-                1.0f, 0.0f, x, //
-                0.0f, 1.0f, y, //
-                0.0f, 0.0f, 1.0f, //
-            };
-
-            Multiply(matrix, matrix, translate);
+            // Multiply(matrix, matrix, translate), only the last column changes.
+            matrix[2] = (matrix[0] * x) + (matrix[1] * y) + matrix[2];
+            matrix[5] = (matrix[3] * x) + (matrix[4] * y) + matrix[5];
+            matrix[8] = (matrix[6] * x) + (matrix[7] * y) + matrix[8];
         }
 
         /**
@@ -187,13 +225,13 @@ namespace Compositor {
          */
         static inline void Scale(Matrix& matrix, const float x, const float y)
         {
-            Matrix scale = {
-                x, 0.0f, 0.0f, //
-                0.0f, y, 0.0f, //
-                0.0f, 0.0f, 1.0f, //
-            };
-
-            Multiply(matrix, matrix, scale);
+            // Multiply(matrix, matrix, scale), only the first two columns change.
+            matrix[0] *= x;
+            matrix[3] *= x;
+            matrix[6] *= x;
+            matrix[1] *= y;
+            matrix[4] *= y;
+            matrix[7] *= y;
         }
 
         /**
@@ -220,9 +258,12 @@ namespace Compositor {
          */
         static inline void Rotate(Matrix& matrix, const float radians)
         {
+            const float cosine = ::cosf(radians);
+            const float sine = ::sinf(radians);
+
             Matrix rotate = {
-                ::cos(radians), -::sin(radians), 0.0f, //
-                ::sin(radians), ::cos(radians), 0.0f, //
+                cosine, -sine, 0.0f, //
+                sine, cosine, 0.0f, //
                 0.0f, 0.0f, 1.0f, //
             };
 
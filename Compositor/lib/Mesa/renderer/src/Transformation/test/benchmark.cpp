@@ -0,0 +1,172 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME TransformationBenchmark
+#endif
+
+#include <core/core.h>
+
+#include <Transformation.h>
+
+extern "C" {
+#include "ref_matrix/ref_matrix.h"
+}
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace Thunder;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+constexpr uint32_t Matrices = 256;
+constexpr uint32_t Rounds = 20000;
+
+// What the compositor keeps per client: the projection and what it was made from.
+struct Cached {
+    Exchange::IComposition::Rectangle Box;
+    uint32_t Output;
+    Compositor::Matrix Projection;
+};
+
+template <typename ACTION>
+double Measure(ACTION&& action)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t round = 0; round < Rounds; ++round) {
+        action(round);
+    }
+
+    return (std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (static_cast<double>(Rounds) * Matrices));
+}
+
+float Difference(const Compositor::Matrix& a, const float b[9])
+{
+    float result = 0;
+
+    for (uint8_t index = 0; index < 9; ++index) {
+        result = std::max(result, std::abs(a[index] - b[index]) / std::max(1.0f, std::abs(b[index])));
+    }
+
+    return (result);
+}
+
+}
+
+int main(int /*argc*/, const char* argv[])
+{
+    printf("%s - build: %s\n", Core::FileNameOnly(argv[0]), __TIMESTAMP__);
+
+#if defined(__TRANSFORMATION_NEON__)
+    printf("Multiply: NEON\n");
+#elif defined(__TRANSFORMATION_SSE__)
+    printf("Multiply: SSE\n");
+#else
+    printf("Multiply: scalar\n");
+#endif
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> values(-100.0f, 100.0f);
+    std::uniform_int_distribution<int> positions(0, 1920);
+
+    std::vector<Compositor::Matrix> matrices(Matrices);
+    std::vector<Compositor::Matrix> results(Matrices);
+    std::vector<std::array<float, 9>> references(Matrices);
+    std::vector<Exchange::IComposition::Rectangle> boxes(Matrices);
+    std::vector<Cached> cache(Matrices);
+
+    for (uint32_t index = 0; index < Matrices; ++index) {
+        for (float& value : matrices[index]) {
+            value = values(generator);
+        }
+        boxes[index] = { positions(generator), positions(generator), static_cast<uint32_t>(positions(generator) + 1), static_cast<uint32_t>(positions(generator) + 1) };
+    }
+
+    Compositor::Matrix projection;
+    Compositor::Transformation::Projection(projection, 1920, 1080, Compositor::Transformation::TRANSFORM_NORMAL);
+
+    /* ############################################################## */
+
+    const double reference = Measure([&](const uint32_t round) {
+        for (uint32_t index = 0; index < Matrices; ++index) {
+            ref_matrix_multiply(references[index].data(), matrices[index].data(), matrices[(index + round) % Matrices].data());
+        }
+    });
+
+    const double multiply = Measure([&](const uint32_t round) {
+        for (uint32_t index = 0; index < Matrices; ++index) {
+            Compositor::Transformation::Multiply(results[index], matrices[index], matrices[(index + round) % Matrices]);
+        }
+    });
+
+    float deviation = 0;
+
+    for (uint32_t index = 0; index < Matrices; ++index) {
+        deviation = std::max(deviation, Difference(results[index], references[index].data()));
+    }
+
+    printf("Multiply:   %6.1f ns (reference %6.1f ns), deviation %g\n", multiply, reference, deviation);
+
+    /* ############################################################## */
+
+    const double project = Measure([&](const uint32_t) {
+        for (uint32_t index = 0; index < Matrices; ++index) {
+            Compositor::Transformation::ProjectBox(results[index], boxes[index], Compositor::Transformation::TRANSFORM_FLIPPED_180, 0, projection);
+        }
+    });
+
+    const double cached = Measure([&](const uint32_t) {
+        for (uint32_t index = 0; index < Matrices; ++index) {
+            Cached& entry(cache[index]);
+            const Exchange::IComposition::Rectangle& box(boxes[index]);
+
+            if ((entry.Output != 1) || (entry.Box.x != box.x) || (entry.Box.y != box.y) || (entry.Box.width != box.width) || (entry.Box.height != box.height)) {
+                Compositor::Transformation::ProjectBox(entry.Projection, box, Compositor::Transformation::TRANSFORM_FLIPPED_180, 0, projection);
+                entry.Box = box;
+                entry.Output = 1;
+            }
+
+            results[index] = entry.Projection;
+        }
+    });
+
+    deviation = 0;
+
+    for (uint32_t index = 0; index < Matrices; ++index) {
+        const ref_box box = { boxes[index].x, boxes[index].y, static_cast<int>(boxes[index].width), static_cast<int>(boxes[index].height) };
+        float ref_projection[9];
+        float expected[9];
+
+        ref_matrix_projection(ref_projection, 1920, 1080, REF_TRANSFORM_NORMAL);
+        ref_matrix_project_box(expected, &box, REF_TRANSFORM_FLIPPED_180, 0, ref_projection);
+
+        deviation = std::max(deviation, Difference(cache[index].Projection, expected));
+    }
+
+    printf("ProjectBox: %6.1f ns (cached %6.1f ns), deviation %g\n", project, cached, deviation);
+
+    Thunder::Core::Singleton::Dispose();
+
+    return (deviation < 1e-4f ? 0 : 1);
+}
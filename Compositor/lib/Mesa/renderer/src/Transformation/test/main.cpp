@@ -174,6 +174,19 @@ int main(int /*argc*/, const char* argv[])
 
     /* ############################################################## */
 
+    // In place, the result is also one of the inputs.
+    Compositor::Matrix test7(test5);
+    Compositor::Transformation::Multiply(test7, test7, test3);
+    Compositor::Transformation::Multiply(test7, test1, test7);
+
+    float wr7[9];
+    ref_matrix_multiply(wr7, wr5, wr3);
+    ref_matrix_multiply(wr7, wr1, wr7);
+
+    ASSERT(compareResult(test7, wr7));
+
+    /* ############################################################## */
+
     TRACE_GLOBAL(Trace::Information, ("Testing Done..."));
     tracer.Close();
     Thunder::Core::Singleton::Dispose();
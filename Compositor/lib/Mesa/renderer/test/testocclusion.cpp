@@ -0,0 +1,130 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME CompositorRenderTest
+#endif
+
+#include <core/core.h>
+
+#include <cstdio>
+#include <vector>
+
+#include <Occlusion.h>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace Thunder;
+
+// Draw calls and pixels filled per frame for typical compositions on a 4K output, with and
+// without the visibility pass the compositor does before drawing. Needs no GPU, the pass
+// decides what is handed to the renderer.
+
+namespace {
+using Layer = Compositor::Occlusion::Layer;
+
+constexpr uint32_t Width = 3840;
+constexpr uint32_t Height = 2160;
+
+const Compositor::Occlusion::Box Output = { 0, 0, Width, Height };
+const Compositor::Occlusion::Box FullScreen = { 0, 0, Width, Height };
+
+struct Scenario {
+    const char* Name;
+    std::vector<Layer> Layers; // bottom to top
+    std::vector<bool> Expected;
+    bool Clear;
+};
+
+uint64_t Pixels(const Compositor::Occlusion::Box& box)
+{
+    return (static_cast<uint64_t>(box.width) * box.height);
+}
+
+bool Run(Scenario& scenario)
+{
+    uint64_t before = Pixels(Output); // the clear
+    uint64_t after = 0;
+    uint16_t draws = 0;
+
+    const bool clear = Compositor::Occlusion::Resolve(scenario.Layers, Output);
+
+    bool correct = (clear == scenario.Clear);
+
+    if (clear == true) {
+        after += Pixels(Output);
+    }
+
+    for (uint16_t index = 0; index < scenario.Layers.size(); index++) {
+        const Layer& layer = scenario.Layers[index];
+
+        before += Pixels(layer.Area);
+
+        if (layer.Visible == true) {
+            after += Pixels(layer.Area);
+            draws++;
+        }
+
+        correct = correct && (layer.Visible == scenario.Expected[index]);
+    }
+
+    printf("%-26s: %u/%u draws, %-8s, %6.1f -> %6.1f Mpixel %s\n",
+        scenario.Name, draws, static_cast<uint32_t>(scenario.Layers.size()), (clear == true ? "clear" : "no clear"),
+        before / 1000000.0, after / 1000000.0, (correct == true ? "" : "FAILED"));
+
+    return (correct);
+}
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    std::vector<Scenario> scenarios = {
+        { "fullscreen app",
+            { { FullScreen, true, false }, { FullScreen, true, false }, { FullScreen, true, false } },
+            { false, false, true }, false },
+        { "app with alpha overlay",
+            { { FullScreen, true, false }, { FullScreen, true, false }, { { 0, 1800, Width, 360 }, false, false } },
+            { false, true, true }, false },
+        { "app fading in",
+            { { FullScreen, true, false }, { FullScreen, false, false } },
+            { true, true }, false },
+        { "split screen",
+            { { FullScreen, true, false }, { { 0, 0, Width / 2, Height }, true, false }, { { Width / 2, 0, Width / 2, Height }, true, false } },
+            { false, true, true }, false },
+        { "picture in picture",
+            { { FullScreen, true, false }, { { 2880, 1620, 960, 540 }, true, false } },
+            { true, true }, false },
+        { "off screen",
+            { { FullScreen, true, false }, { { -1920, 0, 1920, Height }, true, false }, { { 0, Height, Width, 100 }, true, false } },
+            { true, false, false }, false },
+        { "small windows",
+            { { { 100, 100, 640, 360 }, true, false }, { { 120, 120, 320, 180 }, false, false } },
+            { true, true }, true },
+    };
+
+    bool correct = true;
+
+    for (Scenario& scenario : scenarios) {
+        correct = Run(scenario) && correct;
+    }
+
+    printf("visibility                : %s\n", (correct == true ? "correct" : "FAILED"));
+
+    return (correct == true ? 0 : 1);
+}
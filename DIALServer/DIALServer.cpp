@@ -45,6 +45,9 @@ namespace Plugin {
     static const string _DefaultRunningExtension(_T("Running"));
     static const string _DefaultHiddenExtension(_T("Hidden"));
     static const string _ClientFriendlyName = (_T("friendlyName"));
+    static const string _ServerName(_T("Linux/2.6 UPnP/1.0 quick_ssdp/1.0"));
+
+    static constexpr uint32_t HostRefresh = 30; // seconds before an interface address is looked up again
 
     constexpr TCHAR _VersionSupportedKey[] = _T("clientDialVer");
     constexpr TCHAR _HideCommand[] = _T("hide");
@@ -58,21 +61,9 @@ namespace Plugin {
         WebFlow(const WebFlow& a_Copy) = delete;
         WebFlow& operator=(const WebFlow& a_RHS) = delete;
 
-        WebFlow(const Core::ProxyType<Web::Request>& request, const Core::NodeId& nodeId)
-        {
-            if (request.IsValid() == true) {
-                string text;
-                request->ToString(text);
-                _text = Core::ToString(string("\n[" + nodeId.HostAddress() + ']' + text + '\n'));
-            }
-        }
-        WebFlow(const Core::ProxyType<Web::Response>& response, const Core::NodeId& nodeId)
+        WebFlow(const uint8_t frame[], const uint16_t length, const Core::NodeId& nodeId)
         {
-            if (response.IsValid() == true) {
-                string text;
-                response->ToString(text);
-                _text = Core::ToString(string("\n[" + nodeId.HostAddress() + ']' + text + '\n'));
-            }
+            _text = Core::ToString(string("\n[" + nodeId.HostAddress() + ']' + string(reinterpret_cast<const char*>(frame), length) + '\n'));
         }
         ~WebFlow() = default;
 
@@ -90,36 +81,6 @@ namespace Plugin {
         std::string _text;
     };
 
-    uint16_t DIALServer::WebTransform::Transform(Web::Request::Deserializer& deserializer, uint8_t* dataFrame, const uint16_t maxSendSize)
-    {
-        uint16_t index = 0;
-        const uint8_t* checker = dataFrame;
-
-        // This is a UDP service, so a message should be complete. If the first keyword is not a keyword we
-        // expect, ignore the full message, it is not a DIAL server package and does not require any further
-        // processing.
-        // First skip the white sace, if applicable...
-        while (isspace(*checker)) {
-            checker++;
-        }
-
-        // Now see if the first keyword is "M-SEARCH"
-        while ((index < _keywordLength) && (toupper(*checker) == Web::Request::MSEARCH[index])) {
-            checker++;
-            index++;
-        }
-
-        // Now we need to find the keyword "M-SEARCH" see if we have it..
-        if (index == _keywordLength) {
-            deserializer.Flush();
-            index = deserializer.Deserialize(dataFrame, maxSendSize);
-        } else {
-            index = maxSendSize;
-        }
-
-        return (index);
-    }
-
     /* virtual */ uint32_t DIALServer::Default::AdditionalDataURL(string& url) const
     {
         Core::URL baseUrl(_parent->BaseURL());
@@ -129,101 +90,158 @@ namespace Plugin {
         return (Core::ERROR_NONE);
     }
 
-    DIALServer::DIALServerImpl::DIALServerImpl(const string& deviceId, const Core::URL& locator, const string& appPath, const bool dynamicInterface)
-        : BaseClass(5, false, Core::NodeId(DialServerInterface.AnyInterface(), DialServerInterface.PortNumber()), DialServerInterface.AnyInterface(), 1024, 1024)
-        , _response(Core::ProxyType<Web::Response>::Create())
-        , _destinations()
+    DIALServer::DIALServerImpl::DIALServerImpl(const string& deviceId, const Core::URL& locator, const string& appPath, const bool dynamicInterface, const uint16_t responseDelay)
+        : Core::SocketDatagram(false, Core::NodeId(DialServerInterface.AnyInterface(), DialServerInterface.PortNumber()), DialServerInterface.AnyInterface(), 1024, 1024)
+        , _responder(_ServerName, _SearchTarget, _T("uuid:") + deviceId + _T("::") + _SearchTarget, responseDelay)
+        , _job(*this)
+        , _scheduled(0)
+        , _hosts()
         , _locator(locator)
         , _baseURL()
+        , _applicationURL()
         , _appPath(appPath)
         , _dynamicInterface(dynamicInterface)
     {
-        _response->ErrorCode = Web::STATUS_OK;
-        _response->Message = _T("OK");
-        _response->CacheControl = _T("max-age=1800");
-        _response->Server = _T("Linux/2.6 UPnP/1.0 quick_ssdp/1.0");
-        _response->ST = _SearchTarget;
-        _response->USN = _T("uuid:") + deviceId + _T("::") + _SearchTarget;
-        // FIXME: Uncomment when adding WoL/WoWLAN support.
-        // This SHALL NOT be present if neither WoL nor WoWLAN is supported.
-        // Moreover real MAC address of the network interface (either wired or wireless one) should be passed
-        // _response->WakeUp = _T("MAC=") + MACAddress + _T(";Timeout=10");
-        _response->Mode(Web::MARSHAL_UPPERCASE);
+        // FIXME: Add a "WAKEUP: MAC=<address>;Timeout=10" header to the responses when adding WoL/WoWLAN
+        // support. This SHALL NOT be present if neither WoL nor WoWLAN is supported. Moreover real MAC
+        // address of the network interface (either wired or wireless one) should be passed.
 
         UpdateURL();
 
-        if (Link().Open(1000) != Core::ERROR_NONE) {
+        if (Open(1000) != Core::ERROR_NONE) {
             ASSERT(false && "Seems we can not open the DIAL discovery port");
         }
 
-        Link().Join(DialServerInterface);
+        Join(DialServerInterface);
     }
 
     /* virtual */ DIALServer::DIALServerImpl::~DIALServerImpl()
     {
-        Link().Leave(DialServerInterface);
-        Link().Close(Core::infinite);
+        // Nothing can schedule the job anymore once the socket is closed.
+        Leave(DialServerInterface);
+        Close(Core::infinite);
+
+        _job.Revoke();
     }
 
-    // Notification of a Partial Request received, time to attach a body..
-    /* virtual */ void DIALServer::DIALServerImpl::LinkBody(Core::ProxyType<Web::Request>&)
+    /* virtual */ uint16_t DIALServer::DIALServerImpl::SendData(uint8_t[], const uint16_t)
     {
-        // upnp requests are empty so no body needed...
+        // Responses are not sent through the link, the responder sends them.
+        return (0);
     }
 
-    // Notification of a Partial Request received, time to attach a body..
-    // upnp requests are empty so no body needed...
-    /* virtual */ void DIALServer::DIALServerImpl::Received(Core::ProxyType<Web::Request>& request)
+    /* virtual */ uint16_t DIALServer::DIALServerImpl::ReceiveData(uint8_t dataFrame[], const uint16_t receivedSize)
     {
-        Core::NodeId sourceNode(Link().ReceivedNode());
-        TRACE(WebFlow, (request, sourceNode));
+        const Core::NodeId sourceNode(ReceivedNode());
+        TRACE(WebFlow, (dataFrame, receivedSize, sourceNode));
+
+        // This is a UDP service, so a message is complete. Anything that is not a search for a DIAL
+        // server is ignored, it does not require any further processing.
+        if (_responder.IsSearch(dataFrame, receivedSize) == true) {
+
+            TRACE(Protocol, (string(_T("IN: M-SEARCH from ")) + sourceNode.HostAddress()));
+
+            Search(sourceNode, ReceivedInterface(), SSDPResponder::MX(dataFrame, receivedSize));
+        }
+
+        return (receivedSize);
+    }
 
-        if ((request->Verb == Web::Request::HTTP_MSEARCH) && (request->ST.IsSet() == true)) {
-            if (request->ST.Value() == _SearchTarget) {
+    void DIALServer::DIALServerImpl::Search(const Core::NodeId& source, const uint32_t receivedInterface, const uint8_t mx)
+    {
+        const uint64_t now = Core::Time::Now().Ticks();
 
-                TRACE(Protocol, (&(*request)));
+        _lock.Lock();
 
-                _lock.Lock();
+        const uint32_t interface = Host(receivedInterface, now);
+        const uint64_t due = _responder.Schedule(source, interface, mx, now);
 
-                Host(Link().ReceivedInterface());
+        // Only move the job if this response is due before anything already waiting.
+        if ((due != 0) && ((_scheduled == 0) || (due < _scheduled))) {
+            _scheduled = due;
+            _job.Reschedule(Core::Time(due));
+        }
 
-                _destinations.push_back(sourceNode);
+        _lock.Unlock();
+    }
 
-                // remember the NodeId where this comes from.
-                if (_destinations.size() == 1) {
+    uint32_t DIALServer::DIALServerImpl::Host(const uint32_t interface, const uint64_t now)
+    {
+        uint32_t result = SSDPResponder::NoInterface;
+
+        if ((_dynamicInterface == true) && (interface != SSDPResponder::NoInterface)) {
+            HostAddress& entry(_hosts[interface]);
+
+            if (entry.Expires <= now) {
+                string host;
+                Core::AdapterIterator adapter(interface);
+
+                if ((adapter.IsValid() == true)) {
+                    Core::IPV4AddressIterator addresses(adapter.IPV4Addresses());
+                    while (addresses.Next() == true) {
+                        Core::NodeId current(addresses.Address());
+                        if ((current.IsMulticast() == false) && (current.IsLocalInterface() == false)) {
+                            host = current.HostAddress();
+                            break;
+                        }
+                    }
+                }
 
-                    Link().RemoteNode(_destinations.front());
+                entry.Expires = now + (HostRefresh * Core::Time::TicksPerMillisecond * 1000);
 
-                    _response->Location = URL() + '/' + _DefaultAppInfoDevice;
+                if ((host != entry.Host) || (_responder.HasLocation(interface) == false)) {
+                    entry.Host = host;
 
-                    Submit(_response);
+                    if (host.empty() == false) {
+                        Render(interface, host);
+                    }
                 }
+            }
+
+            if (entry.Host.empty() == false) {
+                result = interface;
 
-                _lock.Unlock();
+                if (_locator.Host().Value() != entry.Host) {
+                    _locator.Host(entry.Host);
+                    UpdateURL();
+                }
             }
         }
+
+        return (result);
     }
 
-    // Notification of a Response send.
-    /* virtual */ void DIALServer::DIALServerImpl::Send(const Core::ProxyType<Web::Response>& response)
+    void DIALServer::DIALServerImpl::Render(const uint32_t interface, const string& host)
     {
-        TRACE(WebFlow, (response, _destinations.front()));
+        Core::URL location(_locator);
+        location.Host(host);
 
-        TRACE(Protocol, (&(*response)));
+        _responder.Location(interface, location.Text() + '/' + _appPath + '/' + _DefaultAppInfoDevice);
+    }
 
-        _lock.Lock();
+    void DIALServer::DIALServerImpl::UpdateURL()
+    {
+        _baseURL = (_locator.Text() + '/' + _appPath);
+        _applicationURL = Core::URL(_baseURL);
 
-        // Drop the current destination.
-        _destinations.pop_front();
+        // Searches on an interface without a resolved address get the current base URL.
+        _responder.Location(SSDPResponder::NoInterface, _baseURL + '/' + _DefaultAppInfoDevice);
+
+        TRACE(Trace::Information, (_T("Updated base URL: %s"), _baseURL.c_str()));
+    }
+
+    void DIALServer::DIALServerImpl::Dispatch()
+    {
+        _lock.Lock();
 
-        if (_destinations.size() > 0) {
+        const uint16_t pending = _responder.Pending();
 
-            _response->Location = URL() + '/' + _DefaultAppInfoDevice;
+        _scheduled = _responder.Dispatch(Descriptor(), Core::Time::Now().Ticks());
 
-            // Move on to notifying the next one.
-            Link().RemoteNode(_destinations.front());
+        TRACE(Protocol, (std::to_string(pending - _responder.Pending()) + _T(" SSDP responses sent")));
 
-            Submit(response);
+        if (_scheduled != 0) {
+            _job.Reschedule(Core::Time(_scheduled));
         }
 
         _lock.Unlock();
@@ -335,7 +353,7 @@ namespace Plugin {
             const string deviceId = DeviceId();
             // TODO: THis used to be the MAC, but I think  it is just a unique number, otherwise, we need the MAC
             //       that goes with the selectedNode !!!!
-            _dialServiceImpl = new DIALServerImpl(deviceId, _dialURL, _DefaultAppInfoPath, selectedNode.IsAnyInterface());
+            _dialServiceImpl = new DIALServerImpl(deviceId, _dialURL, _DefaultAppInfoPath, selectedNode.IsAnyInterface(), _config.ResponseDelay.Value());
 
             ASSERT(_dialServiceImpl != nullptr);
 
@@ -549,9 +567,9 @@ namespace Plugin {
                     result->Body(_deviceInfo);
                     result->ContentType = Web::MIME_TEXT_XML;
 
-                    const string url = _dialServiceImpl->URL();
-                    result->ApplicationURL = Core::URL(url);
-                    TRACE(Protocol, (static_cast<const string&>(*_deviceInfo), url));
+                    const Core::URL url(_dialServiceImpl->ApplicationURL());
+                    result->ApplicationURL = url;
+                    TRACE(Protocol, (static_cast<const string&>(*_deviceInfo), url.Text()));
                 }
             } else {
                 auto selectedApp(_appInfo.find(keyword));
@@ -731,7 +749,7 @@ namespace Plugin {
 
         _adminLock.Lock();
 
-        std::map<const string, AppInformation>::iterator index(_appInfo.begin());
+        auto index(_appInfo.begin());
 
         while (index != _appInfo.end()) {
             index->second.SwitchBoard(switchBoard);
@@ -746,7 +764,7 @@ namespace Plugin {
 
         _adminLock.Lock();
 
-        std::map<const string, AppInformation>::iterator index(_appInfo.begin());
+        auto index(_appInfo.begin());
 
         while (index != _appInfo.end()) {
             index->second.SwitchBoard(nullptr);
@@ -21,6 +21,7 @@
 #define __PLUGINDIALSERVER_H
 
 #include "Module.h"
+#include "SSDPResponder.h"
 #include <interfaces/ISwitchBoard.h>
 #include <interfaces/IWebServer.h>
 #include <interfaces/IBrowser.h>
@@ -118,6 +119,7 @@ namespace Plugin {
                 , WebServer()
                 , SwitchBoard()
                 , DeprecatedAPI(false)
+                , ResponseDelay(500)
             {
                 Add(_T("interface"), &Interface);
                 Add(_T("name"), &Name);
@@ -132,6 +134,7 @@ namespace Plugin {
                 Add(_T("webserver"), &WebServer);
                 Add(_T("switchboard"), &SwitchBoard);
                 Add(_T("deprecatedapi"), &DeprecatedAPI);
+                Add(_T("responsedelay"), &ResponseDelay);
                 Add(_T("apps"), &Apps);
             }
             ~Config() override = default;
@@ -150,6 +153,7 @@ namespace Plugin {
             Core::JSON::String WebServer;
             Core::JSON::String SwitchBoard;
             Core::JSON::Boolean DeprecatedAPI;
+            Core::JSON::DecUInt16 ResponseDelay; // ms, upper limit of the random SSDP response delay
             Core::JSON::ArrayType<App> Apps;
         };
 
@@ -726,47 +730,32 @@ namespace Plugin {
         private:
             std::string _text;
         };
-        class WebTransform {
+        class DIALServerImpl : public Core::SocketDatagram {
         private:
-            WebTransform(const WebTransform&);
-            WebTransform& operator=(const WebTransform&);
+            static const Core::NodeId DialServerInterface;
 
-        public:
-            inline WebTransform()
-                : _keywordLength(static_cast<uint8_t>(_tcslen(Web::Request::MSEARCH)))
-            {
-            }
-            inline ~WebTransform()
-            {
-            }
+            using Job = Core::WorkerPool::JobType<DIALServerImpl&>;
 
-            // Methods to extract and insert data into the socket buffers
-            uint16_t Transform(Web::Request::Deserializer& deserializer, uint8_t* dataFrame, const uint16_t maxSendSize);
+            // Resolved address of an interface, looked up again once in a while as it may change.
+            struct HostAddress {
+                string Host;
+                uint64_t Expires;
+            };
 
-        private:
-            uint8_t _keywordLength;
-        };
-        class DIALServerImpl : public Web::WebLinkType<Core::SocketDatagram, Web::Request, Web::Response, Core::ProxyPoolType<Web::Request>, WebTransform> {
-        private:
-            static const Core::NodeId DialServerInterface;
-            typedef Web::WebLinkType<Core::SocketDatagram, Web::Request, Web::Response, Core::ProxyPoolType<Web::Request>, WebTransform> BaseClass;
+            friend class Core::ThreadPool::JobType<DIALServerImpl&>;
 
             DIALServerImpl(const DIALServerImpl&) = delete;
             DIALServerImpl& operator=(const DIALServerImpl&) = delete;
 
         public:
-            DIALServerImpl(const string& MACAddress, const Core::URL& baseURL, const string& appPath, const bool dynamicInterface);
+            DIALServerImpl(const string& MACAddress, const Core::URL& baseURL, const string& appPath, const bool dynamicInterface, const uint16_t responseDelay);
             ~DIALServerImpl() override;
 
         public:
-            // Notification of a Partial Request received, time to attach a body..
-            void LinkBody(Core::ProxyType<Web::Request>& element) override;
-
-            // Notification of a Request received.
-            void Received(Core::ProxyType<Web::Request>& text) override;
-
-            // Notification of a Response send.
-            void Send(const Core::ProxyType<Web::Response>& text) override;
+            // Searches are parsed straight from the datagram, the MX header they carry is not
+            // part of a Web::Request.
+            uint16_t SendData(uint8_t dataFrame[], const uint16_t maxSendSize) override;
+            uint16_t ReceiveData(uint8_t dataFrame[], const uint16_t receivedSize) override;
 
             // Notification of a channel state change..
             void StateChange() override;
@@ -776,6 +765,11 @@ namespace Plugin {
                 Core::SafeSyncType<Core::CriticalSection> scopedLock(_lock);
                 return (_baseURL);
             }
+            Core::URL ApplicationURL() const
+            {
+                Core::SafeSyncType<Core::CriticalSection> scopedLock(_lock);
+                return (_applicationURL);
+            }
             void Locator(const string& locator)
             {
                 Locator(Core::URL(locator));
@@ -785,42 +779,32 @@ namespace Plugin {
                 _lock.Lock();
                 _locator.Port(locator.Port().Value());
                 UpdateURL();
-                _lock.Unlock();
-            }
 
-        private:
-            void Host(const uint32_t interface)
-            {
-                if ((_dynamicInterface == true) && (interface != static_cast<uint32_t>(~0))) {
-                    Core::AdapterIterator adapter(interface);
-                    if ((adapter.IsValid() == true)) {
-                        Core::IPV4AddressIterator addresses(adapter.IPV4Addresses());
-                        while (addresses.Next() == true) {
-                            Core::NodeId current(addresses.Address());
-                            if ((current.IsMulticast() == false) && (current.IsLocalInterface() == false)) {
-                                if (_locator.Host().Value() != current.HostAddress()) {
-                                    _locator.Host(current.HostAddress());
-                                    UpdateURL();
-                                }
-                                break;
-                            }
-                        }
+                // The port is part of every rendered response.
+                for (const auto& entry : _hosts) {
+                    if (entry.second.Host.empty() == false) {
+                        Render(entry.first, entry.second.Host);
                     }
                 }
+                _lock.Unlock();
             }
-            void UpdateURL()
-            {
-                _baseURL = (_locator.Text() + '/' + _appPath);
-                TRACE(Trace::Information, (_T("Updated base URL: %s"), URL().c_str()));
-            }
+
+        private:
+            void Search(const Core::NodeId& source, const uint32_t receivedInterface, const uint8_t mx);
+            uint32_t Host(const uint32_t interface, const uint64_t now);
+            void Render(const uint32_t interface, const string& host);
+            void UpdateURL();
+            void Dispatch();
 
         private:
             mutable Core::CriticalSection _lock;
-            // This should be the "Response" as depicted by the parent/DIALserver.
-            Core::ProxyType<Web::Response> _response;
-            std::list<Core::NodeId> _destinations;
+            SSDPResponder _responder;
+            Job _job;
+            uint64_t _scheduled;
+            std::unordered_map<uint32_t, HostAddress> _hosts;
             Core::URL _locator;
             string _baseURL;
+            Core::URL _applicationURL;
             const string _appPath;
             bool _dynamicInterface;
         };
@@ -1306,7 +1290,7 @@ POP_WARNING()
         DIALServerImpl* _dialServiceImpl;
         Core::ProxyType<Web::TextBody> _deviceInfo;
         Core::SinkType<Notification> _sink;
-        std::map<const string, AppInformation> _appInfo;
+        std::unordered_map<string, AppInformation> _appInfo;
         bool _deprecatedAPI;
     };
 }
@@ -0,0 +1,258 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SSDPResponder.h"
+
+#include <sys/socket.h>
+
+namespace Thunder {
+namespace Plugin {
+
+    static constexpr uint16_t NoResponse = static_cast<uint16_t>(~0);
+
+    SSDPResponder::SSDPResponder(const string& server, const string& searchTarget, const string& usn, const uint16_t maxDelay)
+        : _server(server)
+        , _searchTarget(searchTarget)
+        , _usn(usn)
+        , _maxDelay(maxDelay)
+        , _responses()
+        , _pending()
+        , _seed(static_cast<uint32_t>(Core::Time::Now().Ticks() ^ reinterpret_cast<uintptr_t>(this)) | 1)
+        , _dropped(0)
+    {
+        _pending.reserve(MaxPending);
+    }
+
+    void SSDPResponder::Location(const uint32_t interface, const string& location)
+    {
+        // Same headers as the Web::Response this used to be, plus the EXT the UPnP spec asks for.
+        string text(_T("HTTP/1.1 200 OK\r\n")
+                     _T("CACHE-CONTROL: max-age=1800\r\n")
+                     _T("EXT:\r\n")
+                     _T("LOCATION: ") + location + _T("\r\n")
+                     _T("SERVER: ") + _server + _T("\r\n")
+                     _T("ST: ") + _searchTarget + _T("\r\n")
+                     _T("USN: ") + _usn + _T("\r\n")
+                     _T("\r\n"));
+
+        const uint16_t index = Index(interface);
+
+        if (index != NoResponse) {
+            _responses[index].second = std::move(text);
+        } else {
+            _responses.emplace_back(interface, std::move(text));
+        }
+    }
+
+    bool SSDPResponder::HasLocation(const uint32_t interface) const
+    {
+        return (Index(interface) != NoResponse);
+    }
+
+    const string& SSDPResponder::Response(const uint32_t interface) const
+    {
+        const uint16_t index = Index(interface);
+        return (index != NoResponse ? _responses[index].second : EMPTY_STRING);
+    }
+
+    uint64_t SSDPResponder::Schedule(const Core::NodeId& destination, const uint32_t interface, const uint8_t mx, const uint64_t now)
+    {
+        uint16_t response = Index(interface);
+
+        if (response == NoResponse) {
+            response = Index(NoInterface);
+        }
+
+        if (response != NoResponse) {
+            // Searchers send the same M-SEARCH a few times, one answer is enough.
+            std::vector<Entry>::const_iterator index(_pending.cbegin());
+            while ((index != _pending.cend()) && (index->Destination != destination)) {
+                index++;
+            }
+
+            if (index == _pending.cend()) {
+                if (_pending.size() >= MaxPending) {
+                    _dropped++;
+                } else {
+                    const uint32_t window = std::min(static_cast<uint32_t>(std::min(mx, MaxMX)) * 1000, static_cast<uint32_t>(_maxDelay));
+                    const uint32_t delay = (window != 0 ? (Random() % (window + 1)) : 0);
+
+                    _pending.push_back({ now + (static_cast<uint64_t>(delay) * Core::Time::TicksPerMillisecond), destination, response });
+                    std::push_heap(_pending.begin(), _pending.end(), Later);
+                }
+            }
+        }
+
+        return (_pending.empty() == false ? _pending.front().Due : 0);
+    }
+
+    uint64_t SSDPResponder::Dispatch(const int socket, const uint64_t now)
+    {
+        struct mmsghdr messages[Batch];
+        struct iovec vectors[Batch];
+        Entry sending[Batch];
+        bool full = false;
+
+        while ((full == false) && (_pending.empty() == false) && (_pending.front().Due <= now)) {
+            uint8_t count = 0;
+
+            while ((count < Batch) && (_pending.empty() == false) && (_pending.front().Due <= now)) {
+                std::pop_heap(_pending.begin(), _pending.end(), Later);
+                sending[count] = std::move(_pending.back());
+                _pending.pop_back();
+
+                const string& text(_responses[sending[count].Response].second);
+
+                vectors[count].iov_base = const_cast<char*>(text.c_str());
+                vectors[count].iov_len = text.length();
+
+                ::memset(&messages[count], 0, sizeof(messages[count]));
+                messages[count].msg_hdr.msg_name = const_cast<struct sockaddr*>(static_cast<const struct sockaddr*>(sending[count].Destination));
+                messages[count].msg_hdr.msg_namelen = sending[count].Destination.Size();
+                messages[count].msg_hdr.msg_iov = &(vectors[count]);
+                messages[count].msg_hdr.msg_iovlen = 1;
+
+                count++;
+            }
+
+            int sent = ::sendmmsg(socket, messages, count, MSG_DONTWAIT);
+
+            if (sent < 0) {
+                if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                    sent = 0;
+                } else {
+                    // Not a temporary condition, the first one is not deliverable, skip it.
+                    TRACE(Trace::Error, (_T("SSDP response to %s failed: %d"), sending[0].Destination.HostAddress().c_str(), errno));
+                    sent = 1;
+                }
+            }
+
+            // Whatever did not fit in the socket buffer is tried again a bit later.
+            for (uint8_t index = static_cast<uint8_t>(sent); index < count; index++) {
+                sending[index].Due = now + (RetryDelay * Core::Time::TicksPerMillisecond);
+                _pending.push_back(std::move(sending[index]));
+                std::push_heap(_pending.begin(), _pending.end(), Later);
+                full = true;
+            }
+        }
+
+        return (_pending.empty() == false ? _pending.front().Due : 0);
+    }
+
+    bool SSDPResponder::IsSearch(const uint8_t frame[], const uint16_t length) const
+    {
+        const uint16_t size = static_cast<uint16_t>(_tcslen(Web::Request::MSEARCH));
+        uint16_t index = 0;
+        uint16_t match = 0;
+
+        // Skip the white space, if applicable, and see if the first keyword is "M-SEARCH".
+        while ((index < length) && (isspace(frame[index]) != 0)) {
+            index++;
+        }
+        while (((index + match) < length) && (match < size) && (toupper(frame[index + match]) == Web::Request::MSEARCH[match])) {
+            match++;
+        }
+
+        return ((match == size) && ((index + size) < length) && (frame[index + size] == ' ') && (Header(frame, length, _T("ST")) == _searchTarget));
+    }
+
+    /* static */ string SSDPResponder::Header(const uint8_t frame[], const uint16_t length, const TCHAR key[])
+    {
+        const uint16_t size = static_cast<uint16_t>(_tcslen(key));
+        string result;
+        uint16_t index = 0;
+
+        // Header lines only, the request line can not hold it.
+        while ((index < length) && (frame[index] != '\n')) {
+            index++;
+        }
+
+        while ((index + size + 1) < length) {
+            uint16_t match = 0;
+
+            index++;
+
+            while ((match < size) && (toupper(frame[index + match]) == toupper(key[match]))) {
+                match++;
+            }
+
+            if ((match == size) && (frame[index + size] == ':')) {
+                index += size + 1;
+
+                while ((index < length) && ((frame[index] == ' ') || (frame[index] == '\t'))) {
+                    index++;
+                }
+
+                uint16_t end = index;
+                while ((end < length) && (frame[end] != '\r') && (frame[end] != '\n')) {
+                    end++;
+                }
+                while ((end > index) && ((frame[end - 1] == ' ') || (frame[end - 1] == '\t'))) {
+                    end--;
+                }
+
+                result.assign(reinterpret_cast<const char*>(&frame[index]), end - index);
+                break;
+            }
+
+            while ((index < length) && (frame[index] != '\n')) {
+                index++;
+            }
+        }
+
+        return (result);
+    }
+
+    /* static */ uint8_t SSDPResponder::MX(const uint8_t frame[], const uint16_t length)
+    {
+        const string value(Header(frame, length, _T("MX")));
+        uint32_t result = 0;
+        uint16_t index = 0;
+
+        while ((index < value.length()) && (isdigit(value[index]) != 0)) {
+            result = std::min((result * 10) + (value[index] - '0'), static_cast<uint32_t>(0xFF));
+            index++;
+        }
+
+        return (static_cast<uint8_t>(result));
+    }
+
+    uint16_t SSDPResponder::Index(const uint32_t interface) const
+    {
+        uint16_t index = 0;
+
+        while ((index < _responses.size()) && (_responses[index].first != interface)) {
+            index++;
+        }
+
+        return (index < _responses.size() ? index : NoResponse);
+    }
+
+    uint32_t SSDPResponder::Random()
+    {
+        // xorshift, only used to spread the responses.
+        _seed ^= (_seed << 13);
+        _seed ^= (_seed >> 17);
+        _seed ^= (_seed << 5);
+
+        return (_seed);
+    }
+
+} // namespace Plugin
+} // namespace Thunder
@@ -0,0 +1,110 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+namespace Thunder {
+namespace Plugin {
+
+    // Answers SSDP searches. The response is rendered once per interface the searches come in on,
+    // every response is held back a random part of the MX window the searcher asked for (UPnP 1.1,
+    // 1.3.3) and all responses that are due go out in a single sendmmsg. Not thread safe, the owner
+    // serializes Schedule and Dispatch.
+    class SSDPResponder {
+    private:
+        struct Entry {
+            uint64_t Due;
+            Core::NodeId Destination;
+            uint16_t Response;
+        };
+
+    public:
+        static constexpr uint32_t NoInterface = static_cast<uint32_t>(~0);
+        static constexpr uint16_t MaxPending = 256;
+        static constexpr uint8_t Batch = 32; // datagrams per sendmmsg
+        static constexpr uint8_t MaxMX = 5; // larger values are treated as 5 seconds
+        static constexpr uint16_t RetryDelay = 10; // ms, after the socket buffer ran full
+
+        SSDPResponder() = delete;
+        SSDPResponder(const SSDPResponder&) = delete;
+        SSDPResponder& operator=(const SSDPResponder&) = delete;
+
+        // maxDelay (ms) caps the MX window, so a searcher asking for a 5 seconds window
+        // is not kept waiting that long.
+        SSDPResponder(const string& server, const string& searchTarget, const string& usn, const uint16_t maxDelay);
+        ~SSDPResponder() = default;
+
+    public:
+        // (Re)renders the response to searches that arrive on this interface.
+        void Location(const uint32_t interface, const string& location);
+        bool HasLocation(const uint32_t interface) const;
+        const string& Response(const uint32_t interface) const;
+
+        uint16_t Pending() const
+        {
+            return (static_cast<uint16_t>(_pending.size()));
+        }
+        uint32_t Dropped() const
+        {
+            return (_dropped);
+        }
+        void Clear()
+        {
+            _pending.clear();
+        }
+
+        // Queues a response to the destination, a destination that is already waiting for one
+        // is not queued again. Returns when the first response is due (ticks), 0 if none.
+        uint64_t Schedule(const Core::NodeId& destination, const uint32_t interface, const uint8_t mx, const uint64_t now);
+
+        // Sends every response that is due. Returns when the next response is due (ticks), 0 if none.
+        uint64_t Dispatch(const int socket, const uint64_t now);
+
+        // True if the raw message is an M-SEARCH for the search target this responder answers.
+        bool IsSearch(const uint8_t frame[], const uint16_t length) const;
+
+        // The value of a header of a raw SSDP message, empty if it is not there.
+        static string Header(const uint8_t frame[], const uint16_t length, const TCHAR key[]);
+
+        // The MX header of a raw M-SEARCH, 0 if it is not there or not a number.
+        static uint8_t MX(const uint8_t frame[], const uint16_t length);
+
+    private:
+        static bool Later(const Entry& lhs, const Entry& rhs)
+        {
+            return (lhs.Due > rhs.Due);
+        }
+        uint16_t Index(const uint32_t interface) const;
+        uint32_t Random();
+
+    private:
+        const string _server;
+        const string _searchTarget;
+        const string _usn;
+        const uint16_t _maxDelay;
+        std::vector<std::pair<uint32_t, string>> _responses;
+        std::vector<Entry> _pending; // min heap on Due
+        uint32_t _seed;
+        uint32_t _dropped;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
@@ -0,0 +1,309 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Discovery latency with many searchers on the loopback: every searcher sends its M-SEARCH (twice,
+// as real ones do) at the same moment. Answered one at a time, rendering the response for every
+// destination and waiting for the socket before the next, as the plugin did before, against the
+// rendered responses going out in batches. A last round uses an MX window, to see the responses
+// spread out over it.
+
+#include <SSDPResponder.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace Thunder;
+using Plugin::SSDPResponder;
+
+namespace {
+
+constexpr uint16_t Searchers = 100;
+constexpr uint8_t Repeats = 2;
+constexpr uint16_t MaxDelay = 500; // ms
+const string SearchTarget(_T("urn:dial-multiscreen-org:service:dial:1"));
+const string Server(_T("Linux/2.6 UPnP/1.0 quick_ssdp/1.0"));
+const string USN(_T("uuid:0123456789::") + SearchTarget);
+const string Location(_T("http://127.0.0.1:80/Service/DIALServer/Apps/DeviceInfo.xml"));
+
+using Clock = std::chrono::steady_clock;
+
+struct Searcher {
+    int Socket;
+    Core::NodeId Address;
+    Clock::time_point Sent;
+    double Latency; // ms
+    uint16_t Responses;
+    bool Valid;
+};
+
+int Open(Core::NodeId& address)
+{
+    int result = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+    if (result >= 0) {
+        // All searches arrive at once, make room for them.
+        const int size = 1024 * 1024;
+        ::setsockopt(result, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+        struct sockaddr_in local {};
+        socklen_t length = sizeof(local);
+
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        local.sin_port = 0;
+
+        if ((::bind(result, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) != 0) || (::getsockname(result, reinterpret_cast<struct sockaddr*>(&local), &length) != 0)) {
+            ::close(result);
+            result = -1;
+        } else {
+            address = Core::NodeId(local);
+        }
+    }
+
+    return (result);
+}
+
+void Search(std::vector<Searcher>& searchers, const Core::NodeId& responder, const uint8_t mx)
+{
+    char request[256];
+    const int length = ::snprintf(request, sizeof(request),
+        "M-SEARCH * HTTP/1.1\r\nHOST: 239.255.255.250:1900\r\nMAN: \"ssdp:discover\"\r\nMX: %u\r\nST: %s\r\n\r\n", mx, SearchTarget.c_str());
+
+    for (Searcher& searcher : searchers) {
+        searcher.Sent = Clock::now();
+        searcher.Latency = 0;
+        searcher.Responses = 0;
+        searcher.Valid = true;
+
+        for (uint8_t repeat = 0; repeat < Repeats; repeat++) {
+            ::sendto(searcher.Socket, request, length, 0, static_cast<const struct sockaddr*>(responder), responder.Size());
+        }
+    }
+}
+
+// Reads whatever arrived at the searchers, returns the number of first responses seen.
+uint16_t Collect(std::vector<Searcher>& searchers, const string& expected)
+{
+    char buffer[1024];
+    uint16_t result = 0;
+
+    for (Searcher& searcher : searchers) {
+        ssize_t length;
+
+        while ((length = ::recv(searcher.Socket, buffer, sizeof(buffer), 0)) > 0) {
+            if (searcher.Responses++ == 0) {
+                searcher.Latency = std::chrono::duration<double, std::milli>(Clock::now() - searcher.Sent).count();
+                result++;
+            }
+            searcher.Valid = searcher.Valid && (string(buffer, length) == expected);
+        }
+    }
+
+    return (result);
+}
+
+// Receives the searches waiting at the responder, hands them to the handler as (source, mx).
+template <typename HANDLER>
+uint16_t Receive(const int socket, HANDLER&& handler)
+{
+    uint8_t buffer[1024];
+    uint16_t result = 0;
+    struct sockaddr_in source;
+    socklen_t length = sizeof(source);
+    ssize_t size;
+
+    while ((size = ::recvfrom(socket, buffer, sizeof(buffer), 0, reinterpret_cast<struct sockaddr*>(&source), &length)) > 0) {
+        handler(Core::NodeId(source), SSDPResponder::MX(buffer, static_cast<uint16_t>(size)));
+        length = sizeof(source);
+        result++;
+    }
+
+    return (result);
+}
+
+bool Wait(const int socket, const int timeout)
+{
+    struct pollfd descriptor = { socket, POLLIN, 0 };
+    return (::poll(&descriptor, 1, timeout) > 0);
+}
+
+// The way it was: every search queued, a Web::Response rendered and sent per destination and the
+// next one only after the previous went out. Every repeated search got its own response.
+double Sequential(std::vector<Searcher>& searchers, const int socket, const Core::NodeId& address, const string& expected)
+{
+    std::list<Core::NodeId> destinations;
+    uint16_t answered = 0;
+
+    Search(searchers, address, 1);
+    const Clock::time_point start = Clock::now();
+
+    while ((answered < searchers.size()) && (Wait(socket, 100) == true)) {
+        Receive(socket, [&destinations](const Core::NodeId& source, const uint8_t) { destinations.push_back(source); });
+
+        while (destinations.empty() == false) {
+            const string text(_T("HTTP/1.1 200 OK\r\n")
+                              _T("CACHE-CONTROL: max-age=1800\r\n")
+                              _T("EXT:\r\n")
+                              _T("LOCATION: ") + Location + _T("\r\n")
+                              _T("SERVER: ") + Server + _T("\r\n")
+                              _T("ST: ") + SearchTarget + _T("\r\n")
+                              _T("USN: ") + USN + _T("\r\n")
+                              _T("\r\n"));
+            struct pollfd descriptor = { socket, POLLOUT, 0 };
+
+            ::poll(&descriptor, 1, 100);
+            ::sendto(socket, text.c_str(), text.length(), 0, static_cast<const struct sockaddr*>(destinations.front()), destinations.front().Size());
+            destinations.pop_front();
+        }
+
+        answered += Collect(searchers, expected);
+    }
+
+    return (std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+}
+
+double Batched(std::vector<Searcher>& searchers, const int socket, const Core::NodeId& address, const string& expected, SSDPResponder& responder, const uint8_t mx)
+{
+    uint16_t answered = 0;
+    uint64_t due = 0;
+
+    Search(searchers, address, mx);
+    const Clock::time_point start = Clock::now();
+
+    while (answered < searchers.size()) {
+        const uint64_t now = Core::Time::Now().Ticks();
+        const int timeout = (due == 0 ? 100 : (due > now ? static_cast<int>((due - now) / Core::Time::TicksPerMillisecond) : 0));
+
+        if (Wait(socket, timeout) == true) {
+            Receive(socket, [&responder, &due](const Core::NodeId& source, const uint8_t value) {
+                due = responder.Schedule(source, SSDPResponder::NoInterface, value, Core::Time::Now().Ticks());
+            });
+        } else if (due == 0) {
+            break;
+        }
+
+        due = responder.Dispatch(socket, Core::Time::Now().Ticks());
+        answered += Collect(searchers, expected);
+    }
+
+    const double total = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Late duplicates would show up here.
+    ::usleep(20000);
+    Collect(searchers, expected);
+
+    return (total);
+}
+
+void Report(const char label[], const std::vector<Searcher>& searchers, const double total, bool& correct)
+{
+    std::vector<double> latencies;
+    uint32_t responses = 0;
+    bool valid = true;
+
+    for (const Searcher& searcher : searchers) {
+        if (searcher.Responses != 0) {
+            latencies.push_back(searcher.Latency);
+        }
+        responses += searcher.Responses;
+        valid = valid && searcher.Valid;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    if (latencies.empty() == false) {
+        printf("%-24s: %7.2f ms total, latency p50 %7.2f ms, max %7.2f ms, %u responses to %u searchers\n",
+            label, total, latencies[latencies.size() / 2], latencies.back(), responses, static_cast<uint32_t>(latencies.size()));
+    }
+
+    correct = correct && valid && (latencies.size() == searchers.size());
+}
+
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    Core::NodeId address;
+    const int socket = Open(address);
+    std::vector<Searcher> searchers(Searchers);
+    bool correct = (socket >= 0);
+
+    for (Searcher& searcher : searchers) {
+        searcher.Socket = Open(searcher.Address);
+        correct = correct && (searcher.Socket >= 0);
+    }
+
+    if (correct == false) {
+        printf("could not open the sockets on the loopback\n");
+    } else {
+        SSDPResponder responder(Server, SearchTarget, USN, MaxDelay);
+        responder.Location(SSDPResponder::NoInterface, Location);
+        const string expected(responder.Response(SSDPResponder::NoInterface));
+
+        double total = Sequential(searchers, socket, address, expected);
+        Report("one at a time", searchers, total, correct);
+
+        bool single = true;
+        for (const Searcher& searcher : searchers) {
+            single = single && (searcher.Responses == Repeats);
+        }
+
+        total = Batched(searchers, socket, address, expected, responder, 0);
+        Report("batched, no MX", searchers, total, correct);
+
+        for (const Searcher& searcher : searchers) {
+            single = single && (searcher.Responses == 1);
+        }
+
+        total = Batched(searchers, socket, address, expected, responder, 3);
+        Report("batched, MX 3 (500 ms)", searchers, total, correct);
+
+        double spread = 0;
+        for (const Searcher& searcher : searchers) {
+            single = single && (searcher.Responses == 1) && (searcher.Latency < (MaxDelay + 50));
+            spread = std::max(spread, searcher.Latency);
+        }
+
+        // Responses to the same searcher only once, spread over the window and not beyond it.
+        correct = correct && single && (spread > (MaxDelay / 2)) && (responder.Pending() == 0) && (responder.Dropped() == 0);
+
+        printf("responses               : %s\n", (correct == true ? "complete" : "MISMATCH"));
+    }
+
+    for (Searcher& searcher : searchers) {
+        if (searcher.Socket >= 0) {
+            ::close(searcher.Socket);
+        }
+    }
+    if (socket >= 0) {
+        ::close(socket);
+    }
+
+    Core::Singleton::Dispose();
+
+    return (correct == true ? 0 : 1);
+}
@@ -0,0 +1,141 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <array>
+
+namespace Thunder {
+namespace Plugin {
+
+    // Log-linear histogram of durations in us: every power of two is split in 16 linear steps, so
+    // a percentile is off by at most ~6%. Covers up to 2^32 us, more than an hour.
+    class Histogram {
+    private:
+        static constexpr uint8_t SubBucketBits = 4;
+        static constexpr uint32_t SubBuckets = (1 << SubBucketBits);
+        static constexpr uint32_t Buckets = ((32 - SubBucketBits) + 1) * SubBuckets;
+
+    public:
+        Histogram()
+            : _counts()
+            , _count(0)
+            , _minimum(~0)
+            , _maximum(0)
+            , _sum(0)
+        {
+            _counts.fill(0);
+        }
+        ~Histogram() = default;
+
+    public:
+        void Record(const uint32_t value)
+        {
+            _counts[Index(value)]++;
+            _count++;
+            _sum += value;
+            _minimum = std::min(_minimum, value);
+            _maximum = std::max(_maximum, value);
+        }
+        uint32_t Count() const
+        {
+            return (_count);
+        }
+        uint32_t Minimum() const
+        {
+            return (_count == 0 ? 0 : _minimum);
+        }
+        uint32_t Maximum() const
+        {
+            return (_maximum);
+        }
+        uint32_t Average() const
+        {
+            return (_count == 0 ? 0 : static_cast<uint32_t>(_sum / _count));
+        }
+        uint32_t Percentile(const double percentage) const
+        {
+            uint32_t result = 0;
+
+            if (_count > 0) {
+                uint64_t target = static_cast<uint64_t>((percentage / 100.0) * static_cast<double>(_count));
+                uint64_t seen = 0;
+                uint32_t index = 0;
+
+                if (target == 0) {
+                    target = 1;
+                }
+                while ((index < (Buckets - 1)) && ((seen + _counts[index]) < target)) {
+                    seen += _counts[index];
+                    index++;
+                }
+
+                result = std::max(std::min(Highest(index), _maximum), _minimum);
+            }
+
+            return (result);
+        }
+
+        // Calls the handler for every bucket holding a value, with the highest value it covers.
+        template <typename ACTION>
+        void Visit(ACTION&& action) const
+        {
+            for (uint32_t index = 0; index < Buckets; ++index) {
+                if (_counts[index] != 0) {
+                    action(Highest(index), _counts[index]);
+                }
+            }
+        }
+
+    private:
+        static uint32_t Index(const uint32_t value)
+        {
+            uint32_t result = value;
+
+            if (value >= SubBuckets) {
+                const uint8_t shift = (31 - static_cast<uint8_t>(__builtin_clz(value))) - SubBucketBits;
+                result = ((shift + 1) * SubBuckets) + ((value >> shift) - SubBuckets);
+            }
+
+            return (result);
+        }
+        static uint32_t Highest(const uint32_t index)
+        {
+            uint64_t result = index;
+
+            if (index >= SubBuckets) {
+                const uint8_t shift = static_cast<uint8_t>((index / SubBuckets) - 1);
+                result = ((static_cast<uint64_t>(SubBuckets + (index % SubBuckets)) + 1) << shift) - 1;
+            }
+
+            return (static_cast<uint32_t>(std::min(result, static_cast<uint64_t>(~static_cast<uint32_t>(0)))));
+        }
+
+    private:
+        std::array<uint32_t, Buckets> _counts;
+        uint32_t _count;
+        uint32_t _minimum;
+        uint32_t _maximum;
+        uint64_t _sum;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
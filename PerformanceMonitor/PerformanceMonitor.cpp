@@ -20,6 +20,14 @@
 #include "PerformanceMonitor.h"
 
 namespace Thunder {
+
+ENUM_CONVERSION_BEGIN(Plugin::PerformanceMonitor::mode)
+
+    { Plugin::PerformanceMonitor::mode::JSON, _TXT("json") },
+    { Plugin::PerformanceMonitor::mode::SHARED, _TXT("shared") },
+
+ENUM_CONVERSION_END(Plugin::PerformanceMonitor::mode)
+
 namespace Plugin {
 
     namespace {
@@ -45,11 +53,33 @@ namespace Plugin {
         ASSERT(service != nullptr);
         _skipURL = static_cast<uint8_t>(service->WebPrefix().length());
 
+        _maxChannels = config.Channels.Value();
+        _maxChannelSize = config.ChannelSize.Value();
+        _channelPath = service->VolatilePath();
+
+        if ((_maxChannels > 0) && (Core::Directory(_channelPath.c_str()).CreatePath() == false)) {
+            TRACE(Trace::Error, (_T("Could not create %s, no shared memory channels"), _channelPath.c_str()));
+            _maxChannels = 0;
+        }
+
         return string();
     }
 
     /* virtual */ void PerformanceMonitor::Deinitialize(PluginHost::IShell* service VARIABLE_IS_NOT_USED)
     {
+        _adminLock.Lock();
+        std::unordered_map<uint32_t, Channel> channels(std::move(_channels));
+        _channels.clear();
+        _adminLock.Unlock();
+
+        for (auto& entry : channels) {
+            const string name(entry.second->Name());
+
+            entry.second.reset();
+            Core::File(name).Destroy();
+        }
+
+        Clear();
     }
 
     /* virtual */ string PerformanceMonitor::Information() const
@@ -74,7 +104,14 @@ namespace Plugin {
     {
         uint16_t length = static_cast<uint16_t>(((data.Data.Value().length() * 6) + 7) / 8);
         uint8_t* buffer = static_cast<uint8_t*>(ALLOCA(length));
+
+        const uint64_t start = Core::Time::Now().Ticks();
         Core::FromString(data.Data.Value(), buffer, length);
+        const uint32_t duration = static_cast<uint32_t>(Core::Time::Now().Ticks() - start);
+
+        Record(mode::JSON, stage::CONVERSION, length, duration);
+        Processed(mode::JSON, length, duration);
+
         result = length;
 
         return Core::ERROR_NONE;
@@ -92,6 +129,8 @@ namespace Plugin {
         uint32_t index = 0;
         uint8_t patternIndex = 0;
 
+        const uint64_t start = Core::Time::Now().Ticks();
+
         while (index < length) {
 
             buffer[index++] = pattern[patternIndex++];
@@ -99,7 +138,13 @@ namespace Plugin {
             patternIndex %= (patternLength - 1);
         }
 
+        const uint64_t converting = Core::Time::Now().Ticks();
         Core::ToString(buffer, length, false, convertedBuffer);
+        const uint64_t end = Core::Time::Now().Ticks();
+
+        Record(mode::JSON, stage::CONVERSION, length, static_cast<uint32_t>(end - converting));
+        Processed(mode::JSON, length, static_cast<uint32_t>(end - start));
+
         data.Data = convertedBuffer;
         data.Length = static_cast<uint16_t>(convertedBuffer.length());
         data.Duration = static_cast<uint16_t>(convertedBuffer.length()) + 1; //Dummy
@@ -113,13 +158,18 @@ namespace Plugin {
 
         uint16_t length = static_cast<uint16_t>(data.Data.Value().length());
         uint8_t* buffer = static_cast<uint8_t*>(ALLOCA(length));
+
+        const uint64_t start = Core::Time::Now().Ticks();
         Core::FromString(data.Data.Value(), buffer, length);
+        uint32_t conversion = static_cast<uint32_t>(Core::Time::Now().Ticks() - start);
 
         static uint8_t pattern[] = { 0x00, 0x77, 0xCC, 0x88 };
         uint8_t patternLength = sizeof(pattern);
         uint16_t index = 0;
         uint8_t patternIndex = 0;
 
+        const uint64_t filling = Core::Time::Now().Ticks();
+
         while (index < data.Length.Value()) {
 
             buffer[index++] = pattern[patternIndex++];
@@ -127,12 +177,214 @@ namespace Plugin {
             patternIndex %= (patternLength - 1);
         }
 
+        const uint64_t converting = Core::Time::Now().Ticks();
         Core::ToString(buffer, length, false, convertedBuffer);
+        const uint64_t end = Core::Time::Now().Ticks();
+
+        conversion += static_cast<uint32_t>(end - converting);
+
+        Record(mode::JSON, stage::CONVERSION, length, conversion);
+        Processed(mode::JSON, length, conversion + static_cast<uint32_t>(converting - filling));
+
         result.Data = convertedBuffer;
         result.Length = static_cast<uint16_t>(convertedBuffer.length());
         result.Duration = static_cast<uint16_t>(convertedBuffer.length()) + 1; //Dummy
 
         return Core::ERROR_NONE;
     }
+
+    uint32_t PerformanceMonitor::Open(const uint32_t size, uint32_t& id, string& name)
+    {
+        uint32_t result = Core::ERROR_NONE;
+
+        _adminLock.Lock();
+
+        if (_channels.size() >= _maxChannels) {
+            result = Core::ERROR_UNAVAILABLE;
+        } else if ((size == 0) || (size > _maxChannelSize)) {
+            result = Core::ERROR_INVALID_RANGE;
+        } else {
+            const uint32_t channelId = ++_channelId;
+            const string fileName(_channelPath + _T("channel.") + Core::NumberType<uint32_t>(channelId).Text());
+            Core::File file(fileName);
+
+            // Created for the client (the framework may run as another user) to map it as well.
+            if (file.Create(Core::File::USER_READ | Core::File::USER_WRITE | Core::File::GROUP_READ | Core::File::GROUP_WRITE) == false) {
+                result = Core::ERROR_OPENING_FAILED;
+            } else {
+                file.Close();
+
+                Channel channel(new Core::DataElementFile(fileName, Core::File::SHAREABLE | Core::File::USER_READ | Core::File::USER_WRITE, size));
+
+                if ((channel->IsValid() == false) || (channel->Size() < size)) {
+                    channel.reset();
+                    file.Destroy();
+                    result = Core::ERROR_OPENING_FAILED;
+                } else {
+                    _channels.emplace(channelId, std::move(channel));
+                    id = channelId;
+                    name = fileName;
+
+                    TRACE(Trace::Information, (_T("Opened channel %d of %d bytes: %s"), channelId, size, fileName.c_str()));
+                }
+            }
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    uint32_t PerformanceMonitor::Close(const uint32_t id)
+    {
+        uint32_t result = Core::ERROR_UNKNOWN_KEY;
+        Channel channel;
+
+        _adminLock.Lock();
+
+        std::unordered_map<uint32_t, Channel>::iterator index(_channels.find(id));
+
+        if (index != _channels.end()) {
+            channel = std::move(index->second);
+            _channels.erase(index);
+        }
+
+        _adminLock.Unlock();
+
+        if (channel != nullptr) {
+            const string name(channel->Name());
+
+            channel.reset();
+            Core::File(name).Destroy();
+
+            result = Core::ERROR_NONE;
+        }
+
+        return (result);
+    }
+
+    uint32_t PerformanceMonitor::Transfer(const uint32_t id, const uint32_t length)
+    {
+        uint32_t result = Core::ERROR_UNKNOWN_KEY;
+        const uint64_t start = Core::Time::Now().Ticks();
+
+        _adminLock.Lock();
+
+        std::unordered_map<uint32_t, Channel>::const_iterator index(_channels.find(id));
+
+        if (index != _channels.end()) {
+            result = (length > index->second->Size() ? Core::ERROR_INVALID_RANGE : Core::ERROR_NONE);
+        }
+
+        _adminLock.Unlock();
+
+        // The payload stays in the mapping, the plugin hands it over without touching it.
+        if (result == Core::ERROR_NONE) {
+            Processed(mode::SHARED, length, static_cast<uint32_t>(Core::Time::Now().Ticks() - start));
+        }
+
+        return (result);
+    }
+
+    void PerformanceMonitor::Record(const mode type, const stage step, const uint32_t length, const uint32_t duration)
+    {
+        _adminLock.Lock();
+        _measurements[Bucket(length)].Stages[type][step].Record(duration);
+        _adminLock.Unlock();
+    }
+
+    void PerformanceMonitor::Processed(const mode type, const uint32_t length, const uint32_t duration)
+    {
+        _adminLock.Lock();
+
+        std::list<uint32_t>& pending(_processing[std::make_pair(type, Bucket(length))]);
+
+        // Calls the client never reports a round trip for should not pile up.
+        if (pending.size() >= MaxPending) {
+            pending.pop_front();
+        }
+        pending.push_back(duration);
+
+        _adminLock.Unlock();
+    }
+
+    void PerformanceMonitor::Roundtrip(const mode type, const uint32_t length, const uint32_t duration)
+    {
+        _adminLock.Lock();
+
+        Measurements& measurements(_measurements[Bucket(length)]);
+
+        measurements.Stages[type][stage::ROUNDTRIP].Record(duration);
+
+        // Reports come in the order of the calls they measure, so the oldest call of the same mode
+        // and size the plugin handled is the one this round trip belongs to. What the plugin did not
+        // spend on it, went to the transport and the framework.
+        std::map<std::pair<mode, uint32_t>, std::list<uint32_t>>::iterator index(_processing.find(std::make_pair(type, Bucket(length))));
+
+        if ((index != _processing.end()) && (index->second.empty() == false)) {
+            const uint32_t processing = index->second.front();
+            index->second.pop_front();
+
+            measurements.Stages[type][stage::TRANSFER].Record(duration > processing ? duration - processing : 0);
+        }
+
+        _adminLock.Unlock();
+    }
+
+    void PerformanceMonitor::Clear()
+    {
+        _adminLock.Lock();
+        _measurements.clear();
+        _processing.clear();
+        _adminLock.Unlock();
+    }
+
+    uint32_t PerformanceMonitor::RetrieveHistogram(const uint32_t packageSize, HistogramData& histogramData) const
+    {
+        const uint32_t bucket = Bucket(packageSize);
+
+        histogramData.Bucket = bucket;
+
+        _adminLock.Lock();
+
+        std::map<uint32_t, Measurements>::const_iterator index(_measurements.find(bucket));
+
+        if (index != _measurements.end()) {
+            const Measurements& measurements(index->second);
+
+            histogramData.Json.Conversion.Set(measurements.Stages[mode::JSON][stage::CONVERSION]);
+            histogramData.Json.Transfer.Set(measurements.Stages[mode::JSON][stage::TRANSFER]);
+            histogramData.Json.Roundtrip.Set(measurements.Stages[mode::JSON][stage::ROUNDTRIP]);
+            // Stays empty, the payload in a channel has no string form.
+            histogramData.Shared.Conversion.Set(measurements.Stages[mode::SHARED][stage::CONVERSION]);
+            histogramData.Shared.Transfer.Set(measurements.Stages[mode::SHARED][stage::TRANSFER]);
+            histogramData.Shared.Roundtrip.Set(measurements.Stages[mode::SHARED][stage::ROUNDTRIP]);
+        }
+
+        _adminLock.Unlock();
+
+        return (Core::ERROR_NONE);
+    }
+
+    void PerformanceMonitor::HistogramData::DistributionData::Set(const Histogram& histogram)
+    {
+        Count = histogram.Count();
+        Minimum = histogram.Minimum();
+        Maximum = histogram.Maximum();
+        Average = histogram.Average();
+        P50 = histogram.Percentile(50.0);
+        P90 = histogram.Percentile(90.0);
+        P99 = histogram.Percentile(99.0);
+        P999 = histogram.Percentile(99.9);
+
+        Buckets.Clear();
+
+        histogram.Visit([this](const uint32_t upper, const uint32_t count) {
+            BucketData& entry(Buckets.Add());
+            entry.Upper = upper;
+            entry.Count = count;
+        });
+    }
+
 } // namespace Plugin
 } // namespace Thunder
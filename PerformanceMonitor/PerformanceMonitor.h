@@ -20,6 +20,7 @@
 #pragma once
 
 #include "Module.h"
+#include "Histogram.h"
 
 #include <interfaces/json/JsonData_PerformanceMonitor.h>
 
@@ -27,6 +28,223 @@ namespace Thunder {
 namespace Plugin {
 
     class PerformanceMonitor : public PluginHost::IPlugin, public PluginHost::JSONRPC {
+    private:
+        class Config : public Core::JSON::Container {
+        public:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+            Config()
+                : Core::JSON::Container()
+                , Channels(4)
+                , ChannelSize(16 * 1024 * 1024)
+            {
+                Add(_T("channels"), &Channels);
+                Add(_T("channelsize"), &ChannelSize);
+            }
+            ~Config() override = default;
+
+        public:
+            Core::JSON::DecUInt8 Channels;
+            Core::JSON::DecUInt32 ChannelSize;
+        };
+
+    public:
+        // Payloads moved as JSON strings, or through a shared memory channel with only the handle in
+        // the JSON-RPC message. The difference between the two, for the same size, is what the
+        // serialization costs.
+        enum mode : uint8_t {
+            JSON,
+            SHARED
+        };
+
+        enum stage : uint8_t {
+            CONVERSION, // payload from or to its string form, in the plugin
+            TRANSFER, // the round trip minus the time the plugin spent on the call
+            ROUNDTRIP // the whole call, as measured and reported by the client
+        };
+
+        class ChannelInfo : public Core::JSON::Container {
+        public:
+            ChannelInfo(const ChannelInfo&) = delete;
+            ChannelInfo& operator=(const ChannelInfo&) = delete;
+
+            ChannelInfo()
+                : Core::JSON::Container()
+                , Channel()
+                , Name()
+                , Size()
+            {
+                Add(_T("channel"), &Channel);
+                Add(_T("name"), &Name);
+                Add(_T("size"), &Size);
+            }
+            ~ChannelInfo() override = default;
+
+        public:
+            Core::JSON::DecUInt32 Channel;
+            Core::JSON::String Name; // file to map, on the client side
+            Core::JSON::DecUInt32 Size;
+        };
+
+        class TransferInfo : public Core::JSON::Container {
+        public:
+            TransferInfo(const TransferInfo&) = delete;
+            TransferInfo& operator=(const TransferInfo&) = delete;
+
+            TransferInfo()
+                : Core::JSON::Container()
+                , Channel()
+                , Length()
+            {
+                Add(_T("channel"), &Channel);
+                Add(_T("length"), &Length);
+            }
+            ~TransferInfo() override = default;
+
+        public:
+            Core::JSON::DecUInt32 Channel;
+            Core::JSON::DecUInt32 Length;
+        };
+
+        class RoundtripInfo : public Core::JSON::Container {
+        public:
+            RoundtripInfo(const RoundtripInfo&) = delete;
+            RoundtripInfo& operator=(const RoundtripInfo&) = delete;
+
+            RoundtripInfo()
+                : Core::JSON::Container()
+                , Mode()
+                , Length()
+                , Duration()
+            {
+                Add(_T("mode"), &Mode);
+                Add(_T("length"), &Length);
+                Add(_T("duration"), &Duration);
+            }
+            ~RoundtripInfo() override = default;
+
+        public:
+            Core::JSON::EnumType<mode> Mode;
+            Core::JSON::DecUInt32 Length;
+            Core::JSON::DecUInt32 Duration; // us
+        };
+
+        class HistogramData : public Core::JSON::Container {
+        public:
+            class DistributionData : public Core::JSON::Container {
+            public:
+                class BucketData : public Core::JSON::Container {
+                public:
+                    BucketData& operator=(const BucketData&) = delete;
+
+                    BucketData()
+                        : Core::JSON::Container()
+                        , Upper()
+                        , Count()
+                    {
+                        Add(_T("upper"), &Upper);
+                        Add(_T("count"), &Count);
+                    }
+                    BucketData(const BucketData& copy)
+                        : Core::JSON::Container()
+                        , Upper(copy.Upper)
+                        , Count(copy.Count)
+                    {
+                        Add(_T("upper"), &Upper);
+                        Add(_T("count"), &Count);
+                    }
+                    ~BucketData() override = default;
+
+                public:
+                    Core::JSON::DecUInt32 Upper; // us, the highest duration in this bucket
+                    Core::JSON::DecUInt32 Count;
+                };
+
+            public:
+                DistributionData(const DistributionData&) = delete;
+                DistributionData& operator=(const DistributionData&) = delete;
+
+                DistributionData()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("minimum"), &Minimum);
+                    Add(_T("maximum"), &Maximum);
+                    Add(_T("average"), &Average);
+                    Add(_T("p50"), &P50);
+                    Add(_T("p90"), &P90);
+                    Add(_T("p99"), &P99);
+                    Add(_T("p999"), &P999);
+                    Add(_T("buckets"), &Buckets);
+                }
+                ~DistributionData() override = default;
+
+            public:
+                void Set(const Histogram& histogram);
+
+            public:
+                Core::JSON::DecUInt32 Count;
+                Core::JSON::DecUInt32 Minimum;
+                Core::JSON::DecUInt32 Maximum;
+                Core::JSON::DecUInt32 Average;
+                Core::JSON::DecUInt32 P50;
+                Core::JSON::DecUInt32 P90;
+                Core::JSON::DecUInt32 P99;
+                Core::JSON::DecUInt32 P999;
+                Core::JSON::ArrayType<BucketData> Buckets;
+            };
+
+            class ModeData : public Core::JSON::Container {
+            public:
+                ModeData(const ModeData&) = delete;
+                ModeData& operator=(const ModeData&) = delete;
+
+                ModeData()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("conversion"), &Conversion);
+                    Add(_T("transfer"), &Transfer);
+                    Add(_T("roundtrip"), &Roundtrip);
+                }
+                ~ModeData() override = default;
+
+            public:
+                DistributionData Conversion;
+                DistributionData Transfer;
+                DistributionData Roundtrip;
+            };
+
+        public:
+            HistogramData(const HistogramData&) = delete;
+            HistogramData& operator=(const HistogramData&) = delete;
+
+            HistogramData()
+                : Core::JSON::Container()
+            {
+                Add(_T("bucket"), &Bucket);
+                Add(_T("json"), &Json);
+                Add(_T("shared"), &Shared);
+            }
+            ~HistogramData() override = default;
+
+        public:
+            Core::JSON::DecUInt32 Bucket; // bytes, the package sizes from here up to twice this
+            ModeData Json;
+            ModeData Shared;
+        };
+
+    private:
+        // Per package size bucket.
+        struct Measurements {
+            Histogram Stages[2][3]; // [mode][stage]
+        };
+
+        using Channel = std::shared_ptr<Core::DataElementFile>;
+
+        // Handled calls waiting for their round trip report, per mode and package size bucket.
+        static constexpr uint8_t MaxPending = 64;
+
     public:
         PerformanceMonitor(const PerformanceMonitor&) = delete;
         PerformanceMonitor& operator=(const PerformanceMonitor&) = delete;
@@ -34,6 +252,14 @@ namespace Plugin {
     public:
         PerformanceMonitor()
             : _skipURL(0)
+            , _adminLock()
+            , _measurements()
+            , _processing()
+            , _channels()
+            , _channelPath()
+            , _maxChannels(0)
+            , _maxChannelSize(0)
+            , _channelId(0)
         {
             RegisterAll();
         }
@@ -61,13 +287,29 @@ namespace Plugin {
         uint32_t endpoint_send(const JsonData::PerformanceMonitor::BufferInfo& params, Core::JSON::DecUInt32& response);
         uint32_t endpoint_receive(const Core::JSON::DecUInt32& params, JsonData::PerformanceMonitor::BufferInfo& response);
         uint32_t endpoint_exchange(const JsonData::PerformanceMonitor::BufferInfo& params, JsonData::PerformanceMonitor::BufferInfo& response);
+        uint32_t endpoint_open(const ChannelInfo& params, ChannelInfo& response);
+        uint32_t endpoint_close(const ChannelInfo& params);
+        uint32_t endpoint_sendshared(const TransferInfo& params, Core::JSON::DecUInt32& response);
+        uint32_t endpoint_receiveshared(const TransferInfo& params, Core::JSON::DecUInt32& response);
+        uint32_t endpoint_exchangeshared(const TransferInfo& params, Core::JSON::DecUInt32& response);
+        uint32_t endpoint_roundtrip(const RoundtripInfo& params);
         uint32_t get_measurement(const string& index, JsonData::PerformanceMonitor::MeasurementData& response) const;
+        uint32_t get_histogram(const string& index, HistogramData& response) const;
 
         uint32_t RetrieveInfo(const uint32_t packageSize, JsonData::PerformanceMonitor::MeasurementData& measurementData) const;
+        uint32_t RetrieveHistogram(const uint32_t packageSize, HistogramData& histogramData) const;
         uint32_t Send(const JsonData::PerformanceMonitor::BufferInfo& data, Core::JSON::DecUInt32& result);
         uint32_t Receive(const Core::JSON::DecUInt32& maxSize, JsonData::PerformanceMonitor::BufferInfo& data);
         uint32_t Exchange(const JsonData::PerformanceMonitor::BufferInfo& data, JsonData::PerformanceMonitor::BufferInfo& result);
 
+        uint32_t Open(const uint32_t size, uint32_t& id, string& name);
+        uint32_t Close(const uint32_t id);
+        uint32_t Transfer(const uint32_t id, const uint32_t length);
+        void Processed(const mode type, const uint32_t length, const uint32_t duration);
+        void Roundtrip(const mode type, const uint32_t length, const uint32_t duration);
+        void Record(const mode type, const stage step, const uint32_t length, const uint32_t duration);
+        void Clear();
+
         inline void Measurement(const PluginHost::PerformanceAdministrator::Statistics::Tuple& statistics, JsonData::PerformanceMonitor::MeasurementData::StatisticsData& statisticsData) const {
 
             statisticsData.Minimum = statistics.Minimum();
@@ -76,8 +318,22 @@ namespace Plugin {
             statisticsData.Count = statistics.Count();
         }
 
+        // 0, 1, 2, 4, 8, ...: the highest power of two not above the size.
+        static uint32_t Bucket(const uint32_t packageSize)
+        {
+            return (packageSize == 0 ? 0 : (1u << (31 - __builtin_clz(packageSize))));
+        }
+
     private:
         uint8_t _skipURL;
+        mutable Core::CriticalSection _adminLock;
+        std::map<uint32_t, Measurements> _measurements;
+        std::map<std::pair<mode, uint32_t>, std::list<uint32_t>> _processing; // us
+        std::unordered_map<uint32_t, Channel> _channels;
+        string _channelPath;
+        uint8_t _maxChannels;
+        uint32_t _maxChannelSize;
+        uint32_t _channelId;
     };
 
 } // namespace Plugin
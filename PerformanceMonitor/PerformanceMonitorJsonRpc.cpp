@@ -34,7 +34,14 @@ namespace Plugin {
         Register<BufferInfo,Core::JSON::DecUInt32>(_T("send"), &PerformanceMonitor::endpoint_send, this);
         Register<Core::JSON::DecUInt32,BufferInfo>(_T("receive"), &PerformanceMonitor::endpoint_receive, this);
         Register<BufferInfo,BufferInfo>(_T("exchange"), &PerformanceMonitor::endpoint_exchange, this);
+        Register<ChannelInfo,ChannelInfo>(_T("open"), &PerformanceMonitor::endpoint_open, this);
+        Register<ChannelInfo,void>(_T("close"), &PerformanceMonitor::endpoint_close, this);
+        Register<TransferInfo,Core::JSON::DecUInt32>(_T("sendshared"), &PerformanceMonitor::endpoint_sendshared, this);
+        Register<TransferInfo,Core::JSON::DecUInt32>(_T("receiveshared"), &PerformanceMonitor::endpoint_receiveshared, this);
+        Register<TransferInfo,Core::JSON::DecUInt32>(_T("exchangeshared"), &PerformanceMonitor::endpoint_exchangeshared, this);
+        Register<RoundtripInfo,void>(_T("roundtrip"), &PerformanceMonitor::endpoint_roundtrip, this);
         Property<MeasurementData>(_T("measurement"), &PerformanceMonitor::get_measurement, nullptr, this);
+        Property<HistogramData>(_T("histogram"), &PerformanceMonitor::get_histogram, nullptr, this);
     }
 
     void PerformanceMonitor::UnregisterAll()
@@ -43,7 +50,14 @@ namespace Plugin {
         Unregister(_T("receive"));
         Unregister(_T("exchange"));
         Unregister(_T("clear"));
+        Unregister(_T("open"));
+        Unregister(_T("close"));
+        Unregister(_T("sendshared"));
+        Unregister(_T("receiveshared"));
+        Unregister(_T("exchangeshared"));
+        Unregister(_T("roundtrip"));
         Unregister(_T("measurement"));
+        Unregister(_T("histogram"));
     }
 
     // API implementation
@@ -55,6 +69,7 @@ namespace Plugin {
     uint32_t PerformanceMonitor::endpoint_clear()
     {
         PluginHost::PerformanceAdministrator::Instance().Clear();
+        Clear();
         return Core::ERROR_NONE;
     }
 
@@ -80,6 +95,94 @@ namespace Plugin {
         return Exchange(params, response);
     }
 
+    // Method: open - Open a shared memory channel for the *shared methods
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: All channels are in use
+    //  - ERROR_INVALID_RANGE: Size is zero or above the configured channel size
+    //  - ERROR_OPENING_FAILED: Could not create the shared memory
+    uint32_t PerformanceMonitor::endpoint_open(const ChannelInfo& params, ChannelInfo& response)
+    {
+        uint32_t channel = 0;
+        string name;
+
+        const uint32_t result = Open(params.Size.Value(), channel, name);
+
+        if (result == Core::ERROR_NONE) {
+            response.Channel = channel;
+            response.Name = name;
+            response.Size = params.Size.Value();
+        }
+
+        return (result);
+    }
+
+    // Method: close - Close a shared memory channel
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: No such channel
+    uint32_t PerformanceMonitor::endpoint_close(const ChannelInfo& params)
+    {
+        return Close(params.Channel.Value());
+    }
+
+    // Method: sendshared - Interface to test sending data, through a shared memory channel
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: No such channel
+    //  - ERROR_INVALID_RANGE: Length is above the size of the channel
+    uint32_t PerformanceMonitor::endpoint_sendshared(const TransferInfo& params, Core::JSON::DecUInt32& response)
+    {
+        const uint32_t result = Transfer(params.Channel.Value(), params.Length.Value());
+
+        if (result == Core::ERROR_NONE) {
+            response = params.Length.Value();
+        }
+
+        return (result);
+    }
+
+    // Method: receiveshared - Interface to test receiving data, through a shared memory channel
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: No such channel
+    //  - ERROR_INVALID_RANGE: Length is above the size of the channel
+    uint32_t PerformanceMonitor::endpoint_receiveshared(const TransferInfo& params, Core::JSON::DecUInt32& response)
+    {
+        const uint32_t result = Transfer(params.Channel.Value(), params.Length.Value());
+
+        if (result == Core::ERROR_NONE) {
+            response = params.Length.Value();
+        }
+
+        return (result);
+    }
+
+    // Method: exchangeshared - Interface to test exchanging data, through a shared memory channel
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: No such channel
+    //  - ERROR_INVALID_RANGE: Length is above the size of the channel
+    uint32_t PerformanceMonitor::endpoint_exchangeshared(const TransferInfo& params, Core::JSON::DecUInt32& response)
+    {
+        const uint32_t result = Transfer(params.Channel.Value(), params.Length.Value());
+
+        if (result == Core::ERROR_NONE) {
+            response = params.Length.Value();
+        }
+
+        return (result);
+    }
+
+    // Method: roundtrip - Report the duration of a call, as measured by the client
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t PerformanceMonitor::endpoint_roundtrip(const RoundtripInfo& params)
+    {
+        Roundtrip(params.Mode.Value(), params.Length.Value(), params.Duration.Value());
+        return Core::ERROR_NONE;
+    }
+
     // Property: measurement - Retrieve the performance measurement against given package size
     // Return codes:
     //  - ERROR_NONE: Success
@@ -89,6 +192,15 @@ namespace Plugin {
         return RetrieveInfo(packageSize, response);
     }
 
+    // Property: histogram - Retrieve the duration histograms for the package size bucket of the given size
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t PerformanceMonitor::get_histogram(const string& index, HistogramData& response) const
+    {
+        const uint32_t packageSize = atoi(index.c_str());
+        return RetrieveHistogram(packageSize, response);
+    }
+
 } // namespace Plugin
 }
 
@@ -40,6 +40,7 @@ namespace Plugin {
 
     static Core::ProxyPoolType<Web::JSONBodyType<Power::Data>> jsonBodyDataFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Power::Data>> jsonResponseFactory(4);
+    static Core::ProxyPoolType<Web::JSONBodyType<Power::Timeline>> jsonTimelineFactory(1);
 
     extern "C" {
 
@@ -65,6 +66,16 @@ namespace Plugin {
         _powerKey = config.PowerKey.Value();
         _powerOffMode = config.OffMode.Value();
         _controlClients = config.ControlClients.Value();
+        _deadline = config.Deadline.Value();
+
+        Core::JSON::ArrayType<Config::ClientDeadline>::ConstIterator deadlines(config.Deadlines.Elements());
+
+        while (deadlines.Next() == true) {
+            _deadlines[deadlines.Current().Callsign.Value()] = deadlines.Current().Time.Value();
+        }
+
+        _transition = new Transition(config.Workers.Value(), config.History.Value());
+
         if (_powerKey != KEY_RESERVED) {
             PluginHost::VirtualInput* keyHandler(PluginHost::InputHandler::Handler());
 
@@ -106,13 +117,29 @@ namespace Plugin {
             }
 
             power_deinitialize();
+
+            _adminLock.Lock();
+            _notificationClients.clear();
+            _adminLock.Unlock();
+
+            delete _transition;
+            _transition = nullptr;
+            _deadlines.clear();
         }
     }
 
     /* virtual */ string Power::Information() const
     {
-        // No additional info to report.
-        return (string());
+        Timeline timeline;
+        string result;
+
+        // Asked for before Initialize or after Deinitialize, there is no timeline then.
+        if (_transition != nullptr) {
+            timeline.Set(_transition->History());
+            timeline.ToString(result);
+        }
+
+        return (result);
     }
 
     /* virtual */ void Power::Inbound(Web::Request& request)
@@ -144,6 +171,13 @@ namespace Plugin {
                 } else {
                     result->Message = "Invalid State";
                 }
+            } else if (index.Remainder() == _T("Timeline")) {
+                Core::ProxyType<Web::JSONBodyType<Timeline>> response(jsonTimelineFactory.Element());
+                if (_transition != nullptr) {
+                    response->Set(_transition->History());
+                }
+                result->ContentType = Web::MIMETypes::MIME_JSON;
+                result->Body(Core::ProxyType<Web::IBody>(response));
             } else {
                 result->ErrorCode = Web::STATUS_BAD_REQUEST;
                 result->Message = "Unknown error";
@@ -179,12 +213,12 @@ namespace Plugin {
         _adminLock.Lock();
 
         // Make sure a sink is not registered multiple times.
-        std::list<Exchange::IPower::INotification*>::iterator index(std::find(_notificationClients.begin(), _notificationClients.end(), sink));
+        Notifiers::iterator index(std::find_if(_notificationClients.begin(), _notificationClients.end(),
+            [sink](const std::shared_ptr<Notifier>& entry) { return (entry->IsSink(sink)); }));
         ASSERT(index == _notificationClients.end());
 
         if (index == _notificationClients.end()) {
-            _notificationClients.push_back(sink);
-            sink->AddRef();
+            _notificationClients.push_back(std::make_shared<Notifier>(++_notifiers, sink));
             TRACE(Trace::Information, (_T("Registered a sink on the power")));
 
             result = Core::ERROR_NONE;
@@ -203,13 +237,14 @@ namespace Plugin {
 
         _adminLock.Lock();
 
-        std::list<Exchange::IPower::INotification*>::iterator index(std::find(_notificationClients.begin(), _notificationClients.end(), sink));
+        Notifiers::iterator index(std::find_if(_notificationClients.begin(), _notificationClients.end(),
+            [sink](const std::shared_ptr<Notifier>& entry) { return (entry->IsSink(sink)); }));
 
         // Make sure you do not unregister something you did not register !!!
         ASSERT(index != _notificationClients.end());
 
         if (index != _notificationClients.end()) {
-            (*index)->Release();
+            // A transition still busy with it, holds on to it until it is done.
             _notificationClients.erase(index);
             TRACE(Trace::Information, (_T("Unregistered a sink on the power")));
 
@@ -256,17 +291,19 @@ namespace Plugin {
             ControlClients(state);
         }
 
-        _adminLock.Lock();
+        Transition::Clients clients;
 
-        std::list<Exchange::IPower::INotification*>::iterator index(_notificationClients.begin());
+        _adminLock.Lock();
 
-        while (index != _notificationClients.end()) {
-            (*index)->StateChange(_currentState, state, phase);
-            index++;
+        for (const auto& sink : _notificationClients) {
+            clients.emplace_back(sink, _deadline);
         }
 
         _adminLock.Unlock();
 
+        // All sinks at the same time, the platform continues once they are all done or late.
+        _transition->Run(_T("notify"), _currentState, state, phase, clients);
+
         Exchange::JPower::Event::StateChange(*this, _currentState, state, phase);
 
         if (Exchange::IPower::After == phase) {
@@ -307,9 +344,7 @@ namespace Plugin {
             ASSERT (index == _clients.end());
 
             if (index == _clients.end()) {
-                _clients.emplace(std::piecewise_construct,
-                    std::forward_as_tuple(callsign),
-                    std::forward_as_tuple(stateControl));
+                _clients.emplace(callsign, std::make_shared<Entry>(callsign, stateControl));
                 TRACE(Trace::Information, (_T("%s plugin is add to power control list"), callsign.c_str()));
             }
 
@@ -335,26 +370,28 @@ namespace Plugin {
     void Power::ControlClients(Exchange::IPower::PCState state)
     {
         if ((_controlClients) && (is_power_state_supported(state))) {
-            Clients::iterator client(_clients.begin());
+            Transition::Clients clients;
+
+            _adminLock.Lock();
+
+            for (const auto& client : _clients) {
+                clients.emplace_back(client.second, Deadline(client.first));
+            }
+
+            _adminLock.Unlock();
 
             switch (state) {
                 case Exchange::IPower::PCState::On:
-                    TRACE(Trace::Information, (_T("Change state to RESUME for")));
-                    while (client != _clients.end()) {
-                        client->second.Resume();
-                        client++;
-                    }
-                    //Nothing to be done
+                    TRACE(Trace::Information, (_T("Change state to RESUME for %d clients"), static_cast<uint32_t>(clients.size())));
+                    _transition->Run(_T("resume"), _currentState, state, Exchange::IPower::After, clients);
                     break;
                 case Exchange::IPower::PCState::ActiveStandby:
                 case Exchange::IPower::PCState::PassiveStandby:
                 case Exchange::IPower::PCState::SuspendToRAM:
                 case Exchange::IPower::PCState::Hibernate:
                 case Exchange::IPower::PCState::PowerOff:
-                    while (client != _clients.end()) {
-                        client->second.Suspend();
-                        client++;
-                    }
+                    TRACE(Trace::Information, (_T("Change state to SUSPEND for %d clients"), static_cast<uint32_t>(clients.size())));
+                    _transition->Run(_T("suspend"), _currentState, state, Exchange::IPower::Before, clients);
                     break;
                 default:
                     ASSERT(false);
@@ -362,6 +399,40 @@ namespace Plugin {
             }
         }
     }
+    uint32_t Power::Deadline(const string& callsign) const
+    {
+        std::unordered_map<string, uint32_t>::const_iterator index(_deadlines.find(callsign));
+
+        return (index != _deadlines.end() ? index->second : _deadline);
+    }
+
+    void Power::Timeline::Set(const Transition::Timeline& timeline)
+    {
+        Stages.Clear();
+
+        for (const Transition::Record& record : timeline) {
+            Stage& stage(Stages.Add());
+
+            stage.Name = record.Stage;
+            stage.From = record.From;
+            stage.To = record.To;
+            stage.Phase = record.Phase;
+            stage.Time = Core::Time(record.Time).ToISO8601(true);
+            stage.Duration = record.Duration;
+
+            for (const Transition::Step& step : record.Steps) {
+                Client& client(stage.Clients.Add());
+
+                client.Name = step.Name;
+                client.Start = step.Start;
+                if (step.Done == true) {
+                    client.Duration = step.Duration;
+                    client.Result = step.Result;
+                }
+                client.Expired = step.Expired;
+            }
+        }
+    }
 
 } //namespace Plugin
 } // namespace Thunder
@@ -21,6 +21,7 @@
 #define __POWER_H
 
 #include "Module.h"
+#include "Transition.h"
 #include <interfaces/IPower.h>
 #include <interfaces/json/JPower.h>
 
@@ -77,51 +78,140 @@ namespace Plugin {
             Power& _parent;
         };
 
-        class Entry {
+        class Entry : public Transition::IClient {
         private:
             Entry() = delete;
             Entry(const Entry& copy) = delete;
             Entry& operator=(const Entry&) = delete;
 
         public:
-            Entry(PluginHost::IStateControl* entry)
-                : _shell(entry)
+            Entry(const string& callsign, PluginHost::IStateControl* entry)
+                : _callsign(callsign)
+                , _shell(entry)
+                , _lock()
                 , _lastStateResumed(false)
             {
                 ASSERT(_shell != nullptr);
                 _shell->AddRef();
             }
-            ~Entry()
+            ~Entry() override
             {
                 _shell->Release();
             }
 
         public:
-            bool Suspend()
+            const string& Name() const override
             {
-                bool succeeded(true);
+                return (_callsign);
+            }
+            uint32_t Change(const Exchange::IPower::PCState, const Exchange::IPower::PCState to, const Exchange::IPower::PCPhase) override
+            {
+                // A Suspend that is late can still be running on one worker when the Resume is picked
+                // up by another, they take turns.
+                Core::SafeSyncType<Core::CriticalSection> scopedLock(_lock);
+
+                return (to == Exchange::IPower::PCState::On ? Resume() : Suspend());
+            }
+            uint32_t Suspend()
+            {
+                uint32_t result(Core::ERROR_NONE);
                 if (_shell->State() == PluginHost::IStateControl::RESUMED) {
                     _lastStateResumed = true;
-                    succeeded = (_shell->Request(PluginHost::IStateControl::SUSPEND) == Core::ERROR_NONE);
+                    result = _shell->Request(PluginHost::IStateControl::SUSPEND);
                 }
-                return (succeeded);
+                return (result);
             }
-            bool Resume()
+            uint32_t Resume()
             {
-                bool succeeded(true);
+                uint32_t result(Core::ERROR_NONE);
                 if (_lastStateResumed == true) {
                     _lastStateResumed = false;
-                    succeeded = (_shell->Request(PluginHost::IStateControl::RESUME) == Core::ERROR_NONE);
+                    result = _shell->Request(PluginHost::IStateControl::RESUME);
                 }
-                return (succeeded);
+                return (result);
             }
 
-        public:
+        private:
+            const string _callsign;
             PluginHost::IStateControl* _shell;
+            Core::CriticalSection _lock;
             bool _lastStateResumed;
         };
 
+        // An IPower::INotification sink, told about the change as one of the clients of a transition.
+        class Notifier : public Transition::IClient {
+        private:
+            Notifier() = delete;
+            Notifier(const Notifier& copy) = delete;
+            Notifier& operator=(const Notifier&) = delete;
+
+        public:
+            Notifier(const uint32_t id, Exchange::IPower::INotification* sink)
+                : _name(Core::Format(_T("notification %u"), id))
+                , _sink(sink)
+            {
+                ASSERT(_sink != nullptr);
+                _sink->AddRef();
+            }
+            ~Notifier() override
+            {
+                _sink->Release();
+            }
+
+        public:
+            const string& Name() const override
+            {
+                return (_name);
+            }
+            uint32_t Change(const Exchange::IPower::PCState from, const Exchange::IPower::PCState to, const Exchange::IPower::PCPhase phase) override
+            {
+                _sink->StateChange(from, to, phase);
+                return (Core::ERROR_NONE);
+            }
+            bool IsSink(const Exchange::IPower::INotification* sink) const
+            {
+                return (_sink == sink);
+            }
+
+        private:
+            const string _name;
+            Exchange::IPower::INotification* _sink;
+        };
+
         class Config : public Core::JSON::Container {
+        public:
+            // Callsigns that are known to need more (or less) time for a power change.
+            class ClientDeadline : public Core::JSON::Container {
+            public:
+                ClientDeadline()
+                    : Core::JSON::Container()
+                    , Callsign()
+                    , Time(0)
+                {
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("deadline"), &Time);
+                }
+                ClientDeadline(const ClientDeadline& copy)
+                    : Core::JSON::Container()
+                    , Callsign(copy.Callsign)
+                    , Time(copy.Time)
+                {
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("deadline"), &Time);
+                }
+                ClientDeadline& operator=(const ClientDeadline& RHS)
+                {
+                    Callsign = RHS.Callsign;
+                    Time = RHS.Time;
+                    return (*this);
+                }
+                ~ClientDeadline() override = default;
+
+            public:
+                Core::JSON::String Callsign;
+                Core::JSON::DecUInt32 Time;
+            };
+
         private:
             Config(const Config&);
             Config& operator=(const Config&);
@@ -132,10 +222,18 @@ namespace Plugin {
                 , PowerKey(0)
                 , OffMode(Exchange::IPower::PCState::SuspendToRAM)
                 , ControlClients(true)
+                , Deadline(2000)
+                , Deadlines()
+                , Workers(4)
+                , History(16)
             {
                 Add(_T("powerkey"), &PowerKey);
                 Add(_T("offmode"), &OffMode);
                 Add(_T("controlclients"), &ControlClients);
+                Add(_T("deadline"), &Deadline);
+                Add(_T("deadlines"), &Deadlines);
+                Add(_T("workers"), &Workers);
+                Add(_T("history"), &History);
             }
             ~Config()
             {
@@ -145,9 +243,14 @@ namespace Plugin {
             Core::JSON::DecUInt32 PowerKey;
             Core::JSON::EnumType<Exchange::IPower::PCState> OffMode;
             Core::JSON::Boolean ControlClients;
+            Core::JSON::DecUInt32 Deadline; // ms a client gets to complete a power change
+            Core::JSON::ArrayType<ClientDeadline> Deadlines;
+            Core::JSON::DecUInt8 Workers; // clients that are changed at the same time
+            Core::JSON::DecUInt8 History; // transitions kept in the timeline
         };
 
-        typedef std::map<const string, Entry> Clients;
+        typedef std::map<const string, std::shared_ptr<Entry>> Clients;
+        typedef std::list<std::shared_ptr<Notifier>> Notifiers;
 
     public:
         class Data : public Core::JSON::Container {
@@ -176,6 +279,122 @@ namespace Plugin {
             Core::JSON::DecUInt32 Timeout;
         };
 
+        // The last power transitions, with how long every client took, durations in us.
+        class Timeline : public Core::JSON::Container {
+        public:
+            class Client : public Core::JSON::Container {
+            public:
+                Client& operator=(const Client&) = delete;
+
+                Client()
+                    : Core::JSON::Container()
+                    , Name()
+                    , Start(0)
+                    , Duration(0)
+                    , Result(0)
+                    , Expired(false)
+                {
+                    Add(_T("name"), &Name);
+                    Add(_T("start"), &Start);
+                    Add(_T("duration"), &Duration);
+                    Add(_T("result"), &Result);
+                    Add(_T("expired"), &Expired);
+                }
+                Client(const Client& copy)
+                    : Core::JSON::Container()
+                    , Name(copy.Name)
+                    , Start(copy.Start)
+                    , Duration(copy.Duration)
+                    , Result(copy.Result)
+                    , Expired(copy.Expired)
+                {
+                    Add(_T("name"), &Name);
+                    Add(_T("start"), &Start);
+                    Add(_T("duration"), &Duration);
+                    Add(_T("result"), &Result);
+                    Add(_T("expired"), &Expired);
+                }
+                ~Client() override = default;
+
+            public:
+                Core::JSON::String Name;
+                Core::JSON::DecUInt64 Start; // after the start of the transition
+                Core::JSON::DecUInt64 Duration; // not set while it did not return
+                Core::JSON::DecUInt32 Result;
+                Core::JSON::Boolean Expired;
+            };
+
+            class Stage : public Core::JSON::Container {
+            public:
+                Stage& operator=(const Stage&) = delete;
+
+                Stage()
+                    : Core::JSON::Container()
+                    , Name()
+                    , From()
+                    , To()
+                    , Phase()
+                    , Time()
+                    , Duration(0)
+                    , Clients()
+                {
+                    Init();
+                }
+                Stage(const Stage& copy)
+                    : Core::JSON::Container()
+                    , Name(copy.Name)
+                    , From(copy.From)
+                    , To(copy.To)
+                    , Phase(copy.Phase)
+                    , Time(copy.Time)
+                    , Duration(copy.Duration)
+                    , Clients(copy.Clients)
+                {
+                    Init();
+                }
+                ~Stage() override = default;
+
+            private:
+                void Init()
+                {
+                    Add(_T("stage"), &Name);
+                    Add(_T("from"), &From);
+                    Add(_T("to"), &To);
+                    Add(_T("phase"), &Phase);
+                    Add(_T("time"), &Time);
+                    Add(_T("duration"), &Duration);
+                    Add(_T("clients"), &Clients);
+                }
+
+            public:
+                Core::JSON::String Name;
+                Core::JSON::EnumType<Exchange::IPower::PCState> From;
+                Core::JSON::EnumType<Exchange::IPower::PCState> To;
+                Core::JSON::EnumType<Exchange::IPower::PCPhase> Phase;
+                Core::JSON::String Time;
+                Core::JSON::DecUInt64 Duration;
+                Core::JSON::ArrayType<Client> Clients;
+            };
+
+        public:
+            Timeline(const Timeline&) = delete;
+            Timeline& operator=(const Timeline&) = delete;
+
+            Timeline()
+                : Core::JSON::Container()
+                , Stages()
+            {
+                Add(_T("transitions"), &Stages);
+            }
+            ~Timeline() override = default;
+
+        public:
+            void Set(const Transition::Timeline& timeline);
+
+        public:
+            Core::JSON::ArrayType<Stage> Stages;
+        };
+
     public:
         Power(const Power&) = delete;
         Power& operator=(const Power&) = delete;
@@ -187,6 +406,10 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
             , _clients()
             , _sink(this)
             , _notificationClients()
+            , _notifiers(0)
+            , _transition(nullptr)
+            , _deadline(0)
+            , _deadlines()
             , _powerKey(0)
             , _controlClients(true)
             , _powerOffMode(Exchange::IPower::PCState::SuspendToRAM)
@@ -247,13 +470,18 @@ POP_WARNING()
         void Activated(const string& callsign, PluginHost::IShell* plugin);
         void Deactivated(const string& callsign, PluginHost::IShell* plugin);
         void ControlClients(Exchange::IPower::PCState state);
+        uint32_t Deadline(const string& callsign) const;
 
     private:
         Core::CriticalSection _adminLock;
         uint32_t _skipURL;
         Clients _clients;
         Core::SinkType<Notification> _sink;
-        std::list<Exchange::IPower::INotification*> _notificationClients;
+        Notifiers _notificationClients;
+        uint32_t _notifiers;
+        Transition* _transition;
+        uint32_t _deadline;
+        std::unordered_map<string, uint32_t> _deadlines;
         uint32_t _powerKey;
         bool _controlClients;
         Exchange::IPower::PCState _powerOffMode;
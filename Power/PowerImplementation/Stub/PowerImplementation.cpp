@@ -19,16 +19,26 @@
  
 #include "../../Implementation.h"
 
+/* =============================================================================================
+   NO PLATFORM BEHIND IT: A STATE CHANGE TAKES EFFECT AT ONCE, WITH THE BEFORE AND AFTER
+   NOTIFICATIONS A PLATFORM WOULD GIVE, SO THE PLUGIN AND ITS CLIENTS RUN WITHOUT ONE.
+   ============================================================================================ */
+
 namespace {
 
 static void*              _userData = nullptr;
 static power_state_change _callback = nullptr;
 static Thunder::Exchange::IPower::PCState _state    = Thunder::Exchange::IPower::PCState::On;
 
-void power_initialize(power_state_change callback, void* userData, const char*) {
+}
+
+void power_initialize(power_state_change callback, void* userData, const char*,
+        const enum Thunder::Exchange::IPower::PCState)
+{
     ASSERT ((_callback != nullptr) ^ (callback != nullptr));
     _userData = userData;
     _callback = callback;
+    _state = Thunder::Exchange::IPower::PCState::On;
 }
 
 void power_deinitialize() {
@@ -36,10 +46,13 @@ void power_deinitialize() {
     _userData = nullptr;
 }
 
-uint32_t power_set_state(const enum Thunder::Exchange::IPower::PCState state, const uint32_t sleepTime) {
+uint32_t power_set_state(const enum Thunder::Exchange::IPower::PCState state, const uint32_t) {
+    if (_callback != nullptr) {
+        _callback(_userData, state, Thunder::Exchange::IPower::Before);
+    }
     _state = state;
     if (_callback != nullptr) {
-        _callback(_userData, state);
+        _callback(_userData, state, Thunder::Exchange::IPower::After);
     }
     return (Thunder::Core::ERROR_NONE);
 }
@@ -48,5 +61,6 @@ Thunder::Exchange::IPower::PCState power_get_state() {
     return (_state);
 }
 
+bool is_power_state_supported(const enum Thunder::Exchange::IPower::PCState) {
+    return (true);
 }
-
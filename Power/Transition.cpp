@@ -0,0 +1,207 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Transition.h"
+
+namespace Thunder {
+namespace Plugin {
+
+    Transition::Transition(const uint8_t workers, const uint8_t history)
+        : _adminLock()
+        , _queue()
+        , _workers()
+        , _waiters()
+        , _history()
+        , _depth(std::max(history, static_cast<uint8_t>(1)))
+        , _sequence(0)
+    {
+        const uint8_t count = std::max(workers, static_cast<uint8_t>(1));
+
+        for (uint8_t index = 0; index < count; ++index) {
+            _workers.emplace_back(new Runner(*this));
+        }
+    }
+
+    Transition::~Transition()
+    {
+        _adminLock.Lock();
+
+        _queue.clear();
+
+        // All at once, so a teardown waits for the slowest client only.
+        for (auto& worker : _workers) {
+            worker->Stop();
+        }
+
+        _adminLock.Unlock();
+
+        // A worker still in a client finishes that before it stops. A client can not be cancelled and
+        // the worker runs code of this library, so it is waited for, however long that takes.
+        _workers.clear();
+    }
+
+    uint32_t Transition::Run(const TCHAR stage[], const Exchange::IPower::PCState from, const Exchange::IPower::PCState to, const Exchange::IPower::PCPhase phase, const Clients& clients)
+    {
+        uint32_t result = Core::ERROR_NONE;
+
+        if (clients.empty() == false) {
+            const uint64_t start = Core::Time::Now().Ticks();
+            std::vector<uint64_t> deadlines;
+            uint64_t until = start;
+            Waiter waiter(static_cast<uint32_t>(clients.size()));
+
+            _adminLock.Lock();
+
+            const uint32_t id = ++_sequence;
+
+            _history.push_back({ id, stage, from, to, phase, start, 0, {} });
+
+            if (_history.size() > _depth) {
+                _history.pop_front();
+            }
+
+            Record& record(_history.back());
+
+            for (const auto& client : clients) {
+                const uint64_t deadline = start + (static_cast<uint64_t>(client.second) * Core::Time::TicksPerMillisecond);
+
+                record.Steps.push_back({ client.first->Name(), 0, 0, Core::ERROR_TIMEDOUT, false, false });
+                _queue.push_back({ client.first, id, static_cast<uint32_t>(deadlines.size()), from, to, phase });
+                deadlines.push_back(deadline);
+
+                until = std::max(until, deadline);
+            }
+
+            _waiters.emplace(id, &waiter);
+
+            for (auto& worker : _workers) {
+                worker->Run();
+            }
+
+            _adminLock.Unlock();
+
+            // All at once, so the one with the latest deadline is the longest to wait for.
+            const uint64_t now = Core::Time::Now().Ticks();
+
+            if (now < until) {
+                waiter.Signal.Lock(static_cast<uint32_t>(((until - now) + Core::Time::TicksPerMillisecond - 1) / Core::Time::TicksPerMillisecond));
+            }
+
+            _adminLock.Lock();
+
+            _waiters.erase(id);
+
+            // Whatever did not start yet, is not going to be on time anymore.
+            _queue.remove_if([id](const Task& task) { return (task.Id == id); });
+
+            Record* entry = Find(id);
+
+            if (entry != nullptr) {
+                uint32_t index = 0;
+
+                entry->Duration = Core::Time::Now().Ticks() - start;
+
+                for (Step& step : entry->Steps) {
+                    step.Expired = (step.Done == false) || ((start + step.Start + step.Duration) > deadlines[index]);
+
+                    if (step.Expired == true) {
+                        TRACE(Trace::Warning, (_T("%s did not complete the %s stage within %d ms"), step.Name.c_str(), stage, static_cast<uint32_t>((deadlines[index] - start) / Core::Time::TicksPerMillisecond)));
+                        result = Core::ERROR_TIMEDOUT;
+                    } else if ((step.Result != Core::ERROR_NONE) && (result == Core::ERROR_NONE)) {
+                        result = step.Result;
+                    }
+
+                    index++;
+                }
+
+                TRACE(Trace::Information, (_T("Power %s stage for %d clients took %d ms"), stage, static_cast<uint32_t>(entry->Steps.size()), static_cast<uint32_t>(entry->Duration / Core::Time::TicksPerMillisecond)));
+            }
+
+            _adminLock.Unlock();
+        }
+
+        return (result);
+    }
+
+    uint32_t Transition::Process(Runner& runner)
+    {
+        uint32_t delay = 0;
+
+        _adminLock.Lock();
+
+        if (_queue.empty() == true) {
+            // Blocked under the lock, so a Run that queues work after this, wakes it up again.
+            runner.Block();
+            delay = Core::infinite;
+
+            _adminLock.Unlock();
+        } else {
+            Task task(std::move(_queue.front()));
+            _queue.pop_front();
+
+            Record* record = Find(task.Id);
+
+            if (record != nullptr) {
+                record->Steps[task.Index].Start = Core::Time::Now().Ticks() - record->Time;
+            }
+
+            _adminLock.Unlock();
+
+            const uint64_t begin = Core::Time::Now().Ticks();
+            const uint32_t result = task.Subject->Change(task.From, task.To, task.Phase);
+            const uint64_t end = Core::Time::Now().Ticks();
+
+            _adminLock.Lock();
+
+            // Also when it is late, the timeline should show how late.
+            record = Find(task.Id);
+
+            if (record != nullptr) {
+                Step& step(record->Steps[task.Index]);
+
+                step.Duration = end - begin;
+                step.Result = result;
+                step.Done = true;
+            }
+
+            std::unordered_map<uint32_t, Waiter*>::iterator index(_waiters.find(task.Id));
+
+            if ((index != _waiters.end()) && (--(index->second->Pending) == 0)) {
+                index->second->Signal.SetEvent();
+            }
+
+            _adminLock.Unlock();
+        }
+
+        return (delay);
+    }
+
+    Transition::Record* Transition::Find(const uint32_t id)
+    {
+        Timeline::reverse_iterator index(_history.rbegin());
+
+        while ((index != _history.rend()) && (index->Id != id)) {
+            index++;
+        }
+
+        return (index != _history.rend() ? &(*index) : nullptr);
+    }
+
+} // namespace Plugin
+} // namespace Thunder
@@ -0,0 +1,164 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include <interfaces/IPower.h>
+
+#include <memory>
+
+namespace Thunder {
+namespace Plugin {
+
+    // Takes the clients of the Power plugin through a power state change, all at the same time on
+    // a set of workers, and waits until every one of them is done or its deadline has passed. How
+    // long each client took is kept for the last transitions, so it shows which client is holding
+    // up a suspend or a resume. A client that is still busy when its deadline passes is left to
+    // finish on its worker, its duration is filled in once it does. Tearing it down waits for all
+    // workers to be out of their client.
+    class Transition {
+    public:
+        struct IClient {
+            virtual ~IClient() = default;
+
+            virtual const string& Name() const = 0;
+
+            // Called on a worker, returns when the client is done with the change.
+            virtual uint32_t Change(const Exchange::IPower::PCState from, const Exchange::IPower::PCState to, const Exchange::IPower::PCPhase phase) = 0;
+        };
+
+        using Client = std::shared_ptr<IClient>;
+        using Clients = std::vector<std::pair<Client, uint32_t>>; // with its deadline, in ms
+
+        struct Step {
+            string Name;
+            uint64_t Start; // us after the start of the transition, when a worker picked it up
+            uint64_t Duration; // us
+            uint32_t Result;
+            bool Done;
+            bool Expired; // not done within its deadline
+        };
+
+        struct Record {
+            uint32_t Id;
+            string Stage;
+            Exchange::IPower::PCState From;
+            Exchange::IPower::PCState To;
+            Exchange::IPower::PCPhase Phase;
+            uint64_t Time; // ticks, when it started
+            uint64_t Duration; // us, until the last client was done or given up on
+            std::vector<Step> Steps;
+        };
+
+        using Timeline = std::list<Record>;
+
+    private:
+        struct Task {
+            Client Subject;
+            uint32_t Id;
+            uint32_t Index;
+            Exchange::IPower::PCState From;
+            Exchange::IPower::PCState To;
+            Exchange::IPower::PCPhase Phase;
+        };
+
+        class Runner : public Core::Thread {
+        public:
+            Runner() = delete;
+            Runner(const Runner&) = delete;
+            Runner& operator=(const Runner&) = delete;
+
+            explicit Runner(Transition& parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("PowerTransition"))
+                , _parent(parent)
+            {
+            }
+            ~Runner() override
+            {
+                Stop();
+                Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+            }
+
+        private:
+            uint32_t Worker() override
+            {
+                return (_parent.Process(*this));
+            }
+
+        private:
+            Transition& _parent;
+        };
+
+        // The one waiting for a transition to complete.
+        struct Waiter {
+            Waiter() = delete;
+            Waiter(const Waiter&) = delete;
+            Waiter& operator=(const Waiter&) = delete;
+
+            explicit Waiter(const uint32_t pending)
+                : Signal(false, true)
+                , Pending(pending)
+            {
+            }
+
+            Core::Event Signal;
+            uint32_t Pending;
+        };
+
+    public:
+        Transition() = delete;
+        Transition(Transition&&) = delete;
+        Transition(const Transition&) = delete;
+        Transition& operator=(Transition&&) = delete;
+        Transition& operator=(const Transition&) = delete;
+
+        Transition(const uint8_t workers, const uint8_t history);
+        ~Transition();
+
+    public:
+        // Returns Core::ERROR_TIMEDOUT if a client missed its deadline, otherwise the first error
+        // a client reported, if any.
+        uint32_t Run(const TCHAR stage[], const Exchange::IPower::PCState from, const Exchange::IPower::PCState to, const Exchange::IPower::PCPhase phase, const Clients& clients);
+
+        Timeline History() const
+        {
+            _adminLock.Lock();
+            Timeline result(_history);
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+    private:
+        uint32_t Process(Runner& runner);
+        Record* Find(const uint32_t id);
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        std::list<Task> _queue;
+        std::vector<std::unique_ptr<Runner>> _workers;
+        std::unordered_map<uint32_t, Waiter*> _waiters;
+        Timeline _history;
+        const uint8_t _depth;
+        uint32_t _sequence;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
@@ -0,0 +1,203 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Power transitions with fake clients that take a known time to suspend or resume: they should
+// run side by side, a slow one should not hold up the rest beyond its deadline and still show
+// up in the timeline once it is done. The last part goes through the Stub platform, as the
+// plugin does, with the clients notified before and after the change.
+
+#include "Module.h"
+#include "Transition.h"
+#include "Implementation.h"
+
+#include <atomic>
+#include <cstdio>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace Thunder;
+
+namespace {
+
+class Fake : public Plugin::Transition::IClient {
+public:
+    Fake() = delete;
+    Fake(const Fake&) = delete;
+    Fake& operator=(const Fake&) = delete;
+
+    Fake(const string& name, const uint32_t duration, const uint32_t result = Core::ERROR_NONE)
+        : _name(name)
+        , _duration(duration)
+        , _result(result)
+        , _changes(0)
+    {
+    }
+    ~Fake() override = default;
+
+public:
+    const string& Name() const override
+    {
+        return (_name);
+    }
+    uint32_t Change(const Exchange::IPower::PCState, const Exchange::IPower::PCState, const Exchange::IPower::PCPhase) override
+    {
+        SleepMs(_duration);
+        _changes++;
+        return (_result);
+    }
+    uint32_t Changes() const
+    {
+        return (_changes);
+    }
+
+private:
+    const string _name;
+    const uint32_t _duration;
+    const uint32_t _result;
+    std::atomic<uint32_t> _changes;
+};
+
+using Fakes = std::vector<std::shared_ptr<Fake>>;
+
+Plugin::Transition::Clients Clients(const Fakes& fakes, const uint32_t deadline)
+{
+    Plugin::Transition::Clients result;
+
+    for (const auto& fake : fakes) {
+        result.emplace_back(fake, deadline);
+    }
+
+    return (result);
+}
+
+uint32_t Elapsed(const uint64_t start)
+{
+    return (static_cast<uint32_t>((Core::Time::Now().Ticks() - start) / Core::Time::TicksPerMillisecond));
+}
+
+bool Check(const char label[], const bool condition, const uint32_t value)
+{
+    printf("%-32s: %5u ms %s\n", label, value, (condition == true ? "" : "FAILED"));
+    return (condition);
+}
+
+// What the Power plugin does for the notifications of the platform.
+struct Platform {
+    Plugin::Transition* Engine;
+    Plugin::Transition::Clients Sinks;
+    std::vector<Exchange::IPower::PCPhase> Phases;
+};
+
+void Changed(void* userData, const Exchange::IPower::PCState state, const Exchange::IPower::PCPhase phase)
+{
+    Platform& platform(*static_cast<Platform*>(userData));
+
+    platform.Phases.push_back(phase);
+    platform.Engine->Run(_T("notify"), power_get_state(), state, phase, platform.Sinks);
+}
+
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    bool correct = true;
+
+    {
+        Plugin::Transition engine(4, 3);
+
+        // Four clients of 100 ms, side by side: little more than one of them.
+        {
+            Fakes fakes { std::make_shared<Fake>("a", 100), std::make_shared<Fake>("b", 100), std::make_shared<Fake>("c", 100), std::make_shared<Fake>("d", 100) };
+            const uint64_t start = Core::Time::Now().Ticks();
+            const uint32_t result = engine.Run(_T("suspend"), Exchange::IPower::PCState::On, Exchange::IPower::PCState::SuspendToRAM, Exchange::IPower::Before, Clients(fakes, 1000));
+            const uint32_t elapsed = Elapsed(start);
+
+            correct = Check("parallel, 4 x 100 ms", (result == Core::ERROR_NONE) && (elapsed < 250), elapsed) && correct;
+        }
+
+        // Twice as many clients as workers: two rounds.
+        {
+            Fakes fakes;
+            for (uint8_t index = 0; index < 8; ++index) {
+                fakes.push_back(std::make_shared<Fake>(Core::Format("client%d", index), 50));
+            }
+
+            const uint64_t start = Core::Time::Now().Ticks();
+            const uint32_t result = engine.Run(_T("resume"), Exchange::IPower::PCState::SuspendToRAM, Exchange::IPower::PCState::On, Exchange::IPower::After, Clients(fakes, 1000));
+            const uint32_t elapsed = Elapsed(start);
+            const Plugin::Transition::Timeline history(engine.History());
+
+            correct = Check("8 x 50 ms on 4 workers", (result == Core::ERROR_NONE) && (elapsed >= 95) && (elapsed < 200) && (history.back().Steps.back().Start >= (45 * Core::Time::TicksPerMillisecond)), elapsed) && correct;
+        }
+
+        // A slow one is given up on at its deadline, and shows up in the timeline once done.
+        {
+            Fakes fakes { std::make_shared<Fake>("fast", 10), std::make_shared<Fake>("slow", 400) };
+            const uint64_t start = Core::Time::Now().Ticks();
+            const uint32_t result = engine.Run(_T("suspend"), Exchange::IPower::PCState::On, Exchange::IPower::PCState::ActiveStandby, Exchange::IPower::Before, Clients(fakes, 100));
+            const uint32_t elapsed = Elapsed(start);
+
+            const Plugin::Transition::Step given(engine.History().back().Steps[1]);
+            correct = Check("deadline 100 ms, slowest 400 ms", (result == Core::ERROR_TIMEDOUT) && (elapsed < 200) && (given.Expired == true) && (given.Done == false), elapsed) && correct;
+
+            SleepMs(400);
+
+            const Plugin::Transition::Step late(engine.History().back().Steps[1]);
+            const Plugin::Transition::Step fast(engine.History().back().Steps[0]);
+            const uint32_t duration = static_cast<uint32_t>(late.Duration / Core::Time::TicksPerMillisecond);
+
+            correct = Check("late client in the timeline", (late.Done == true) && (duration >= 395) && (fast.Expired == false), duration) && correct;
+        }
+
+        // The first error a client reports is passed on.
+        {
+            Fakes fakes { std::make_shared<Fake>("good", 10), std::make_shared<Fake>("bad", 10, Core::ERROR_GENERAL) };
+            const uint64_t start = Core::Time::Now().Ticks();
+            const uint32_t result = engine.Run(_T("resume"), Exchange::IPower::PCState::ActiveStandby, Exchange::IPower::PCState::On, Exchange::IPower::After, Clients(fakes, 1000));
+
+            correct = Check("client error", (result == Core::ERROR_GENERAL), Elapsed(start)) && correct;
+        }
+
+        // Only the last transitions are kept.
+        correct = Check("history", (engine.History().size() == 3), 0) && correct;
+    }
+
+    // Through the Stub platform, the sinks are told before and after the change.
+    {
+        Plugin::Transition engine(4, 8);
+        Fakes sinks { std::make_shared<Fake>("sink1", 20), std::make_shared<Fake>("sink2", 20) };
+        Platform platform { &engine, Clients(sinks, 500), {} };
+
+        power_initialize(Changed, &platform, "", Exchange::IPower::PCState::On);
+
+        const uint64_t start = Core::Time::Now().Ticks();
+        const uint32_t result = power_set_state(Exchange::IPower::PCState::PassiveStandby, 0);
+        const uint32_t elapsed = Elapsed(start);
+
+        correct = Check("stub platform, 2 phases", (result == Core::ERROR_NONE) && (power_get_state() == Exchange::IPower::PCState::PassiveStandby) && (platform.Phases.size() == 2) && (platform.Phases[0] == Exchange::IPower::Before) && (sinks[0]->Changes() == 2) && (sinks[1]->Changes() == 2) && (elapsed < 100), elapsed) && correct;
+
+        power_deinitialize();
+    }
+
+    printf("%-32s: %s\n", "transition", (correct == true ? "correct" : "FAILED"));
+
+    Core::Singleton::Dispose();
+
+    return (correct == true ? 0 : 1);
+}
@@ -0,0 +1,238 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Thunder {
+
+namespace Plugin {
+
+    // The statistics of one cgroup v2 directory. All files are opened once and re-read from offset 0
+    // on every sample, the kernel regenerates their content on such a read, so sampling costs one
+    // pread per file and no path lookups. Files that are not there (PSI can be compiled out, io is
+    // not always delegated) are skipped and leave their fields at 0.
+    class CGroupMetrics {
+    public:
+        struct Snapshot {
+            uint64_t Memory;      // memory.current, bytes
+            uint64_t Anonymous;   // memory.stat anon, bytes
+            uint64_t Cache;       // memory.stat file, bytes
+            uint64_t Shared;      // memory.stat shmem, bytes
+            uint64_t Usage;       // cpu.stat usage_usec
+            uint64_t User;        // cpu.stat user_usec
+            uint64_t System;      // cpu.stat system_usec
+            uint64_t Read;        // io.stat rbytes, all devices
+            uint64_t Written;     // io.stat wbytes, all devices
+            uint16_t MemoryStall; // memory.pressure "some" avg10, 1/100 %
+            uint16_t CPUStall;    // cpu.pressure "some" avg10, 1/100 %
+            uint16_t IOStall;     // io.pressure "some" avg10, 1/100 %
+        };
+
+    private:
+        enum source : uint8_t {
+            MEMORY_CURRENT,
+            MEMORY_STAT,
+            CPU_STAT,
+            IO_STAT,
+            MEMORY_PRESSURE,
+            CPU_PRESSURE,
+            IO_PRESSURE,
+            SOURCES
+        };
+
+        static constexpr uint16_t BufferSize = 4096; // memory.stat is the largest, about 1.5KB
+
+    public:
+        CGroupMetrics() = delete;
+        CGroupMetrics(const CGroupMetrics&) = delete;
+        CGroupMetrics& operator=(const CGroupMetrics&) = delete;
+
+        CGroupMetrics(const std::string& path)
+            : _path(path)
+        {
+            static const char* const Files[SOURCES] = {
+                "memory.current", "memory.stat", "cpu.stat", "io.stat",
+                "memory.pressure", "cpu.pressure", "io.pressure"
+            };
+
+            for (uint8_t index = 0; index < SOURCES; index++) {
+                _descriptors[index] = ::open((path + '/' + Files[index]).c_str(), O_RDONLY | O_CLOEXEC);
+            }
+        }
+        ~CGroupMetrics()
+        {
+            for (int descriptor : _descriptors) {
+                if (descriptor != -1) {
+                    ::close(descriptor);
+                }
+            }
+        }
+
+    public:
+        const std::string& Path() const
+        {
+            return (_path);
+        }
+        bool IsValid() const
+        {
+            return ((_descriptors[MEMORY_CURRENT] != -1) || (_descriptors[CPU_STAT] != -1));
+        }
+
+        // Returns false if none of the files could be read, the cgroup is most likely gone.
+        bool Sample(Snapshot& snapshot)
+        {
+            bool result = false;
+
+            ::memset(&snapshot, 0, sizeof(snapshot));
+
+            if (Load(MEMORY_CURRENT) == true) {
+                snapshot.Memory = Number(_buffer);
+                result = true;
+            }
+            if (Load(MEMORY_STAT) == true) {
+                const Key keys[] = { { "anon ", &snapshot.Anonymous }, { "file ", &snapshot.Cache }, { "shmem ", &snapshot.Shared } };
+                Lines(keys, sizeof(keys) / sizeof(Key));
+                result = true;
+            }
+            if (Load(CPU_STAT) == true) {
+                const Key keys[] = { { "usage_usec ", &snapshot.Usage }, { "user_usec ", &snapshot.User }, { "system_usec ", &snapshot.System } };
+                Lines(keys, sizeof(keys) / sizeof(Key));
+                result = true;
+            }
+            if (Load(IO_STAT) == true) {
+                Devices(snapshot.Read, snapshot.Written);
+            }
+            if (Load(MEMORY_PRESSURE) == true) {
+                snapshot.MemoryStall = Stall();
+            }
+            if (Load(CPU_PRESSURE) == true) {
+                snapshot.CPUStall = Stall();
+            }
+            if (Load(IO_PRESSURE) == true) {
+                snapshot.IOStall = Stall();
+            }
+
+            return (result);
+        }
+
+    private:
+        struct Key {
+            const char* Name; // including the separating space
+            uint64_t* Value;
+        };
+
+        bool Load(const source file)
+        {
+            ssize_t length = -1;
+
+            if (_descriptors[file] != -1) {
+                length = ::pread(_descriptors[file], _buffer, sizeof(_buffer) - 1, 0);
+            }
+
+            _buffer[length > 0 ? length : 0] = '\0';
+
+            return (length > 0);
+        }
+        static uint64_t Number(const char* text)
+        {
+            uint64_t value = 0;
+
+            while ((*text >= '0') && (*text <= '9')) {
+                value = (value * 10) + (*text++ - '0');
+            }
+
+            return (value);
+        }
+        // "<key> <value>\n" files, only the listed keys are picked up.
+        void Lines(const Key keys[], const uint8_t count)
+        {
+            const char* line = _buffer;
+            uint8_t found = 0;
+
+            while ((*line != '\0') && (found < count)) {
+                for (uint8_t index = 0; index < count; index++) {
+                    const size_t length = ::strlen(keys[index].Name);
+
+                    if (::strncmp(line, keys[index].Name, length) == 0) {
+                        *(keys[index].Value) = Number(&line[length]);
+                        found++;
+                        break;
+                    }
+                }
+
+                line = ::strchr(line, '\n');
+                line = (line != nullptr ? line + 1 : "");
+            }
+        }
+        // "<major>:<minor> rbytes=<n> wbytes=<n> rios=<n> ...\n" per device.
+        void Devices(uint64_t& read, uint64_t& written)
+        {
+            const char* position = _buffer;
+
+            while ((position = ::strchr(position, '=')) != nullptr) {
+                if ((position >= &_buffer[6]) && (::strncmp(position - 6, "rbytes", 6) == 0)) {
+                    read += Number(position + 1);
+                } else if ((position >= &_buffer[6]) && (::strncmp(position - 6, "wbytes", 6) == 0)) {
+                    written += Number(position + 1);
+                }
+                position++;
+            }
+        }
+        // "some avg10=1.23 avg60=..." to hundredths of a percent.
+        uint16_t Stall() const
+        {
+            uint16_t result = 0;
+            const char* position = ::strstr(_buffer, "some avg10=");
+
+            if (position != nullptr) {
+                position += 11;
+                result = static_cast<uint16_t>(Number(position) * 100);
+
+                while ((*position >= '0') && (*position <= '9')) {
+                    position++;
+                }
+
+                if ((position[0] == '.') && (position[1] >= '0') && (position[1] <= '9')) {
+                    result += static_cast<uint16_t>((position[1] - '0') * 10);
+
+                    if ((position[2] >= '0') && (position[2] <= '9')) {
+                        result += static_cast<uint16_t>(position[2] - '0');
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        const std::string _path;
+        int _descriptors[SOURCES];
+        char _buffer[BufferSize];
+    };
+
+} // namespace Plugin
+
+}
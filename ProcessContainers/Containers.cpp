@@ -18,6 +18,7 @@
  */
 
 #include "Containers.h"
+#include <processcontainers/processcontainers.h>
 
 namespace Thunder {
 namespace Plugin {
@@ -36,18 +37,201 @@ namespace Plugin {
         );
     }
 
-    const string Containers::Initialize(PluginHost::IShell* service VARIABLE_IS_NOT_USED)
+    const string Containers::Initialize(PluginHost::IShell* service)
     {
+        Config config;
+        config.FromString(service->ConfigLine());
+
+        _interval = config.Interval.Value();
+        _cgroup = config.CGroup.Value();
+        _memoryLimit = config.Thresholds.Memory.Value();
+        _cpuLimit = config.Thresholds.CPU.Value();
+        _pressureLimit = static_cast<uint16_t>(config.Thresholds.Pressure.Value()) * 100;
+
+        if (_interval != 0) {
+            _job.Submit();
+        }
+
         return (string());
     }
 
     void Containers::Deinitialize(PluginHost::IShell* service VARIABLE_IS_NOT_USED)
     {
+        _job.Revoke();
+
+        _adminLock.Lock();
+        _metrics.clear();
+        _adminLock.Unlock();
     }
 
     string Containers::Information() const 
     {
         return (string());
     }
+
+    void Containers::Dispatch()
+    {
+        const uint64_t now = Core::Time::Now().Ticks();
+        std::list<string> ids;
+        std::list<Event> events;
+
+        auto& administrator = ProcessContainers::ContainerAdministrator::Instance();
+        auto containers = administrator.Containers();
+
+        while (containers->Next() == true) {
+            ids.push_back(containers->Id());
+        }
+
+        containers->Release();
+
+        _adminLock.Lock();
+
+        MetricsMap::iterator index = _metrics.begin();
+        while (index != _metrics.end()) {
+            if (std::find(ids.cbegin(), ids.cend(), index->first) == ids.cend()) {
+                index = _metrics.erase(index);
+            } else {
+                index++;
+            }
+        }
+
+        for (const string& id : ids) {
+            Metrics& entry(_metrics[id]);
+
+            if ((entry.Group == nullptr) && (_cgroup.empty() == false)) {
+                string path(_cgroup);
+                const size_t position = path.find(_T("%s"));
+
+                if (position != string::npos) {
+                    path.replace(position, 2, id);
+                }
+
+                entry.Group.reset(new CGroupMetrics(path));
+
+                TRACE(Trace::Information, (_T("Container %s samples %s"), id.c_str(), (entry.Group->IsValid() == true ? path.c_str() : _T("the backend"))));
+            }
+        }
+
+        _adminLock.Unlock();
+
+        for (const string& id : ids) {
+            // Only this job adds or removes entries, so the cgroup can be used without holding the lock.
+            _adminLock.Lock();
+            CGroupMetrics* group = _metrics[id].Group.get();
+            _adminLock.Unlock();
+
+            Reading reading;
+
+            if (Read(id, ((group != nullptr) && (group->IsValid() == true) ? group : nullptr), reading) == true) {
+                _adminLock.Lock();
+                Update(id, _metrics[id], reading, now, events);
+                _adminLock.Unlock();
+            }
+        }
+
+        for (const Event& event : events) {
+            event_threshold(event);
+        }
+
+        _job.Reschedule(Core::Time::Now().Add(_interval));
+    }
+
+    /* static */ bool Containers::Read(const string& id, CGroupMetrics* group, Reading& reading)
+    {
+        auto& administrator = ProcessContainers::ContainerAdministrator::Instance();
+        auto container = administrator.Get(id);
+        const bool result = container.IsValid();
+
+        if (result == true) {
+            if ((group != nullptr) && (group->Sample(reading.Stats) == true)) {
+                reading.Memory.Allocated = reading.Stats.Memory;
+                reading.Memory.Resident = reading.Stats.Anonymous + reading.Stats.Cache;
+                reading.Memory.Shared = reading.Stats.Shared;
+                reading.Processor.Total = reading.Stats.Usage * 1000;
+
+                // cgroup v2 does not account per core, the cores the cpu property reports still come from the backend.
+                auto processorInfo = container->ProcessorInfo();
+                if (processorInfo != nullptr) {
+                    for (int i = 0; i < processorInfo->NumberOfCores(); i++) {
+                        reading.Processor.Cores.push_back(processorInfo->CoreUsage(i));
+                    }
+                    processorInfo->Release();
+                }
+            } else {
+                auto memoryInfo = container->Memory();
+                if (memoryInfo != nullptr) {
+                    reading.Memory.Allocated = memoryInfo->Allocated();
+                    reading.Memory.Resident = memoryInfo->Resident();
+                    reading.Memory.Shared = memoryInfo->Shared();
+                    memoryInfo->Release();
+                }
+
+                auto processorInfo = container->ProcessorInfo();
+                if (processorInfo != nullptr) {
+                    reading.Processor.Total = processorInfo->TotalUsage();
+                    for (int i = 0; i < processorInfo->NumberOfCores(); i++) {
+                        reading.Processor.Cores.push_back(processorInfo->CoreUsage(i));
+                    }
+                    processorInfo->Release();
+                }
+            }
+
+            auto iterator = container->NetworkInterfaces();
+            if (iterator != nullptr) {
+                while (iterator->Next() == true) {
+                    reading.Networks.emplace_back(iterator->Name(), std::vector<string>());
+
+                    for (int ip = 0; ip < iterator->NumAddresses(); ip++) {
+                        reading.Networks.back().second.push_back(iterator->Address(ip));
+                    }
+                }
+                iterator->Release();
+            }
+
+            container.Release();
+        }
+
+        return (result);
+    }
+
+    void Containers::Update(const string& id, Metrics& metrics, Reading& reading, const uint64_t now, std::list<Event>& events) const
+    {
+        if ((metrics.Sampled != 0) && (now > metrics.Sampled) && (reading.Processor.Total >= metrics.Current.Processor.Total)) {
+            // ns of CPU time over us of wall time, in percent.
+            metrics.Load = static_cast<uint16_t>((reading.Processor.Total - metrics.Current.Processor.Total) / ((now - metrics.Sampled) * 10));
+        }
+
+        metrics.Current = std::move(reading);
+        metrics.Sampled = now;
+
+        const Reading& current(metrics.Current);
+        const uint16_t stall = std::max(std::max(current.Stats.MemoryStall, current.Stats.CPUStall), current.Stats.IOStall);
+
+        const struct {
+            metric Metric;
+            uint64_t Value;
+            uint64_t Limit;
+        } checks[] = {
+            { MEMORY, current.Memory.Allocated, _memoryLimit },
+            { CPU, metrics.Load, _cpuLimit },
+            { PRESSURE, stall, _pressureLimit }
+        };
+
+        for (const auto& check : checks) {
+            if (check.Limit != 0) {
+                const bool exceeded = ((metrics.Exceeded & check.Metric) != 0);
+
+                // Only report crossings, and only clear below 90% of the limit, so a value that
+                // hovers around the limit does not flood the subscribers.
+                if ((exceeded == false) && (check.Value >= check.Limit)) {
+                    metrics.Exceeded |= check.Metric;
+                    events.push_back({ id, check.Metric, check.Value, check.Limit, true });
+                } else if ((exceeded == true) && (check.Value < ((check.Limit * 9) / 10))) {
+                    metrics.Exceeded &= static_cast<uint8_t>(~check.Metric);
+                    events.push_back({ id, check.Metric, check.Value, check.Limit, false });
+                }
+            }
+        }
+    }
 }
 }
@@ -23,17 +23,162 @@
 // This plugin should never be started as outofprocess!
 
 #include "Module.h"
+#include "CGroupMetrics.h"
 #include "interfaces/json/JsonData_Containers.h"
 
+#include <unordered_map>
+
 namespace Thunder {
 namespace Plugin {
 
     class Containers : public PluginHost::IPlugin, PluginHost::JSONRPC {
+    private:
+        class Config : public Core::JSON::Container {
+        public:
+            class ThresholdConfig : public Core::JSON::Container {
+            public:
+                ThresholdConfig(const ThresholdConfig&) = delete;
+                ThresholdConfig& operator=(const ThresholdConfig&) = delete;
+
+                ThresholdConfig()
+                    : Core::JSON::Container()
+                    , Memory(0)
+                    , CPU(0)
+                    , Pressure(0)
+                {
+                    Add(_T("memory"), &Memory);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("pressure"), &Pressure);
+                }
+                ~ThresholdConfig() override = default;
+
+            public:
+                Core::JSON::DecUInt64 Memory; // bytes, 0 is off
+                Core::JSON::DecUInt16 CPU; // percent of one core, 0 is off
+                Core::JSON::DecUInt8 Pressure; // percent of time stalled (PSI some avg10), 0 is off
+            };
+
+        public:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+            Config()
+                : Core::JSON::Container()
+                , Interval(1000)
+                , CGroup(_T("/sys/fs/cgroup/%s"))
+                , Thresholds()
+            {
+                Add(_T("interval"), &Interval);
+                Add(_T("cgroup"), &CGroup);
+                Add(_T("thresholds"), &Thresholds);
+            }
+            ~Config() override = default;
+
+        public:
+            Core::JSON::DecUInt32 Interval; // ms, 0 reads the backend on every request
+            Core::JSON::String CGroup; // %s is replaced by the container id
+            ThresholdConfig Thresholds;
+        };
+
+        class ThresholdData : public Core::JSON::Container {
+        public:
+            ThresholdData(const ThresholdData&) = delete;
+            ThresholdData& operator=(const ThresholdData&) = delete;
+
+            ThresholdData()
+                : Core::JSON::Container()
+                , Name()
+                , Metric()
+                , Value(0)
+                , Limit(0)
+                , Exceeded(false)
+            {
+                Add(_T("name"), &Name);
+                Add(_T("metric"), &Metric);
+                Add(_T("value"), &Value);
+                Add(_T("limit"), &Limit);
+                Add(_T("exceeded"), &Exceeded);
+            }
+            ~ThresholdData() override = default;
+
+        public:
+            Core::JSON::String Name;
+            Core::JSON::String Metric;
+            Core::JSON::DecUInt64 Value;
+            Core::JSON::DecUInt64 Limit;
+            Core::JSON::Boolean Exceeded;
+        };
+
+        enum metric : uint8_t {
+            MEMORY = 0x01,
+            CPU = 0x02,
+            PRESSURE = 0x04
+        };
+
+        struct Event {
+            string Name;
+            metric Metric;
+            uint64_t Value;
+            uint64_t Limit;
+            bool Exceeded;
+        };
+
+        // Everything the JSON-RPC properties report for one container.
+        struct Reading {
+            Reading()
+                : Stats()
+                , Memory()
+                , Processor()
+                , Networks()
+            {
+            }
+
+            CGroupMetrics::Snapshot Stats;
+            struct {
+                uint64_t Allocated;
+                uint64_t Resident;
+                uint64_t Shared;
+            } Memory;
+            struct {
+                uint64_t Total; // ns
+                std::vector<uint64_t> Cores;
+            } Processor;
+            std::vector<std::pair<string, std::vector<string>>> Networks;
+        };
+
+        // The cgroup is only touched by the sampling job, the rest is guarded by the admin lock.
+        struct Metrics {
+            Metrics()
+                : Group()
+                , Sampled(0)
+                , Load(0)
+                , Exceeded(0)
+                , Current()
+            {
+            }
+
+            std::unique_ptr<CGroupMetrics> Group;
+            uint64_t Sampled; // ticks, 0 if not sampled yet
+            uint16_t Load; // CPU, percent of one core, over the last interval
+            uint8_t Exceeded; // metric bits currently over their threshold
+            Reading Current;
+        };
+
+        using MetricsMap = std::unordered_map<string, Metrics>;
+
     public:
         Containers(const Containers&) = delete;
         Containers& operator=(const Containers&) = delete;
 
         Containers()
+            : _adminLock()
+            , _metrics()
+            , _interval(0)
+            , _cgroup()
+            , _memoryLimit(0)
+            , _cpuLimit(0)
+            , _pressureLimit(0)
+            , _job(*this)
         {
             RegisterAll();
         }
@@ -66,6 +211,39 @@ namespace Plugin {
         uint32_t get_networks(const string& index, Core::JSON::ArrayType<JsonData::Containers::NetworksResultDataElem>& response) const;
         uint32_t get_memory(const string& index, JsonData::Containers::MemoryData& response) const;
         uint32_t get_cpu(const string& index, JsonData::Containers::CpuData& response) const;
+        void event_threshold(const Event& event);
+
+    private:
+        template<typename ACTION>
+        bool Cached(const string& id, ACTION&& action) const
+        {
+            Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
+
+            MetricsMap::const_iterator index = _metrics.find(id);
+            const bool result = ((index != _metrics.cend()) && (index->second.Sampled != 0));
+
+            if (result == true) {
+                action(index->second);
+            }
+
+            return (result);
+        }
+
+        friend Core::ThreadPool::JobType<Containers&>;
+        void Dispatch();
+
+        static bool Read(const string& id, CGroupMetrics* group, Reading& reading);
+        void Update(const string& id, Metrics& metrics, Reading& reading, const uint64_t now, std::list<Event>& events) const;
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        MetricsMap _metrics;
+        uint32_t _interval;
+        string _cgroup;
+        uint64_t _memoryLimit;
+        uint16_t _cpuLimit;
+        uint16_t _pressureLimit; // 1/100 %
+        Core::WorkerPool::JobType<Containers&> _job;
     };
 
 } // namespace Plugin
@@ -133,6 +133,9 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // The properties below are served from the last sample if the sampler runs, a container it
+    // has not seen yet is read from the backend directly.
+
     // Property: networks - Networks information
     // Return codes:
     //  - ERROR_NONE: Success
@@ -141,32 +144,50 @@ namespace Plugin {
     {
         uint32_t result = Core::ERROR_NONE;
 
-        auto& administrator = ProcessContainers::ContainerAdministrator::Instance();
-        auto container = administrator.Get(index);
+        const bool cached = Cached(index, [&](const Metrics& metrics) {
+            for (const auto& network : metrics.Current.Networks) {
+                NetworksResultDataElem networkData;
 
-        if (container.IsValid() == true) {
-            auto iterator = container->NetworkInterfaces();
+                networkData.Interface = network.first;
+
+                for (const string& address : network.second) {
+                    Core::JSON::String ipJSON;
+                    ipJSON = address;
+
+                    networkData.Ips.Add(ipJSON);
+                }
+                response.Add(networkData);
+            }
+        });
+
+        if (cached == false) {
+            auto& administrator = ProcessContainers::ContainerAdministrator::Instance();
+            auto container = administrator.Get(index);
 
-            if (iterator != nullptr) {
-                while(iterator->Next() == true) {
-                    NetworksResultDataElem networkData;
+            if (container.IsValid() == true) {
+                auto iterator = container->NetworkInterfaces();
 
-                    networkData.Interface = iterator->Name();
+                if (iterator != nullptr) {
+                    while(iterator->Next() == true) {
+                        NetworksResultDataElem networkData;
 
-                    for (int ip = 0; ip < iterator->NumAddresses(); ip++) {
-                        Core::JSON::String ipJSON;
-                        ipJSON = iterator->Address(ip);
+                        networkData.Interface = iterator->Name();
 
-                        networkData.Ips.Add(ipJSON);
+                        for (int ip = 0; ip < iterator->NumAddresses(); ip++) {
+                            Core::JSON::String ipJSON;
+                            ipJSON = iterator->Address(ip);
+
+                            networkData.Ips.Add(ipJSON);
+                        }
+                        response.Add(networkData);
                     }
-                    response.Add(networkData);
+                    iterator->Release();
                 }
-                iterator->Release();
+                container.Release();
+            }
+            else {
+                result = Core::ERROR_UNAVAILABLE;
             }
-            container.Release();
-        }
-        else {
-            result = Core::ERROR_UNAVAILABLE;
         }
 
         return result;
@@ -180,21 +201,29 @@ namespace Plugin {
     {
         uint32_t result = Core::ERROR_NONE;
 
-        auto& administrator = ProcessContainers::ContainerAdministrator::Instance();
-        auto container = administrator.Get(index);
-
-        if (container.IsValid() == true) {
-            auto memoryInfo = container->Memory();
-            if (memoryInfo != nullptr) {
-                response.Allocated = memoryInfo->Allocated();
-                response.Resident = memoryInfo->Resident();
-                response.Shared = memoryInfo->Shared();
-                memoryInfo->Release();
+        const bool cached = Cached(index, [&](const Metrics& metrics) {
+            response.Allocated = metrics.Current.Memory.Allocated;
+            response.Resident = metrics.Current.Memory.Resident;
+            response.Shared = metrics.Current.Memory.Shared;
+        });
+
+        if (cached == false) {
+            auto& administrator = ProcessContainers::ContainerAdministrator::Instance();
+            auto container = administrator.Get(index);
+
+            if (container.IsValid() == true) {
+                auto memoryInfo = container->Memory();
+                if (memoryInfo != nullptr) {
+                    response.Allocated = memoryInfo->Allocated();
+                    response.Resident = memoryInfo->Resident();
+                    response.Shared = memoryInfo->Shared();
+                    memoryInfo->Release();
+                }
+                container.Release();
+            }
+            else {
+                result = Core::ERROR_UNAVAILABLE;
             }
-            container.Release();
-        }
-        else {
-            result = Core::ERROR_UNAVAILABLE;
         }
 
         return result;
@@ -208,33 +237,77 @@ namespace Plugin {
     {
         uint32_t result = Core::ERROR_NONE;
 
-        auto& administrator = ProcessContainers::ContainerAdministrator::Instance();
-        auto container = administrator.Get(index);
+        const bool cached = Cached(index, [&](const Metrics& metrics) {
+            response.Total = metrics.Current.Processor.Total;
 
-        if (container.IsValid() == true) {
-            auto processorInfo = container->ProcessorInfo();
+            for (const uint64_t usage : metrics.Current.Processor.Cores) {
+                Core::JSON::DecUInt64 coreTime;
+                coreTime = usage;
+
+                response.Cores.Add(coreTime);
+            }
+        });
 
-            if (processorInfo != nullptr) {
-                response.Total = processorInfo->TotalUsage();
+        if (cached == false) {
+            auto& administrator = ProcessContainers::ContainerAdministrator::Instance();
+            auto container = administrator.Get(index);
 
-                for (int i = 0; i < processorInfo->NumberOfCores(); i++) {
-                    Core::JSON::DecUInt64 coreTime;
-                    coreTime = processorInfo->CoreUsage(i);
+            if (container.IsValid() == true) {
+                auto processorInfo = container->ProcessorInfo();
 
-                    response.Cores.Add(coreTime);
+                if (processorInfo != nullptr) {
+                    response.Total = processorInfo->TotalUsage();
+
+                    for (int i = 0; i < processorInfo->NumberOfCores(); i++) {
+                        Core::JSON::DecUInt64 coreTime;
+                        coreTime = processorInfo->CoreUsage(i);
+
+                        response.Cores.Add(coreTime);
+                    }
+
+                    processorInfo->Release();
                 }
 
-                processorInfo->Release();
+                container.Release();
+            }
+            else {
+                result = Core::ERROR_UNAVAILABLE;
             }
-
-            container.Release();
-        }
-        else {
-            result = Core::ERROR_UNAVAILABLE;
         }
 
         return result;
     }
+
+    // Event: threshold - A container crossed one of the configured thresholds, up or down
+    void Containers::event_threshold(const Event& event)
+    {
+        ThresholdData params;
+
+        params.Name = event.Name;
+
+        switch (event.Metric) {
+        case MEMORY:
+            params.Metric = _T("memory");
+            params.Value = event.Value;
+            params.Limit = event.Limit;
+            break;
+        case CPU:
+            params.Metric = _T("cpu");
+            params.Value = event.Value;
+            params.Limit = event.Limit;
+            break;
+        case PRESSURE:
+            // Kept in 1/100 % internally, reported in percent like it is configured.
+            params.Metric = _T("pressure");
+            params.Value = event.Value / 100;
+            params.Limit = event.Limit / 100;
+            break;
+        }
+
+        params.Exceeded = event.Exceeded;
+
+        Notify(_T("threshold"), params);
+    }
 } // namespace Plugin
 
 }
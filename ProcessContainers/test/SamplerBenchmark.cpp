@@ -0,0 +1,183 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Builds a fake cgroup v2 tree, checks the sampler parses it, and measures what a sweep over all
+// containers costs with the files kept open, against opening them again for every read.
+
+#ifndef MODULE_NAME
+#define MODULE_NAME CGroupSamplerTest
+#endif
+
+#include <core/core.h>
+
+#include <CGroupMetrics.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+using Thunder::Plugin::CGroupMetrics;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+constexpr uint8_t Containers = 20;
+constexpr uint16_t Sweeps = 2000;
+
+bool Write(const std::string& path, const std::string& content)
+{
+    FILE* file = ::fopen(path.c_str(), "w");
+
+    if (file != nullptr) {
+        ::fputs(content.c_str(), file);
+        ::fclose(file);
+    }
+
+    return (file != nullptr);
+}
+
+// The layout and size of what a 6.x kernel reports, the values are derived from the index.
+bool Populate(const std::string& path, const uint32_t index)
+{
+    const std::string n(std::to_string(index));
+
+    std::string stat;
+    stat += "anon " + n + "1000\n";
+    stat += "file " + n + "2000\n";
+    stat += "kernel 1146880\nkernel_stack 81920\npagetables 143360\nsec_pagetables 0\npercpu 960\nsock 0\nvmalloc 0\n";
+    stat += "shmem " + n + "3000\n";
+    stat += "zswap 0\nzswapped 0\nfile_mapped 3637248\nfile_dirty 0\nfile_writeback 0\nswapcached 0\nanon_thp 0\n"
+            "file_thp 0\nshmem_thp 0\ninactive_anon 4096\nactive_anon 9334784\ninactive_file 2383872\n"
+            "active_file 9596928\nunevictable 0\nslab_reclaimable 460600\nslab_unreclaimable 343656\nslab 804256\n"
+            "workingset_refault_anon 0\nworkingset_refault_file 0\nworkingset_activate_anon 0\nworkingset_activate_file 0\n"
+            "workingset_restore_anon 0\nworkingset_restore_file 0\nworkingset_nodereclaim 0\npgscan 0\npgsteal 0\n"
+            "pgscan_kswapd 0\npgscan_direct 0\npgscan_khugepaged 0\npgsteal_kswapd 0\npgsteal_direct 0\n"
+            "pgsteal_khugepaged 0\npgfault 35757\npgmajfault 1\npgrefill 0\npgactivate 3290\npgdeactivate 0\n"
+            "pglazyfree 0\npglazyfreed 0\nzswpin 0\nzswpout 0\nthp_fault_alloc 0\nthp_collapse_alloc 0\n";
+
+    return ((::mkdir(path.c_str(), 0755) == 0) &&
+        Write(path + "/memory.current", n + "4000\n") &&
+        Write(path + "/memory.stat", stat) &&
+        Write(path + "/cpu.stat", "usage_usec " + n + "5000\nuser_usec " + n + "3000\nsystem_usec " + n + "2000\n"
+                                  "core_sched.force_idle_usec 0\nnr_periods 0\nnr_throttled 0\nthrottled_usec 0\n"
+                                  "nr_bursts 0\nburst_usec 0\n") &&
+        Write(path + "/io.stat", "259:0 rbytes=" + n + "100 wbytes=" + n + "200 rios=12 wios=7 dbytes=0 dios=0\n"
+                                 "8:0 rbytes=300 wbytes=400 rios=1 wios=1 dbytes=0 dios=0\n") &&
+        Write(path + "/memory.pressure", "some avg10=" + n + ".25 avg60=0.00 avg300=0.00 total=1234\n"
+                                         "full avg10=0.00 avg60=0.00 avg300=0.00 total=1000\n") &&
+        Write(path + "/cpu.pressure", "some avg10=1.50 avg60=0.00 avg300=0.00 total=99\n"
+                                      "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n") &&
+        Write(path + "/io.pressure", "some avg10=0.07 avg60=0.00 avg300=0.00 total=5\n"
+                                     "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"));
+}
+
+bool Verify(const CGroupMetrics::Snapshot& snapshot, const uint32_t index)
+{
+    const uint64_t n(index);
+
+    return ((snapshot.Memory == (n * 10000) + 4000) &&
+        (snapshot.Anonymous == (n * 10000) + 1000) &&
+        (snapshot.Cache == (n * 10000) + 2000) &&
+        (snapshot.Shared == (n * 10000) + 3000) &&
+        (snapshot.Usage == (n * 10000) + 5000) &&
+        (snapshot.User == (n * 10000) + 3000) &&
+        (snapshot.System == (n * 10000) + 2000) &&
+        (snapshot.Read == (n * 1000) + 100 + 300) &&
+        (snapshot.Written == (n * 1000) + 200 + 400) &&
+        (snapshot.MemoryStall == (n * 100) + 25) &&
+        (snapshot.CPUStall == 150) &&
+        (snapshot.IOStall == 7));
+}
+
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    char root[] = "/tmp/cgroupsamplerXXXXXX";
+    const bool created = (::mkdtemp(root) != nullptr);
+    bool correct = created;
+    std::vector<std::string> paths;
+
+    for (uint8_t index = 0; (index < Containers) && (correct == true); index++) {
+        paths.push_back(std::string(root) + "/container" + std::to_string(index));
+        correct = Populate(paths.back(), index);
+    }
+
+    if (correct == false) {
+        printf("could not create the fake cgroup tree in %s\n", root);
+    } else {
+        std::vector<std::unique_ptr<CGroupMetrics>> groups;
+        CGroupMetrics::Snapshot snapshot;
+
+        for (const std::string& path : paths) {
+            groups.emplace_back(new CGroupMetrics(path));
+        }
+
+        for (uint8_t index = 0; index < Containers; index++) {
+            correct = correct && (groups[index]->Sample(snapshot) == true) && (Verify(snapshot, index) == true);
+        }
+
+        // Rewritten in place, as the kernel does, the open descriptor must see the new value.
+        Write(paths[0] + "/memory.current", "123456789\n");
+        correct = correct && (groups[0]->Sample(snapshot) == true) && (snapshot.Memory == 123456789);
+        Write(paths[0] + "/memory.current", "4000\n");
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint16_t sweep = 0; sweep < Sweeps; sweep++) {
+            for (auto& group : groups) {
+                group->Sample(snapshot);
+            }
+        }
+
+        const auto middle = std::chrono::steady_clock::now();
+
+        for (uint16_t sweep = 0; sweep < Sweeps; sweep++) {
+            for (const std::string& path : paths) {
+                CGroupMetrics group(path);
+                group.Sample(snapshot);
+            }
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+
+        const double kept = std::chrono::duration<double, std::micro>(middle - start).count() / Sweeps;
+        const double reopened = std::chrono::duration<double, std::micro>(end - middle).count() / Sweeps;
+
+        printf("containers          : %u\n", Containers);
+        printf("persistent fds      : %8.1f us/sweep\n", kept);
+        printf("open on every read  : %8.1f us/sweep\n", reopened);
+        printf("overhead at 1s      : %8.4f %% of one core\n", kept / 10000.0);
+        printf("parsing             : %s\n", (correct == true ? "correct" : "WRONG"));
+
+        groups.clear();
+    }
+
+    if ((created == true) && (Thunder::Core::Directory(root).Destroy() == false)) {
+        printf("could not remove the fake cgroup tree in %s\n", root);
+    }
+
+    return (correct == true ? 0 : 1);
+}
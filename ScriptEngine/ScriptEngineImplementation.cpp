@@ -19,6 +19,7 @@
  
 #include "Module.h"
 #include "Implementation.h"
+#include "SourceTransfer.h"
 
 #include <interfaces/IScriptEngine.h>
 #include <interfaces/IConfiguration.h>
@@ -31,6 +32,7 @@ namespace Plugin {
 class ScriptEngineImplementation
     : public Exchange::IScriptEngine
     , public Exchange::IConfiguration
+    , public SourceTransfer::ICallback
     , public Core::Thread {
 private:
     class Config: public Core::JSON::Container {
@@ -41,13 +43,16 @@ private:
 
         Config()
             : Core::JSON::Container()
-            , Url() {
+            , Url()
+            , Cache() {
             Add(_T("url"), &Url);
+            Add(_T("cache"), &Cache);
         }
         ~Config() override = default;
 
     public:
         Core::JSON::String Url;
+        Core::JSON::String Cache;
     };
 
     using Observers = std::vector<Exchange::IScriptEngine::INotification*>;
@@ -62,19 +67,38 @@ public:
         , _adminLock()
         , _clients()
         , _platform(nullptr)
-        , _service(nullptr) {
+        , _service(nullptr)
+        , _transfer(nullptr)
+        , _closing(false) {
     }
     ~ScriptEngineImplementation() override {
+        // Nothing may start the script anymore.
+        _adminLock.Lock();
+        _closing = true;
+        _adminLock.Unlock();
+
+        if (_platform != nullptr) {
+            // The script runs straight from the mapped source, it must be done before that goes.
+            Core::Thread::Wait((Core::Thread::BLOCKED | Core::Thread::STOPPED), Core::infinite);
+        }
+
+        if (_transfer != nullptr) {
+            _transfer->Abort();
+        }
+
         if (_service) {
             _service->Release();
             _service = nullptr;
         }
 
         if (_platform != nullptr) {
-            Core::Thread::Wait((Core::Thread::BLOCKED | Core::Thread::STOPPED), Core::infinite);
-
             script_destroy_platform(_platform);
         }
+
+        if (_transfer != nullptr) {
+            delete _transfer;
+            _transfer = nullptr;
+        }
     }
 
 public:
@@ -103,7 +127,19 @@ public:
             _service = service;
             _service->AddRef();
 
-            Run();
+            if (_url.empty() == true) {
+                Run();
+            } else {
+                // Sources are kept (by content) over restarts, a reload only asks the server if they changed.
+                _transfer = new SourceTransfer(this, (config.Cache.IsSet() == true ? config.Cache.Value() : service->PersistentPath() + _T("sources/")));
+
+                uint32_t loaded = _transfer->Download(_url);
+
+                if ((loaded != Core::ERROR_NONE) && (loaded != Core::ERROR_INPROGRESS)) {
+                    TRACE(Trace::Error, (_T("Could not load the script from %s [%d]"), _url.c_str(), loaded));
+                    result = loaded;
+                }
+            }
         }
  
         return (result);
@@ -175,13 +211,34 @@ public:
     END_INTERFACE_MAP
 
 private:
+    //
+    // SourceTransfer::ICallback members
+    // ---------------------------------------------------------------------------------
+    void Transfered(const string& url, const uint32_t result) override {
+        if (result == Core::ERROR_NONE) {
+            _adminLock.Lock();
+            if (_closing == false) {
+                Run();
+            }
+            _adminLock.Unlock();
+        } else {
+            TRACE(Trace::Error, (_T("Could not load the script from %s [%d]"), url.c_str(), result));
+        }
+    }
+
     uint32_t Worker() override {
         if (IsRunning() == true) {
             ASSERT(_platform != nullptr);
 
             uint32_t length = ( (sizeof(script)/sizeof(TCHAR)) - 1);
+            const TCHAR* source = script;
+
+            // Handed over as mapped from the cache, not copied.
+            if (_transfer != nullptr) {
+                _transfer->Source(source, length);
+            }
 
-            if (script_prepare(_platform, length, script) == Core::ERROR_NONE) {
+            if (script_prepare(_platform, length, source) == Core::ERROR_NONE) {
                 script_execute(_platform);
             }
         }
@@ -197,6 +254,8 @@ private:
     Observers _clients;
     platform* _platform;
     PluginHost::IShell* _service;
+    SourceTransfer* _transfer;
+    bool _closing;
 };
 
 SERVICE_REGISTRATION(ScriptEngineImplementation, 1, 0);
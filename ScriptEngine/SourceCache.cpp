@@ -0,0 +1,277 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SourceCache.h"
+
+#include <cstdio>
+
+namespace Thunder {
+namespace Plugin {
+
+    uint32_t SourceCache::View::Map(const string& path)
+    {
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+
+        Unmap();
+
+        Core::File file(path);
+
+        if (file.Exists() == true) {
+            if (file.Size() == 0) {
+                // Nothing to map, still a valid (empty) source.
+                _empty = true;
+                result = Core::ERROR_NONE;
+            } else {
+                _file = new Core::DataElementFile(path, Core::File::SHAREABLE | Core::File::USER_READ);
+
+                if (_file->IsValid() == true) {
+                    result = Core::ERROR_NONE;
+                } else {
+                    delete _file;
+                    _file = nullptr;
+                    result = Core::ERROR_OPENING_FAILED;
+                }
+            }
+        }
+
+        return (result);
+    }
+
+    void SourceCache::View::Unmap()
+    {
+        if (_file != nullptr) {
+            delete _file;
+            _file = nullptr;
+        }
+        _empty = false;
+    }
+
+    SourceCache::SourceCache(const string& root)
+        : _root(Core::Directory::Normalize(root))
+        , _valid(Core::Directory((_root + _T("objects")).c_str()).CreatePath())
+        , _entries()
+        , _staged(0)
+    {
+        if (_valid == true) {
+            Cleanup();
+            Load();
+        } else {
+            TRACE(Trace::Error, (_T("Could not create the script source cache in %s"), _root.c_str()));
+        }
+    }
+
+    bool SourceCache::Lookup(const string& url, Meta& meta) const
+    {
+        std::unordered_map<string, Meta>::const_iterator index(_entries.find(url));
+
+        if (index != _entries.end()) {
+            meta = index->second;
+        }
+
+        return (index != _entries.end());
+    }
+
+    string SourceCache::Staging()
+    {
+        return (_root + _T("objects/.staged.") + Core::NumberType<uint32_t>(_staged++).Text());
+    }
+
+    uint32_t SourceCache::Commit(const string& url, const string& staged, Meta&& meta)
+    {
+        uint32_t result = Core::ERROR_NONE;
+        const string object(Object(meta.Hash));
+
+        if (Core::File(object).Exists() == true) {
+            // Same content as we already have, for this or another URL.
+            Core::File(staged).Destroy();
+        } else if (::rename(staged.c_str(), object.c_str()) != 0) {
+            Core::File(staged).Destroy();
+            result = Core::ERROR_WRITE_ERROR;
+        }
+
+        if (result == Core::ERROR_NONE) {
+            std::unordered_map<string, Meta>::iterator index(_entries.find(url));
+            string previous;
+
+            if (index == _entries.end()) {
+                _entries.emplace(url, std::move(meta));
+            } else {
+                previous = std::move(index->second.Hash);
+                index->second = std::move(meta);
+            }
+
+            // The content this URL had before is dropped, if nothing else refers to it.
+            if ((previous.empty() == false) && (IsReferenced(previous) == false)) {
+                Core::File(Object(previous)).Destroy();
+            }
+
+            Save();
+        }
+
+        return (result);
+    }
+
+    void SourceCache::Revalidated(const string& url, const string& etag, const string& modified)
+    {
+        std::unordered_map<string, Meta>::iterator index(_entries.find(url));
+
+        if ((index != _entries.end()) && (((etag.empty() == false) && (etag != index->second.ETag)) || ((modified.empty() == false) && (modified != index->second.Modified)))) {
+            if (etag.empty() == false) {
+                index->second.ETag = etag;
+            }
+            if (modified.empty() == false) {
+                index->second.Modified = modified;
+            }
+
+            Save();
+        }
+    }
+
+    uint32_t SourceCache::Map(const string& url, View& view) const
+    {
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+        std::unordered_map<string, Meta>::const_iterator index(_entries.find(url));
+
+        if (index != _entries.end()) {
+            result = view.Map(Object(index->second.Hash));
+        }
+
+        return (result);
+    }
+
+    /* static */ string SourceCache::Hex(const uint8_t hash[], const uint8_t length)
+    {
+        static const TCHAR digits[] = _T("0123456789abcdef");
+        string result;
+
+        result.reserve(length * 2);
+
+        for (uint8_t index = 0; index < length; index++) {
+            result += digits[hash[index] >> 4];
+            result += digits[hash[index] & 0x0F];
+        }
+
+        return (result);
+    }
+
+    bool SourceCache::IsReferenced(const string& hash) const
+    {
+        std::unordered_map<string, Meta>::const_iterator index(_entries.begin());
+
+        while ((index != _entries.end()) && (index->second.Hash != hash)) {
+            index++;
+        }
+
+        return (index != _entries.end());
+    }
+
+    // Downloads that were in progress when the process went down, and an index that was never
+    // moved in place. Staging starts counting from 0 again, so they would not be reused either.
+    void SourceCache::Cleanup()
+    {
+        Core::Directory staged((_root + _T("objects")).c_str(), _T(".staged.*"));
+
+        while (staged.Next() == true) {
+            Core::File(staged.Current()).Destroy();
+        }
+
+        Core::File(_root + _T("index.staged")).Destroy();
+    }
+
+    // One line per URL: hash, size, ETag, Last-Modified and the URL, tab separated.
+    void SourceCache::Load()
+    {
+        Core::File index(_root + _T("index"));
+
+        if ((index.Exists() == true) && (index.Open(true) == true)) {
+            string content;
+            uint8_t buffer[1024];
+            uint32_t loaded;
+
+            content.reserve(static_cast<size_t>(index.Size()));
+
+            while ((loaded = index.Read(buffer, sizeof(buffer))) != 0) {
+                content.append(reinterpret_cast<const char*>(buffer), loaded);
+            }
+
+            size_t start = 0;
+
+            while (start < content.length()) {
+                size_t end = content.find('\n', start);
+                std::vector<string> fields;
+
+                if (end == string::npos) {
+                    end = content.length();
+                }
+
+                size_t field = start;
+                while ((fields.size() < 4) && (field < end)) {
+                    size_t tab = content.find('\t', field);
+
+                    if ((tab == string::npos) || (tab > end)) {
+                        break;
+                    }
+
+                    fields.emplace_back(content, field, tab - field);
+                    field = tab + 1;
+                }
+
+                // Entries of which the content went missing are forgotten.
+                if ((fields.size() == 4) && (field < end) && (Core::File(Object(fields[0])).Exists() == true)) {
+                    Meta meta;
+                    meta.Hash = std::move(fields[0]);
+                    meta.Size = static_cast<uint32_t>(std::strtoul(fields[1].c_str(), nullptr, 10));
+                    meta.ETag = std::move(fields[2]);
+                    meta.Modified = std::move(fields[3]);
+
+                    _entries.emplace(string(content, field, end - field), std::move(meta));
+                }
+
+                start = end + 1;
+            }
+        }
+    }
+
+    void SourceCache::Save() const
+    {
+        const string staged(_root + _T("index.staged"));
+        const string target(_root + _T("index"));
+        Core::File index(staged);
+
+        if (index.Create() == true) {
+            string content;
+
+            for (const auto& entry : _entries) {
+                content += entry.second.Hash + '\t' + Core::NumberType<uint32_t>(entry.second.Size).Text() + '\t' + entry.second.ETag + '\t' + entry.second.Modified + '\t' + entry.first + '\n';
+            }
+
+            const bool written = (index.Write(reinterpret_cast<const uint8_t*>(content.c_str()), static_cast<uint32_t>(content.length())) == content.length());
+
+            index.Close();
+
+            // Replaced in one go, a crash half way leaves the previous index.
+            if ((written == false) || (::rename(staged.c_str(), target.c_str()) != 0)) {
+                TRACE(Trace::Error, (_T("Could not store the script source index in %s"), _root.c_str()));
+                Core::File(staged).Destroy();
+            }
+        }
+    }
+
+} // namespace Plugin
+} // namespace Thunder
@@ -0,0 +1,147 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+namespace Thunder {
+namespace Plugin {
+
+    // Script sources, stored by the SHA-256 of their content in <root>/objects, and per URL what is
+    // needed to revalidate them (ETag, Last-Modified) in <root>/index. A source loaded from more
+    // than one URL is stored once. Not thread safe, the SourceTransfer serializes the access.
+    class SourceCache {
+    public:
+        struct Meta {
+            string Hash; // hex
+            string ETag;
+            string Modified;
+            uint32_t Size;
+        };
+
+        // A read only mapping of a source, handed to the engine as it is.
+        class View {
+        public:
+            View(const View&) = delete;
+            View& operator=(const View&) = delete;
+
+            View()
+                : _file(nullptr)
+                , _empty(false)
+            {
+            }
+            View(View&& move)
+                : _file(move._file)
+                , _empty(move._empty)
+            {
+                move._file = nullptr;
+                move._empty = false;
+            }
+            View& operator=(View&& move)
+            {
+                if (this != &move) {
+                    Unmap();
+                    _file = move._file;
+                    _empty = move._empty;
+                    move._file = nullptr;
+                    move._empty = false;
+                }
+                return (*this);
+            }
+            ~View()
+            {
+                Unmap();
+            }
+
+        public:
+            bool IsValid() const
+            {
+                return ((_file != nullptr) || (_empty == true));
+            }
+            const char* Data() const
+            {
+                return (_file != nullptr ? reinterpret_cast<const char*>(_file->Buffer()) : _T(""));
+            }
+            uint32_t Length() const
+            {
+                return (_file != nullptr ? static_cast<uint32_t>(_file->Size()) : 0);
+            }
+
+            uint32_t Map(const string& path);
+            void Unmap();
+
+        private:
+            Core::DataElementFile* _file;
+            bool _empty;
+        };
+
+    public:
+        SourceCache() = delete;
+        SourceCache(SourceCache&&) = delete;
+        SourceCache(const SourceCache&) = delete;
+        SourceCache& operator=(const SourceCache&) = delete;
+
+        explicit SourceCache(const string& root);
+        ~SourceCache() = default;
+
+    public:
+        bool IsValid() const
+        {
+            return (_valid);
+        }
+        uint32_t Entries() const
+        {
+            return (static_cast<uint32_t>(_entries.size()));
+        }
+
+        bool Lookup(const string& url, Meta& meta) const;
+
+        // Where the next download can be written to, before it is known what it holds.
+        string Staging();
+
+        // Moves a completed download into the store under its hash and remembers it for the url.
+        uint32_t Commit(const string& url, const string& staged, Meta&& meta);
+
+        // The url answered "not modified", the ETag or date may have been refreshed though.
+        void Revalidated(const string& url, const string& etag, const string& modified);
+
+        uint32_t Map(const string& url, View& view) const;
+
+        static string Hex(const uint8_t hash[], const uint8_t length);
+
+    private:
+        string Object(const string& hash) const
+        {
+            return (_root + _T("objects/") + hash);
+        }
+        bool IsReferenced(const string& hash) const;
+        void Cleanup();
+        void Load();
+        void Save() const;
+
+    private:
+        const string _root;
+        bool _valid;
+        std::unordered_map<string, Meta> _entries;
+        uint32_t _staged;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
@@ -4,7 +4,20 @@
 namespace Thunder {
     namespace Plugin {
 
-        /* static */ Core::ProxyPoolType<Web::Response> SourceTransfer::_responseFactory(1);
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
+        SourceTransfer::SourceTransfer(ICallback* callback, const string& storageSpace)
+            : _adminLock()
+            , _url()
+            , _location()
+            , _callback(callback)
+            , _cache(storageSpace)
+            , _source()
+            , _fetch()
+            , _completed()
+            , _job(*this) {
+            ASSERT(_callback != nullptr);
+        }
+POP_WARNING()
 
         uint32_t SourceTransfer::Download(const string& url) {
             uint32_t result = Core::ERROR_ILLEGAL_STATE;
@@ -21,44 +34,27 @@ namespace Thunder {
                     _adminLock.Unlock();
                 }
                 else if (_url.Type() == Core::URL::SchemeType::SCHEME_FILE) {
-                        
+
                     if ((_url.Path().IsSet() == false) || (Core::File(_url.Path().Value()).Exists() == false)) {
                         _adminLock.Unlock();
                         result = Core::ERROR_BAD_REQUEST;
                     }
+                    else if ((result = _source.Map(_url.Path().Value())) != Core::ERROR_NONE) {
+                        _adminLock.Unlock();
+                        result = Core::ERROR_OPENING_FAILED;
+                    }
                     else {
-                        Core::File content(_url.Path().Value());
-
-                        if (content.Open(true) == false) {
-                            _adminLock.Unlock();
-                            result = Core::ERROR_OPENING_FAILED;
-                        }
-                        else {
-                            uint32_t size = static_cast<uint32_t>(content.Size());
-                            _source.reserve(size);
-                            while (size != 0) {
-                                uint8_t buffer[1024];
-                                uint32_t readBytes = content.Read(buffer, sizeof(buffer));
-                                size -= readBytes;
-                                _source.append(reinterpret_cast<const char*>(buffer), readBytes);
-                            }
-                            _adminLock.Unlock();
-
-                            _callback->Transfered(url, Core::ERROR_NONE);
-                            result = Core::ERROR_NONE;
-                        }
+                        _adminLock.Unlock();
+
+                        _callback->Transfered(url, Core::ERROR_NONE);
                     }
                 }
-                else if (_url.Type() == Core::URL::SchemeType::SCHEME_HTTP) {
-                    _downloader = Core::ProxyType<WebClient>::Create(*this, _url);
-                    _adminLock.Unlock();
-                    result = Core::ERROR_INPROGRESS;
+                else if ((_url.Type() == Core::URL::SchemeType::SCHEME_HTTP) || (_url.Type() == Core::URL::SchemeType::SCHEME_HTTPS)) {
+                    _location = url;
 
-                }
-                else if (_url.Type() == Core::URL::SchemeType::SCHEME_HTTPS) {
-                    _downloader = Core::ProxyType<SecureWebClient>::Create(*this, _url);
-                    _adminLock.Unlock();
+                    Start(url);
 
+                    _adminLock.Unlock();
                     result = Core::ERROR_INPROGRESS;
                 }
                 else {
@@ -69,18 +65,130 @@ namespace Thunder {
             }
             return (result);
         }
+
         uint32_t SourceTransfer::Abort() {
+            Core::ProxyType<Core::IReferenceCounted> fetch;
 
             _adminLock.Lock();
 
-            if (_url.IsValid() == true) {
-                if (_downloader.IsValid() == true) {
-                    _downloader.Release();
-                }
-                _url.Clear();
+            fetch = std::move(_fetch);
+            _source.Unmap();
+            _url.Clear();
+            _location.clear();
+
+            _adminLock.Unlock();
+
+            // Closing the socket reports it as failed, outside the lock as that is taken to report.
+            fetch.Release();
+
+            _job.Revoke();
+
+            _adminLock.Lock();
+
+            for (const Completion& completion : _completed) {
+                Core::File(completion.Staged).Destroy();
             }
+            _completed.clear();
+
             _adminLock.Unlock();
+
             return (Core::ERROR_NONE);
         }
+
+        void SourceTransfer::Start(const string& url) {
+            Core::ProxyType<Core::IReferenceCounted> fetch;
+            SourceCache::Meta meta;
+            const bool cached = _cache.Lookup(url, meta);
+            const Core::URL info(url.c_str());
+            const string staged(_cache.Staging());
+
+            if (info.Type() == Core::URL::SchemeType::SCHEME_HTTP) {
+                fetch = Core::ProxyType<Fetch>::Create(*this, url, info, (cached == true ? &meta : nullptr), staged);
+            }
+            #if defined(SECURESOCKETS_ENABLED)
+            else if (info.Type() == Core::URL::SchemeType::SCHEME_HTTPS) {
+                fetch = Core::ProxyType<SecureFetch>::Create(*this, url, info, (cached == true ? &meta : nullptr), staged);
+            }
+            #endif
+
+            if (fetch.IsValid() == true) {
+                _fetch = std::move(fetch);
+            } else {
+                Fetched(url, Core::ERROR_NOT_SUPPORTED, false, staged, std::move(meta));
+            }
+        }
+
+        // Called from the socket, the rest happens on the job.
+        void SourceTransfer::Fetched(const string& url, const uint32_t result, const bool notModified, const string& staged, SourceCache::Meta&& meta) {
+            _adminLock.Lock();
+
+            _completed.push_back({ url, result, notModified, staged, std::move(meta) });
+            _job.Submit();
+
+            _adminLock.Unlock();
+        }
+
+        void SourceTransfer::Dispatch() {
+            bool report = false;
+            string location;
+            uint32_t result = Core::ERROR_NONE;
+
+            _adminLock.Lock();
+
+            while (_completed.empty() == false) {
+                Completion completion(std::move(_completed.front()));
+                _completed.pop_front();
+
+                if ((_fetch.IsValid() == true) && (completion.Url == _location)) {
+                    Core::ProxyType<Core::IReferenceCounted> fetch(std::move(_fetch));
+
+                    // The socket reports under the lock, so it is closed outside of it.
+                    _adminLock.Unlock();
+                    fetch.Release();
+                    _adminLock.Lock();
+                }
+
+                if (completion.Url == _location) {
+                    if ((result = Settle(completion)) == Core::ERROR_NONE) {
+                        result = _cache.Map(completion.Url, _source);
+                    }
+
+                    report = true;
+                    location = _location;
+                } else {
+                    // Aborted in the mean time.
+                    Core::File(completion.Staged).Destroy();
+                }
+            }
+
+            _adminLock.Unlock();
+
+            if (report == true) {
+                _callback->Transfered(location, result);
+            }
+        }
+
+        uint32_t SourceTransfer::Settle(Completion& completion) {
+            uint32_t result = completion.Result;
+
+            if ((result == Core::ERROR_NONE) && (completion.NotModified == true)) {
+                Core::File(completion.Staged).Destroy();
+                _cache.Revalidated(completion.Url, completion.Meta.ETag, completion.Meta.Modified);
+            } else if (result == Core::ERROR_NONE) {
+                result = _cache.Commit(completion.Url, completion.Staged, std::move(completion.Meta));
+            } else {
+                SourceCache::Meta cached;
+
+                Core::File(completion.Staged).Destroy();
+
+                // Offline, or the server is having a bad day: what was cached before still works.
+                if (_cache.Lookup(completion.Url, cached) == true) {
+                    TRACE(Trace::Information, (_T("Loading %s failed [%d], using the cached source"), completion.Url.c_str(), result));
+                    result = Core::ERROR_NONE;
+                }
+            }
+
+            return (result);
+        }
     }
-}
\ No newline at end of file
+}
@@ -1,80 +1,237 @@
 #pragma once
 
 #include "Module.h"
+#include "SourceCache.h"
 
 namespace Thunder {
 	namespace Plugin {
 		class SourceTransfer {
 		private:
+            // One source over HTTP/1.0, so the server ends the body by closing and nothing comes
+            // chunked. What is cached goes along as If-None-Match/If-Modified-Since and the body is
+            // written to disk, and hashed, as it comes in.
             template<typename SOCKETPORT>
-            class WebClientType : public Web::WebLinkType<SOCKETPORT, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&> {
+            class FetchType : public Core::StreamType<SOCKETPORT> {
             private:
-                using BaseClass = Web::WebLinkType<SOCKETPORT, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&>;
+                using BaseClass = Core::StreamType<SOCKETPORT>;
+
+                static constexpr uint16_t MaxHeader = 8192;
 
             public:
-                WebClientType() = delete;
-                WebClientType(WebClientType<SOCKETPORT>&& copy) = delete;
-                WebClientType(const WebClientType<SOCKETPORT>& copy) = delete;
-                WebClientType<SOCKETPORT>& operator=(const WebClientType<SOCKETPORT>&) = delete;
+                FetchType() = delete;
+                FetchType(FetchType<SOCKETPORT>&& copy) = delete;
+                FetchType(const FetchType<SOCKETPORT>& copy) = delete;
+                FetchType<SOCKETPORT>& operator=(const FetchType<SOCKETPORT>&) = delete;
 
-                WebClientType(SourceTransfer& parent, const Core::URL& url)
-                    : BaseClass(5, _responseFactory, Core::SocketPort::STREAM, Core::NodeId(), Core::NodeId(), 2048, 2048)
+                FetchType(SourceTransfer& parent, const string& url, const Core::URL& info, const SourceCache::Meta* cached, const string& staged)
+                    : BaseClass(Core::SocketPort::STREAM, Remote(info).AnyInterface(), Remote(info), 1024, 16384)
                     , _parent(parent)
+                    , _url(url)
                     , _request()
-                    , _content() {
-                    if (url.Host().IsSet() == true) {
-                        Core::NodeId nodeId(url.Host().Value().c_str(), url.Port().Value());
-                        BaseClass::Link().RemoteNode(nodeId);
-                        BaseClass::Link().LocalNode(nodeId.AnyInterface());
+                    , _offset(0)
+                    , _header()
+                    , _status(0)
+                    , _length(~0)
+                    , _received(0)
+                    , _etag()
+                    , _modified()
+                    , _staged(staged)
+                    , _storage(staged)
+                    , _hash()
+                    , _completed(false) {
+
+                    if ((info.Host().IsSet() == true) && (_storage.Create() == true)) {
+                        string path(info.Path().IsSet() == true ? info.Path().Value() : string());
+
+                        if ((path.empty() == true) || (path[0] != '/')) {
+                            path.insert(0, 1, '/');
+                        }
 
-                        _request.Verb = Web::Request::HTTP_GET;
-                        _request.Path = url.Path().Value();
+                        _request = _T("GET ") + path +
+                                   (info.Query().IsSet() == true ? _T("?") + info.Query().Value() : string()) + _T(" HTTP/1.0\r\n") +
+                                   _T("Host: ") + info.Host().Value() + _T("\r\n") +
+                                   _T("Accept-Encoding: identity\r\n") +
+                                   _T("Connection: close\r\n");
 
-                        uint32_t result = BaseClass::Open(100);
+                        if (cached != nullptr) {
+                            if (cached->ETag.empty() == false) {
+                                _request += _T("If-None-Match: ") + cached->ETag + _T("\r\n");
+                            }
+                            if (cached->Modified.empty() == false) {
+                                _request += _T("If-Modified-Since: ") + cached->Modified + _T("\r\n");
+                            }
+                        }
+                        _request += _T("\r\n");
+
+                        uint32_t result = BaseClass::Open(0);
 
                         if ((result != Core::ERROR_INPROGRESS) && (result != Core::ERROR_NONE)) {
-                            _request.Verb = Web::Request::HTTP_NONE;
-                            BaseClass::Close(0);
+                            Complete(result);
                         }
+                    } else {
+                        Complete(Core::ERROR_OPENING_FAILED);
                     }
                 }
-                ~WebClientType() override {
+                ~FetchType() override {
                     BaseClass::Close(Core::infinite);
+
+                    if (_storage.IsOpen() == true) {
+                        _storage.Close();
+                    }
                 }
 
             public:
-                // Notification of a Partial Request received, time to attach a body..
-                void LinkBody(Core::ProxyType<Web::Response>& element) override {
-                    // Time to attach a String Body
-                    element->Body<Web::TextBody>(Core::ProxyType<Web::TextBody>(_content));
-                }
-                void Received(Core::ProxyType<Web::Response>& element) override {
-                    _request.Verb = Web::Request::HTTP_NONE;
-                    _parent.StateChange(element->ErrorCode == Web::WebStatus::STATUS_OK ? Core::ERROR_NONE : Core::ERROR_BAD_REQUEST);
+                uint16_t SendData(uint8_t* dataFrame, const uint16_t maxSendSize) override {
+                    uint16_t size = static_cast<uint16_t>(std::min(_request.length() - _offset, static_cast<size_t>(maxSendSize)));
+
+                    ::memcpy(dataFrame, &(_request.c_str()[_offset]), size);
+                    _offset += size;
+
+                    return (size);
                 }
-                void Send(const Core::ProxyType<Web::Request>& response) override {
+                uint16_t ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize) override {
+                    uint16_t offset = 0;
+
+                    while ((_status == 0) && (_completed == false) && (offset < receivedSize)) {
+                        _header += static_cast<char>(dataFrame[offset++]);
+
+                        if ((_header.length() >= 4) && (_header.compare(_header.length() - 4, 4, _T("\r\n\r\n")) == 0)) {
+                            Header();
+                        } else if (_header.length() > MaxHeader) {
+                            Complete(Core::ERROR_INVALID_INPUT_LENGTH);
+                        }
+                    }
+
+                    if ((_completed == false) && (_status == Web::WebStatus::STATUS_OK) && (offset < receivedSize)) {
+                        const uint16_t size = receivedSize - offset;
+
+                        if (_storage.Write(&(dataFrame[offset]), size) != size) {
+                            Complete(Core::ERROR_WRITE_ERROR);
+                        } else {
+                            _hash.Input(&(dataFrame[offset]), size);
+                            _received += size;
+
+                            if (_received >= _length) {
+                                Complete(Core::ERROR_NONE);
+                            }
+                        }
+                    }
+
+                    return (receivedSize);
                 }
                 void StateChange() override {
-                    if ((BaseClass::IsOpen() == false) && (_request.Verb == Web::Request::HTTP_GET)) {
-                        _request.Verb = Web::Request::HTTP_NONE;
-                        _parent.StateChange(Core::ERROR_ASYNC_FAILED);
+                    if (BaseClass::IsOpen() == true) {
+                        BaseClass::Trigger();
+                    } else if (_completed == false) {
+                        // Without a Content-Length, the close ends the body.
+                        Complete(((_status == Web::WebStatus::STATUS_OK) && (_length == static_cast<uint32_t>(~0))) || (_status == Web::WebStatus::STATUS_NOT_MODIFIED) ? Core::ERROR_NONE : Core::ERROR_ASYNC_FAILED);
+                    }
+                }
+
+            private:
+                static Core::NodeId Remote(const Core::URL& info) {
+                    const uint16_t port = (info.Port().IsSet() == true ? info.Port().Value() : (info.Type() == Core::URL::SchemeType::SCHEME_HTTPS ? 443 : 80));
+
+                    return (info.Host().IsSet() == true ? Core::NodeId(info.Host().Value().c_str(), port) : Core::NodeId());
+                }
+                static bool Is(const string& line, const size_t colon, const TCHAR name[]) {
+                    const size_t length = std::char_traits<TCHAR>::length(name);
+                    bool result = (colon == length);
+
+                    for (size_t index = 0; (result == true) && (index < length); index++) {
+                        result = (::tolower(line[index]) == name[index]);
+                    }
+
+                    return (result);
+                }
+                void Header() {
+                    size_t start = _header.find(' ');
+
+                    _status = (start != string::npos ? static_cast<uint16_t>(std::strtoul(&(_header.c_str()[start + 1]), nullptr, 10)) : 0);
+                    start = _header.find(_T("\r\n"));
+
+                    while ((start != string::npos) && ((start + 2) < _header.length())) {
+                        const size_t end = _header.find(_T("\r\n"), start + 2);
+                        const string line(_header, start + 2, (end == string::npos ? string::npos : end - start - 2));
+                        const size_t colon = line.find(':');
+
+                        if (colon != string::npos) {
+                            const size_t value = line.find_first_not_of(_T(" \t"), colon + 1);
+                            const string content(value != string::npos ? line.substr(value) : string());
+
+                            if (Is(line, colon, _T("etag")) == true) {
+                                _etag = content;
+                            } else if (Is(line, colon, _T("last-modified")) == true) {
+                                _modified = content;
+                            } else if (Is(line, colon, _T("content-length")) == true) {
+                                _length = static_cast<uint32_t>(std::strtoul(content.c_str(), nullptr, 10));
+                            }
+                        }
+
+                        start = end;
                     }
+
+                    if (_status == Web::WebStatus::STATUS_NOT_MODIFIED) {
+                        Complete(Core::ERROR_NONE);
+                    } else if (_status != Web::WebStatus::STATUS_OK) {
+                        Complete(Core::ERROR_BAD_REQUEST);
+                    } else if (_length == 0) {
+                        Complete(Core::ERROR_NONE);
+                    }
+
+                    _header.clear();
                 }
-                void Load(string content) {
-                    content = std::move(_content);
+                void Complete(const uint32_t result) {
+                    if (_completed == false) {
+                        _completed = true;
+
+                        if (_storage.IsOpen() == true) {
+                            _storage.Close();
+                        }
+
+                        SourceCache::Meta meta;
+                        meta.Size = _received;
+                        meta.ETag = _etag;
+                        meta.Modified = _modified;
+
+                        if ((result == Core::ERROR_NONE) && (_status == Web::WebStatus::STATUS_OK)) {
+                            meta.Hash = SourceCache::Hex(_hash.Result(), Crypto::HASH_SHA256);
+                        }
+
+                        _parent.Fetched(_url, result, (_status == Web::WebStatus::STATUS_NOT_MODIFIED), _staged, std::move(meta));
+                    }
                 }
 
             private:
                 SourceTransfer& _parent;
-                Core::ProxyObject<Web::Request> _request;
-                Core::ProxyObject<Web::TextBody> _content;
+                const string _url;
+                string _request;
+                size_t _offset;
+                string _header;
+                uint16_t _status;
+                uint32_t _length;
+                uint32_t _received;
+                string _etag;
+                string _modified;
+                const string _staged;
+                Core::File _storage;
+                Crypto::SHA256 _hash;
+                bool _completed;
             };
 
-            using WebClient       = WebClientType<Core::SocketPort>;
+            using Fetch       = FetchType<Core::SocketPort>;
             #if defined(SECURESOCKETS_ENABLED)
-            using SecureWebClient = WebClientType<Crypto::SecureSocketPort>;
+            using SecureFetch = FetchType<Crypto::SecureSocketPort>;
             #endif
 
+            struct Completion {
+                string Url;
+                uint32_t Result;
+                bool NotModified;
+                string Staged;
+                SourceCache::Meta Meta;
+            };
+
         public:
 			struct ICallback {
 				virtual ~ICallback() = default;
@@ -87,48 +244,60 @@ namespace Thunder {
 			SourceTransfer(const SourceTransfer&) = delete;
 			SourceTransfer& operator= (const SourceTransfer&) = delete;
 
-			SourceTransfer(ICallback* callback, const string& storageSpace)
-				: _adminLock()
-                , _url()
-				, _callback(callback)
-				, _source()
-                , _downloader() {
-			}
+            // The source is kept in storageSpace.
+			SourceTransfer(ICallback* callback, const string& storageSpace);
 			~SourceTransfer() {
 				Abort();
 			}
 
 		public:
             inline void Reset() {
-                _url.Clear();
+                Abort();
             }
             inline bool IsValid() const {
+                Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
                 return (_url.IsValid());
             }
             inline bool IsLoaded() const {
-                return ((_url.IsValid()) && (_downloader.IsValid() == false));
+                Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
+                return ((_url.IsValid()) && (_source.IsValid() == true));
             }
-            inline const string& Source() const {
-                return(_source);
+            // Mapped from the cache (or the file for file:// URLs), it is not copied. The mapping
+            // stays until the next Abort(), so whoever runs it must be done before that.
+            inline bool Source(const TCHAR*& data, uint32_t& length) const {
+                Core::SafeSyncType<Core::CriticalSection> scopedLock(_adminLock);
+
+                const bool loaded = ((_url.IsValid()) && (_source.IsValid() == true));
+
+                if (loaded == true) {
+                    data = _source.Data();
+                    length = _source.Length();
+                }
+
+                return (loaded);
             }
+
             uint32_t Download(const string& url);
 			uint32_t Abort();
 
         private:
-            void StateChange(const uint32_t error) {
-            }
+            friend Core::ThreadPool::JobType<SourceTransfer&>;
+            void Dispatch();
+
+            void Start(const string& url);
+            void Fetched(const string& url, const uint32_t result, const bool notModified, const string& staged, SourceCache::Meta&& meta);
+            uint32_t Settle(Completion& completion);
 
         private:
-            Core::CriticalSection _adminLock;
+            mutable Core::CriticalSection _adminLock;
 			Core::URL _url;
+            string _location;
 			ICallback* _callback;
-            string _source;
-            Core::ProxyType<Core::IReferenceCounted> _downloader;
-
-            // All requests needed by any instance of this socket class, is coming from this static factory.
-            // This means that all Requests, received are shared among all WebServer sockets, hopefully limiting
-            // the number of requests that need to be created.
-            static Core::ProxyPoolType<Web::Response> _responseFactory;
+            SourceCache _cache;
+            SourceCache::View _source;
+            Core::ProxyType<Core::IReferenceCounted> _fetch;
+            std::list<Completion> _completed;
+            Core::WorkerPool::JobType<SourceTransfer&> _job;
 		};
 	}
 }
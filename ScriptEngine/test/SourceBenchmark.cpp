@@ -0,0 +1,372 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Time from the Download until the source is there to run. From an origin on loopback that
+// answers conditional requests: with an empty cache, with a cache the origin only has to confirm
+// and with the origin gone, where the cache is all there is.
+
+#include "Module.h"
+#include "SourceTransfer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <thread>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace Thunder;
+
+namespace {
+
+class WorkerPoolImplementation : public Core::WorkerPool {
+private:
+    class Dispatcher : public Core::ThreadPool::IDispatcher {
+    public:
+        Dispatcher(const Dispatcher&) = delete;
+        Dispatcher& operator=(const Dispatcher&) = delete;
+
+        Dispatcher() = default;
+        ~Dispatcher() override = default;
+
+    private:
+        void Initialize() override {}
+        void Deinitialize() override {}
+        void Dispatch(Core::IDispatch* job) override
+        {
+            ASSERT(job != nullptr);
+            job->Dispatch();
+        }
+    };
+
+public:
+    WorkerPoolImplementation() = delete;
+    WorkerPoolImplementation(const WorkerPoolImplementation&) = delete;
+    WorkerPoolImplementation& operator=(const WorkerPoolImplementation&) = delete;
+
+    WorkerPoolImplementation(const uint8_t threads, const uint32_t stackSize, const uint32_t queueSize)
+        : WorkerPool(threads, stackSize, queueSize, &_dispatcher)
+        , _dispatcher()
+    {
+    }
+    ~WorkerPoolImplementation()
+    {
+        Core::WorkerPool::Stop();
+    }
+
+    void Run()
+    {
+        Core::WorkerPool::Run();
+        Core::WorkerPool::Join();
+    }
+    void Stop()
+    {
+        Core::WorkerPool::Stop();
+    }
+
+private:
+    Dispatcher _dispatcher;
+};
+
+// Serves the sources, one request per connection, with an ETag per source.
+class Origin : public Core::Thread {
+public:
+    Origin(const Origin&) = delete;
+    Origin& operator=(const Origin&) = delete;
+
+    Origin()
+        : Core::Thread()
+        , _socket(-1)
+        , _port(0)
+        , _sources()
+        , _requests(0)
+        , _sent(0)
+    {
+    }
+    ~Origin() override
+    {
+        Close();
+    }
+
+public:
+    void Add(const string& path, const string& content)
+    {
+        _sources[path] = content;
+    }
+    bool Open()
+    {
+        struct sockaddr_in address {};
+        socklen_t length = sizeof(address);
+
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+
+        _socket = ::socket(AF_INET, SOCK_STREAM, 0);
+
+        if ((_socket != -1) && (::bind(_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0) && (::listen(_socket, 16) == 0) && (::getsockname(_socket, reinterpret_cast<struct sockaddr*>(&address), &length) == 0)) {
+            _port = ntohs(address.sin_port);
+            Run();
+        }
+
+        return (_port != 0);
+    }
+    void Close()
+    {
+        if (_socket != -1) {
+            Stop();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+            ::close(_socket);
+            _socket = -1;
+        }
+    }
+    string Url(const string& path) const
+    {
+        return (_T("http://127.0.0.1:") + Core::NumberType<uint16_t>(_port).Text() + path);
+    }
+    void Reset()
+    {
+        _requests = 0;
+        _sent = 0;
+    }
+    uint32_t Requests() const
+    {
+        return (_requests);
+    }
+    uint32_t Sent() const
+    {
+        return (_sent);
+    }
+
+private:
+    static string ETag(const string& content)
+    {
+        return (_T("\"") + Core::NumberType<uint32_t>(static_cast<uint32_t>(std::hash<string>()(content))).Text() + _T("\""));
+    }
+    uint32_t Worker() override
+    {
+        struct pollfd pending { _socket, POLLIN, 0 };
+
+        if ((::poll(&pending, 1, 100) == 1) && ((pending.revents & POLLIN) != 0)) {
+            int connection = ::accept(_socket, nullptr, nullptr);
+
+            if (connection != -1) {
+                Serve(connection);
+                ::close(connection);
+            }
+        }
+
+        return (0);
+    }
+    void Serve(const int connection)
+    {
+        string request;
+        char buffer[1024];
+        ssize_t loaded;
+
+        while ((request.find(_T("\r\n\r\n")) == string::npos) && ((loaded = ::recv(connection, buffer, sizeof(buffer), 0)) > 0)) {
+            request.append(buffer, loaded);
+        }
+
+        const size_t start = request.find(' ') + 1;
+        const string path(request, start, request.find(' ', start) - start);
+        std::map<string, string>::const_iterator index(_sources.find(path));
+        string response;
+        string body;
+
+        _requests++;
+
+        if (index == _sources.end()) {
+            response = _T("HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+        } else {
+            const string etag(ETag(index->second));
+
+            if (request.find(_T("If-None-Match: ") + etag) != string::npos) {
+                response = _T("HTTP/1.0 304 Not Modified\r\nETag: ") + etag + _T("\r\n\r\n");
+            } else {
+                response = _T("HTTP/1.0 200 OK\r\nETag: ") + etag + _T("\r\nContent-Length: ") + Core::NumberType<uint32_t>(static_cast<uint32_t>(index->second.length())).Text() + _T("\r\n\r\n");
+                body = index->second;
+                _sent += static_cast<uint32_t>(body.length());
+            }
+        }
+
+        response += body;
+
+        size_t offset = 0;
+        ssize_t written;
+
+        while ((offset < response.length()) && ((written = ::send(connection, &(response[offset]), response.length() - offset, MSG_NOSIGNAL)) > 0)) {
+            offset += written;
+        }
+    }
+
+private:
+    int _socket;
+    uint16_t _port;
+    std::map<string, string> _sources;
+    std::atomic<uint32_t> _requests;
+    std::atomic<uint32_t> _sent;
+};
+
+class Loader : public Plugin::SourceTransfer::ICallback {
+public:
+    Loader(const Loader&) = delete;
+    Loader& operator=(const Loader&) = delete;
+
+    Loader()
+        : _loaded(false, true)
+        , _result(Core::ERROR_UNAVAILABLE)
+    {
+    }
+    ~Loader() override = default;
+
+public:
+    void Transfered(const string& /* url */, const uint32_t result) override
+    {
+        _result = result;
+        _loaded.SetEvent();
+    }
+    uint32_t Wait()
+    {
+        return (_loaded.Lock(5000) == Core::ERROR_NONE ? _result : Core::ERROR_TIMEDOUT);
+    }
+
+private:
+    Core::Event _loaded;
+    uint32_t _result;
+};
+
+using Clock = std::chrono::steady_clock;
+
+using Sources = std::map<string, string>;
+
+Sources Application()
+{
+    Sources sources;
+    string bundle(_T("const ui = { render: function (state) { return state; } };\nui.render({});\n"));
+
+    // A bundled application, to have something that takes more than one read to come in.
+    while (bundle.length() < (256 * 1024)) {
+        bundle += _T("// layout, animation and focus handling of the framework\n");
+    }
+
+    sources[_T("/app/main.js")] = bundle;
+    // Served as well, it is not what is loaded.
+    sources[_T("/app/other.js")] = _T("console.log('not this one');\n");
+
+    return (sources);
+}
+
+bool Same(const TCHAR data[], const uint32_t length, const string& content)
+{
+    return ((length == content.length()) && (::memcmp(data, content.c_str(), content.length()) == 0));
+}
+
+double Load(Origin& origin, const Sources& sources, const string& cache, bool& correct)
+{
+    Loader loader;
+    Plugin::SourceTransfer transfer(&loader, cache);
+
+    const Clock::time_point start = Clock::now();
+
+    uint32_t result = transfer.Download(origin.Url(_T("/app/main.js")));
+
+    if (result == Core::ERROR_INPROGRESS) {
+        result = loader.Wait();
+    }
+
+    const double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    const TCHAR* data = nullptr;
+    uint32_t length = 0;
+
+    correct = (result == Core::ERROR_NONE) && (transfer.Source(data, length) == true) && (Same(data, length, sources.at(_T("/app/main.js"))) == true) && correct;
+
+    return (elapsed);
+}
+
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    bool correct = true;
+    const Sources sources(Application());
+    const string cache(_T("/tmp/scriptenginesourcetest.") + Core::NumberType<uint32_t>(static_cast<uint32_t>(::getpid())).Text() + _T("/"));
+
+    {
+        Core::ProxyType<WorkerPoolImplementation> engine(Core::ProxyType<WorkerPoolImplementation>::Create(2, Core::Thread::DefaultStackSize(), 16));
+        Core::IWorkerPool::Assign(&(*engine));
+
+        std::thread([&engine]() { engine->Run(); }).detach();
+
+        Origin origin;
+
+        for (const auto& source : sources) {
+            origin.Add(source.first, source.second);
+        }
+
+        if (origin.Open() == false) {
+            printf("origin                  : could not listen on loopback\n");
+            correct = false;
+        } else {
+            // What a download that was cut short by a crash leaves behind.
+            const string leftover(cache + _T("objects/.staged.7"));
+
+            Core::Directory((cache + _T("objects")).c_str()).CreatePath();
+            Core::File(leftover).Create();
+
+            double elapsed = Load(origin, sources, cache, correct);
+            printf("cold (empty cache)      : %7.2f ms, %u requests, %u bytes\n", elapsed, origin.Requests(), origin.Sent());
+
+            // Only the source itself, nothing else is fetched, and the leftover is cleaned up.
+            correct = correct && (origin.Requests() == 1) && (Core::File(leftover).Exists() == false);
+
+            origin.Reset();
+
+            elapsed = Load(origin, sources, cache, correct);
+            printf("warm (revalidated)      : %7.2f ms, %u requests, %u bytes\n", elapsed, origin.Requests(), origin.Sent());
+
+            // All answered "not modified", no source came over again.
+            correct = correct && (origin.Sent() == 0);
+
+            origin.Close();
+
+            elapsed = Load(origin, sources, cache, correct);
+            printf("offline (stale cache)   : %7.2f ms, origin gone\n", elapsed);
+        }
+
+        Core::IWorkerPool::Assign(nullptr);
+        engine->Stop();
+    }
+
+    Core::Directory(cache.c_str()).Destroy();
+
+    printf("sources                 : %s\n", (correct == true ? "complete" : "FAILED"));
+
+    Core::Singleton::Dispose();
+
+    return (correct == true ? 0 : 1);
+}
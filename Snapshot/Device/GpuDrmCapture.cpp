@@ -18,10 +18,13 @@
  */
 
 #include "../Module.h"
+#include "../Streaming.h"
 
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <drm/drm.h>
 #include <drm/drm_mode.h>
 #include <drm/drm_fourcc.h>
@@ -34,14 +37,43 @@
 #include <GLES2/gl2ext.h>
 #include <interfaces/ICapture.h>
 #include <chrono>
+#include <map>
 #include <vector>
 #include <string>
 #include <memory>
 #include <algorithm>
 
+// OpenGL ES 3.0 pixel pack buffers and fences, for the asynchronous readback. The headers are
+// the GLES2 ones, the entry points are looked up when the context turns out to be 3.0 or up.
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+
 namespace Thunder {
 namespace Plugin {
 
+    typedef struct __GLsync* SyncObject;
+    typedef void* (GL_APIENTRYP MapBufferRangeFunction)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+    typedef GLboolean (GL_APIENTRYP UnmapBufferFunction)(GLenum target);
+    typedef SyncObject (GL_APIENTRYP FenceSyncFunction)(GLenum condition, GLbitfield flags);
+    typedef GLenum (GL_APIENTRYP ClientWaitSyncFunction)(SyncObject sync, GLbitfield flags, uint64_t timeout);
+    typedef void (GL_APIENTRYP DeleteSyncFunction)(SyncObject sync);
+
     /**
      * Framebuffer format information including multi-plane support
      */
@@ -119,11 +151,18 @@ namespace Plugin {
         MULTI_PLANE_YUV
     };
 
-    class GpuDrmCapture : public Exchange::ICapture {
+    class GpuDrmCapture : public Exchange::ICapture, public IStreaming {
     private:
         GpuDrmCapture(const GpuDrmCapture&) = delete;
         GpuDrmCapture& operator=(const GpuDrmCapture&) = delete;
 
+        // Scanout buffers imported per monitor, a compositor flips between two or three.
+        static constexpr uint8_t MaxImports = 4;
+        // While streaming the CRTCs are followed frame by frame, connectors are rescanned this often (ms).
+        static constexpr uint32_t TopologyInterval = 2000;
+        static constexpr uint32_t VSyncTimeout = 100; // ms
+        static constexpr uint64_t ReadbackTimeout = 100000000; // ns
+
         /**
          * Represents a single monitor/display output with GPU texture binding
          */
@@ -150,6 +189,17 @@ namespace Plugin {
             // VSync support
             uint32_t crtcIndex; // Index for vblank events
             bool vsyncEnabled;
+            bool vblankPending;
+
+            // Framebuffers imported earlier, texture and eglImage above are one of these. DRM hands
+            // out the id of a removed framebuffer again, so the buffer behind it is part of the key.
+            struct Import {
+                uint32_t framebufferId;
+                ino_t buffer; // inode of the dma-buf of the first plane
+                GLuint texture;
+                EGLImage eglImage;
+            };
+            std::vector<Import> imports;
 
             MonitorInfo()
                 : connectorId(0)
@@ -169,6 +219,22 @@ namespace Plugin {
                 , formatType(FormatType::UNSUPPORTED)
                 , crtcIndex(0)
                 , vsyncEnabled(false)
+                , vblankPending(false)
+                , imports()
+            {
+            }
+        };
+
+        /**
+         * A vblank event queued on a CRTC, the event carries this as its user data
+         */
+        struct VBlank {
+            uint32_t sequence; // the vblank the last request is for
+            bool arrived;
+
+            VBlank()
+                : sequence(0)
+                , arrived(false)
             {
             }
         };
@@ -217,6 +283,24 @@ namespace Plugin {
             // Platform capabilities
             bool hasModifierSupport;
 
+            // OpenGL ES 3.0 entry points, all set or none
+            MapBufferRangeFunction glMapBufferRange;
+            UnmapBufferFunction glUnmapBuffer;
+            FenceSyncFunction glFenceSync;
+            ClientWaitSyncFunction glClientWaitSync;
+            DeleteSyncFunction glDeleteSync;
+
+            // Double buffered readback: a frame is read into one pack buffer while the other is mapped
+            GLuint packBuffers[2];
+            SyncObject packFences[2];
+            bool packValid[2];
+            uint32_t packSize;
+            uint8_t packIndex;
+            int8_t packMapped;
+
+            // Synchronous readback, kept from frame to frame
+            std::vector<uint8_t> readbackBuffer;
+
             GpuContext(int fd, const std::string& path)
                 : drmFd(fd)
                 , devicePath(path)
@@ -246,7 +330,36 @@ namespace Plugin {
                 , compositionWidth(0)
                 , compositionHeight(0)
                 , hasModifierSupport(false)
+                , glMapBufferRange(nullptr)
+                , glUnmapBuffer(nullptr)
+                , glFenceSync(nullptr)
+                , glClientWaitSync(nullptr)
+                , glDeleteSync(nullptr)
+                , packBuffers { 0, 0 }
+                , packFences { nullptr, nullptr }
+                , packValid { false, false }
+                , packSize(0)
+                , packIndex(0)
+                , packMapped(-1)
+                , readbackBuffer()
+            {
+            }
+
+            bool HasAsyncReadback() const
             {
+                return (glMapBufferRange != nullptr);
+            }
+
+            // Whatever is in the pack buffers is of no use anymore, needs the context current
+            void ResetPackBuffers()
+            {
+                for (uint8_t index = 0; index < 2; ++index) {
+                    if (packFences[index] != nullptr) {
+                        glDeleteSync(packFences[index]);
+                        packFences[index] = nullptr;
+                    }
+                    packValid[index] = false;
+                }
             }
 
             ~GpuContext()
@@ -270,6 +383,19 @@ namespace Plugin {
                     if (compositionTexture)
                         glDeleteTextures(1, &compositionTexture);
 
+                    // Cleanup readback resources
+                    if (HasAsyncReadback()) {
+                        if (packMapped >= 0) {
+                            glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffers[packMapped]);
+                            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                            packMapped = -1;
+                        }
+                        ResetPackBuffers();
+                    }
+                    if (packBuffers[0])
+                        glDeleteBuffers(2, packBuffers);
+
                     // Cleanup blit resources
                     if (blitVertexBuffer)
                         glDeleteBuffers(1, &blitVertexBuffer);
@@ -313,19 +439,29 @@ namespace Plugin {
                     glDeleteFramebuffers(1, &monitor.framebuffer);
                     monitor.framebuffer = 0;
                 }
-                if (monitor.texture) {
-                    glDeleteTextures(1, &monitor.texture);
-                    monitor.texture = 0;
-                }
-                if (monitor.eglImage != EGL_NO_IMAGE_KHR && eglDestroyImageKHR) {
-                    eglDestroyImageKHR(eglDisplay, monitor.eglImage);
-                    monitor.eglImage = EGL_NO_IMAGE_KHR;
+                for (auto& import : monitor.imports) {
+                    ReleaseImport(import);
                 }
+                monitor.imports.clear();
+                monitor.texture = 0;
+                monitor.eglImage = EGL_NO_IMAGE_KHR;
                 monitor.gpuResourcesReady = false;
 
                 // Force GPU completion after cleanup
                 glFlush();
             }
+
+            void ReleaseImport(MonitorInfo::Import& import)
+            {
+                if (import.texture) {
+                    glDeleteTextures(1, &import.texture);
+                    import.texture = 0;
+                }
+                if (import.eglImage != EGL_NO_IMAGE_KHR && eglDestroyImageKHR) {
+                    eglDestroyImageKHR(eglDisplay, import.eglImage);
+                    import.eglImage = EGL_NO_IMAGE_KHR;
+                }
+            }
         };
 
         /**
@@ -490,6 +626,48 @@ namespace Plugin {
             return false;
         }
 
+        /**
+         * Identify the buffer behind a framebuffer id: the dma-buf of its first plane is the same file for
+         * as long as the buffer exists. Only a few ioctls, much cheaper than importing it again.
+         */
+        static bool FramebufferBuffer(int drmFd, uint32_t fbId, ino_t& buffer)
+        {
+            bool result = false;
+            uint32_t handles[4] = { 0, 0, 0, 0 };
+
+            drmModeFB2* fb2 = drmModeGetFB2(drmFd, fbId);
+            if (fb2) {
+                std::copy(fb2->handles, fb2->handles + 4, handles);
+                drmModeFreeFB2(fb2);
+            } else {
+                drmModeFB* fb = drmModeGetFB(drmFd, fbId);
+                if (fb) {
+                    handles[0] = fb->handle;
+                    drmModeFreeFB(fb);
+                }
+            }
+
+            int planeFd = -1;
+            if ((handles[0] != 0) && (drmPrimeHandleToFD(drmFd, handles[0], DRM_CLOEXEC, &planeFd) == 0)) {
+                struct stat info;
+                if (fstat(planeFd, &info) == 0) {
+                    buffer = info.st_ino;
+                    result = true;
+                }
+                close(planeFd);
+            }
+
+            // Every GETFB(2) hands out new GEM handles, planes of the same buffer share one
+            for (uint8_t index = 0; index < 4; ++index) {
+                if ((handles[index] != 0) && (std::find(handles, handles + index, handles[index]) == handles + index)) {
+                    struct drm_gem_close request = { handles[index], 0 };
+                    drmIoctl(drmFd, DRM_IOCTL_GEM_CLOSE, &request);
+                }
+            }
+
+            return result;
+        }
+
         /**
          * Get appropriate fragment shader for format
          */
@@ -677,33 +855,84 @@ namespace Plugin {
         }
 
         /**
-         * Wait for VSync on a specific monitor for stable frame capture
+         * Wait for the next VSync on all monitors at once, instead of one monitor after the other
          */
-        bool WaitForVSync(const MonitorInfo& monitor)
+        void WaitForVSyncs(const std::vector<MonitorInfo*>& monitors)
         {
-            if (!monitor.vsyncEnabled) {
-                return true; // Skip VSync if not supported
+            auto vsyncStart = std::chrono::high_resolution_clock::now();
+            std::vector<struct pollfd> slots;
+            std::vector<std::pair<MonitorInfo*, VBlank*>> waiting;
+            uint32_t pending = 0;
+
+            // Queue a vblank event on every CRTC, these come in on the DRM file descriptors
+            for (auto* monitor : monitors) {
+                monitor->vblankPending = false;
+
+                if (monitor->vsyncEnabled) {
+                    VBlank& entry(_vblanks[std::make_pair(monitor->drmFd, monitor->crtcId)]);
+                    drmVBlank vblank = {};
+
+                    entry.arrived = false;
+
+                    vblank.request.type = (drmVBlankSeqType)(DRM_VBLANK_RELATIVE | DRM_VBLANK_EVENT | (monitor->crtcIndex << DRM_VBLANK_HIGH_CRTC_SHIFT));
+                    vblank.request.sequence = 1; // Wait for next VBlank
+                    vblank.request.signal = reinterpret_cast<unsigned long>(&entry);
+
+                    if (drmWaitVBlank(monitor->drmFd, &vblank) != 0) {
+                        TRACE_GLOBAL(Trace::Warning, (_T("VBlank request failed for monitor %d: %s, capturing anyway"), monitor->connectorId, strerror(errno)));
+                    } else {
+                        // The event for this request carries the sequence it was queued for.
+                        entry.sequence = vblank.reply.sequence;
+                        monitor->vblankPending = true;
+                        waiting.emplace_back(monitor, &entry);
+                        pending++;
+
+                        if (std::find_if(slots.begin(), slots.end(), [monitor](const struct pollfd& slot) { return (slot.fd == monitor->drmFd); }) == slots.end()) {
+                            slots.push_back({ monitor->drmFd, POLLIN, 0 });
+                        }
+                    }
+                }
             }
 
-            auto vsyncStart = std::chrono::high_resolution_clock::now();
+            drmEventContext events = {};
+            events.version = 2;
+            events.vblank_handler = VBlankHandler;
 
-            // Setup VBlank request
-            drmVBlank vblank = {};
-            vblank.request.type = (drmVBlankSeqType)(DRM_VBLANK_RELATIVE | (monitor.crtcIndex << DRM_VBLANK_HIGH_CRTC_SHIFT));
-            vblank.request.sequence = 1; // Wait for next VBlank
+            while (pending > 0) {
+                const int32_t remaining = static_cast<int32_t>(VSyncTimeout) - static_cast<int32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - vsyncStart).count());
 
-            // Wait for VBlank
-            int ret = drmWaitVBlank(monitor.drmFd, &vblank);
-            if (ret != 0) {
-                TRACE_GLOBAL(Trace::Warning, (_T("VBlank wait failed for monitor %d: %s"), monitor.connectorId, strerror(errno)));
-                return false;
+                if ((remaining <= 0) || (poll(slots.data(), slots.size(), remaining) <= 0)) {
+                    TRACE_GLOBAL(Trace::Warning, (_T("VBlank wait timed out on %d monitor(s), capturing anyway"), pending));
+                    break;
+                }
+
+                for (auto& slot : slots) {
+                    if ((slot.revents & POLLIN) != 0) {
+                        drmHandleEvent(slot.fd, &events);
+
+                        for (auto& entry : waiting) {
+                            if ((entry.first->vblankPending) && (entry.first->drmFd == slot.fd) && (entry.second->arrived == true)) {
+                                entry.first->vblankPending = false;
+                                pending--;
+                            }
+                        }
+                    }
+                }
             }
 
             auto vsyncDuration = std::chrono::duration_cast<std::chrono::microseconds>(
                 std::chrono::high_resolution_clock::now() - vsyncStart);
-            TRACE_GLOBAL(Trace::Information, (_T("VSync wait completed in %lld μs for monitor %d"), vsyncDuration.count(), monitor.connectorId));
+            TRACE_GLOBAL(Trace::Information, (_T("VSync wait completed in %lld μs for %d monitors"), vsyncDuration.count(), static_cast<int>(monitors.size())));
+        }
 
-            return true;
+        // Events of an earlier wait that timed out may still come in, these carry an older sequence.
+        static void VBlankHandler(int /* fd */, unsigned int sequence, unsigned int /* seconds */, unsigned int /* microseconds */, void* data)
+        {
+            VBlank* entry = static_cast<VBlank*>(data);
+
+            if (sequence == entry->sequence) {
+                entry->arrived = true;
+            }
         }
 
         /**
@@ -761,6 +990,11 @@ namespace Plugin {
 
     public:
         GpuDrmCapture()
+            : _adminLock()
+            , _gpuContexts()
+            , _streaming(false)
+            , _refreshed(0)
+            , _vblanks()
         {
             TRACE_GLOBAL(Trace::Information, (_T("GpuDrmCapture: Initializing hardware-accelerated capture - Build: %s"), __TIMESTAMP__));
 
@@ -788,6 +1022,55 @@ namespace Plugin {
          * Target: <10ms per monitor for GPU framebuffer snap operation
          */
         bool Capture(ICapture::IStore& storer) override
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
+
+            // One shot, so never the frame of an earlier capture, even while a stream is running
+            bool result = Snap(storer, false);
+
+            // Release context, the next capture may come from another thread
+            if (eglGetCurrentContext() != EGL_NO_CONTEXT) {
+                eglMakeCurrent(eglGetCurrentDisplay(), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            }
+
+            return result;
+        }
+
+        //   IStreaming methods
+        // -------------------------------------------------------------------------------------------------------
+        bool Next(ICapture::IStore& storer) override
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
+
+            bool result = Snap(storer, _streaming);
+
+            if (eglGetCurrentContext() != EGL_NO_CONTEXT) {
+                eglMakeCurrent(eglGetCurrentDisplay(), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            }
+
+            return result;
+        }
+        void Streaming(const bool enabled) override
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
+
+            if (_streaming != enabled) {
+                _streaming = enabled;
+
+                // Start from a fresh view of the connectors, and without frames of an earlier session.
+                _refreshed = 0;
+
+                for (auto& context : _gpuContexts) {
+                    context->packValid[0] = false;
+                    context->packValid[1] = false;
+                }
+
+                TRACE_GLOBAL(Trace::Information, (_T("GpuDrmCapture: streaming %s"), enabled ? _T("started") : _T("stopped")));
+            }
+        }
+
+    private:
+        bool Snap(ICapture::IStore& storer, const bool overlapped)
         {
             auto captureStart = std::chrono::high_resolution_clock::now();
 
@@ -796,8 +1079,8 @@ namespace Plugin {
                 return false;
             }
 
-            // Refresh display information to handle hotplug events
-            if (!RefreshAllDisplays()) {
+            // Follow the scanout, the connectors are only rescanned now and then while streaming
+            if (!UpdateDisplays()) {
                 TRACE_GLOBAL(Trace::Error, (_T("Failed to refresh displays for capture")));
                 return false;
             }
@@ -827,6 +1110,9 @@ namespace Plugin {
                 return false;
             }
 
+            // Wait for VSync before capture for frame stability, on all monitors at the same time
+            WaitForVSyncs(allMonitors);
+
             // Capture each monitor using GPU acceleration with partial capture support
             std::vector<MonitorInfo*> successfulMonitors;
             std::vector<MonitorInfo*> failedMonitors;
@@ -834,11 +1120,6 @@ namespace Plugin {
             for (auto* monitor : allMonitors) {
                 auto monitorStart = std::chrono::high_resolution_clock::now();
 
-                // Wait for VSync before capture for frame stability
-                if (!WaitForVSync(*monitor)) {
-                    TRACE_GLOBAL(Trace::Warning, (_T("VSync wait failed for monitor %d, capturing anyway"), monitor->connectorId));
-                }
-
                 if (CaptureMonitorToGpu(*monitor)) {
                     successfulMonitors.push_back(monitor);
                     
@@ -870,40 +1151,30 @@ namespace Plugin {
                 std::chrono::high_resolution_clock::now() - composeStart);
             TRACE_GLOBAL(Trace::Information, (_T("GPU composition completed in %lld μs"), composeDuration.count()));
 
-            // Read back final composed buffer from GPU to CPU
-            std::vector<uint8_t> compositionBuffer(bounds.totalWidth * bounds.totalHeight * 4);
+            // Read back final composed buffer from GPU to CPU, while streaming this is the frame before this one
+            const uint8_t* compositionBuffer = nullptr;
             auto readbackStart = std::chrono::high_resolution_clock::now();
-            if (!ReadbackCompositionBuffer(bounds, compositionBuffer)) {
+            GpuContext* context = ReadbackCompositionBuffer(bounds, overlapped, compositionBuffer);
+            if (context == nullptr) {
                 TRACE_GLOBAL(Trace::Error, (_T("Failed to readback composition buffer")));
                 return false;
             }
-            auto readbackDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            auto readbackDuration = std::chrono::duration_cast<std::chrono::microseconds>(
                 std::chrono::high_resolution_clock::now() - readbackStart);
-            TRACE_GLOBAL(Trace::Information, (_T("GPU readback completed in %lld ms"), readbackDuration.count()));
+            TRACE_GLOBAL(Trace::Information, (_T("GPU readback completed in %lld μs"), readbackDuration.count()));
 
             auto totalDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::high_resolution_clock::now() - captureStart);
             TRACE_GLOBAL(Trace::Information, (_T("Total GPU capture completed in %lld ms for %d/%d monitors"), totalDuration.count(), static_cast<int>(successfulMonitors.size()), static_cast<int>(allMonitors.size())));
 
-            // Cleanup GPU resources after capture to prevent accumulation
-            for (auto& context : _gpuContexts) {
-                if (context->initialized && !context->monitors.empty()) {
-                    if (eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context->eglContext)) {
-                        // Force GPU completion and release resources
-                        glFlush();
-                        glFinish();
-                        // Release context
-                        eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
-                    }
-                    break; // Only cleanup the active context
-                }
-            }
+            // Pass composed buffer to store interface, straight from the mapped pack buffer if there is one
+            bool result = storer.R8_G8_B8_A8(compositionBuffer, bounds.totalWidth, bounds.totalHeight);
+
+            ReleaseReadback(*context);
 
-            // Pass composed buffer to store interface
-            return storer.R8_G8_B8_A8(compositionBuffer.data(), bounds.totalWidth, bounds.totalHeight);
+            return result;
         }
 
-    private:
         /**
          * Initialize all GPU contexts and display enumeration
          */
@@ -1115,6 +1386,20 @@ namespace Plugin {
                 return false;
             }
 
+            // Asynchronous readback needs OpenGL ES 3.0, without it frames are read back synchronously
+            if (glVersion && strncmp(glVersion, "OpenGL ES ", 10) == 0 && glVersion[10] >= '3' && glVersion[10] <= '9') {
+                context.glMapBufferRange = (MapBufferRangeFunction)eglGetProcAddress("glMapBufferRange");
+                context.glUnmapBuffer = (UnmapBufferFunction)eglGetProcAddress("glUnmapBuffer");
+                context.glFenceSync = (FenceSyncFunction)eglGetProcAddress("glFenceSync");
+                context.glClientWaitSync = (ClientWaitSyncFunction)eglGetProcAddress("glClientWaitSync");
+                context.glDeleteSync = (DeleteSyncFunction)eglGetProcAddress("glDeleteSync");
+
+                if (!context.glMapBufferRange || !context.glUnmapBuffer || !context.glFenceSync || !context.glClientWaitSync || !context.glDeleteSync) {
+                    context.glMapBufferRange = nullptr;
+                }
+            }
+            TRACE_GLOBAL(Trace::Information, (_T("Asynchronous readback: %s"), context.HasAsyncReadback() ? "Yes" : "No"));
+
             // Initialize OpenGL ES resources for blitting and composition
             if (!InitializeGlResources(context)) {
                 TRACE_GLOBAL(Trace::Error, (_T("Failed to initialize OpenGL resources for %s"), context.devicePath.c_str()));
@@ -1275,14 +1560,68 @@ namespace Plugin {
             return foundAnyDisplays;
         }
 
+        /**
+         * Refresh what is needed for the next capture: everything for a single capture, only the
+         * scanout buffers while streaming, unless a CRTC changed or the connectors are due a rescan
+         */
+        bool UpdateDisplays()
+        {
+            bool result;
+
+            const uint64_t now = Core::Time::Now().Ticks();
+
+            if (!_streaming || ((now - _refreshed) > (TopologyInterval * 1000ull)) || !UpdateScanout()) {
+                result = RefreshAllDisplays();
+                _refreshed = now;
+            } else {
+                result = true;
+            }
+
+            return result;
+        }
+
+        /**
+         * Pick up the framebuffer each CRTC scans out now, false if the mode changed under us
+         */
+        bool UpdateScanout()
+        {
+            bool result = false;
+
+            for (auto& context : _gpuContexts) {
+                for (auto& monitor : context->monitors) {
+                    drmModeCrtc* crtc = drmModeGetCrtc(monitor.drmFd, monitor.crtcId);
+
+                    if (!crtc || !crtc->mode_valid || !crtc->buffer_id || crtc->width != monitor.width || crtc->height != monitor.height || crtc->x != static_cast<uint32_t>(monitor.x) || crtc->y != static_cast<uint32_t>(monitor.y)) {
+                        if (crtc) {
+                            drmModeFreeCrtc(crtc);
+                        }
+                        return false;
+                    }
+
+                    monitor.framebufferId = crtc->buffer_id;
+                    result = true;
+
+                    drmModeFreeCrtc(crtc);
+                }
+            }
+
+            return result;
+        }
+
         /**
          * Refresh displays for a single GPU context with enhanced format detection
          */
         bool RefreshDisplaysForContext(GpuContext& context)
         {
             // Cleanup existing monitor GPU resources
-            for (auto& monitor : context.monitors) {
-                context.CleanupMonitorGpuResources(monitor);
+            if (!context.monitors.empty() && context.initialized) {
+                eglMakeCurrent(context.eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context.eglContext);
+
+                for (auto& monitor : context.monitors) {
+                    context.CleanupMonitorGpuResources(monitor);
+                }
+
+                eglMakeCurrent(context.eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
             }
             context.monitors.clear();
 
@@ -1416,10 +1755,8 @@ namespace Plugin {
                 return false;
             }
 
-            // Ensure no other context is current first
-            eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
-
-            if (!eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context->eglContext)) {
+            // Ensure no other context is current first, a capture keeps using the same one
+            if (!MakeCurrent(*context)) {
                 EGLint eglError = eglGetError();
                 TRACE_GLOBAL(Trace::Error, (_T("Failed to make EGL context current for composition setup. EGL error: 0x%x"), eglError));
 
@@ -1500,10 +1837,8 @@ namespace Plugin {
                 return false;
             }
 
-            // Ensure no other context is current first
-            eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
-
-            if (!eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context->eglContext)) {
+            // Ensure no other context is current first, a capture keeps using the same one
+            if (!MakeCurrent(*context)) {
                 EGLint eglError = eglGetError();
                 TRACE_GLOBAL(Trace::Error, (_T("Failed to make EGL context current for monitor capture. EGL error: 0x%x"), eglError));
                 return false;
@@ -1511,6 +1846,26 @@ namespace Plugin {
 
             TRACE_GLOBAL(Trace::Information, (_T("Made EGL context current for monitor %d on %s"), monitor.connectorId, context->devicePath.c_str()));
 
+            // Imported before, the EGL image follows what is rendered into the buffer
+            ino_t buffer = 0;
+            const bool identified = FramebufferBuffer(monitor.drmFd, monitor.framebufferId, buffer);
+
+            auto cached = std::find_if(monitor.imports.begin(), monitor.imports.end(),
+                [&monitor](const MonitorInfo::Import& import) { return (import.framebufferId == monitor.framebufferId); });
+
+            if (cached != monitor.imports.end()) {
+                if (identified && (cached->buffer == buffer)) {
+                    monitor.texture = cached->texture;
+                    monitor.eglImage = cached->eglImage;
+                    monitor.gpuResourcesReady = true;
+                    return true;
+                }
+
+                // The framebuffer was removed and its id handed out again, for another buffer
+                context->ReleaseImport(*cached);
+                monitor.imports.erase(cached);
+            }
+
             // Get comprehensive framebuffer info with multi-plane support
             FramebufferInfo fbInfo;
             if (!GetFramebufferInfo(monitor.drmFd, monitor.framebufferId, fbInfo)) {
@@ -1518,31 +1873,44 @@ namespace Plugin {
                 return false;
             }
 
-            // Cleanup previous GPU resources for this monitor BEFORE creating new ones
-            context->CleanupMonitorGpuResources(monitor);
+            // Make room for this one, the oldest import is the least likely to be scanned out again
+            if (monitor.imports.size() >= MaxImports) {
+                context->ReleaseImport(monitor.imports.front());
+                monitor.imports.erase(monitor.imports.begin());
+            }
+
+            monitor.texture = 0;
+            monitor.eglImage = EGL_NO_IMAGE_KHR;
+            monitor.gpuResourcesReady = false;
 
             // Force OpenGL state cleanup
             glBindTexture(GL_TEXTURE_2D, 0);
-            glFlush();
 
             // Create EGL image based on detected format and plane configuration
-            if (!CreateEGLImageFromFramebuffer(*context, fbInfo, monitor.texture, monitor.eglImage)) {
+            MonitorInfo::Import import = { monitor.framebufferId, buffer, 0, EGL_NO_IMAGE_KHR };
+            if (!CreateEGLImageFromFramebuffer(*context, fbInfo, import.texture, import.eglImage)) {
                 TRACE_GLOBAL(Trace::Error, (_T("Failed to create EGL image for monitor %d with format %s"), 
                     monitor.connectorId, FormatToString(fbInfo.format)));
+                context->ReleaseImport(import);
                 return false;
             }
 
-            monitor.gpuResourcesReady = true;
-
-            // Force GPU state completion and check for errors
-            glFlush();
+            // Check for errors
             GLenum error = glGetError();
             if (error != GL_NO_ERROR) {
                 TRACE_GLOBAL(Trace::Error, (_T("OpenGL error during monitor capture: %d"), error));
-                context->CleanupMonitorGpuResources(monitor);
+                context->ReleaseImport(import);
                 return false;
             }
 
+            // Without knowing the buffer behind it, it can not be recognized the next time
+            if (identified) {
+                monitor.imports.push_back(import);
+            }
+            monitor.texture = import.texture;
+            monitor.eglImage = import.eglImage;
+            monitor.gpuResourcesReady = true;
+
             return true;
         }
 
@@ -1571,10 +1939,8 @@ namespace Plugin {
                 return false;
             }
 
-            // Ensure no other context is current first
-            eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
-
-            if (!eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context->eglContext)) {
+            // Ensure no other context is current first, a capture keeps using the same one
+            if (!MakeCurrent(*context)) {
                 EGLint eglError = eglGetError();
                 TRACE_GLOBAL(Trace::Error, (_T("Failed to make EGL context current for composition. EGL error: 0x%x"), eglError));
                 return false;
@@ -1655,9 +2021,25 @@ namespace Plugin {
         }
 
         /**
-         * Read back final composition buffer from GPU to CPU as RGBA8888
+         * Make the context current, unless it is already
          */
-        bool ReadbackCompositionBuffer(const CompositionBounds& bounds, std::vector<uint8_t>& buffer)
+        bool MakeCurrent(GpuContext& context)
+        {
+            bool result = (eglGetCurrentContext() == context.eglContext);
+
+            if (!result) {
+                eglMakeCurrent(context.eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                result = eglMakeCurrent(context.eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context.eglContext);
+            }
+
+            return result;
+        }
+
+        /**
+         * Read back final composition buffer from GPU to CPU as RGBA8888, the frame stays valid until ReleaseReadback.
+         * Overlapped hands out the frame of the previous call, if the context can, and starts reading this one.
+         */
+        GpuContext* ReadbackCompositionBuffer(const CompositionBounds& bounds, const bool overlapped, const uint8_t*& frame)
         {
             // Find a GPU context that actually has displays (same as composition setup)
             GpuContext* context = nullptr;
@@ -1670,38 +2052,109 @@ namespace Plugin {
 
             if (!context) {
                 TRACE_GLOBAL(Trace::Error, (_T("No GPU context with displays found for readback")));
-                return false;
+                return nullptr;
             }
 
             // Verify context is still valid
             if (context->eglContext == EGL_NO_CONTEXT || context->eglDisplay == EGL_NO_DISPLAY) {
                 TRACE_GLOBAL(Trace::Error, (_T("Invalid EGL context or display for readback")));
-                return false;
+                return nullptr;
             }
 
-            // Ensure no other context is current first
-            eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
-
-            if (!eglMakeCurrent(context->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context->eglContext)) {
+            // Ensure no other context is current first, a capture keeps using the same one
+            if (!MakeCurrent(*context)) {
                 EGLint eglError = eglGetError();
                 TRACE_GLOBAL(Trace::Error, (_T("Failed to make EGL context current for readback. EGL error: 0x%x"), eglError));
-                return false;
+                return nullptr;
             }
 
             // Bind composition framebuffer for reading
             glBindFramebuffer(GL_FRAMEBUFFER, context->compositionFramebuffer);
 
-            // Read pixels from GPU to CPU
-            glReadPixels(0, 0, bounds.totalWidth, bounds.totalHeight, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
+            const uint32_t size = bounds.totalWidth * bounds.totalHeight * 4;
+
+            if (overlapped && context->HasAsyncReadback()) {
+                frame = ReadbackAsync(*context, bounds, size);
+            } else {
+                // Read pixels from GPU to CPU
+                context->readbackBuffer.resize(size);
+                glReadPixels(0, 0, bounds.totalWidth, bounds.totalHeight, GL_RGBA, GL_UNSIGNED_BYTE, context->readbackBuffer.data());
+                frame = context->readbackBuffer.data();
+            }
 
             // Check for OpenGL errors
             GLenum error = glGetError();
-            if (error != GL_NO_ERROR) {
+            if (error != GL_NO_ERROR || frame == nullptr) {
                 TRACE_GLOBAL(Trace::Error, (_T("OpenGL error during composition readback: %d"), error));
-                return false;
+                ReleaseReadback(*context);
+                return nullptr;
             }
 
-            return true;
+            return context;
+        }
+
+        /**
+         * Start reading this frame into one pack buffer and map the other one, holding the frame before.
+         * Only the first frame of a session, or after a resize, waits for its own readback.
+         */
+        const uint8_t* ReadbackAsync(GpuContext& context, const CompositionBounds& bounds, const uint32_t size)
+        {
+            if (context.packSize != size) {
+                // Whatever is in flight has the wrong geometry
+                context.ResetPackBuffers();
+
+                if (!context.packBuffers[0]) {
+                    glGenBuffers(2, context.packBuffers);
+                }
+                for (uint8_t index = 0; index < 2; ++index) {
+                    glBindBuffer(GL_PIXEL_PACK_BUFFER, context.packBuffers[index]);
+                    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+                }
+                context.packSize = size;
+            }
+
+            const uint8_t current = context.packIndex;
+            const uint8_t previous = current ^ 1;
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, context.packBuffers[current]);
+            glReadPixels(0, 0, bounds.totalWidth, bounds.totalHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+            if (context.packFences[current] != nullptr) {
+                context.glDeleteSync(context.packFences[current]);
+            }
+            context.packFences[current] = context.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            context.packValid[current] = true;
+            context.packIndex = previous;
+
+            const uint8_t collect = (context.packValid[previous] ? previous : current);
+
+            if (context.glClientWaitSync(context.packFences[collect], GL_SYNC_FLUSH_COMMANDS_BIT, ReadbackTimeout) == GL_WAIT_FAILED) {
+                TRACE_GLOBAL(Trace::Warning, (_T("Waiting for the readback failed")));
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, context.packBuffers[collect]);
+            const uint8_t* frame = static_cast<const uint8_t*>(context.glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+
+            if (frame != nullptr) {
+                context.packMapped = collect;
+            } else {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            }
+
+            return frame;
+        }
+
+        /**
+         * Done with the frame ReadbackCompositionBuffer handed out
+         */
+        void ReleaseReadback(GpuContext& context)
+        {
+            if (context.packMapped >= 0) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, context.packBuffers[context.packMapped]);
+                context.glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                context.packMapped = -1;
+            }
         }
 
         /**
@@ -1714,7 +2167,13 @@ namespace Plugin {
         }
 
     private:
+        Core::CriticalSection _adminLock;
         std::vector<std::unique_ptr<GpuContext>> _gpuContexts;
+        bool _streaming;
+        uint64_t _refreshed;
+
+        // Per DRM file descriptor and CRTC, never removed: a late event still points to its entry.
+        std::map<std::pair<int, uint32_t>, VBlank> _vblanks;
     };
 
 } // namespace Plugin
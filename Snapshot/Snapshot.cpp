@@ -22,6 +22,14 @@
 #include <png.h>
 
 namespace Thunder {
+
+ENUM_CONVERSION_BEGIN(Plugin::Stream::format)
+
+    { Plugin::Stream::format::RAW, _TXT("raw") },
+    { Plugin::Stream::format::MJPEG, _TXT("mjpeg") },
+
+ENUM_CONVERSION_END(Plugin::Stream::format)
+
 namespace Plugin {
 
     namespace {
@@ -215,7 +223,20 @@ namespace Plugin {
         _device = Exchange::ICapture::Instance();
 
         if (_device != nullptr) {
+            Config config;
+            config.FromString(service->ConfigLine());
+
             TRACE(Trace::Information, (_T("Capture device: %s"), _device->Name()));
+
+            _format = config.Stream.Format.Value();
+            _maxClients = config.Stream.Clients.Value();
+
+            if (Stream::IsSupported(_format) == false) {
+                TRACE(Trace::Warning, (_T("Stream format %d is not available in this build, using raw"), _format));
+                _format = Stream::format::RAW;
+            }
+
+            _stream = new Stream(_device, this, config.Stream.Fps.Value(), config.Stream.Quality.Value());
         } else {
             result = string("No capture device is registered");
         }
@@ -225,6 +246,15 @@ namespace Plugin {
 
     /* virtual */ void Snapshot::Deinitialize(PluginHost::IShell*)
     {
+        if (_stream != nullptr) {
+            delete _stream;
+            _stream = nullptr;
+        }
+
+        _adminLock.Lock();
+        _channels.clear();
+        _adminLock.Unlock();
+
         if (_device != nullptr) {
             _device->Release();
             _device = nullptr;
@@ -237,10 +267,87 @@ namespace Plugin {
         return (string());
     }
 
+    /* virtual */ bool Snapshot::Attach(PluginHost::Channel& channel)
+    {
+        bool result = (_stream != nullptr);
+        Stream::format type = _format;
+        const string& options(channel.Query());
+
+        // The format can be picked per client, as in ws://<host>/Service/Snapshot?format=mjpeg
+        if (options.empty() == false) {
+            Core::URL::KeyValue keys(options);
+
+            if (keys.HasKey(_T("format"), true) == Core::URL::KeyValue::status::KEY_VALUE) {
+                Core::EnumerateType<Stream::format> value(keys.Value(_T("format"), true).Text().c_str(), false);
+
+                if (value.IsSet() == true) {
+                    type = value.Value();
+                } else {
+                    result = false;
+                }
+            }
+        }
+
+        if (result == true) {
+            _adminLock.Lock();
+
+            result = (_channels.size() < _maxClients) && (_channels.emplace(channel.Id(), &channel).second == true);
+
+            _adminLock.Unlock();
+
+            if ((result == true) && (_stream->Attach(channel.Id(), type) == false)) {
+                _adminLock.Lock();
+                _channels.erase(channel.Id());
+                _adminLock.Unlock();
+
+                result = false;
+            }
+        }
+
+        TRACE(Trace::Information, (_T("Stream client [%d] %s"), channel.Id(), (result == true ? _T("attached") : _T("rejected"))));
+
+        return (result);
+    }
+
+    /* virtual */ void Snapshot::Detach(PluginHost::Channel& channel)
+    {
+        _adminLock.Lock();
+        size_t removed = _channels.erase(channel.Id());
+        _adminLock.Unlock();
+
+        if ((removed != 0) && (_stream != nullptr)) {
+            _stream->Detach(channel.Id());
+        }
+    }
+
     /* virtual */ void Snapshot::Inbound(Web::Request& /* request */)
     {
     }
 
+    /* virtual */ uint32_t Snapshot::Inbound(const uint32_t /* ID */, const uint8_t /* data */[], const uint16_t length)
+    {
+        // Nothing is expected from the clients, the stream only goes out.
+        return (length);
+    }
+
+    /* virtual */ uint32_t Snapshot::Outbound(const uint32_t ID, uint8_t data[], const uint16_t length) const
+    {
+        return (_stream != nullptr ? _stream->Read(ID, data, length) : 0);
+    }
+
+    void Snapshot::Pending(const uint32_t id)
+    {
+        _adminLock.Lock();
+
+        std::unordered_map<uint32_t, PluginHost::Channel*>::iterator index(_channels.find(id));
+
+        if (index != _channels.end()) {
+            index->second->RequestOutbound();
+        }
+
+        _adminLock.Unlock();
+    }
+
     /* virtual */ Core::ProxyType<Web::Response> Snapshot::Process(const Web::Request& request)
     {
         ASSERT(_skipURL <= request.Path.length());
@@ -21,22 +21,74 @@
 #define __SNAPSHOT_H
 
 #include "Module.h"
+#include "Stream.h"
 #include <interfaces/ICapture.h>
 
 namespace Thunder {
 namespace Plugin {
 
-    class Snapshot : public PluginHost::IPlugin, public PluginHost::IWeb {
+    class Snapshot : public PluginHost::IPluginExtended, public PluginHost::IWeb, public PluginHost::IChannel, public Stream::ISink {
     private:
         Snapshot(const Snapshot&) = delete;
         Snapshot& operator=(const Snapshot&) = delete;
 
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            class StreamConfig : public Core::JSON::Container {
+            private:
+                StreamConfig(const StreamConfig&) = delete;
+                StreamConfig& operator=(const StreamConfig&) = delete;
+
+            public:
+                StreamConfig()
+                    : Core::JSON::Container()
+                    , Fps(15)
+                    , Format(Stream::format::RAW)
+                    , Quality(75)
+                    , Clients(4)
+                {
+                    Add(_T("fps"), &Fps);
+                    Add(_T("format"), &Format);
+                    Add(_T("quality"), &Quality);
+                    Add(_T("clients"), &Clients);
+                }
+                ~StreamConfig() override = default;
+
+            public:
+                Core::JSON::DecUInt8 Fps;
+                Core::JSON::EnumType<Stream::format> Format;
+                Core::JSON::DecUInt8 Quality;
+                Core::JSON::DecUInt8 Clients;
+            };
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , Stream()
+            {
+                Add(_T("stream"), &Stream);
+            }
+            ~Config() override = default;
+
+        public:
+            StreamConfig Stream;
+        };
+
     public:
         Snapshot()
             : _skipURL(0)
             , _device(nullptr)
             , _fileName()
             , _inProgress(false)
+            , _adminLock()
+            , _channels()
+            , _format(Stream::format::RAW)
+            , _maxClients(0)
+            , _stream(nullptr)
         {
         }
 
@@ -44,7 +96,9 @@ namespace Plugin {
 
         BEGIN_INTERFACE_MAP(Snapshot)
         INTERFACE_ENTRY(PluginHost::IPlugin)
+        INTERFACE_ENTRY(PluginHost::IPluginExtended)
         INTERFACE_ENTRY(PluginHost::IWeb)
+        INTERFACE_ENTRY(PluginHost::IChannel)
         INTERFACE_AGGREGATE(Exchange::ICapture, _device)
         END_INTERFACE_MAP
 
@@ -55,16 +109,37 @@ namespace Plugin {
         void Deinitialize(PluginHost::IShell* service) override;
         string Information() const override;
 
+        //   IPluginExtended methods
+        // -------------------------------------------------------------------------------------------------------
+        // A WebSocket to the plugin receives the screen as a stream of frames, see Stream.h.
+        bool Attach(PluginHost::Channel& channel) override;
+        void Detach(PluginHost::Channel& channel) override;
+
         //	IWeb methods
         // -------------------------------------------------------------------------------------------------------
         void Inbound(Web::Request& request) override;
         Core::ProxyType<Web::Response> Process(const Web::Request& request) override;
 
+        //	IChannel methods
+        // -------------------------------------------------------------------------------------------------------
+        uint32_t Inbound(const uint32_t ID, const uint8_t data[], const uint16_t length) override;
+        uint32_t Outbound(const uint32_t ID, uint8_t data[], const uint16_t length) const override;
+
+    private:
+        //	Stream::ISink methods
+        // -------------------------------------------------------------------------------------------------------
+        void Pending(const uint32_t id) override;
+
     private:
         uint8_t _skipURL;
         Exchange::ICapture* _device;
         string _fileName;
         Core::BinairySemaphore _inProgress;
+        Core::CriticalSection _adminLock;
+        std::unordered_map<uint32_t, PluginHost::Channel*> _channels;
+        Stream::format _format;
+        uint8_t _maxClients;
+        Stream* _stream;
     };
 
 } // Namespace Plugin.
@@ -0,0 +1,459 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Stream.h"
+
+#ifdef SNAPSHOT_MJPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+namespace Thunder {
+namespace Plugin {
+
+    namespace {
+
+        void Store(uint8_t destination[], const uint32_t value)
+        {
+            destination[0] = static_cast<uint8_t>(value);
+            destination[1] = static_cast<uint8_t>(value >> 8);
+            destination[2] = static_cast<uint8_t>(value >> 16);
+            destination[3] = static_cast<uint8_t>(value >> 24);
+        }
+
+#ifdef SNAPSHOT_MJPEG
+        struct ErrorManager {
+            struct jpeg_error_mgr Base;
+            jmp_buf Jump;
+        };
+
+        void Failure(j_common_ptr info)
+        {
+            longjmp(reinterpret_cast<ErrorManager*>(info->err)->Jump, 1);
+        }
+
+        // Only plain data in here, libjpeg leaves through longjmp when it fails.
+        bool Compress(const uint8_t buffer[], const uint32_t width, const uint32_t height, const uint8_t quality, unsigned char*& image, unsigned long& size)
+        {
+            struct jpeg_compress_struct info;
+            ErrorManager error;
+#ifndef JCS_EXTENSIONS
+            JSAMPLE* const row = static_cast<JSAMPLE*>(::malloc(width * 3));
+#endif
+            volatile bool result = false;
+
+            info.err = jpeg_std_error(&error.Base);
+            error.Base.error_exit = Failure;
+
+            if (setjmp(error.Jump) == 0) {
+                jpeg_create_compress(&info);
+                jpeg_mem_dest(&info, &image, &size);
+
+                info.image_width = width;
+                info.image_height = height;
+#ifdef JCS_EXTENSIONS
+                info.input_components = 4;
+                info.in_color_space = JCS_EXT_RGBA;
+#else
+                info.input_components = 3;
+                info.in_color_space = JCS_RGB;
+#endif
+                jpeg_set_defaults(&info);
+                jpeg_set_quality(&info, quality, TRUE);
+                jpeg_start_compress(&info, TRUE);
+
+                while (info.next_scanline < info.image_height) {
+                    const uint8_t* line = &(buffer[info.next_scanline * width * 4]);
+#ifdef JCS_EXTENSIONS
+                    JSAMPLE* scanline = const_cast<JSAMPLE*>(line);
+#else
+                    JSAMPLE* scanline = row;
+
+                    for (uint32_t x = 0; x < width; ++x) {
+                        row[(x * 3) + 0] = line[(x * 4) + 0];
+                        row[(x * 3) + 1] = line[(x * 4) + 1];
+                        row[(x * 3) + 2] = line[(x * 4) + 2];
+                    }
+#endif
+                    jpeg_write_scanlines(&info, &scanline, 1);
+                }
+
+                jpeg_finish_compress(&info);
+                result = true;
+            }
+
+            jpeg_destroy_compress(&info);
+
+#ifndef JCS_EXTENSIONS
+            ::free(row);
+#endif
+            return (result);
+        }
+#endif
+    }
+
+    Stream::Stream(Exchange::ICapture* device, ISink* sink, const uint8_t fps, const uint8_t quality)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("SnapshotStream"))
+        , _adminLock()
+        , _device(device)
+        , _streaming(dynamic_cast<IStreaming*>(device))
+        , _sink(sink)
+        , _period(fps == 0 ? 0 : (1000000 / fps))
+        , _quality(quality)
+        , _clients()
+        , _last()
+        , _fingerprint(0)
+        , _sequence(0)
+        , _active(false)
+        , _statistics()
+        , _collected(Core::Time::Now().Ticks())
+    {
+        ASSERT(_device != nullptr);
+        ASSERT(_sink != nullptr);
+
+        _device->AddRef();
+    }
+
+    Stream::~Stream()
+    {
+        Stop();
+        Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+        if ((_active == true) && (_streaming != nullptr)) {
+            _streaming->Streaming(false);
+        }
+
+        _device->Release();
+    }
+
+    /* static */ bool Stream::IsSupported(const format type)
+    {
+#ifdef SNAPSHOT_MJPEG
+        return ((type == format::RAW) || (type == format::MJPEG));
+#else
+        return (type == format::RAW);
+#endif
+    }
+
+    bool Stream::Attach(const uint32_t id, const format type)
+    {
+        bool result = false;
+
+        if (IsSupported(type) == true) {
+            _adminLock.Lock();
+
+            // Whatever is on screen now is the first frame, if it is known already.
+            result = _clients.emplace(id, Client { type, nullptr, 0, _last[type], true }).second;
+
+            if (result == true) {
+                Run();
+            }
+
+            _adminLock.Unlock();
+        }
+
+        return (result);
+    }
+
+    void Stream::Detach(const uint32_t id)
+    {
+        _adminLock.Lock();
+        _clients.erase(id);
+        _adminLock.Unlock();
+    }
+
+    uint16_t Stream::Read(const uint32_t id, uint8_t data[], const uint16_t length)
+    {
+        uint16_t result = 0;
+
+        _adminLock.Lock();
+
+        std::unordered_map<uint32_t, Client>::iterator index(_clients.find(id));
+
+        if (index != _clients.end()) {
+            Client& client(index->second);
+
+            if ((client.Sending == nullptr) || (client.Offset == client.Sending->size())) {
+                client.Sending = std::move(client.Next);
+                client.Next.reset();
+                client.Offset = 0;
+            }
+
+            if (client.Sending != nullptr) {
+                result = static_cast<uint16_t>(std::min(static_cast<size_t>(length), client.Sending->size() - client.Offset));
+
+                ::memcpy(data, &((*client.Sending)[client.Offset]), result);
+                client.Offset += result;
+
+                _statistics.Bytes += result;
+            }
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    Stream::Statistics Stream::Collect()
+    {
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        _adminLock.Lock();
+
+        Statistics result(_statistics);
+        result.Duration = now - _collected;
+
+        _statistics = Statistics();
+        _collected = now;
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    /* static */ uint64_t Stream::Fingerprint(const uint8_t data[], const uint32_t length)
+    {
+        static constexpr uint64_t Prime = 0x100000001B3ull;
+
+        // Four independent lanes, so the multiplications do not wait on each other.
+        uint64_t lanes[4] = { 0xCBF29CE484222325ull, 0x84222325CBF29CE4ull, 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full };
+        uint32_t offset = 0;
+
+        for (; (offset + 32) <= length; offset += 32) {
+            for (uint8_t lane = 0; lane < 4; ++lane) {
+                uint64_t word;
+                ::memcpy(&word, &(data[offset + (lane * 8)]), sizeof(word));
+                lanes[lane] = (lanes[lane] ^ word) * Prime;
+                lanes[lane] ^= (lanes[lane] >> 29);
+            }
+        }
+
+        uint64_t result = lanes[0] ^ (lanes[1] * 3) ^ (lanes[2] * 5) ^ (lanes[3] * 7) ^ length;
+
+        for (; offset < length; ++offset) {
+            result = (result ^ data[offset]) * Prime;
+        }
+
+        return (result);
+    }
+
+    bool Stream::R8_G8_B8_A8(const unsigned char* buffer, const unsigned int width, const unsigned int height)
+    {
+        const uint64_t fingerprint = Fingerprint(buffer, width * height * 4) ^ ((static_cast<uint64_t>(width) << 32) | height);
+        bool wanted[Formats] = {};
+        bool encode = false;
+        std::vector<uint32_t> pending;
+        uint32_t sequence;
+
+        _adminLock.Lock();
+
+        if (fingerprint != _fingerprint) {
+            _fingerprint = fingerprint;
+            _sequence++;
+
+            for (Frame& last : _last) {
+                last.reset();
+            }
+        }
+
+        // Encoded once per format in use, also when unchanged for a format that got its first client.
+        for (const std::pair<const uint32_t, Client>& client : _clients) {
+            if (_last[client.second.Format] == nullptr) {
+                wanted[client.second.Format] = true;
+                encode = true;
+            }
+        }
+
+        sequence = _sequence;
+
+        _adminLock.Unlock();
+
+        Frame frames[Formats];
+
+        if (encode == true) {
+            const uint64_t start = Core::Time::Now().Ticks();
+
+            for (uint8_t type = 0; type < Formats; ++type) {
+                if (wanted[type] == true) {
+                    frames[type] = Encode(static_cast<format>(type), buffer, width, height, sequence);
+                }
+            }
+
+            const uint64_t elapsed = Core::Time::Now().Ticks() - start;
+
+            _adminLock.Lock();
+            _statistics.EncodeTime += elapsed;
+            _adminLock.Unlock();
+        }
+
+        _adminLock.Lock();
+
+        if (encode == false) {
+            _statistics.Unchanged++;
+        } else {
+            _statistics.Emitted++;
+        }
+
+        for (uint8_t type = 0; type < Formats; ++type) {
+            if ((frames[type] != nullptr) && (sequence == _sequence)) {
+                _last[type] = frames[type];
+            }
+        }
+
+        for (std::pair<const uint32_t, Client>& entry : _clients) {
+            Client& client(entry.second);
+            const Frame& frame(frames[client.Format]);
+
+            if (frame != nullptr) {
+                if (client.Next != nullptr) {
+                    _statistics.Skipped++;
+                }
+                client.Next = frame;
+                client.Fresh = false;
+                pending.push_back(entry.first);
+            } else if ((client.Fresh == true) && (client.Next != nullptr)) {
+                client.Fresh = false;
+                pending.push_back(entry.first);
+            }
+        }
+
+        _adminLock.Unlock();
+
+        for (const uint32_t id : pending) {
+            _sink->Pending(id);
+        }
+
+        return (true);
+    }
+
+    Stream::Frame Stream::Encode(const format type, const uint8_t buffer[], const uint32_t width, const uint32_t height, const uint32_t sequence) const
+    {
+        std::vector<uint8_t>* frame = nullptr;
+
+        if (type == format::RAW) {
+            const uint32_t length = width * height * 4;
+
+            frame = new std::vector<uint8_t>(HeaderSize + length);
+            ::memcpy(&((*frame)[HeaderSize]), buffer, length);
+        }
+#ifdef SNAPSHOT_MJPEG
+        else if (type == format::MJPEG) {
+            unsigned char* image = nullptr;
+            unsigned long size = 0;
+
+            if (Compress(buffer, width, height, _quality, image, size) == true) {
+                frame = new std::vector<uint8_t>(HeaderSize + size);
+                ::memcpy(&((*frame)[HeaderSize]), image, size);
+            } else {
+                TRACE(Trace::Error, (_T("Could not compress a %dx%d frame"), width, height));
+            }
+
+            ::free(image);
+        }
+#endif
+
+        if (frame != nullptr) {
+            uint8_t* header = frame->data();
+
+            header[0] = 'S';
+            header[1] = 'N';
+            header[2] = 'A';
+            header[3] = 'P';
+            header[4] = static_cast<uint8_t>(type);
+            header[5] = 0;
+            header[6] = 0;
+            header[7] = 0;
+            Store(&header[8], width);
+            Store(&header[12], height);
+            Store(&header[16], sequence);
+            Store(&header[20], static_cast<uint32_t>(frame->size() - HeaderSize));
+        }
+
+        return (Frame(frame));
+    }
+
+    uint32_t Stream::Worker()
+    {
+        uint32_t result = Core::infinite;
+
+        _adminLock.Lock();
+
+        if (_clients.empty() == true) {
+            const bool stop = _active;
+
+            _active = false;
+            _fingerprint = 0;
+
+            for (Frame& last : _last) {
+                last.reset();
+            }
+
+            Block();
+
+            _adminLock.Unlock();
+
+            if (stop == true) {
+                const Statistics statistics(Collect());
+
+                if (_streaming != nullptr) {
+                    _streaming->Streaming(false);
+                }
+
+                TRACE(Trace::Information, (_T("Stream ended: %u captures, %u frames sent, %u unchanged, %u skipped, %u failed"),
+                    statistics.Captured, statistics.Emitted, statistics.Unchanged, statistics.Skipped, statistics.Failed));
+            }
+        } else {
+            const bool start = (_active == false);
+
+            _active = true;
+
+            _adminLock.Unlock();
+
+            if ((start == true) && (_streaming != nullptr)) {
+                _streaming->Streaming(true);
+            }
+
+            const uint64_t begin = Core::Time::Now().Ticks();
+            const bool captured = (_streaming != nullptr ? _streaming->Next(*this) : _device->Capture(*this));
+            const uint64_t elapsed = Core::Time::Now().Ticks() - begin;
+
+            _adminLock.Lock();
+
+            _statistics.Captured++;
+            _statistics.CaptureTime += elapsed;
+
+            if (captured == false) {
+                if (_statistics.Failed == 0) {
+                    TRACE(Trace::Error, (_T("Could not capture on %s"), _device->Name()));
+                }
+                _statistics.Failed++;
+            }
+
+            _adminLock.Unlock();
+
+            // Keep the pace, a capture that took too long is followed by the next right away.
+            result = (elapsed < _period ? static_cast<uint32_t>((_period - elapsed) / 1000) : 0);
+        }
+
+        return (result);
+    }
+
+} // namespace Plugin
+} // namespace Thunder
@@ -0,0 +1,139 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include "Streaming.h"
+
+#include <interfaces/ICapture.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Thunder {
+namespace Plugin {
+
+    // Captures the screen at a steady rate for as long as there are clients, and only passes on
+    // the frames that differ from the one before. Each frame goes out prefixed by a header, all
+    // values little endian:
+    //
+    //     "SNAP" | format (1) | reserved (3) | width (4) | height (4) | sequence (4) | length (4)
+    //
+    // followed by length bytes: RGBA pixels, top row first, for raw or a JPEG image for mjpeg. A
+    // client that reads slower than frames come in, skips frames; it always gets the latest.
+    class Stream : public Core::Thread, public Exchange::ICapture::IStore {
+    public:
+        enum format : uint8_t {
+            RAW = 0,
+            MJPEG = 1
+        };
+
+        static constexpr uint8_t HeaderSize = 24;
+        static constexpr uint8_t Formats = 2;
+
+        struct ISink {
+            virtual ~ISink() = default;
+
+            // There is a frame to read for this client, reported from the capture thread.
+            virtual void Pending(const uint32_t id) = 0;
+        };
+
+        struct Statistics {
+            uint32_t Captured;
+            uint32_t Unchanged;
+            uint32_t Emitted;
+            uint32_t Skipped; // replaced by a newer frame before a client got to it
+            uint32_t Failed;
+            uint64_t Bytes; // read by the clients
+            uint64_t CaptureTime; // us, all captures together, encoding included
+            uint64_t EncodeTime; // us
+            uint64_t Duration; // us, since the previous collection
+        };
+
+    private:
+        using Frame = std::shared_ptr<const std::vector<uint8_t>>;
+
+        struct Client {
+            format Format;
+            Frame Sending;
+            uint32_t Offset;
+            Frame Next;
+            bool Fresh; // not told about a frame yet
+        };
+
+    public:
+        Stream() = delete;
+        Stream(Stream&&) = delete;
+        Stream(const Stream&) = delete;
+        Stream& operator=(Stream&&) = delete;
+        Stream& operator=(const Stream&) = delete;
+
+        Stream(Exchange::ICapture* device, ISink* sink, const uint8_t fps, const uint8_t quality);
+        ~Stream() override;
+
+    public:
+        static bool IsSupported(const format type);
+
+        bool Attach(const uint32_t id, const format type);
+        void Detach(const uint32_t id);
+        uint16_t Read(const uint32_t id, uint8_t data[], const uint16_t length);
+
+        uint32_t Clients() const
+        {
+            _adminLock.Lock();
+            uint32_t result = static_cast<uint32_t>(_clients.size());
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        Statistics Collect();
+
+        //   ICapture::IStore methods
+        // -------------------------------------------------------------------------------------------------------
+        bool R8_G8_B8_A8(const unsigned char* buffer, const unsigned int width, const unsigned int height) override;
+
+        // Cheap enough to run over every frame, to see if anything changed at all.
+        static uint64_t Fingerprint(const uint8_t data[], const uint32_t length);
+
+    private:
+        uint32_t Worker() override;
+
+        Frame Encode(const format type, const uint8_t buffer[], const uint32_t width, const uint32_t height, const uint32_t sequence) const;
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        Exchange::ICapture* _device;
+        IStreaming* _streaming;
+        ISink* _sink;
+        const uint32_t _period; // us
+        const uint8_t _quality;
+        std::unordered_map<uint32_t, Client> _clients;
+        Frame _last[Formats];
+        uint64_t _fingerprint;
+        uint32_t _sequence;
+        bool _active;
+        Statistics _statistics;
+        uint64_t _collected;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
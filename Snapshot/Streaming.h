@@ -0,0 +1,44 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <interfaces/ICapture.h>
+
+namespace Thunder {
+namespace Plugin {
+
+    // Implemented next to Exchange::ICapture by the capture devices that can do better when they
+    // know captures follow each other, as they do while a stream is running. Between
+    // Streaming(true) and Streaming(false) such a device may keep state from one Capture to the
+    // next and hand over the frame of the previous Capture, so the readback of one frame overlaps
+    // with the encoding of the other, but only for the captures of the stream, taken with Next().
+    // A Capture in between, a one shot snapshot, always returns the screen as it is at that moment.
+    // Devices without it are captured one shot after the other.
+    struct IStreaming {
+        virtual ~IStreaming() = default;
+
+        virtual void Streaming(const bool enabled) = 0;
+
+        // The next frame of the stream, it may be the frame of the previous call.
+        virtual bool Next(Exchange::ICapture::IStore& storer) = 0;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
@@ -0,0 +1,291 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Sustained frame rate and CPU cost of a stream session. First with a synthetic screen, where it
+// is known which frames change, to check only those go out. Then, when built with the GBM
+// backend, on the real capture device: one shot captures back to back against a stream session.
+// Without a GPU, that part runs on a software EGL driver, e.g. vkms for the display and Mesa with
+// GALLIUM_DRIVER=llvmpipe for the rendering.
+
+#include "Module.h"
+#include "Stream.h"
+
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <vector>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace Thunder;
+
+namespace {
+
+constexpr uint32_t Duration = 3000; // ms per run
+
+// 1080p, a box moves on every fourth capture.
+class Synthetic : public Exchange::ICapture {
+public:
+    static constexpr uint32_t Width = 1920;
+    static constexpr uint32_t Height = 1080;
+    static constexpr uint32_t ChangeEvery = 4;
+
+    Synthetic(const Synthetic&) = delete;
+    Synthetic& operator=(const Synthetic&) = delete;
+
+    Synthetic()
+        : _screen(Width * Height * 4, 0x20)
+        , _captures(0)
+        , _changes(0)
+    {
+    }
+    ~Synthetic() override = default;
+
+    BEGIN_INTERFACE_MAP(Synthetic)
+    INTERFACE_ENTRY(Exchange::ICapture)
+    END_INTERFACE_MAP
+
+public:
+    const TCHAR* Name() const override
+    {
+        return (_T("Synthetic"));
+    }
+    bool Capture(ICapture::IStore& storer) override
+    {
+        if ((_captures++ % ChangeEvery) == 0) {
+            const uint32_t x = (_changes * 16) % (Width - 128);
+            const uint32_t y = (_changes * 8) % (Height - 128);
+
+            for (uint32_t row = y; row < (y + 128); ++row) {
+                ::memset(&(_screen[((row * Width) + x) * 4]), static_cast<int>(_changes & 0xFF), 128 * 4);
+            }
+
+            _changes++;
+        }
+
+        return (storer.R8_G8_B8_A8(_screen.data(), Width, Height));
+    }
+
+    uint32_t Changes() const
+    {
+        return (_changes);
+    }
+
+private:
+    std::vector<uint8_t> _screen;
+    uint32_t _captures;
+    uint32_t _changes;
+};
+
+// Reads as a channel would: everything there is, whenever a frame is reported.
+class Client : public Plugin::Stream::ISink {
+public:
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    Client()
+        : _pending(false, true)
+        , _frame()
+        , _frames(0)
+        , _sequence(0)
+        , _valid(true)
+    {
+    }
+    ~Client() override = default;
+
+public:
+    void Pending(const uint32_t /* id */) override
+    {
+        _pending.SetEvent();
+    }
+
+    void Drain(Plugin::Stream& stream, const uint32_t id, const uint32_t duration)
+    {
+        const uint64_t end = Core::Time::Now().Add(duration).Ticks();
+        uint8_t chunk[0xFFFF];
+
+        while (Core::Time::Now().Ticks() < end) {
+            if (_pending.Lock(100) == Core::ERROR_NONE) {
+                _pending.ResetEvent();
+
+                uint16_t loaded;
+
+                while ((loaded = stream.Read(id, chunk, sizeof(chunk))) > 0) {
+                    Received(chunk, loaded);
+                }
+            }
+        }
+    }
+
+    uint32_t Frames() const
+    {
+        return (_frames);
+    }
+    bool IsValid() const
+    {
+        return (_valid);
+    }
+
+private:
+    static uint32_t Load(const uint8_t data[])
+    {
+        return (data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24));
+    }
+    void Received(const uint8_t data[], const uint16_t length)
+    {
+        _frame.insert(_frame.end(), data, data + length);
+
+        while ((_frame.size() >= Plugin::Stream::HeaderSize) && (_frame.size() >= (Plugin::Stream::HeaderSize + Load(&(_frame[20]))))) {
+            const uint32_t size = Plugin::Stream::HeaderSize + Load(&(_frame[20]));
+            const uint32_t sequence = Load(&(_frame[16]));
+
+            // Frames may be skipped, never repeated or out of order.
+            _valid = _valid && (::memcmp(_frame.data(), "SNAP", 4) == 0) && (sequence > _sequence);
+            _sequence = sequence;
+            _frames++;
+
+            _frame.erase(_frame.begin(), _frame.begin() + size);
+        }
+    }
+
+private:
+    Core::Event _pending;
+    std::vector<uint8_t> _frame;
+    uint32_t _frames;
+    uint32_t _sequence;
+    bool _valid;
+};
+
+// Counts, as the one shot PNG store would get them.
+class Counter : public Exchange::ICapture::IStore {
+public:
+    Counter()
+        : _frames(0)
+    {
+    }
+    ~Counter() override = default;
+
+    bool R8_G8_B8_A8(const unsigned char* /* buffer */, const unsigned int /* width */, const unsigned int /* height */) override
+    {
+        _frames++;
+        return (true);
+    }
+    uint32_t Frames() const
+    {
+        return (_frames);
+    }
+
+private:
+    uint32_t _frames;
+};
+
+double Cpu()
+{
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+
+    return ((usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0);
+}
+
+void Report(const char label[], const uint32_t frames, const double wall, const double cpu)
+{
+    printf("%-28s: %7.1f fps, %6.2f ms CPU per frame, %5.1f%% of a core\n",
+        label, (frames * 1000.0) / wall, (frames > 0 ? cpu / frames : 0.0), (cpu * 100.0) / wall);
+}
+
+bool Session(Exchange::ICapture* device, const char label[], const Plugin::Stream::format type, uint32_t& sent)
+{
+    Client client;
+    Plugin::Stream stream(device, &client, 0, 75);
+
+    const double cpu = Cpu();
+    const uint64_t start = Core::Time::Now().Ticks();
+
+    stream.Attach(1, type);
+    client.Drain(stream, 1, Duration);
+
+    // Before the detach, once idle the stream collects (and resets) them itself.
+    const Plugin::Stream::Statistics statistics(stream.Collect());
+    const double wall = (Core::Time::Now().Ticks() - start) / 1000.0;
+
+    stream.Detach(1);
+
+    Report(label, statistics.Captured, wall, Cpu() - cpu);
+    printf("%-28s: %u sent, %u unchanged, %u skipped, %.1f MB/s\n", "",
+        client.Frames(), statistics.Unchanged, statistics.Skipped, statistics.Bytes / (wall * 1000.0));
+
+    sent = client.Frames();
+
+    return ((client.IsValid() == true) && (statistics.Captured > 0) && (statistics.Failed == 0));
+}
+
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    bool correct = true;
+
+    {
+        Exchange::ICapture* synthetic = Core::ServiceType<Synthetic>::Create<Exchange::ICapture>();
+        uint32_t sent = 0;
+
+        correct = Session(synthetic, "synthetic raw", Plugin::Stream::format::RAW, sent) && correct;
+
+        // Every change went out, unless the reader fell behind and it was skipped for a newer one.
+        correct = correct && (sent > 0) && (sent <= static_cast<Synthetic*>(synthetic)->Changes());
+
+        if (Plugin::Stream::IsSupported(Plugin::Stream::format::MJPEG) == true) {
+            correct = Session(synthetic, "synthetic mjpeg", Plugin::Stream::format::MJPEG, sent) && correct;
+        }
+
+        synthetic->Release();
+    }
+
+#ifdef SNAPSHOT_DEVICE
+    {
+        Exchange::ICapture* device = Exchange::ICapture::Instance();
+        Counter counter;
+
+        if (device->Capture(counter) == false) {
+            printf("%-28s: skipped, no display to capture\n", device->Name());
+        } else {
+            double cpu = Cpu();
+            const uint64_t start = Core::Time::Now().Ticks();
+            const uint64_t end = start + (Duration * 1000ull);
+
+            while (Core::Time::Now().Ticks() < end) {
+                device->Capture(counter);
+            }
+
+            Report("device one shot", counter.Frames() - 1, (Core::Time::Now().Ticks() - start) / 1000.0, Cpu() - cpu);
+
+            uint32_t sent = 0;
+            correct = Session(device, "device stream raw", Plugin::Stream::format::RAW, sent) && correct;
+        }
+
+        device->Release();
+    }
+#endif
+
+    printf("%-28s: %s\n", "stream", (correct == true ? "correct" : "FAILED"));
+
+    Core::Singleton::Dispose();
+
+    return (correct == true ? 0 : 1);
+}
@@ -355,6 +355,32 @@ namespace Implementation {
                 return Core::ERROR_NONE;
             }
 
+            uint32_t Reset() override
+            {
+                uint32_t result = Core::ERROR_UNAVAILABLE;
+
+                Terminate();
+
+                _adminLock.Lock();
+
+                // The AAMP instance and its event listener stay, only the stream is dropped.
+                if (_aampPlayer != nullptr) {
+                    _aampPlayer->Stop();
+
+                    _uri.clear();
+                    _speed = -1;
+                    _drmType = Exchange::IStream::drmtype::Unknown;
+                    _error = Core::ERROR_NONE;
+                    _elements.clear();
+                    _state = Exchange::IStream::state::Idle;
+                    result = Core::ERROR_NONE;
+                }
+
+                _adminLock.Unlock();
+
+                return (result);
+            }
+
             void Callback(ICallback* callback) override
             {
                 _adminLock.Lock();
@@ -437,28 +463,26 @@ namespace Implementation {
                 uint32_t result = Core::ERROR_NONE;
                 TRACE(Trace::Information, (_T("URI = %s"), uri.c_str()));
 
+                // A tune while Controlled is a channel change: AAMP switches the stream on the
+                // pipeline it has, the decoder stays attached and the main loop keeps running.
                 _adminLock.Lock();
-                if (_state != Exchange::IStream::state::Controlled) {
-                    if (uri.empty() == false) {
-                        TRACE(Trace::Information, (_T("uri = %s"), uri.c_str()));
-                        string uriType = UriType(uri);
-                        if ((uriType == "m3u8") || (uriType == "mpd")) {
-                            TRACE(Trace::Information, (_T("URI type is %s"), uriType.c_str()));
-                            _speed = -1;
-                            _drmType = Exchange::IStream::drmtype::Unknown;
-                            _uri = uri;
-                            _error = Core::ERROR_NONE;
-                            _aampPlayer->Tune(_uri.c_str());
-                        } else {
-                            result = Core::ERROR_INCORRECT_URL;
-                            TRACE(Trace::Error, (_T("URI is not dash/hls")));
-                        }
+                if (uri.empty() == false) {
+                    TRACE(Trace::Information, (_T("uri = %s"), uri.c_str()));
+                    string uriType = UriType(uri);
+                    if ((uriType == "m3u8") || (uriType == "mpd")) {
+                        TRACE(Trace::Information, (_T("URI type is %s"), uriType.c_str()));
+                        _speed = -1;
+                        _drmType = Exchange::IStream::drmtype::Unknown;
+                        _uri = uri;
+                        _error = Core::ERROR_NONE;
+                        _aampPlayer->Tune(_uri.c_str());
                     } else {
                         result = Core::ERROR_INCORRECT_URL;
-                        TRACE(Trace::Error, (_T("URI is not provided")));
+                        TRACE(Trace::Error, (_T("URI is not dash/hls")));
                     }
                 } else {
-                    result = Core::ERROR_ILLEGAL_STATE;
+                    result = Core::ERROR_INCORRECT_URL;
+                    TRACE(Trace::Error, (_T("URI is not provided")));
                 }
                 _adminLock.Unlock();
 
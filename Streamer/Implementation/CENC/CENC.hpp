@@ -55,6 +55,7 @@ namespace Player {
                 // --------------------------------------------------------------
                 uint32_t Setup() override;
                 uint32_t Teardown() override;
+                uint32_t Reset() override;
                 void Callback(ICallback* callback) override;
                 string Metadata() const override;
                 Exchange::IStream::streamtype Type() const override;
@@ -102,6 +103,7 @@ namespace Player {
                 mutable Core::CriticalSection _adminLock;
                 PipelineData _data;
                 GstBus* _bus;
+                bool _attached;
 
                 // OpenCDMSystem* _system;
             };
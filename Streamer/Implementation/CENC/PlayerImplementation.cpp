@@ -45,6 +45,7 @@ namespace Player {
                 , _adminLock()
                 , _data()
                 , _bus(nullptr)
+                , _attached(false)
             {
                 if(!gst_is_initialized())
                     gst_init(0, nullptr);
@@ -137,6 +138,25 @@ namespace Player {
                 return Core::ERROR_NONE;
             }
 
+            uint32_t CENC::Reset()
+            {
+                // Takes the playbin to NULL, the playbin and its bus stay.
+                DetachDecoder(_index);
+
+                _adminLock.Lock();
+
+                uint32_t result = (_data._playbin != nullptr ? Core::ERROR_NONE : Core::ERROR_UNAVAILABLE);
+
+                if (result == Core::ERROR_NONE) {
+                    _speed = 100;
+                    _error = Core::ERROR_NONE;
+                }
+
+                _adminLock.Unlock();
+
+                return (result);
+            }
+
             void CENC::Callback(ICallback* callback VARIABLE_IS_NOT_USED)
             {
                 TRACE(Trace::Information, (_T("CENC callback setter is called, not implemented")));
@@ -189,8 +209,17 @@ namespace Player {
                 _adminLock.Lock();
 
                 initializeOcdm();
-                gst_element_set_state(_data._playbin, GstState::GST_STATE_NULL);
-                g_object_set(_data._playbin, "uri", uri.c_str(), NULL);
+
+                if (_attached == true) {
+                    // Channel change: READY drops the stream but keeps the decoders and sinks
+                    // of the playbin, which picks up again on the new uri.
+                    gst_element_set_state(_data._playbin, GstState::GST_STATE_READY);
+                    g_object_set(_data._playbin, "uri", uri.c_str(), NULL);
+                    gst_element_set_state(_data._playbin, GstState::GST_STATE_PLAYING);
+                } else {
+                    gst_element_set_state(_data._playbin, GstState::GST_STATE_NULL);
+                    g_object_set(_data._playbin, "uri", uri.c_str(), NULL);
+                }
 
                 _adminLock.Unlock();
                 return Error();
@@ -207,6 +236,7 @@ namespace Player {
                 gst_element_set_state(_data._playbin, GstState::GST_STATE_PLAYING);
                 if (!this->IsRunning())
                     this->Run();
+                _attached = true;
 
                 _adminLock.Unlock();
                 return (Core::ERROR_NONE);
@@ -219,6 +249,7 @@ namespace Player {
                 
                 gst_element_set_state(_data._playbin, GstState::GST_STATE_NULL);
                 this->Stop();
+                _attached = false;
 
                 _adminLock.Unlock();
                 return (Core::ERROR_NONE);
@@ -31,6 +31,8 @@ namespace Implementation {
 
         class QAM : public IPlayerPlatform {
         private:
+            static constexpr uint8_t NoDecoder = static_cast<uint8_t>(~0);
+
             QAM() = delete;
             QAM(const QAM&) = delete;
             QAM& operator=(const QAM&) = delete;
@@ -71,6 +73,8 @@ namespace Implementation {
                 , _player(nullptr)
                 , _sink(*this)
                 , _index(index)
+                , _decoder(NoDecoder)
+                , _adminLock()
             {
                 _speeds.push_back(100);
             }
@@ -110,9 +114,41 @@ namespace Implementation {
 
                 return Core::ERROR_NONE;
             }
+            uint32_t Reset() override
+            {
+                uint32_t result = Core::ERROR_UNAVAILABLE;
+
+                _adminLock.Lock();
+
+                if (_player != nullptr) {
+                    // No more streaming to a decoder, but the tuner stays open and tuned, the next Load only retunes.
+                    if (_decoder != NoDecoder) {
+                        _player->Detach(_decoder);
+                        _decoder = NoDecoder;
+                    }
+
+                    _state = Exchange::IStream::state::Idle;
+                    _error = Core::ERROR_NONE;
+                    _drmType = Exchange::IStream::drmtype::Unknown;
+                    _speed = 0;
+                    _absoluteTime = 0;
+                    _begin = 0;
+                    _end = ~0;
+                    _rectangle = Rectangle();
+                    _z = 0;
+                    _elements.clear();
+                    result = Core::ERROR_NONE;
+                }
+
+                _adminLock.Unlock();
+
+                return (result);
+            }
             void Callback(ICallback* callback) override
             {
+                _adminLock.Lock();
                 _callback = callback;
+                _adminLock.Unlock();
             }
             string Metadata() const override
             {
@@ -146,6 +182,8 @@ namespace Implementation {
 
                 result = Core::ERROR_ILLEGAL_STATE;
 
+                _adminLock.Lock();
+
                 if (_state != Exchange::IStream::state::Error) {
 
                     Broadcast::Designator parser(configuration);
@@ -168,10 +206,17 @@ namespace Implementation {
                     } else {
                         TRACE(Trace::Information, (_T("Tuning to ProgramNumber %d"), parser.ProgramNumber()));
                         _player->Prepare(parser.ProgramNumber());
-                        _state = Exchange::IStream::state::Prepared;
+
+                        // With a decoder attached this is a channel change, the decoder stays attached
+                        // and the tuner reports when the new program streams.
+                        if (_state != Exchange::IStream::state::Controlled) {
+                            _state = Exchange::IStream::state::Prepared;
+                        }
                     }
                 }
 
+                _adminLock.Unlock();
+
                 return result;
             }
             const std::vector<int32_t>& Speeds() const override
@@ -250,6 +295,8 @@ namespace Implementation {
 
                 result = Core::ERROR_ILLEGAL_STATE;
 
+                _adminLock.Lock();
+
                 if (_state == Exchange::IStream::state::Prepared) {
 
                     result = _player->Attach(index);
@@ -258,9 +305,13 @@ namespace Implementation {
                         _error = result;
                         _state = Exchange::IStream::state::Error;
                         _callback->StateChange(_state);
+                    } else {
+                        _decoder = index;
                     }
                 }
 
+                _adminLock.Unlock();
+
                 return (result);
             }
             uint32_t DetachDecoder(const uint8_t index) override
@@ -271,6 +322,8 @@ namespace Implementation {
 
                 result = Core::ERROR_ILLEGAL_STATE;
 
+                _adminLock.Lock();
+
                 if ( (_state > Exchange::IStream::state::Prepared) && (_state != Exchange::IStream::state::Error) ) {
 
                     result = _player->Detach(index);
@@ -279,9 +332,13 @@ namespace Implementation {
                         _error = result;
                         _state = Exchange::IStream::state::Error;
                         _callback->StateChange(_state);
+                    } else {
+                        _decoder = NoDecoder;
                     }
                 }
 
+                _adminLock.Unlock();
+
                 return (result);
             }
             const std::list<ElementaryStream>& Elements() const override
@@ -291,6 +348,8 @@ namespace Implementation {
             void StateChange() {
                 ASSERT(_player != nullptr);
 
+                _adminLock.Lock();
+
                 Exchange::IStream::state oldState = _state;
                 Broadcast::ITuner::state result = _player->State();
 
@@ -317,18 +376,24 @@ namespace Implementation {
                 if ( (oldState != _state) && (_callback != nullptr)) {
                     _callback->StateChange(_state);
                 }
+
+                _adminLock.Unlock();
             }
             void StreamEvent(uint32_t eventId)
             {
+                _adminLock.Lock();
                 if (_callback != nullptr) {
                     _callback->StreamEvent(eventId);
                 }
+                _adminLock.Unlock();
             }
             void PlayerEvent(uint32_t eventId)
             {
+                _adminLock.Lock();
                 if (_callback != nullptr) {
                     _callback->PlayerEvent(eventId);
                 }
+                _adminLock.Unlock();
             }
 
         private:
@@ -352,6 +417,8 @@ namespace Implementation {
             Broadcast::ITuner* _player;
             Sink _sink;
             uint8_t _index;
+            uint8_t _decoder; // attached to the tuner, NoDecoder if none
+            Core::CriticalSection _adminLock;
         };
 
         static PlayerPlatformRegistrationType<QAM, Exchange::IStream::streamtype::Undefined> Register(
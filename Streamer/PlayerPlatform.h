@@ -24,6 +24,7 @@
 #include "Geometry.h"
 #include "Element.h"
 
+#include <list>
 #include <vector>
 #include <set>
 
@@ -52,6 +53,10 @@ namespace Player {
             virtual uint32_t Setup() = 0;
             virtual uint32_t Teardown() = 0;
 
+            // Brings a released player back to Idle, like it was right after Setup, but keeps
+            // what Setup built, so it can be handed out again without building it anew.
+            virtual uint32_t Reset() = 0;
+
             virtual void Callback(ICallback* callback) = 0;
 
             virtual string Metadata() const = 0;
@@ -112,6 +117,8 @@ namespace Player {
                 , _Deinitialize(deinitializer)
                 , _configuration()
                 , _players()
+                , _idle()
+                , _pool(0)
                 , _adminLock()
             {
                 ASSERT(Name().empty() == false);
@@ -145,21 +152,40 @@ namespace Player {
                 result = (_Initialize != nullptr? _Initialize(_configuration) : static_cast<uint32_t>(Core::ERROR_NONE));
 
                 if (result == Core::ERROR_NONE) {
-                    // Pick up the number of frontends
+                    // Pick up the number of frontends and how many of them to keep set up
                     struct DefaultConfig : public Core::JSON::Container {
                     public:
                         DefaultConfig()
                             : Core::JSON::Container()
                             , Frontends(0)
+                            , Pool(0)
                         {
                             Add(_T("frontends"), &Frontends);
+                            Add(_T("pool"), &Pool);
                         }
 
                         Core::JSON::DecUInt8 Frontends;
+                        Core::JSON::DecUInt8 Pool;
                     } config;
 
                     config.FromString(_configuration);
                     _slots.Reset(config.Frontends.Value());
+                    _pool = std::min(config.Pool.Value(), config.Frontends.Value());
+
+                    // Set up the idle players now, so handing one out is only taking it from the pool.
+                    while (_idle.size() < _pool) {
+                        IPlayerPlatform* player = Start(_slots.Find());
+
+                        if (player == nullptr) {
+                            break;
+                        }
+
+                        _idle.push_back(player);
+                    }
+
+                    if (_idle.empty() == false) {
+                        TRACE(Trace::Information, (_T("Player '%s' has %i idle instance(s) set up"), Name().c_str(), static_cast<uint32_t>(_idle.size())));
+                    }
                 }
 
                 _adminLock.Unlock();
@@ -171,11 +197,19 @@ namespace Player {
             {
                 _adminLock.Lock();
 
+                ASSERT(_players.empty() == true);
+
+                while (_idle.empty() == false) {
+                    Stop(_idle.front());
+                    _idle.pop_front();
+                }
+
                 if (_Deinitialize) {
                     _Deinitialize();
                 }
 
                 _slots.Reset();
+                _pool = 0;
 
                 _adminLock.Unlock();
             }
@@ -186,20 +220,15 @@ namespace Player {
 
                 _adminLock.Lock();
 
-                uint8_t index = _slots.Find();
-                if (index < _slots.Size()) {
-                    player =  new PLAYER(Type(), index);
-
-                    if ((player != nullptr) && (player->Setup() != Core::ERROR_NONE)) {
-                        TRACE(Trace::Error, (_T("Player '%s' setup failed!"),  Name().c_str()));
-                        delete player;
-                        player = nullptr;
-                    }
+                if (_idle.empty() == false) {
+                    player = _idle.front();
+                    _idle.pop_front();
+                } else {
+                    player = Start(_slots.Find());
+                }
 
-                    if (player != nullptr) {
-                        _players.emplace(player);
-                        _slots.Set(index);
-                    }
+                if (player != nullptr) {
+                    _players.emplace(player);
                 }
 
                 _adminLock.Unlock();
@@ -216,20 +245,18 @@ namespace Player {
 
                 auto it = _players.find(player);
                 if (it != _players.end()) {
-                    uint8_t index = player->Index();
-                    ASSERT(_slots.IsSet(index) == true);
-
-                    if (_slots.IsSet(index) == true) {
-                        _slots.Clr(index);
+                    ASSERT(_slots.IsSet(player->Index()) == true);
 
-                        if (player->Teardown() != Core::ERROR_NONE) {
-                            TRACE(Trace::Error, (_T("Player %s[%i] teardown failed!"), Name().c_str(), player->Index()));
-                        }
+                    _players.erase(it);
 
-                        _players.erase(it);
-                        delete player;
-                        result = true;
+                    // Back to the pool if there is room and it can be reused, gone otherwise.
+                    if ((_idle.size() < _pool) && (player->Reset() == Core::ERROR_NONE)) {
+                        _idle.push_back(player);
+                    } else {
+                        Stop(player);
                     }
+
+                    result = true;
                 }
 
                 _adminLock.Unlock();
@@ -258,6 +285,41 @@ namespace Player {
             }
 
         private:
+            // Helper functions, not interlocked
+            IPlayerPlatform* Start(const uint8_t index)
+            {
+                IPlayerPlatform* player = nullptr;
+
+                if (index < _slots.Size()) {
+                    player = new PLAYER(Type(), index);
+
+                    if ((player != nullptr) && (player->Setup() != Core::ERROR_NONE)) {
+                        TRACE(Trace::Error, (_T("Player '%s' setup failed!"),  Name().c_str()));
+                        delete player;
+                        player = nullptr;
+                    }
+
+                    if (player != nullptr) {
+                        _slots.Set(index);
+                    }
+                }
+
+                return (player);
+            }
+            void Stop(IPlayerPlatform* player)
+            {
+                const uint8_t index = player->Index();
+
+                if (_slots.IsSet(index) == true) {
+                    _slots.Clr(index);
+                }
+
+                if (player->Teardown() != Core::ERROR_NONE) {
+                    TRACE(Trace::Error, (_T("Player %s[%i] teardown failed!"), Name().c_str(), index));
+                }
+
+                delete player;
+            }
             Exchange::IStream::streamtype Type(const TemplateIntToType<true>& /* For compile time diffrentiation */) const 
             {
                 // Lets load the StreamType from the Player..
@@ -275,6 +337,8 @@ namespace Player {
             DeinitializerType _Deinitialize;
             string _configuration;
             std::set<IPlayerPlatform*> _players;
+            std::list<IPlayerPlatform*> _idle; // Set up, not handed out
+            uint8_t _pool;
             mutable Core::CriticalSection _adminLock;
         };
 
@@ -0,0 +1,334 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Channel change time, from the request until the new stream is Controlled, through the
+// Administrator and the Frontend the plugin hands out. The player only sleeps for what its
+// steps typically cost on a box. Three ways to zap: release the stream and acquire a new one
+// (what a client had to do), the same with a pre-warmed player waiting in the pool, and a Load
+// on the stream that is already playing.
+
+#include <Administrator.h>
+
+#include <chrono>
+#include <cstdio>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace Thunder;
+using namespace Thunder::Player::Implementation;
+
+namespace {
+
+constexpr uint16_t Zaps = 20;
+
+// Typical costs (ms) of the steps of a player.
+constexpr uint16_t SetupCost = 40;
+constexpr uint16_t TeardownCost = 10;
+constexpr uint16_t ResetCost = 2;
+constexpr uint16_t TuneCost = 15;
+constexpr uint16_t AttachCost = 20;
+constexpr uint16_t DetachCost = 5;
+
+void Spend(const uint16_t cost)
+{
+    ::usleep(cost * 1000);
+}
+
+class FakePlayer : public IPlayerPlatform {
+public:
+    FakePlayer() = delete;
+    FakePlayer(const FakePlayer&) = delete;
+    FakePlayer& operator=(const FakePlayer&) = delete;
+
+    FakePlayer(const Exchange::IStream::streamtype streamType, const uint8_t index)
+        : _state(Exchange::IStream::state::Error)
+        , _streamType(streamType)
+        , _index(index)
+        , _callback(nullptr)
+        , _speeds({ 100 })
+        , _rectangle()
+        , _order(0)
+        , _elements()
+    {
+    }
+    ~FakePlayer() override = default;
+
+public:
+    static uint32_t Setups()
+    {
+        return (_setups);
+    }
+
+    uint32_t Setup() override
+    {
+        Spend(SetupCost);
+        _setups++;
+        _state = Exchange::IStream::state::Idle;
+        return (Core::ERROR_NONE);
+    }
+    uint32_t Teardown() override
+    {
+        Spend(TeardownCost);
+        _state = Exchange::IStream::state::Error;
+        return (Core::ERROR_NONE);
+    }
+    uint32_t Reset() override
+    {
+        Spend(ResetCost);
+        _state = Exchange::IStream::state::Idle;
+        return (Core::ERROR_NONE);
+    }
+    void Callback(ICallback* callback) override
+    {
+        _callback = callback;
+    }
+    string Metadata() const override
+    {
+        return (string());
+    }
+    Exchange::IStream::streamtype Type() const override
+    {
+        return (_streamType);
+    }
+    Exchange::IStream::drmtype DRM() const override
+    {
+        return (Exchange::IStream::drmtype::None);
+    }
+    Exchange::IStream::state State() const override
+    {
+        return (_state);
+    }
+    uint32_t Error() const override
+    {
+        return (Core::ERROR_NONE);
+    }
+    uint8_t Index() const override
+    {
+        return (_index);
+    }
+    uint32_t Load(const string& /* uri */) override
+    {
+        Spend(TuneCost);
+
+        // Retuned on the decoder it has, as the real players do.
+        if (_state != Exchange::IStream::state::Controlled) {
+            StateChange(Exchange::IStream::state::Prepared);
+        } else if (_callback != nullptr) {
+            _callback->StateChange(_state);
+        }
+
+        return (Core::ERROR_NONE);
+    }
+    uint32_t AttachDecoder(const uint8_t /* index */) override
+    {
+        Spend(AttachCost);
+        StateChange(Exchange::IStream::state::Controlled);
+        return (Core::ERROR_NONE);
+    }
+    uint32_t DetachDecoder(const uint8_t /* index */) override
+    {
+        Spend(DetachCost);
+        StateChange(Exchange::IStream::state::Prepared);
+        return (Core::ERROR_NONE);
+    }
+    uint32_t Speed(const int32_t /* speed */) override
+    {
+        return (Core::ERROR_NONE);
+    }
+    int32_t Speed() const override
+    {
+        return (100);
+    }
+    const std::vector<int32_t>& Speeds() const override
+    {
+        return (_speeds);
+    }
+    void Position(const uint64_t /* absoluteTime */) override
+    {
+    }
+    uint64_t Position() const override
+    {
+        return (0);
+    }
+    void TimeRange(uint64_t& begin, uint64_t& end) const override
+    {
+        begin = 0;
+        end = ~0;
+    }
+    const Rectangle& Window() const override
+    {
+        return (_rectangle);
+    }
+    void Window(const Rectangle& rectangle) override
+    {
+        _rectangle = rectangle;
+    }
+    uint32_t Order() const override
+    {
+        return (_order);
+    }
+    void Order(const uint32_t order) override
+    {
+        _order = order;
+    }
+    const std::list<ElementaryStream>& Elements() const override
+    {
+        return (_elements);
+    }
+
+private:
+    void StateChange(const Exchange::IStream::state newState)
+    {
+        _state = newState;
+        if (_callback != nullptr) {
+            _callback->StateChange(_state);
+        }
+    }
+
+private:
+    Exchange::IStream::state _state;
+    Exchange::IStream::streamtype _streamType;
+    uint8_t _index;
+    ICallback* _callback;
+    std::vector<int32_t> _speeds;
+    Rectangle _rectangle;
+    uint32_t _order;
+    std::list<ElementaryStream> _elements;
+
+    static uint32_t _setups;
+};
+
+uint32_t FakePlayer::_setups = 0;
+
+static PlayerPlatformRegistrationType<FakePlayer, Exchange::IStream::streamtype::IP> Register;
+
+using Clock = std::chrono::steady_clock;
+
+string Configuration(const uint8_t pool)
+{
+    return (_T("{\"decoders\":1,\"FakePlayer\":{\"frontends\":2,\"pool\":") + Core::NumberType<uint8_t>(pool).Text() + _T("}}"));
+}
+
+string Channel(const uint16_t zap)
+{
+    return (_T("http://127.0.0.1/channel/") + Core::NumberType<uint16_t>(zap).Text() + _T(".ts"));
+}
+
+bool Tune(Exchange::IStream*& stream, Exchange::IStream::IControl*& control, const string& uri)
+{
+    stream = Administrator::Instance().Acquire(Exchange::IStream::streamtype::IP);
+
+    if (stream != nullptr) {
+        stream->Load(uri);
+        control = stream->Control();
+    }
+
+    return ((control != nullptr) && (stream->State() == Exchange::IStream::state::Controlled));
+}
+
+void Drop(Exchange::IStream*& stream, Exchange::IStream::IControl*& control)
+{
+    if (control != nullptr) {
+        control->Release();
+        control = nullptr;
+    }
+    if (stream != nullptr) {
+        stream->Release();
+        stream = nullptr;
+    }
+}
+
+// Every zap gives the stream back and acquires a new one, as a client had to do.
+double Reacquire(const uint8_t pool, bool& correct, uint32_t& setups)
+{
+    Exchange::IStream* stream = nullptr;
+    Exchange::IStream::IControl* control = nullptr;
+    double total = 0;
+
+    Administrator::Instance().Initialize(Configuration(pool));
+    correct = Tune(stream, control, Channel(0)) && correct;
+
+    setups = FakePlayer::Setups();
+
+    for (uint16_t zap = 1; zap <= Zaps; zap++) {
+        const Clock::time_point start = Clock::now();
+
+        Drop(stream, control);
+        correct = Tune(stream, control, Channel(zap)) && correct;
+
+        total += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    setups = FakePlayer::Setups() - setups;
+
+    Drop(stream, control);
+    Administrator::Instance().Deinitialize();
+
+    return (total / Zaps);
+}
+
+// Every zap is a Load on the stream that is playing.
+double Retune(bool& correct)
+{
+    Exchange::IStream* stream = nullptr;
+    Exchange::IStream::IControl* control = nullptr;
+    double total = 0;
+
+    Administrator::Instance().Initialize(Configuration(0));
+    correct = Tune(stream, control, Channel(0)) && correct;
+
+    for (uint16_t zap = 1; zap <= Zaps; zap++) {
+        const Clock::time_point start = Clock::now();
+
+        correct = (stream->Load(Channel(zap)) == Core::ERROR_NONE) && (stream->State() == Exchange::IStream::state::Controlled) && correct;
+
+        total += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    Drop(stream, control);
+    Administrator::Instance().Deinitialize();
+
+    return (total / Zaps);
+}
+
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    bool correct = true;
+    uint32_t setups = 0;
+
+    double zap = Reacquire(0, correct, setups);
+    printf("release and acquire     : %6.1f ms/zap, %u player setups\n", zap, setups);
+
+    zap = Reacquire(1, correct, setups);
+    printf("from the pool           : %6.1f ms/zap, %u player setups\n", zap, setups);
+
+    // Taken from the pool, nothing is set up while zapping.
+    correct = correct && (setups == 0);
+
+    zap = Retune(correct);
+    printf("load on the stream      : %6.1f ms/zap\n", zap);
+
+    printf("channel changes         : %s\n", (correct == true ? "complete" : "FAILED"));
+
+    Core::Singleton::Dispose();
+
+    return (correct == true ? 0 : 1);
+}
@@ -17,6 +17,7 @@
  * limitations under the License.
  */
 #include "Module.h"
+#include "ObjectIndex.h"
 
 #include <cryptography/cryptography.h>
 #include <interfaces/IConfiguration.h>
@@ -74,15 +75,24 @@ namespace Plugin {
                 : Core::JSON::Container()
                 , Connector(_T("/tmp/svalbard"))
                 , Location(_T("objects"))
+                , Index(_T("objects.index"))
             {
                 Add(_T("connector"), &Connector);
                 Add(_T("location"), &Location);
+                Add(_T("index"), &Index);
             }
             ~Config() override = default;
 
         public:
             Core::JSON::String Connector;
             Core::JSON::String Location;
+            Core::JSON::String Index; // within the persistent path of this plugin, empty to import everything at startup
+        };
+
+        struct Object {
+            Exchange::CryptographyVault Vault;
+            uint32_t Id; // 0 until imported into the vault
+            uint32_t Offset; // of the record in the index, 0 if not indexed
         };
 
     public:
@@ -93,6 +103,7 @@ namespace Plugin {
             : _adminLock()
             , _cryptography(nullptr)
             , _rpcLink(nullptr)
+            , _index()
             , _objects()
         {
             TRACE(Trace::Information, (_T("Constructing CryptographyImplementation Service: %p"), this));
@@ -168,8 +179,20 @@ namespace Plugin {
                     persistentPath += (config.Location.Value() + _T("/"));
                 }
 
-                const uint16_t count = ImportObjects(persistentPath);
-                TRACE(Trace::Information, (_T("Imported %d sealed object(s) from '%s'"), count, persistentPath.c_str()));
+                string indexFile;
+
+                if ((config.Index.Value().empty() == false) && (service->PersistentPath().empty() == false)
+                        && (Core::Directory(service->PersistentPath().c_str()).CreatePath() == true)) {
+                    indexFile = service->PersistentPath() + config.Index.Value();
+                }
+
+                if ((indexFile.empty() == false) && (LoadObjects(persistentPath, indexFile) == true)) {
+                    TRACE(Trace::Information, (_T("Indexed %d sealed object(s) from '%s'"), static_cast<uint32_t>(_objects.size()), persistentPath.c_str()));
+                }
+                else {
+                    const uint16_t count = ImportObjects(persistentPath);
+                    TRACE(Trace::Information, (_T("Imported %d sealed object(s) from '%s'"), count, persistentPath.c_str()));
+                }
             }
 
             _adminLock.Unlock();
@@ -192,16 +215,24 @@ namespace Plugin {
                 auto it = _objects.find(label);
 
                 if (it != _objects.end()) {
-                    const Exchange::CryptographyVault& vaultId = (*it).second.first;
+                    Object& object = (*it).second;
 
-                    Exchange::IVault* vault = _cryptography->Vault(vaultId);
+                    Exchange::IVault* vault = _cryptography->Vault(object.Vault);
                     ASSERT(vault != nullptr);
 
                     if (vault != nullptr) {
-                        result = (*it).second.second;
-                        ASSERT(result != 0);
+                        if (object.Id == 0) {
+                            object.Id = ImportObject(label, object.Offset, *vault);
+                        }
+
+                        result = object.Id;
 
-                        outVault = vault;
+                        if (result != 0) {
+                            outVault = vault;
+                        }
+                        else {
+                            vault->Release();
+                        }
                     };
                 }
             }
@@ -271,7 +302,7 @@ namespace Plugin {
                         const string label = (obj.Label.Value().empty() == false?
                                                     obj.Label.Value() : Core::File::FileName(storageDir.Current()));
 
-                        _objects.emplace(label, std::make_pair(vaultId, blobId));
+                        _objects.emplace(label, Object{ vaultId, static_cast<uint32_t>(blobId), 0 });
                         count++;
                     }
                     else {
@@ -288,6 +319,105 @@ namespace Plugin {
             return (count);
         }
 
+        // The object files are parsed and decoded once into the index, on later starts only the
+        // index is read, and only if the directory changed it is scanned for new, changed and
+        // removed files. Objects are imported into their vault when they are asked for.
+        bool LoadObjects(const string& path, const string& indexFile)
+        {
+            const uint64_t stamp = ObjectIndex::Stamp(path);
+
+            if ((_index.Open(indexFile) == false) || (_index.Stamp() != stamp)) {
+                if (_index.IsOpen() == true) {
+                    Synchronize(path, stamp);
+                }
+            }
+
+            if (_index.IsOpen() == true) {
+                _index.Visit([this](const uint32_t offset, const ObjectIndex::Object& object) {
+                    _objects.emplace(string(object.Label, object.LabelLength), Object{ static_cast<Exchange::CryptographyVault>(object.Vault), 0, offset });
+                });
+            }
+            else {
+                TRACE(Trace::Error, (_T("Failed to open the object index '%s'!"), indexFile.c_str()));
+            }
+
+            return (_index.IsOpen());
+        }
+
+        void Synchronize(const string& path, const uint64_t stamp)
+        {
+            uint32_t added = 0;
+            uint32_t removed = 0;
+
+            if (_index.Synchronize(path, stamp, [this](const string& pathName, const string& fileName, const uint64_t signature) { return (IndexObject(pathName, fileName, signature)); }, added, removed) == false) {
+                TRACE(Trace::Error, (_T("Failed to update the object index!")));
+            }
+            else if ((_index.Removed() > _index.Records()) && (_index.Compact() == false)) {
+                TRACE(Trace::Error, (_T("Failed to compact the object index!")));
+            }
+
+            TRACE(Trace::Information, (_T("Object index updated, %d added, %d removed"), added, removed));
+        }
+
+        bool IndexObject(const string& pathName, const string& fileName, const uint64_t signature)
+        {
+            bool result = false;
+
+            TRACE(Trace::Information, (_T("Indexing a sealed object from '%s'..."), fileName.c_str()));
+
+            Core::File file(pathName.c_str());
+
+            if (file.Open(true) == true) {
+                ObjectFile obj;
+                obj.IElement::FromFile(file);
+
+                const Exchange::CryptographyVault vaultId = Cryptography::VaultId(obj.Vault.Value());
+
+                if ((vaultId != static_cast<Exchange::CryptographyVault>(~0))
+                        && (obj.Data.Value().empty() == false) && (obj.Data.Value().size() <= ((0xFFFF * 4) / 3))) {
+
+                    uint16_t blobLength = 0xFFFF;
+
+                    uint8_t* const blob = static_cast<uint8_t*>(ALLOCA(blobLength));
+                    ASSERT(blob != nullptr);
+
+                    if ((Core::FromString(obj.Data.Value(), blob, blobLength) == obj.Data.Value().size()) && (blobLength != 0)) {
+                        const string label = (obj.Label.Value().empty() == false?
+                                                    obj.Label.Value() : Core::File::FileName(pathName));
+
+                        result = (_index.Append(static_cast<uint8_t>(vaultId), signature, fileName, label, blobLength, blob) != 0);
+                    }
+                }
+
+                if (result == false) {
+                    TRACE(Trace::Error, (_T("Failed to index '%s'!"), fileName.c_str()));
+                }
+
+                file.Close();
+            }
+            else {
+                TRACE(Trace::Error, (_T("Failed to open file '%s'!"), fileName.c_str()));
+            }
+
+            return (result);
+        }
+
+        uint32_t ImportObject(const string& label, const uint32_t offset, Exchange::IVault& vault)
+        {
+            uint32_t blobId = 0;
+            ObjectIndex::Object object;
+
+            if ((offset != 0) && (_index.Get(offset, object) == true) && (object.DataLength != 0)) {
+                blobId = vault.Set(object.DataLength, object.Data);
+            }
+
+            if (blobId == 0) {
+                TRACE(Trace::Error, (_T("Failed to import '%s'!"), label.c_str()));
+            }
+
+            return (blobId);
+        }
+
     private:
         class ObjectFile : public Core::JSON::Container {
         public:
@@ -316,7 +446,8 @@ namespace Plugin {
         Core::CriticalSection _adminLock;
         Exchange::ICryptography* _cryptography;
         ExternalAccess* _rpcLink;
-        std::map<string, std::pair<Exchange::CryptographyVault, uint32_t>> _objects;
+        ObjectIndex _index;
+        std::map<string, Object> _objects;
     };
 
     SERVICE_REGISTRATION(CryptographyImplementation, 1, 0)
@@ -0,0 +1,508 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <core/core.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Thunder {
+
+namespace Plugin {
+
+    // A single file holding the decoded provisioned objects, so a restart does not have to parse
+    // and hex-decode every object file again. The file is mapped read only; records are appended
+    // with pwrite and the header, which tells how much of the file is valid, is written last, so
+    // an interrupted append leaves the previous content intact. Every record carries a checksum,
+    // a removed record is only flagged, until Compact() rewrites the file.
+    //
+    // Layout: [Header][Record + source + label + data, padded to 8 bytes]...
+    class ObjectIndex {
+    public:
+        struct Object {
+            uint8_t Vault;
+            uint64_t Signature; // of the source file, to tell if it changed
+            const char* Source;
+            uint16_t SourceLength;
+            const char* Label;
+            uint16_t LabelLength;
+            const uint8_t* Data;
+            uint16_t DataLength;
+        };
+
+    private:
+        static constexpr uint32_t Magic = 0x58495653; // "SVIX"
+        static constexpr uint16_t Version = 2;
+        static constexpr uint8_t REMOVED = 0x01;
+
+        struct Header {
+            uint32_t Magic;
+            uint16_t Version;
+            uint16_t Reserved;
+            uint32_t Records;
+            uint32_t Removed;
+            uint64_t Length; // bytes in use, including this header
+            uint64_t Stamp; // of the directory the objects came from
+            uint32_t Checksum; // over the fields above
+            uint32_t Padding;
+        };
+
+        struct Record {
+            uint32_t Size; // including padding
+            uint8_t Flags; // the only field not covered by the checksum, so a record can be removed in place
+            uint8_t Vault;
+            uint16_t SourceLength;
+            uint16_t LabelLength;
+            uint16_t DataLength;
+            uint32_t Checksum;
+            uint64_t Signature;
+        };
+
+        static_assert((sizeof(Header) % 8) == 0, "Records must stay 8 byte aligned");
+        static_assert((sizeof(Record) % 8) == 0, "Records must stay 8 byte aligned");
+
+    public:
+        ObjectIndex(const ObjectIndex&) = delete;
+        ObjectIndex& operator=(const ObjectIndex&) = delete;
+
+        ObjectIndex()
+            : _fileName()
+            , _descriptor(-1)
+            , _map(nullptr)
+            , _mapped(0)
+            , _header()
+        {
+        }
+        ~ObjectIndex()
+        {
+            Close();
+        }
+
+    public:
+        // Returns true if the file held a valid index. If it did not, it is reset to an empty one.
+        bool Open(const std::string& fileName)
+        {
+            bool valid = false;
+
+            Close();
+
+            _fileName = fileName;
+            _descriptor = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+
+            if (_descriptor != -1) {
+                struct stat info;
+
+                if ((::fstat(_descriptor, &info) == 0) && (static_cast<size_t>(info.st_size) >= sizeof(Header))) {
+                    valid = (Map(static_cast<size_t>(info.st_size)) == true) && (Validate() == true);
+                }
+
+                if (valid == false) {
+                    Reset();
+                }
+            }
+
+            return (valid);
+        }
+        void Close()
+        {
+            Unmap();
+
+            if (_descriptor != -1) {
+                ::close(_descriptor);
+                _descriptor = -1;
+            }
+        }
+        bool IsOpen() const
+        {
+            return (_descriptor != -1);
+        }
+        uint64_t Stamp() const
+        {
+            return (_header.Stamp);
+        }
+        uint32_t Records() const
+        {
+            return (_header.Records - _header.Removed);
+        }
+        uint32_t Removed() const
+        {
+            return (_header.Removed);
+        }
+
+        // Calls action(offset, object) for every record that is not removed. The object points into
+        // the mapping, it stays valid until the next Commit() or Compact().
+        template<typename ACTION>
+        void Visit(ACTION&& action) const
+        {
+            uint64_t offset = sizeof(Header);
+
+            while (offset < std::min(_header.Length, static_cast<uint64_t>(_mapped))) {
+                const Record* record = reinterpret_cast<const Record*>(&_map[offset]);
+
+                if ((record->Flags & REMOVED) == 0) {
+                    action(static_cast<uint32_t>(offset), Describe(*record));
+                }
+
+                offset += record->Size;
+            }
+        }
+        bool Get(const uint32_t offset, Object& object) const
+        {
+            bool result = false;
+
+            if ((offset >= sizeof(Header)) && ((offset + sizeof(Record)) <= std::min(_header.Length, static_cast<uint64_t>(_mapped)))) {
+                const Record* record = reinterpret_cast<const Record*>(&_map[offset]);
+
+                if ((record->Flags & REMOVED) == 0) {
+                    object = Describe(*record);
+                    result = true;
+                }
+            }
+
+            return (result);
+        }
+
+        // Returns the offset of the new record, 0 if it could not be written. The record is not part
+        // of the index before the next Commit().
+        uint32_t Append(const uint8_t vault, const uint64_t signature, const std::string& source, const std::string& label, const uint16_t length, const uint8_t data[])
+        {
+            uint32_t result = 0;
+
+            if ((IsOpen() == true) && (source.size() <= 0xFFFF) && (label.size() <= 0xFFFF)) {
+                const uint32_t payload = static_cast<uint32_t>(source.size() + label.size() + length);
+                const uint32_t size = static_cast<uint32_t>((sizeof(Record) + payload + 7) & ~static_cast<size_t>(7));
+
+                Record record;
+                ::memset(&record, 0, sizeof(record));
+                record.Size = size;
+                record.Vault = vault;
+                record.SourceLength = static_cast<uint16_t>(source.size());
+                record.LabelLength = static_cast<uint16_t>(label.size());
+                record.DataLength = length;
+                record.Signature = signature;
+
+                uint32_t checksum = Checksum(record);
+                checksum = Hash(checksum, reinterpret_cast<const uint8_t*>(source.data()), source.size());
+                checksum = Hash(checksum, reinterpret_cast<const uint8_t*>(label.data()), label.size());
+                record.Checksum = Hash(checksum, data, length);
+
+                static const uint8_t padding[8] = {};
+                const struct iovec parts[] = {
+                    { &record, sizeof(record) },
+                    { const_cast<char*>(source.data()), source.size() },
+                    { const_cast<char*>(label.data()), label.size() },
+                    { const_cast<uint8_t*>(data), length },
+                    { const_cast<uint8_t*>(padding), size - sizeof(Record) - payload }
+                };
+
+                if (::pwritev(_descriptor, parts, sizeof(parts) / sizeof(parts[0]), static_cast<off_t>(_header.Length)) == static_cast<ssize_t>(size)) {
+                    result = static_cast<uint32_t>(_header.Length);
+                    _header.Length += size;
+                    _header.Records++;
+                }
+            }
+
+            return (result);
+        }
+        void Remove(const uint32_t offset)
+        {
+            Object object;
+
+            if (Get(offset, object) == true) {
+                const uint8_t flags = REMOVED;
+
+                if (::pwrite(_descriptor, &flags, sizeof(flags), offset + offsetof(Record, Flags)) == sizeof(flags)) {
+                    _header.Removed++;
+                }
+            }
+        }
+
+        // Makes the appended and removed records part of the index and maps them.
+        bool Commit(const uint64_t stamp)
+        {
+            bool result = false;
+
+            if (IsOpen() == true) {
+                _header.Stamp = stamp;
+                _header.Checksum = Checksum(_header);
+
+                // The records must be on disk before the header that claims them.
+                result = (::fdatasync(_descriptor) == 0) && (::pwrite(_descriptor, &_header, sizeof(_header), 0) == sizeof(_header)) && (::fdatasync(_descriptor) == 0);
+
+                Unmap();
+                result = Map(static_cast<size_t>(_header.Length)) && result;
+            }
+
+            return (result);
+        }
+
+        // Brings the index in line with the *.json files in path, and commits it with the given stamp.
+        // Records of removed and changed files are removed, every new or changed file is handed to
+        // indexer(pathName, fileName, signature), which should Append() it and return if it did.
+        template<typename INDEXER>
+        bool Synchronize(const std::string& path, const uint64_t stamp, INDEXER&& indexer, uint32_t& added, uint32_t& removed)
+        {
+            std::unordered_map<std::string, std::pair<uint32_t, uint64_t>> known;
+
+            added = 0;
+            removed = 0;
+
+            Visit([&known](const uint32_t offset, const Object& object) {
+                known.emplace(std::string(object.Source, object.SourceLength), std::make_pair(offset, object.Signature));
+            });
+
+            Core::Directory storageDir(path.c_str(), _T("*.json"));
+
+            while (storageDir.Next() == true) {
+                const std::string fileName = Core::File::FileNameExtended(storageDir.Current());
+                const uint64_t signature = Signature(storageDir.Current());
+
+                auto entry = known.find(fileName);
+                bool changed = true;
+
+                if (entry != known.end()) {
+                    changed = (entry->second.second != signature);
+
+                    if (changed == true) {
+                        Remove(entry->second.first);
+                        removed++;
+                    }
+
+                    known.erase(entry);
+                }
+
+                if ((changed == true) && (indexer(storageDir.Current(), fileName, signature) == true)) {
+                    added++;
+                }
+            }
+
+            for (const auto& entry : known) {
+                Remove(entry.second.first);
+                removed++;
+            }
+
+            return (Commit(stamp));
+        }
+
+        // Of the directory holding the object files. Adding, removing or renaming an object file
+        // changes the directory, the path is taken along so a different location is never mistaken
+        // for the indexed one. A file rewritten in place leaves it untouched.
+        static uint64_t Stamp(const std::string& path)
+        {
+            struct stat info;
+            uint64_t stamp = 0;
+
+            if (::stat(path.c_str(), &info) == 0) {
+                stamp = Hash(static_cast<uint64_t>(14695981039346656037ULL), reinterpret_cast<const uint8_t*>(path.c_str()), path.size());
+                stamp = Hash(stamp, reinterpret_cast<const uint8_t*>(&info.st_mtim), sizeof(info.st_mtim));
+                stamp = Hash(stamp, reinterpret_cast<const uint8_t*>(&info.st_ino), sizeof(info.st_ino));
+            }
+
+            return (stamp);
+        }
+        // Of an object file, to tell if it changed.
+        static uint64_t Signature(const std::string& pathName)
+        {
+            struct stat info;
+            uint64_t signature = 0;
+
+            if (::stat(pathName.c_str(), &info) == 0) {
+                signature = Hash(static_cast<uint64_t>(14695981039346656037ULL), reinterpret_cast<const uint8_t*>(&info.st_mtim), sizeof(info.st_mtim));
+                signature = Hash(signature, reinterpret_cast<const uint8_t*>(&info.st_size), sizeof(info.st_size));
+                signature = Hash(signature, reinterpret_cast<const uint8_t*>(&info.st_ino), sizeof(info.st_ino));
+            }
+
+            return (signature);
+        }
+
+        // Rewrites the file without the removed records, offsets change.
+        bool Compact()
+        {
+            bool result = false;
+
+            if (IsOpen() == true) {
+                const std::string fileName(_fileName);
+                const std::string temporary(fileName + ".new");
+                ObjectIndex compacted;
+
+                ::unlink(temporary.c_str());
+
+                // A fresh file never holds a valid index.
+                if (compacted.Open(temporary) == false) {
+                    result = true;
+
+                    Visit([&](const uint32_t, const Object& object) {
+                        result = result && (compacted.Append(object.Vault, object.Signature, std::string(object.Source, object.SourceLength), std::string(object.Label, object.LabelLength), object.DataLength, object.Data) != 0);
+                    });
+
+                    result = result && compacted.Commit(_header.Stamp);
+                    compacted.Close();
+
+                    if ((result == true) && (::rename(temporary.c_str(), fileName.c_str()) == 0)) {
+                        result = Open(fileName);
+                    } else {
+                        ::unlink(temporary.c_str());
+                        result = false;
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        static uint32_t Hash(uint32_t hash, const uint8_t data[], const size_t length)
+        {
+            // FNV-1a
+            for (size_t index = 0; index < length; index++) {
+                hash = (hash ^ data[index]) * 16777619u;
+            }
+
+            return (hash);
+        }
+        static uint64_t Hash(uint64_t hash, const uint8_t data[], const size_t length)
+        {
+            // FNV-1a
+            for (size_t index = 0; index < length; index++) {
+                hash = (hash ^ data[index]) * 1099511628211ULL;
+            }
+
+            return (hash);
+        }
+        static uint32_t Checksum(const Header& header)
+        {
+            return (Hash(2166136261u, reinterpret_cast<const uint8_t*>(&header), offsetof(Header, Checksum)));
+        }
+        static uint32_t Checksum(const Record& record)
+        {
+            const uint8_t* raw = reinterpret_cast<const uint8_t*>(&record);
+            uint32_t hash = Hash(2166136261u, &raw[offsetof(Record, Size)], sizeof(record.Size));
+            hash = Hash(hash, &raw[offsetof(Record, Vault)], offsetof(Record, Checksum) - offsetof(Record, Vault));
+            return (Hash(hash, &raw[offsetof(Record, Signature)], sizeof(Record) - offsetof(Record, Signature)));
+        }
+
+        Object Describe(const Record& record) const
+        {
+            const char* payload = reinterpret_cast<const char*>(&record + 1);
+
+            return { record.Vault, record.Signature,
+                payload, record.SourceLength,
+                payload + record.SourceLength, record.LabelLength,
+                reinterpret_cast<const uint8_t*>(payload + record.SourceLength + record.LabelLength), record.DataLength };
+        }
+
+        bool Map(const size_t size)
+        {
+            bool result = true;
+
+            if (size > 0) {
+                void* map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, _descriptor, 0);
+
+                if (map != MAP_FAILED) {
+                    _map = static_cast<const uint8_t*>(map);
+                    _mapped = size;
+                } else {
+                    result = false;
+                }
+            }
+
+            return (result);
+        }
+        void Unmap()
+        {
+            if (_map != nullptr) {
+                ::munmap(const_cast<uint8_t*>(_map), _mapped);
+                _map = nullptr;
+                _mapped = 0;
+            }
+        }
+        bool Validate()
+        {
+            bool valid = false;
+
+            ::memcpy(&_header, _map, sizeof(_header));
+
+            if ((_header.Magic == Magic) && (_header.Version == Version) && (_header.Checksum == Checksum(_header)) && (_header.Length <= _mapped)) {
+                uint64_t offset = sizeof(Header);
+                uint32_t records = 0;
+                uint32_t removed = 0;
+
+                valid = true;
+
+                while ((valid == true) && (offset < _header.Length)) {
+                    const Record* record = reinterpret_cast<const Record*>(&_map[offset]);
+
+                    valid = ((offset + sizeof(Record)) <= _header.Length)
+                        && (record->Size >= (sizeof(Record) + record->SourceLength + record->LabelLength + record->DataLength))
+                        && ((offset + record->Size) <= _header.Length)
+                        && (Hash(Checksum(*record), reinterpret_cast<const uint8_t*>(record + 1), record->SourceLength + record->LabelLength + record->DataLength) == record->Checksum);
+
+                    if (valid == true) {
+                        records++;
+                        removed += ((record->Flags & REMOVED) != 0 ? 1 : 0);
+                        offset += record->Size;
+                    }
+                }
+
+                // The removed count in the header may lag behind, a record is flagged before the header is written.
+                valid = valid && (records == _header.Records);
+                _header.Removed = removed;
+            }
+
+            return (valid);
+        }
+        void Reset()
+        {
+            Unmap();
+
+            ::memset(&_header, 0, sizeof(_header));
+            _header.Magic = Magic;
+            _header.Version = Version;
+            _header.Length = sizeof(Header);
+
+            if ((_descriptor != -1) && (::ftruncate(_descriptor, 0) == 0)) {
+                Commit(0);
+            }
+        }
+
+    private:
+        std::string _fileName;
+        int _descriptor;
+        const uint8_t* _map;
+        size_t _mapped;
+        Header _header;
+    };
+
+} // namespace Plugin
+
+}
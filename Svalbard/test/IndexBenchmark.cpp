@@ -0,0 +1,295 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Startup time of Svalbard with 10k provisioned objects: parsing every object file, as it was done
+// before, against building the index once and reading only the index on the next starts. The index
+// is kept in step by ObjectIndex::Synchronize, as the plugin does, through additions, a changed
+// file, removals and the compaction that follows them.
+
+#ifndef MODULE_NAME
+#define MODULE_NAME SvalbardIndexTest
+#endif
+
+#include <core/core.h>
+
+#include <ObjectIndex.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace Thunder;
+using Plugin::ObjectIndex;
+
+namespace {
+
+constexpr uint16_t Objects = 10000;
+constexpr uint8_t BlobSize = 72; // a wrapped 256 bits key and its tag
+
+class ObjectFile : public Core::JSON::Container {
+public:
+    ObjectFile(const ObjectFile&) = delete;
+    ObjectFile& operator=(const ObjectFile&) = delete;
+    ObjectFile()
+        : Core::JSON::Container()
+        , Vault()
+        , Label()
+        , Data()
+    {
+        Add(_T("vault"), &Vault);
+        Add(_T("label"), &Label);
+        Add(_T("data"), &Data);
+    }
+    ~ObjectFile() override = default;
+
+public:
+    Core::JSON::String Vault;
+    Core::JSON::String Label;
+    Core::JSON::String Data;
+};
+
+using Blobs = std::map<string, std::vector<uint8_t>>;
+
+string FileName(const string& path, const uint16_t index)
+{
+    return (path + _T("object") + Core::NumberType<uint16_t>(index).Text() + _T(".json"));
+}
+
+string Label(const uint16_t index)
+{
+    return (_T("object") + Core::NumberType<uint16_t>(index).Text());
+}
+
+std::vector<uint8_t> Blob(const uint16_t index, const uint8_t size, const uint8_t seed)
+{
+    std::vector<uint8_t> blob(size);
+
+    for (uint8_t position = 0; position < size; position++) {
+        blob[position] = static_cast<uint8_t>((index * 31) + (position * 7) + seed);
+    }
+
+    return (blob);
+}
+
+bool Provision(const string& path, const uint16_t index, const std::vector<uint8_t>& blob)
+{
+    string data;
+
+    Core::ToString(blob.data(), static_cast<uint16_t>(blob.size()), true, data);
+
+    FILE* file = ::fopen(FileName(path, index).c_str(), "w");
+
+    if (file != nullptr) {
+        ::fprintf(file, "{\"vault\":\"platform\",\"label\":\"%s\",\"data\":\"%s\"}", Label(index).c_str(), data.c_str());
+        ::fclose(file);
+    }
+
+    return (file != nullptr);
+}
+
+bool Parse(const string& pathName, string& label, uint16_t& length, uint8_t blob[])
+{
+    bool result = false;
+    Core::File file(pathName.c_str());
+
+    if (file.Open(true) == true) {
+        ObjectFile object;
+        object.IElement::FromFile(file);
+
+        length = 0xFFFF;
+
+        if (Core::FromString(object.Data.Value(), blob, length) == object.Data.Value().size()) {
+            label = object.Label.Value();
+            result = (length != 0);
+        }
+
+        file.Close();
+    }
+
+    return (result);
+}
+
+// What the plugin did on every start: parse and decode every object file.
+Blobs Legacy(const string& path)
+{
+    Blobs blobs;
+    Core::Directory storageDir(path.c_str(), _T("*.json"));
+    uint8_t* const blob = static_cast<uint8_t*>(ALLOCA(0xFFFF));
+
+    while (storageDir.Next() == true) {
+        string label;
+        uint16_t length;
+
+        if (Parse(storageDir.Current(), label, length, blob) == true) {
+            blobs.emplace(label, std::vector<uint8_t>(blob, blob + length));
+        }
+    }
+
+    return (blobs);
+}
+
+// What the plugin does when the directory changed, the vault lookup of the plugin left out.
+bool Synchronize(ObjectIndex& index, const string& path, uint32_t& added, uint32_t& removed)
+{
+    uint8_t* const blob = static_cast<uint8_t*>(ALLOCA(0xFFFF));
+
+    return (index.Synchronize(path, ObjectIndex::Stamp(path), [&index, blob](const string& pathName, const string& fileName, const uint64_t signature) {
+        string label;
+        uint16_t length;
+
+        return ((Parse(pathName, label, length, blob) == true) && (index.Append(1, signature, fileName, label, length, blob) != 0));
+    }, added, removed));
+}
+
+// What the plugin does on a start where the directory did not change.
+std::map<string, uint32_t> Load(ObjectIndex& index, const string& indexFile)
+{
+    std::map<string, uint32_t> objects;
+
+    index.Open(indexFile);
+    index.Visit([&objects](const uint32_t offset, const ObjectIndex::Object& object) {
+        objects.emplace(string(object.Label, object.LabelLength), offset);
+    });
+
+    return (objects);
+}
+
+// Every object must come out of the index as it went into its file, and nothing else.
+bool Matches(const ObjectIndex& index, const Blobs& expected)
+{
+    bool result = (index.Records() == expected.size());
+
+    index.Visit([&](const uint32_t offset, const ObjectIndex::Object& object) {
+        ObjectIndex::Object found;
+        const Blobs::const_iterator blob = expected.find(string(object.Label, object.LabelLength));
+
+        result = result && (index.Get(offset, found) == true) && (blob != expected.end())
+            && (blob->second.size() == object.DataLength) && (::memcmp(blob->second.data(), object.Data, object.DataLength) == 0);
+    });
+
+    return (result);
+}
+
+double Milliseconds(const std::chrono::steady_clock::time_point& start)
+{
+    return (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+int main(int /* argc */, const char* /* argv */[])
+{
+    char root[] = "/tmp/svalbardindexXXXXXX";
+    const bool created = (::mkdtemp(root) != nullptr);
+    const string path = string(root) + _T("/objects/");
+    const string indexFile = string(root) + _T("/objects.index");
+    Blobs expected;
+
+    bool correct = created && (Core::Directory(path.c_str()).CreatePath() == true);
+
+    for (uint16_t index = 0; (index < Objects) && (correct == true); index++) {
+        expected.emplace(Label(index), Blob(index, BlobSize, 0));
+        correct = Provision(path, index, expected[Label(index)]);
+    }
+
+    if (correct == false) {
+        printf("could not provision the objects in %s\n", root);
+    } else {
+        uint32_t added = 0;
+        uint32_t removed = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        const Blobs blobs = Legacy(path);
+        const double legacy = Milliseconds(start);
+
+        ObjectIndex index;
+
+        start = std::chrono::steady_clock::now();
+        index.Open(indexFile);
+        correct = Synchronize(index, path, added, removed) && (added == Objects) && (removed == 0);
+        const double first = Milliseconds(start);
+
+        index.Close();
+
+        start = std::chrono::steady_clock::now();
+        const std::map<string, uint32_t> objects = Load(index, indexFile);
+        const bool current = (index.Stamp() == ObjectIndex::Stamp(path));
+        const double warm = Milliseconds(start);
+
+        correct = correct && (current == true) && (blobs == expected) && (objects.size() == Objects) && (Matches(index, expected) == true);
+
+        // One more object provisioned, only that one is parsed.
+        expected.emplace(Label(Objects), Blob(Objects, BlobSize, 0));
+        Provision(path, Objects, expected[Label(Objects)]);
+
+        start = std::chrono::steady_clock::now();
+        correct = correct && (index.Stamp() != ObjectIndex::Stamp(path)) && Synchronize(index, path, added, removed);
+        const double incremental = Milliseconds(start);
+
+        correct = correct && (added == 1) && (removed == 0) && (Matches(index, expected) == true);
+
+        // A file rewritten with other content, its record is replaced.
+        expected[Label(0)] = Blob(0, BlobSize + 8, 1);
+        Provision(path, 0, expected[Label(0)]);
+
+        start = std::chrono::steady_clock::now();
+        correct = correct && Synchronize(index, path, added, removed);
+        const double changed = Milliseconds(start);
+
+        correct = correct && (added == 1) && (removed == 1) && (Matches(index, expected) == true);
+
+        // Most files removed, their records are flagged and the file is compacted, as the plugin does.
+        for (uint16_t object = 1; object <= (Objects / 2) + 1; object++) {
+            ::unlink(FileName(path, object).c_str());
+            expected.erase(Label(object));
+        }
+
+        start = std::chrono::steady_clock::now();
+        correct = correct && Synchronize(index, path, added, removed) && (added == 0) && (removed == ((Objects / 2) + 1));
+        correct = correct && (index.Removed() > index.Records()) && (index.Compact() == true);
+        const double compacted = Milliseconds(start);
+
+        correct = correct && (index.Removed() == 0) && (Matches(index, expected) == true);
+
+        // And what was compacted reads back the same on the next start.
+        index.Close();
+        correct = correct && (Load(index, indexFile).size() == expected.size()) && (index.Stamp() == ObjectIndex::Stamp(path)) && (Matches(index, expected) == true);
+
+        printf("objects                 : %u\n", Objects);
+        printf("parse every file        : %8.1f ms\n", legacy);
+        printf("first start, build index: %8.1f ms\n", first);
+        printf("next start, read index  : %8.1f ms\n", warm);
+        printf("one object added        : %8.1f ms\n", incremental);
+        printf("one object changed      : %8.1f ms\n", changed);
+        printf("half removed, compacted : %8.1f ms\n", compacted);
+        printf("content                 : %s\n", (correct == true ? "identical" : "MISMATCH"));
+    }
+
+    if ((created == true) && (Core::Directory(root).Destroy() == false)) {
+        printf("could not remove %s\n", root);
+    }
+
+    Core::Singleton::Dispose();
+
+    return (correct == true ? 0 : 1);
+}
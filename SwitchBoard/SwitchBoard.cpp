@@ -37,6 +37,12 @@ namespace Plugin {
     }
 
     static Core::ProxyPoolType<Web::JSONBodyType<SwitchBoard::Config> > jsonBodySwitchFactory(1);
+    static Core::ProxyPoolType<Web::JSONBodyType<SwitchBoard::Timing> > jsonBodyTimingFactory(1);
+
+    static uint32_t Elapsed(const uint64_t start)
+    {
+        return (static_cast<uint32_t>((Core::Time::Now().Ticks() - start) / Core::Time::TicksPerMillisecond));
+    }
 
 PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
     SwitchBoard::SwitchBoard()
@@ -46,6 +52,11 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         , _sink(this)
         , _service(nullptr)
         , _state(INACTIVE)
+        , _suspend(true)
+        , _hibernate(0)
+        , _overlap(true)
+        , _last()
+        , _activator(*this)
         , _job(*this)
     {
     }
@@ -72,6 +83,10 @@ POP_WARNING()
             _service = service;
             _skipURL = static_cast<uint8_t>(_service->WebPrefix().length());
 
+            _suspend = config.Suspend.Value();
+            _hibernate = config.Hibernate.Value();
+            _overlap = config.Overlap.Value();
+
             _service->AddRef();
             _service->Register(&_sink);
 
@@ -88,6 +103,27 @@ POP_WARNING()
                 }
             }
 
+            // Work out, once, in which order the preconditions of every callsign are to be activated.
+            std::map<string, std::vector<string>> declared;
+            Core::JSON::ArrayType<Config::Dependency>::Iterator dependency(config.Dependencies.Elements());
+
+            while (dependency.Next() == true) {
+                std::vector<string>& preconditions(declared[dependency.Current().Callsign.Value()]);
+                Core::JSON::ArrayType<Core::JSON::String>::Iterator precondition(dependency.Current().Preconditions.Elements());
+
+                while (precondition.Next() == true) {
+                    preconditions.push_back(precondition.Current().Value());
+                }
+            }
+
+            for (auto& entry : _switches) {
+                std::vector<string> path;
+                std::vector<Entry*> ordered;
+
+                Resolve(declared, entry.first, path, ordered);
+                entry.second.Preconditions(std::move(ordered));
+            }
+
             if (defaultCallsign.empty() == false) {
                 std::map<string, Entry>::iterator base(_switches.find(defaultCallsign));
 
@@ -100,6 +136,7 @@ POP_WARNING()
                 _service->Unregister(&_sink);
                 _service = nullptr;
                 _switches.clear();
+                _preconditions.clear();
             }
         }
 
@@ -119,6 +156,7 @@ POP_WARNING()
                 index.second.Unregister(&_sink);
             }
             _switches.clear();
+            _preconditions.clear();
 
             Deinitialize();
 
@@ -130,8 +168,27 @@ POP_WARNING()
 
     /* virtual */ string SwitchBoard::Information() const
     {
-        // No additional info to report.
-        return (string());
+        Timing timing;
+        string result;
+
+        _adminLock.Lock();
+
+        if (_last.To.empty() == false) {
+            timing.From = _last.From;
+            timing.To = _last.To;
+            timing.Preconditions = _last.Preconditions;
+            timing.Suspend = _last.Suspend;
+            timing.Activate = _last.Activate;
+            timing.Total = _last.Total;
+        }
+
+        _adminLock.Unlock();
+
+        if (timing.To.IsSet() == true) {
+            timing.ToString(result);
+        }
+
+        return (result);
     }
 
     /* virtual */ void SwitchBoard::Inbound(Web::Request& request VARIABLE_IS_NOT_USED)
@@ -179,6 +236,23 @@ POP_WARNING()
             result->Message = string(_T("OK"));
             result->Body(Core::ProxyType<Web::IBody>(response));
 
+        } else if ( (request.Verb == Web::Request::HTTP_GET) && (index.Current().Text() == _T("Timing")) && (index.Next() == false) ) {
+
+            Core::ProxyType<Web::JSONBodyType<Timing> > response(jsonBodyTimingFactory.Element());
+
+            _adminLock.Lock();
+            response->From = _last.From;
+            response->To = _last.To;
+            response->Preconditions = _last.Preconditions;
+            response->Suspend = _last.Suspend;
+            response->Activate = _last.Activate;
+            response->Total = _last.Total;
+            _adminLock.Unlock();
+
+            result->ErrorCode = Web::STATUS_OK;
+            result->Message = string(_T("OK"));
+            result->Body(Core::ProxyType<Web::IBody>(response));
+
         } else if ( (request.Verb == Web::Request::HTTP_PUT) && (index.Next() == true) ) {
             const string callSign(index.Current().Text());
             uint32_t error = Activate(callSign);
@@ -258,18 +332,7 @@ POP_WARNING()
 
                 if ((&(activate->second) != _activeCallsign) || (activate->second.IsActive() == false)) {
 
-                    if ((_activeCallsign != nullptr) && (&(activate->second) != _activeCallsign)) {
-
-                        if ((result = _activeCallsign->Deactivate()) == Core::ERROR_NONE) {
-                            _activeCallsign = nullptr;
-                        }
-                    }
-
-                    if ((result == Core::ERROR_NONE) &&
-                        ((result = activate->second.Activate()) == Core::ERROR_NONE)) {
-
-                        Activated(activate->second);
-                    }
+                    result = Switch(activate->second);
                 }
             }
 
@@ -310,8 +373,10 @@ POP_WARNING()
                         // check if we can start a default one.
                         _activeCallsign = nullptr;
 
+                        Phases phases{};
+
                         if ((_defaultCallsign != nullptr) &&
-                            ((result = _defaultCallsign->Activate()) == Core::ERROR_NONE)) {
+                            ((result = Bring(*_defaultCallsign, phases)) == Core::ERROR_NONE)) {
 
                             Activated(*_defaultCallsign);
                         }
@@ -348,8 +413,10 @@ POP_WARNING()
                 index++;
             }
 
+            Phases phases{};
+
             _state = IDLE;
-            if ((_defaultCallsign != nullptr) && ((result = _defaultCallsign->Activate()) == Core::ERROR_NONE)) {
+            if ((_defaultCallsign != nullptr) && ((result = Bring(*_defaultCallsign, phases)) == Core::ERROR_NONE)) {
                 Activated(*_defaultCallsign);
             }
         }
@@ -384,6 +451,139 @@ POP_WARNING()
         return(result);
     }
 
+    void SwitchBoard::Resolve(const std::map<string, std::vector<string>>& declared, const string& callsign, std::vector<string>& path, std::vector<Entry*>& ordered)
+    {
+        std::map<string, std::vector<string>>::const_iterator index(declared.find(callsign));
+
+        if (index != declared.end()) {
+
+            path.push_back(callsign);
+
+            for (const string& required : index->second) {
+
+                if (std::find(path.begin(), path.end(), required) != path.end()) {
+                    TRACE(Trace::Error, (_T("Precondition %s of %s is circular, it is ignored"), required.c_str(), callsign.c_str()));
+                } else {
+                    // Whatever the precondition needs comes before it.
+                    Resolve(declared, required, path, ordered);
+
+                    Entry* entry = Lookup(required);
+
+                    if (entry == nullptr) {
+                        TRACE(Trace::Error, (_T("Precondition %s of %s is not available"), required.c_str(), callsign.c_str()));
+                    } else if (std::find(ordered.begin(), ordered.end(), entry) == ordered.end()) {
+                        ordered.push_back(entry);
+                    }
+                }
+            }
+
+            path.pop_back();
+        }
+    }
+
+    SwitchBoard::Entry* SwitchBoard::Lookup(const string& callsign)
+    {
+        Entry* result = nullptr;
+        std::map<string, Entry>::iterator index(_switches.find(callsign));
+
+        if (index != _switches.end()) {
+            result = &(index->second);
+        } else if ((index = _preconditions.find(callsign)) != _preconditions.end()) {
+            result = &(index->second);
+        } else {
+            PluginHost::IShell* shell(_service->QueryInterfaceByCallsign<PluginHost::IShell>(callsign));
+
+            if (shell != nullptr) {
+                result = &(_preconditions.emplace(callsign, Entry(shell)).first->second);
+                shell->Release();
+            }
+        }
+
+        return (result);
+    }
+
+    uint32_t SwitchBoard::Switch(Entry& incoming)
+    {
+        uint32_t result = Core::ERROR_NONE;
+        const uint64_t start = Core::Time::Now().Ticks();
+        Phases phases{};
+
+        // A plugin the incoming one depends on stays up.
+        Entry* outgoing = (((_activeCallsign != nullptr) && (_activeCallsign != &incoming) && (incoming.Requires(*_activeCallsign) == false)) ? _activeCallsign : nullptr);
+
+        phases.From = (_activeCallsign != nullptr ? _activeCallsign->Callsign() : string());
+        phases.To = incoming.Callsign();
+
+        if (outgoing == nullptr) {
+            result = Bring(incoming, phases);
+        } else if (_overlap == true) {
+            _activator.Start(incoming, phases);
+
+            uint32_t parked = Park(*outgoing, phases);
+            result = _activator.Completed();
+
+            if (parked == Core::ERROR_NONE) {
+                _activeCallsign = nullptr;
+            } else if (result == Core::ERROR_NONE) {
+                TRACE(Trace::Error, (_T("Switched to %s, but %s could not be suspended [%d]"), phases.To.c_str(), phases.From.c_str(), parked));
+            }
+        } else if ((result = Park(*outgoing, phases)) == Core::ERROR_NONE) {
+            _activeCallsign = nullptr;
+            result = Bring(incoming, phases);
+        }
+
+        if (result == Core::ERROR_NONE) {
+            Activated(incoming);
+        }
+
+        phases.Total = Elapsed(start);
+
+        TRACE(Switching, (_T("Switch [%s] -> [%s]: preconditions %u ms, suspend %u ms, activate %u ms, total %u ms, result [%d]"),
+            phases.From.c_str(), phases.To.c_str(), phases.Preconditions, phases.Suspend, phases.Activate, phases.Total, result));
+
+        _adminLock.Lock();
+        _last = std::move(phases);
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    uint32_t SwitchBoard::Bring(Entry& entry, Phases& phases)
+    {
+        uint32_t result = Core::ERROR_NONE;
+        uint64_t start = Core::Time::Now().Ticks();
+
+        for (Entry* precondition : entry.Preconditions()) {
+
+            if ((precondition->IsActive() == false) && ((result = precondition->Activate()) != Core::ERROR_NONE)) {
+                TRACE(Trace::Error, (_T("Precondition %s of %s failed to activate [%d]"), precondition->Callsign().c_str(), entry.Callsign().c_str(), result));
+                break;
+            }
+        }
+
+        phases.Preconditions = Elapsed(start);
+        start = Core::Time::Now().Ticks();
+
+        if (result == Core::ERROR_NONE) {
+            result = entry.Activate();
+        }
+
+        phases.Activate = Elapsed(start);
+
+        return (result);
+    }
+
+    uint32_t SwitchBoard::Park(Entry& entry, Phases& phases)
+    {
+        const uint64_t start = Core::Time::Now().Ticks();
+
+        uint32_t result = (_suspend == true ? entry.Park(_hibernate) : entry.Deactivate());
+
+        phases.Suspend = Elapsed(start);
+
+        return (result);
+    }
+
     void SwitchBoard::Activated(Entry& entry) {
 
         if (entry.IsActive() == true) {
@@ -415,9 +615,10 @@ POP_WARNING()
             }
 
             // Oops looks like the active plugin is no longer active. Time to switch to the default.
+            Phases phases{};
             _activeCallsign = nullptr;
 
-            if (_defaultCallsign->Activate() == Core::ERROR_NONE) {
+            if (Bring(*_defaultCallsign, phases) == Core::ERROR_NONE) {
 
                 Activated(*_defaultCallsign);
             }
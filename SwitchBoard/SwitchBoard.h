@@ -39,14 +39,54 @@ namespace Plugin {
                 External
             };
 
+            // Callsigns that have to be running before the callsign is switched to.
+            class Dependency : public Core::JSON::Container {
+            public:
+                Dependency()
+                    : Core::JSON::Container()
+                    , Callsign()
+                    , Preconditions()
+                {
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("preconditions"), &Preconditions);
+                }
+                Dependency(const Dependency& copy)
+                    : Core::JSON::Container()
+                    , Callsign(copy.Callsign)
+                    , Preconditions(copy.Preconditions)
+                {
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("preconditions"), &Preconditions);
+                }
+                Dependency& operator=(const Dependency& RHS)
+                {
+                    Callsign = RHS.Callsign;
+                    Preconditions = RHS.Preconditions;
+                    return (*this);
+                }
+                ~Dependency() override = default;
+
+            public:
+                Core::JSON::String Callsign;
+                Core::JSON::ArrayType<Core::JSON::String> Preconditions;
+            };
+
         public:
             Config()
                 : Core::JSON::Container()
                 , Default()
                 , Callsigns()
+                , Dependencies()
+                , Suspend(true)
+                , Hibernate(0)
+                , Overlap(true)
             {
                 Add(_T("default"), &Default);
                 Add(_T("callsigns"), &Callsigns);
+                Add(_T("dependencies"), &Dependencies);
+                Add(_T("suspend"), &Suspend);
+                Add(_T("hibernate"), &Hibernate);
+                Add(_T("overlap"), &Overlap);
             }
             ~Config()
             {
@@ -55,12 +95,59 @@ namespace Plugin {
         public:
             Core::JSON::String Default;
             Core::JSON::ArrayType<Core::JSON::String> Callsigns;
+            Core::JSON::ArrayType<Dependency> Dependencies;
+            Core::JSON::Boolean Suspend; // leave the outgoing plugin suspended if it can be, instead of deactivating it
+            Core::JSON::DecUInt32 Hibernate; // ms allowed to hibernate a suspended plugin, 0 does not hibernate
+            Core::JSON::Boolean Overlap; // activate the incoming plugin while the outgoing one is being suspended
+        };
+
+        // How long the phases of the last switch took, in ms.
+        class Timing : public Core::JSON::Container {
+        private:
+            Timing(const Timing&) = delete;
+            Timing& operator=(const Timing&) = delete;
+
+        public:
+            Timing()
+                : Core::JSON::Container()
+                , From()
+                , To()
+                , Preconditions(0)
+                , Suspend(0)
+                , Activate(0)
+                , Total(0)
+            {
+                Add(_T("from"), &From);
+                Add(_T("to"), &To);
+                Add(_T("preconditions"), &Preconditions);
+                Add(_T("suspend"), &Suspend);
+                Add(_T("activate"), &Activate);
+                Add(_T("total"), &Total);
+            }
+            ~Timing() override = default;
+
+        public:
+            Core::JSON::String From;
+            Core::JSON::String To;
+            Core::JSON::DecUInt32 Preconditions;
+            Core::JSON::DecUInt32 Suspend;
+            Core::JSON::DecUInt32 Activate;
+            Core::JSON::DecUInt32 Total;
         };
 
     private:
         SwitchBoard(const SwitchBoard&) = delete;
         SwitchBoard& operator= (const SwitchBoard&) = delete;
 
+        struct Phases {
+            string From;
+            string To;
+            uint32_t Preconditions;
+            uint32_t Suspend;
+            uint32_t Activate;
+            uint32_t Total;
+        };
+
         // Trace class for internal information of the SwitchBoard 
         class Switching {
         private:
@@ -146,12 +233,14 @@ namespace Plugin {
         public:
             Entry(PluginHost::IShell* entry)
                 : _shell(entry)
+                , _preconditions()
             {
                 ASSERT(_shell != nullptr);
                 _shell->AddRef();
             }
             Entry(const Entry& copy)
                 : _shell(copy._shell)
+                , _preconditions(copy._preconditions)
             {
                 ASSERT(_shell != nullptr);
                 _shell->AddRef();
@@ -166,6 +255,19 @@ namespace Plugin {
             {
                 return (_shell->Callsign());
             }
+            // In the order they have to be activated.
+            const std::vector<Entry*>& Preconditions() const
+            {
+                return (_preconditions);
+            }
+            void Preconditions(std::vector<Entry*>&& preconditions)
+            {
+                _preconditions = std::move(preconditions);
+            }
+            bool Requires(const Entry& entry) const
+            {
+                return (std::find(_preconditions.begin(), _preconditions.end(), &entry) != _preconditions.end());
+            }
             bool IsActive() const
             {
                 bool running((_shell->State() == PluginHost::IShell::ACTIVATED) ||
@@ -250,6 +352,47 @@ namespace Plugin {
 
                 return (result);
             }
+            // Suspends, and if asked for hibernates, the plugin. Only when it can not be suspended
+            // it is deactivated.
+            uint32_t Park(const uint32_t hibernate) {
+
+                uint32_t result = Core::ERROR_NONE;
+
+                TRACE(Switching, (_T("Parking plugin [%s] on plugin state [%d]"), _shell->Callsign().c_str(), _shell->State()));
+
+                if (_shell->State() == PluginHost::IShell::ACTIVATED) {
+
+                    PluginHost::IStateControl* control(_shell->QueryInterface<PluginHost::IStateControl>());
+
+                    if (control == nullptr) {
+                        result = Core::ERROR_UNAVAILABLE;
+                    } else {
+                        if (control->State() == PluginHost::IStateControl::RESUMED) {
+
+                            result = control->Request(PluginHost::IStateControl::SUSPEND);
+                            TRACE(Switching, (_T("Suspended plugin [%s], result [%d]"), _shell->Callsign().c_str(), result));
+                        }
+
+                        control->Release();
+                    }
+
+                    if ((result == Core::ERROR_NONE) && (hibernate != 0)) {
+
+                        // Not every plugin can be hibernated, suspended is good enough then.
+                        uint32_t hibernated = _shell->Hibernate(hibernate);
+                        TRACE(Switching, (_T("Hibernated plugin [%s], result [%d]"), _shell->Callsign().c_str(), hibernated));
+                    }
+
+                    if (result != Core::ERROR_NONE) {
+
+                        result = _shell->Deactivate(PluginHost::IShell::REQUESTED);
+
+                        TRACE(Switching, (_T("Deactivated plugin [%s], result [%d]"), _shell->Callsign().c_str(), result));
+                    }
+                }
+
+                return (result);
+            }
             void Register(PluginHost::IStateControl::INotification* sink) {
 
                 ASSERT(sink != nullptr);
@@ -277,6 +420,74 @@ namespace Plugin {
 
         private:
             PluginHost::IShell* _shell;
+            std::vector<Entry*> _preconditions;
+        };
+
+        // Brings up the incoming plugin, while the thread doing the switch suspends the outgoing one.
+        class Activator : public Core::Thread {
+        private:
+            Activator() = delete;
+            Activator(const Activator&) = delete;
+            Activator& operator=(const Activator&) = delete;
+
+        public:
+            explicit Activator(SwitchBoard& parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("SwitchBoardActivator"))
+                , _parent(parent)
+                , _entry(nullptr)
+                , _phases(nullptr)
+                , _result(Core::ERROR_NONE)
+                , _signal(false, true)
+                , _done(false, false)
+            {
+                Run();
+            }
+            ~Activator() override
+            {
+                Stop();
+                _signal.SetEvent();
+                Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+            }
+
+        public:
+            void Start(Entry& entry, Phases& phases)
+            {
+                ASSERT(_entry == nullptr);
+
+                _entry = &entry;
+                _phases = &phases;
+                _done.ResetEvent();
+                _signal.SetEvent();
+            }
+            uint32_t Completed()
+            {
+                _done.Lock(Core::infinite);
+                _entry = nullptr;
+                _phases = nullptr;
+
+                return (_result);
+            }
+
+        private:
+            uint32_t Worker() override
+            {
+                _signal.Lock(Core::infinite);
+
+                if ((IsRunning() == true) && (_entry != nullptr) && (_done.IsSet() == false)) {
+                    _result = _parent.Bring(*_entry, *_phases);
+                    _done.SetEvent();
+                }
+
+                return (0);
+            }
+
+        private:
+            SwitchBoard& _parent;
+            Entry* _entry;
+            Phases* _phases;
+            uint32_t _result;
+            Core::Event _signal;
+            Core::Event _done;
         };
 
     public:
@@ -427,6 +638,11 @@ namespace Plugin {
     private:
         uint32_t Initialize();
         uint32_t Deinitialize();
+        void Resolve(const std::map<string, std::vector<string>>& declared, const string& callsign, std::vector<string>& path, std::vector<Entry*>& ordered);
+        Entry* Lookup(const string& callsign);
+        uint32_t Switch(Entry& incoming);
+        uint32_t Bring(Entry& entry, Phases& phases);
+        uint32_t Park(Entry& entry, Phases& phases);
         void Evaluate();
         void Activated(Entry& entry);
         void Activated(const string& callsign, PluginHost::IShell* plugin);
@@ -441,15 +657,21 @@ namespace Plugin {
         }
 
     private:
-        Core::CriticalSection _adminLock;
+        mutable Core::CriticalSection _adminLock;
         uint8_t _skipURL;
         Entry* _defaultCallsign;
         Entry* _activeCallsign;
         std::map<string, Entry> _switches;
+        std::map<string, Entry> _preconditions; // callsigns only switched on for others
         std::list<Exchange::ISwitchBoard::INotification*> _notificationClients;
         Core::SinkType<Notification> _sink;
         PluginHost::IShell* _service;
         volatile state _state;
+        bool _suspend;
+        uint32_t _hibernate;
+        bool _overlap;
+        Phases _last;
+        Activator _activator;
 
         Core::WorkerPool::JobType<SwitchBoard&> _job;
     };
@@ -18,6 +18,7 @@
  */
  
 #include "VolumeControl.h"
+#include <interfaces/IConfiguration.h>
 
 namespace Thunder {
 namespace Plugin {
@@ -53,6 +54,12 @@ namespace Plugin {
         if (_implementation == nullptr) {
             message = _T("Couldn't create volume control instance");
         } else {
+          Exchange::IConfiguration* configuration = _implementation->QueryInterface<Exchange::IConfiguration>();
+          if (configuration != nullptr) {
+              configuration->Configure(_service);
+              configuration->Release();
+          }
+
           _implementation->Register(&_volumeNotification);
           Exchange::JVolumeControl::Register(*this, _implementation);
         }
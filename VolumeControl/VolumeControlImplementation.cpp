@@ -28,25 +28,52 @@ namespace Plugin {
 
     VolumeControlImplementation::VolumeControlImplementation()
         : _adminLock{}
+        , _notifications{}
+        , _interval{100}
         , _platform{std::move(VolumeControlPlatform::Create(
                                 [this]() { NotifyVolumeChange(); },
                                 [this]() { NotifyMutedChange(); }))}
+        , _mailbox{*_platform}
     {
     }
 
-    VolumeControlImplementation::~VolumeControlImplementation() = default;
+    VolumeControlImplementation::~VolumeControlImplementation()
+    {
+        // Nothing may reach the platform, or the subscribers, from here on.
+        _mailbox.Revoke();
+
+        _adminLock.Lock();
+        Subscribers subscribers(std::move(_notifications));
+        _adminLock.Unlock();
+
+        subscribers.clear();
+    }
+
+    uint32_t VolumeControlImplementation::Configure(PluginHost::IShell* service)
+    {
+        ASSERT(service != nullptr);
+
+        Config config;
+        config.FromString(service->ConfigLine());
+
+        _adminLock.Lock();
+        _interval = config.Interval.Value();
+        _adminLock.Unlock();
+
+        return (Core::ERROR_NONE);
+    }
 
     void VolumeControlImplementation::Register(Exchange::IVolumeControl::INotification* notification)
     {
         ASSERT(notification);
 
         _adminLock.Lock();
-        auto item = std::find(_notifications.begin(), _notifications.end(), notification);
+        auto item = std::find_if(_notifications.begin(), _notifications.end(),
+            [notification](const std::unique_ptr<Subscriber>& entry) { return (entry->Sink() == notification); });
         ASSERT(item == _notifications.end());
 
         if (item == _notifications.end()) {
-            notification->AddRef();
-            _notifications.push_back(notification);
+            _notifications.emplace_back(new Subscriber(notification, _interval));
         }
         _adminLock.Unlock();
     }
@@ -55,28 +82,35 @@ namespace Plugin {
     {
         ASSERT(notification);
 
+        std::unique_ptr<Subscriber> entry;
+
         _adminLock.Lock();
-        auto item = std::find(_notifications.begin(), _notifications.end(), notification);
+        auto item = std::find_if(_notifications.begin(), _notifications.end(),
+            [notification](const std::unique_ptr<Subscriber>& entry) { return (entry->Sink() == notification); });
         ASSERT(item != _notifications.end());
 
         if (item != _notifications.end()) {
-            Exchange::IVolumeControl::INotification* entry = *item;
+            entry = std::move(*item);
             _notifications.erase(item);
-            entry->Release();
         }
         _adminLock.Unlock();
-    }
 
+        // Outside the lock, a notification on its way to it has to complete first.
+        entry.reset();
+    }
 
     uint32_t VolumeControlImplementation::Muted(const bool muted)
     {
         TRACE(Trace::Information, (_T("Set Muted: %s"), muted ? _T("true") : _T("false")));
-        return _platform->Muted(muted);
+        _mailbox.Muted(muted);
+        return (Core::ERROR_NONE);
     }
 
     uint32_t VolumeControlImplementation::Muted(bool& muted) const
     {
-        muted = _platform->Muted();
+        if (_mailbox.Muted(muted) == false) {
+            muted = _platform->Muted();
+        }
         TRACE(Trace::Information, (_T("Get Muted: %s"), muted ? _T("true") : _T("false")));
         return Core::ERROR_NONE;
     }
@@ -84,33 +118,127 @@ namespace Plugin {
     uint32_t VolumeControlImplementation::Volume(const uint8_t volume)
     {
         TRACE(Trace::Information, (_T("Set Volume: %d"), volume));
-        return _platform->Volume(volume);
+        _mailbox.Volume(volume);
+        return (Core::ERROR_NONE);
     }
 
     uint32_t VolumeControlImplementation::Volume(uint8_t& vol) const
     {
-        vol = _platform->Volume();
+        if (_mailbox.Volume(vol) == false) {
+            vol = _platform->Volume();
+        }
         TRACE(Trace::Information, (_T("Get Volume: %d"), vol));
         return Core::ERROR_NONE;
     }
 
     void VolumeControlImplementation::NotifyVolumeChange()
     {
+        const uint8_t volume = _platform->Volume();
+
         _adminLock.Lock();
-        for (auto* notification : _notifications) {
-            notification->Volume(_platform->Volume());
+        for (auto& subscriber : _notifications) {
+            subscriber->Volume(volume);
         }
         _adminLock.Unlock();
     }
 
     void VolumeControlImplementation::NotifyMutedChange()
     {
+        const bool muted = _platform->Muted();
+
         _adminLock.Lock();
-        for (auto* notification : _notifications) {
-            notification->Muted(_platform->Muted());
+        for (auto& subscriber : _notifications) {
+            subscriber->Muted(muted);
         }
         _adminLock.Unlock();
     }
 
+    void VolumeControlImplementation::Subscriber::Schedule()
+    {
+        if (_busy == false) {
+            _busy = true;
+
+            // A mute change is not held back, a volume change once the interval has passed.
+            const uint64_t due = _sent + (static_cast<uint64_t>(_interval) * Core::Time::TicksPerMillisecond);
+
+            if ((_pendingMuted == true) || (due <= Core::Time::Now().Ticks())) {
+                _job.Submit();
+            } else {
+                _job.Reschedule(Core::Time(due));
+            }
+        }
+    }
+
+    void VolumeControlImplementation::Subscriber::Dispatch()
+    {
+        _lock.Lock();
+
+        const bool volumeChanged = _pendingVolume;
+        const bool mutedChanged = _pendingMuted;
+        const uint8_t volume = _volume;
+        const bool muted = _muted;
+
+        _pendingVolume = false;
+        _pendingMuted = false;
+
+        if (volumeChanged == true) {
+            _sent = Core::Time::Now().Ticks();
+        }
+
+        _lock.Unlock();
+
+        if (mutedChanged == true) {
+            _sink->Muted(muted);
+        }
+        if (volumeChanged == true) {
+            _sink->Volume(volume);
+        }
+
+        _lock.Lock();
+
+        _busy = false;
+
+        // Whatever came in during the delivery, the latest of it goes out next.
+        if ((_pendingVolume == true) || (_pendingMuted == true)) {
+            Schedule();
+        }
+
+        _lock.Unlock();
+    }
+
+    void VolumeControlImplementation::Mailbox::Dispatch()
+    {
+        bool done = false;
+
+        while (done == false) {
+            _lock.Lock();
+
+            const bool volumeChanged = _pendingVolume;
+            const bool mutedChanged = _pendingMuted;
+            const uint8_t volume = _volume;
+            const bool muted = _muted;
+
+            _pendingVolume = false;
+            _pendingMuted = false;
+
+            if ((volumeChanged == false) && (mutedChanged == false)) {
+                // Up to date, from now on the platform can answer for itself.
+                _volumeSet = false;
+                _mutedSet = false;
+                _busy = false;
+                done = true;
+            }
+
+            _lock.Unlock();
+
+            if ((mutedChanged == true) && (_platform.Muted(muted) != Core::ERROR_NONE)) {
+                TRACE(Trace::Error, (_T("Platform failed to set muted to %s"), muted ? _T("true") : _T("false")));
+            }
+            if ((volumeChanged == true) && (_platform.Volume(volume) != Core::ERROR_NONE)) {
+                TRACE(Trace::Error, (_T("Platform failed to set volume to %d"), volume));
+            }
+        }
+    }
+
 }  // namespace Plugin
 }  // namespace Thunder
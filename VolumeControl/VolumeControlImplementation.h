@@ -22,6 +22,7 @@
 #include <memory>
 
 #include "Module.h"
+#include <interfaces/IConfiguration.h>
 #include <interfaces/IVolumeControl.h>
 
 namespace Thunder {
@@ -29,7 +30,198 @@ namespace Plugin {
 
     class VolumeControlPlatform;
 
-    class VolumeControlImplementation : public Exchange::IVolumeControl {
+    class VolumeControlImplementation : public Exchange::IVolumeControl, public Exchange::IConfiguration {
+    private:
+        class Config : public Core::JSON::Container {
+        public:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+            Config()
+                : Core::JSON::Container()
+                , Interval(100)
+            {
+                Add(_T("interval"), &Interval);
+            }
+            ~Config() override = default;
+
+        public:
+            Core::JSON::DecUInt16 Interval; // ms between two volume notifications to the same subscriber
+        };
+
+        // Holding the volume key sends changes faster than a subscriber can, or wants to, take them.
+        // What a subscriber did not get yet is kept here, a newer value replaces an older one. The
+        // first change goes out right away, after that at most one per interval, and the last one
+        // always goes out.
+        class Subscriber {
+        public:
+            Subscriber() = delete;
+            Subscriber(Subscriber&&) = delete;
+            Subscriber(const Subscriber&) = delete;
+            Subscriber& operator=(Subscriber&&) = delete;
+            Subscriber& operator=(const Subscriber&) = delete;
+
+            Subscriber(Exchange::IVolumeControl::INotification* sink, const uint16_t interval)
+                : _lock()
+                , _sink(sink)
+                , _interval(interval)
+                , _volume(0)
+                , _muted(false)
+                , _pendingVolume(false)
+                , _pendingMuted(false)
+                , _busy(false)
+                , _sent(0)
+                , _job(*this)
+            {
+                _sink->AddRef();
+            }
+            ~Subscriber()
+            {
+                _job.Revoke();
+                _sink->Release();
+            }
+
+        public:
+            const Exchange::IVolumeControl::INotification* Sink() const
+            {
+                return (_sink);
+            }
+            void Revoke()
+            {
+                _job.Revoke();
+            }
+            void Volume(const uint8_t volume)
+            {
+                _lock.Lock();
+                _volume = volume;
+                _pendingVolume = true;
+                Schedule();
+                _lock.Unlock();
+            }
+            void Muted(const bool muted)
+            {
+                _lock.Lock();
+                _muted = muted;
+                _pendingMuted = true;
+                Schedule();
+                _lock.Unlock();
+            }
+
+        private:
+            friend class Core::ThreadPool::JobType<Subscriber&>;
+            void Dispatch();
+            void Schedule();
+
+        private:
+            Core::CriticalSection _lock;
+            Exchange::IVolumeControl::INotification* _sink;
+            const uint16_t _interval;
+            uint8_t _volume;
+            bool _muted;
+            bool _pendingVolume;
+            bool _pendingMuted;
+            bool _busy; // scheduled or delivering
+            uint64_t _sent; // ticks, when the last volume went out
+            Core::ThreadPool::JobType<Subscriber&> _job;
+        };
+
+        // The latest volume and mute state asked for, not yet handed to the platform. The caller
+        // does not wait for the mixer, and values set while it is busy replace each other.
+        class Mailbox {
+        public:
+            Mailbox() = delete;
+            Mailbox(Mailbox&&) = delete;
+            Mailbox(const Mailbox&) = delete;
+            Mailbox& operator=(Mailbox&&) = delete;
+            Mailbox& operator=(const Mailbox&) = delete;
+
+            explicit Mailbox(VolumeControlPlatform& platform)
+                : _lock()
+                , _platform(platform)
+                , _volume(0)
+                , _muted(false)
+                , _pendingVolume(false)
+                , _pendingMuted(false)
+                , _volumeSet(false)
+                , _mutedSet(false)
+                , _busy(false)
+                , _job(*this)
+            {
+            }
+            ~Mailbox()
+            {
+                _job.Revoke();
+            }
+
+        public:
+            void Revoke()
+            {
+                _job.Revoke();
+            }
+            void Volume(const uint8_t volume)
+            {
+                _lock.Lock();
+                _volume = volume;
+                _pendingVolume = true;
+                _volumeSet = true;
+                Schedule();
+                _lock.Unlock();
+            }
+            void Muted(const bool muted)
+            {
+                _lock.Lock();
+                _muted = muted;
+                _pendingMuted = true;
+                _mutedSet = true;
+                Schedule();
+                _lock.Unlock();
+            }
+            // What was asked for last, also when the platform does not have it yet.
+            bool Volume(uint8_t& volume) const
+            {
+                _lock.Lock();
+                const bool pending = _volumeSet;
+                volume = _volume;
+                _lock.Unlock();
+
+                return (pending);
+            }
+            bool Muted(bool& muted) const
+            {
+                _lock.Lock();
+                const bool pending = _mutedSet;
+                muted = _muted;
+                _lock.Unlock();
+
+                return (pending);
+            }
+
+        private:
+            friend class Core::ThreadPool::JobType<Mailbox&>;
+            void Dispatch();
+            void Schedule()
+            {
+                if (_busy == false) {
+                    _busy = true;
+                    _job.Submit();
+                }
+            }
+
+        private:
+            mutable Core::CriticalSection _lock;
+            VolumeControlPlatform& _platform;
+            uint8_t _volume;
+            bool _muted;
+            bool _pendingVolume; // not handed to the platform yet
+            bool _pendingMuted;
+            bool _volumeSet; // set since the mailbox was last empty
+            bool _mutedSet;
+            bool _busy;
+            Core::ThreadPool::JobType<Mailbox&> _job;
+        };
+
+        using Subscribers = std::list<std::unique_ptr<Subscriber>>;
+
     public:
         VolumeControlImplementation(const VolumeControlImplementation&) = delete;
         VolumeControlImplementation& operator=(const VolumeControlImplementation&) = delete;
@@ -39,8 +231,12 @@ namespace Plugin {
 
         BEGIN_INTERFACE_MAP(VolumeControlImplementation)
             INTERFACE_ENTRY(Exchange::IVolumeControl)
+            INTERFACE_ENTRY(Exchange::IConfiguration)
         END_INTERFACE_MAP
 
+        //   IConfiguration methods
+        uint32_t Configure(PluginHost::IShell* service) override;
+
         //   IVolumControl methods
         void Register(Exchange::IVolumeControl::INotification* observer) override;
         void Unregister(const Exchange::IVolumeControl::INotification* observer) override;
@@ -54,9 +250,11 @@ namespace Plugin {
         void NotifyVolumeChange();
 
         Core::CriticalSection _adminLock;
-        std::vector<Exchange::IVolumeControl::INotification*> _notifications;
+        Subscribers _notifications;
+        uint16_t _interval;
 
         std::unique_ptr<VolumeControlPlatform> _platform;
+        Mailbox _mailbox;
     };
 
 }  // namespace Plugin
@@ -21,10 +21,13 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdio>
 #include <mutex>
+#include <thread>
 
 #include <interfaces/IVolumeControl.h>
 #include <test_support/ThunderTestRuntime.h>
@@ -39,6 +42,17 @@ namespace Tests {
         constexpr const char* Locator = VOLUMECONTROL_TEST_LOCATOR;
         constexpr const char* PluginPath = VOLUMECONTROL_TEST_PLUGIN_PATH;
 
+        // As with the volume key held down on a remote: a change every few ms.
+        constexpr uint8_t BurstChanges = 100;
+        constexpr std::chrono::milliseconds BurstSpacing(2);
+        constexpr uint32_t Interval = 100; // ms, the default rate limit of the plugin
+
+        // Clamped at zero, a notification can come in before the burst is measured to be over.
+        uint32_t Milliseconds(const std::chrono::steady_clock::duration duration)
+        {
+            return (static_cast<uint32_t>(std::max(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(), static_cast<std::chrono::milliseconds::rep>(0))));
+        }
+
         class NotificationSink : public Exchange::IVolumeControl::INotification {
         public:
             NotificationSink() = default;
@@ -49,14 +63,32 @@ namespace Tests {
 
             void Volume(const uint8_t volume) override
             {
+                std::lock_guard<std::mutex> lock(_mutex);
                 _lastVolume = volume;
+                _lastVolumeTime = std::chrono::steady_clock::now();
                 _volumeCount++;
+                _condition.notify_all();
             }
 
             void Muted(const bool muted) override
             {
+                std::lock_guard<std::mutex> lock(_mutex);
                 _lastMuted = muted;
                 _mutedCount++;
+                _condition.notify_all();
+            }
+
+            // Notifications are delivered asynchronously, wait until the given one came in.
+            bool WaitForVolume(const uint8_t volume, const std::chrono::milliseconds timeout)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                return (_condition.wait_for(lock, timeout, [&] { return ((_volumeCount > 0) && (_lastVolume == volume)); }));
+            }
+
+            bool WaitForMuted(const bool muted, const std::chrono::milliseconds timeout)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                return (_condition.wait_for(lock, timeout, [&] { return ((_mutedCount > 0) && (_lastMuted == muted)); }));
             }
 
             void Reset()
@@ -87,11 +119,20 @@ namespace Tests {
                 return (_volumeCount);
             }
 
+            std::chrono::steady_clock::time_point LastVolumeTime() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return (_lastVolumeTime);
+            }
+
             BEGIN_INTERFACE_MAP(NotificationSink)
                 INTERFACE_ENTRY(Exchange::IVolumeControl::INotification)
             END_INTERFACE_MAP
 
         private:
+            mutable std::mutex _mutex;
+            std::condition_variable _condition;
+            std::chrono::steady_clock::time_point _lastVolumeTime;
             std::atomic<bool> _lastMuted { false };
             std::atomic<uint8_t> _lastVolume { 0 };
             std::atomic<uint32_t> _mutedCount { 0 };
@@ -108,9 +149,20 @@ namespace Tests {
             auto* volumeControl = Interface();
             ASSERT_NE(volumeControl, nullptr);
 
+            // The platform is written to asynchronously, the notifications of these should not
+            // end up with a subscriber of the test. So wait until they went out.
+            Core::SinkType<NotificationSink> sink;
+            sink.Reset();
+
+            volumeControl->Register(&sink);
+
             EXPECT_EQ(volumeControl->Muted(false), Core::ERROR_NONE);
             EXPECT_EQ(volumeControl->Volume(static_cast<uint8_t>(0)), Core::ERROR_NONE);
 
+            EXPECT_TRUE(sink.WaitForMuted(false, std::chrono::seconds(2)));
+            EXPECT_TRUE(sink.WaitForVolume(0, std::chrono::seconds(2)));
+
+            volumeControl->Unregister(&sink);
             volumeControl->Release();
         }
 
@@ -290,12 +342,14 @@ namespace Tests {
         volumeControl->Register(&sink);
         EXPECT_EQ(volumeControl->Volume(static_cast<uint8_t>(44)), Core::ERROR_NONE);
 
+        EXPECT_TRUE(sink.WaitForVolume(44, std::chrono::seconds(2)));
         EXPECT_EQ(sink.VolumeCount(), 1u);
         EXPECT_EQ(sink.LastVolume(), 44);
 
         volumeControl->Unregister(&sink);
         EXPECT_EQ(volumeControl->Volume(static_cast<uint8_t>(12)), Core::ERROR_NONE);
 
+        EXPECT_FALSE(sink.WaitForVolume(12, std::chrono::milliseconds(500)));
         EXPECT_EQ(sink.VolumeCount(), 1u);
         EXPECT_EQ(sink.LastVolume(), 44);
 
@@ -313,12 +367,14 @@ namespace Tests {
         volumeControl->Register(&sink);
         EXPECT_EQ(volumeControl->Muted(true), Core::ERROR_NONE);
 
+        EXPECT_TRUE(sink.WaitForMuted(true, std::chrono::seconds(2)));
         EXPECT_EQ(sink.MutedCount(), 1u);
         EXPECT_TRUE(sink.LastMuted());
 
         volumeControl->Unregister(&sink);
         EXPECT_EQ(volumeControl->Muted(false), Core::ERROR_NONE);
 
+        EXPECT_FALSE(sink.WaitForMuted(false, std::chrono::milliseconds(500)));
         EXPECT_EQ(sink.MutedCount(), 1u);
         EXPECT_TRUE(sink.LastMuted());
 
@@ -405,6 +461,105 @@ namespace Tests {
         }
     }
 
+    TEST_F(VolumeControlTest, ComRpcVolumeBurstIsCoalesced)
+    {
+        auto* volumeControl = Interface();
+        ASSERT_NE(volumeControl, nullptr);
+
+        Core::SinkType<NotificationSink> sink;
+        sink.Reset();
+
+        volumeControl->Register(&sink);
+
+        std::chrono::steady_clock::duration slowest(0);
+        const auto start = std::chrono::steady_clock::now();
+
+        std::chrono::steady_clock::time_point end;
+
+        for (uint8_t volume = 1; volume <= BurstChanges; ++volume) {
+            const auto before = std::chrono::steady_clock::now();
+            EXPECT_EQ(volumeControl->Volume(volume), Core::ERROR_NONE);
+            end = std::chrono::steady_clock::now();
+            slowest = std::max(slowest, end - before);
+
+            if (volume < BurstChanges) {
+                std::this_thread::sleep_for(BurstSpacing);
+            }
+        }
+
+        // Whatever was skipped, the last value has to come in.
+        EXPECT_TRUE(sink.WaitForVolume(BurstChanges, std::chrono::seconds(2)));
+
+        const uint32_t duration = Milliseconds(end - start);
+        const uint32_t latency = Milliseconds(sink.LastVolumeTime() - end);
+        const uint32_t events = sink.VolumeCount();
+
+        printf("%-32s: %u changes in %u ms, slowest set %u us\n", "burst", BurstChanges, duration,
+            static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(slowest).count()));
+        printf("%-32s: %u events, last one %u ms after the burst\n", "COM-RPC subscriber", events, latency);
+
+        EXPECT_GE(events, 1u);
+        EXPECT_LT(events, static_cast<uint32_t>(BurstChanges));
+        EXPECT_LE(events, (duration / Interval) + 3);
+        EXPECT_LT(latency, Interval + 500);
+
+        volumeControl->Unregister(&sink);
+        volumeControl->Release();
+    }
+
+    TEST_F(VolumeControlTest, JsonRpcVolumeBurstIsCoalesced)
+    {
+        auto link = _runtime.CreateJSONRPCLink(Callsign);
+        ASSERT_TRUE(link.IsValid());
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        uint32_t count = 0;
+        string lastParams;
+        std::chrono::steady_clock::time_point lastTime;
+
+        const uint32_t subscribeResult = link->Subscribe("volume",
+            [&](const string& /* designator */, const string& /* index */, const string& params) {
+                std::lock_guard<std::mutex> lock(mutex);
+                lastParams = params;
+                lastTime = std::chrono::steady_clock::now();
+                count++;
+                condition.notify_one();
+            });
+        ASSERT_EQ(subscribeResult, Core::ERROR_NONE);
+
+        const string last = Core::NumberType<uint8_t>(BurstChanges).Text();
+        const auto start = std::chrono::steady_clock::now();
+
+        std::chrono::steady_clock::time_point end;
+
+        for (uint8_t volume = 1; volume <= BurstChanges; ++volume) {
+            string response;
+            EXPECT_EQ(_runtime.Invoke("VolumeControl.volume", Core::NumberType<uint8_t>(volume).Text(), response), Core::ERROR_NONE);
+            end = std::chrono::steady_clock::now();
+
+            if (volume < BurstChanges) {
+                std::this_thread::sleep_for(BurstSpacing);
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            EXPECT_TRUE(condition.wait_for(lock, std::chrono::seconds(2), [&] { return (lastParams.find(last) != string::npos); }));
+
+            const uint32_t duration = Milliseconds(end - start);
+            const uint32_t latency = Milliseconds(lastTime - end);
+
+            printf("%-32s: %u events, last one %u ms after the burst\n", "JSON-RPC subscriber", count, latency);
+
+            EXPECT_LT(count, static_cast<uint32_t>(BurstChanges));
+            EXPECT_LE(count, (duration / Interval) + 3);
+            EXPECT_LT(latency, Interval + 500);
+        }
+
+        EXPECT_EQ(link->Unsubscribe("volume"), Core::ERROR_NONE);
+    }
+
 } // namespace Tests
 } // namespace Plugin
-} // namespace Thunder
\ No newline at end of file
+} // namespace Thunder
@@ -38,9 +38,11 @@ public:
     Helper(const Helper&) = delete;
     Helper& operator= (const Helper&) = delete;
 
-    Helper(Parameter* parameter, Attribute* attribute)
+    Helper(Parameter* parameter, Attribute* attribute, ParameterTree::Batch& values, Parameter::Results& results)
         : _parameter(parameter)
         , _attribute(attribute)
+        , _values(values)
+        , _results(results)
     {
     }
     virtual ~Helper() = default;
@@ -61,6 +63,8 @@ private:
 private:
     Parameter* _parameter;
     Attribute* _attribute;
+    ParameterTree::Batch& _values;
+    Parameter::Results& _results;
 };
 
 Adapter::Adapter(Handler* handler)
@@ -70,6 +74,8 @@ Adapter::Adapter(Handler* handler)
     , _parameter(nullptr)
     , _attribute(nullptr)
     , _notifier(nullptr)
+    , _values()
+    , _results()
     , _adminLock()
 {
     _dataModel = new DataModel(handler);
@@ -194,7 +200,9 @@ void Adapter::ProcessRequest(char* reqPayload, char* transactionId VARIABLE_IS_N
             resObj->reqType = reqObj->reqType;
             const req_struct* requestObj = reqObj;
 
-            Helper helper(_parameter, _attribute);
+            _adminLock.Lock();
+
+            Helper helper(_parameter, _attribute, _values, _results);
             switch(reqObj->reqType)
             {
             case GET:
@@ -226,6 +234,8 @@ void Adapter::ProcessRequest(char* reqPayload, char* transactionId VARIABLE_IS_N
                 break;
             }
 
+            _adminLock.Unlock();
+
             char* payload = nullptr;
             wdmp_form_response(resObj, &payload);
 
@@ -302,31 +312,32 @@ WebPAStatus Adapter::Helper::GetParameters(const req_struct*& reqObj, res_struct
 
     if ((status == WEBPA_SUCCESS) && (reqObj->u.getReq->paramCnt > 0)) {
         resObj->paramCnt = reqObj->u.getReq->paramCnt;
-        std::map<std::vector<Data>, WebPAStatus> parametersList;
-        _parameter->Values(parameterNames, parametersList);
-        if (parametersList.size() > 0) {
-
-            int i = 0;
-            for (std::map<std::vector<Data>, WebPAStatus>::iterator parameters = parametersList.begin(); parameters != parametersList.end(); parameters++, i++) {
-                resObj->u.getRes->paramNames[i] = strdup(parameterNames[i].c_str());
-                resObj->u.getRes->retParamCnt[i] = parameters->first.size();
-                resObj->retStatus[i] = static_cast<WDMP_STATUS>(parameters->second);
-
-                TRACE(Trace::Information, (_T("Response:> paramNames[%d] = %s"), i, resObj->u.getRes->paramNames[i]));
-                TRACE(Trace::Information, (_T("Response:> retParamCnt[%d] = %zu"), i, resObj->u.getRes->retParamCnt[i]));
-                TRACE(Trace::Information, (_T("Response:> retStatus[%d] = %d"), i, resObj->retStatus[i]));
- 
-                resObj->u.getRes->params[i] = static_cast<param_t*> (calloc(sizeof(param_t), parameters->first.size()));
-                ASSERT(resObj->u.getRes->params[i]);
-                int j = 0;
-                for (auto& parameter: parameters->first) {
+        _parameter->Values(parameterNames, _values, _results);
+
+        for (uint32_t i = 0; i < _results.size(); i++) {
+            const Parameter::Result& result = _results[i];
+
+            resObj->u.getRes->paramNames[i] = strdup(parameterNames[i].c_str());
+            resObj->u.getRes->retParamCnt[i] = result.Count;
+            resObj->retStatus[i] = static_cast<WDMP_STATUS>(result.Status);
+
+            TRACE(Trace::Information, (_T("Response:> paramNames[%d] = %s"), i, resObj->u.getRes->paramNames[i]));
+            TRACE(Trace::Information, (_T("Response:> retParamCnt[%d] = %zu"), i, resObj->u.getRes->retParamCnt[i]));
+            TRACE(Trace::Information, (_T("Response:> retStatus[%d] = %d"), i, resObj->retStatus[i]));
+
+            resObj->u.getRes->params[i] = static_cast<param_t*> (calloc(sizeof(param_t), result.Count));
+            ASSERT((result.Count == 0) || (resObj->u.getRes->params[i] != nullptr));
+            int j = 0;
+            for (uint32_t index = result.Offset; index < (result.Offset + result.Length); index++) {
+                // Only the values that could be read are reported
+                if (_values.Status(index) == FaultCode::NoFault) {
+                    const Data& parameter = _values.Entry(index);
                     resObj->u.getRes->params[i][j].name = strdup(parameter.Name().c_str());
                     resObj->u.getRes->params[i][j].type = static_cast<DATA_TYPE>(parameter.Value().Type());
                     resObj->u.getRes->params[i][j].value = strdup(Utils::ConvertParamValueToString(parameter).c_str());
                     j++;
                 }
             }
-            parametersList.clear();
         }
     } else {
         resObj->retStatus[0] = static_cast<WDMP_STATUS>(status);
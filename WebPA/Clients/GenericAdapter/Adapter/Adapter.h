@@ -102,6 +102,10 @@ private:
     Attribute* _attribute;
     Notifier* _notifier;
 
+    // Reused by every get request, so the values of a request are not allocated over and over.
+    ParameterTree::Batch _values;
+    Parameter::Results _results;
+
     Core::CriticalSection _adminLock;
 };
 
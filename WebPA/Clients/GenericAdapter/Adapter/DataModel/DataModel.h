@@ -20,9 +20,7 @@
 #pragma once
 #include "Module.h"
 #include "Handler.h"
-#include "Utils.h"
-
-#include <tinyxml.h>
+#include "ParameterTree.h"
 
 namespace Thunder {
 
@@ -38,10 +36,6 @@ typedef enum
 DMStatus;
 
 class DataModel {
-private:
-    static constexpr const uint32_t  MaxNumParameters = 2048;
-    static constexpr const TCHAR* InstanceNumberIndicator = "{i}.";
-
 public:
     DataModel() = delete;
     DataModel(const DataModel&) = delete;
@@ -51,22 +45,11 @@ public:
     ~DataModel();
 
     DMStatus LoadDM(const std::string& filename);
-    DMStatus Parameters(const std::string& paramName, std::map<uint32_t, std::pair<std::string, std::string>>& paramList) const;
-    bool IsValidParameter(const std::string& paramName, std::string& dataType) const;
-    int DMHandle() { return _dmHandle; }
-
-private:
-    TiXmlNode* Parameters(TiXmlNode* pParent, const std::string& paramName, std::string& currentParam, std::map<uint32_t, std::pair<std::string, std::string>>& paramList) const;
-    void CheckforParameterMatch(TiXmlNode *pParent, const std::string& paramName, bool& pMatch, std::string& dataType) const;
-    bool IsParamEndsWithInstance(const std::string& paramName) const;
-    void ReplaceWithInstanceNumber(string& paramName, uint16_t instanceNumber) const;
-    bool CheckMatchingParameter(const char* attrValue, const char* paramName, uint32_t& ret) const;
-    bool ValidateParameterInstance(const std::string& paramName, std::string& dataType) const;
-    uint8_t FindInstanceOccurance(const std::string& paramName, std::map<uint8_t, std::pair<std::size_t, std::size_t>>& positions) const;
-    int16_t ParameterInstanceCount(const std::string& paramName) const;
+    bool IsLoaded() const { return (_tree.IsEmpty() == false); }
+    const ParameterTree& Tree() const { return (_tree); }
 
 private:
-    int _dmHandle;
+    ParameterTree _tree;
     Handler* _handler;
 };
 }
@@ -0,0 +1,416 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ParameterTree.h"
+
+#include <tinyxml.h>
+
+namespace Thunder {
+
+static constexpr const TCHAR* InstanceSegment = _T("{i}");
+static constexpr const TCHAR* EntriesSuffix = _T("NumberOfEntries");
+static constexpr const uint8_t ProfileDepth = 2; // Device.<Profile>.
+static constexpr const uint8_t AllSegments = 0xFF;
+static constexpr const uint16_t NameLength = 256;
+
+ParameterTree::ParameterTree()
+    : _nodes()
+    , _root(nullptr)
+    , _parameters(0)
+{
+    Clear();
+}
+
+void ParameterTree::Clear()
+{
+    _nodes.clear();
+    _parameters = 0;
+
+    _nodes.emplace_back();
+    _root = &_nodes.back();
+    _root->Type = Variant::ParamType::TypeNone;
+    _root->Parameter = false;
+    _root->Readable = false;
+    _root->Instance = nullptr;
+    _root->Entries = nullptr;
+    _root->Control = nullptr;
+}
+
+bool ParameterTree::Compile(const TiXmlDocument& document, const Resolver& resolver)
+{
+    Clear();
+
+    // Go to the first object node, ie "Device."
+    const TiXmlNode* child = document.FirstChild();
+    while ((child != nullptr) && ((child->Type() != TiXmlNode::TINYXML_ELEMENT) || (strcmp(child->Value(), "object") != 0))) {
+        child = (child->Type() != TiXmlNode::TINYXML_ELEMENT ? child->NextSibling() : child->FirstChild());
+    }
+
+    for (const TiXmlElement* object = (child != nullptr ? child->ToElement() : nullptr); object != nullptr; object = object->NextSiblingElement("object")) {
+        const char* base = object->Attribute("base");
+
+        if (base != nullptr) {
+            Node* node = Insert(base);
+
+            for (const TiXmlElement* parameter = object->FirstChildElement("parameter"); parameter != nullptr; parameter = parameter->NextSiblingElement("parameter")) {
+                const char* name = parameter->Attribute("base");
+
+                if ((name != nullptr) && (Child(node, name, static_cast<uint16_t>(strlen(name))) == nullptr)) {
+                    const TiXmlElement* syntax = parameter->FirstChildElement("syntax");
+                    const TiXmlElement* type = (syntax != nullptr ? syntax->FirstChildElement() : nullptr);
+                    const char* index = parameter->Attribute("getIdx");
+
+                    Node* leaf = Create(name, node);
+                    leaf->Type = Utils::ConvertToParamType(type != nullptr ? type->Value() : "string");
+                    leaf->Initial = Empty(leaf->Type);
+                    leaf->Parameter = true;
+                    leaf->Readable = ((index != nullptr) && (strtol(index, nullptr, 10) >= 1));
+                    _parameters++;
+                }
+            }
+        }
+    }
+
+    Link(_root, nullptr, 0, resolver);
+
+    return (_parameters > 0);
+}
+
+const ParameterTree::Node* ParameterTree::Find(const string& name) const
+{
+    const Node* node = nullptr;
+
+    if (Utils::IsWildCardParam(name) == false) {
+        node = Walk(name, AllSegments);
+
+        if ((node != nullptr) && (node->Parameter == false)) {
+            node = nullptr;
+        }
+    }
+
+    return (node);
+}
+
+IProfileControl* ParameterTree::Controller(const string& name) const
+{
+    const Node* node = Walk(name, ProfileDepth);
+    return (node != nullptr ? node->Control : nullptr);
+}
+
+uint32_t ParameterTree::Expand(const string& name, Batch& batch) const
+{
+    const uint32_t start = batch.Count();
+
+    if (Utils::IsWildCardParam(name) == true) {
+        const Node* object = Walk(name, AllSegments);
+
+        if ((object != nullptr) && (object->Parameter == false)) {
+            string path(name);
+            path.reserve(NameLength);
+
+            Collect(*object, path, batch, start + MaxParameters);
+
+            if (object->Instance != nullptr) {
+                // The table itself is asked for, so all of its instances.
+                path.resize(path.length() - object->Segment.length() - 1);
+                Table(*object, path, batch, start + MaxParameters);
+            }
+        }
+    }
+
+    return (batch.Count() - start);
+}
+
+void ParameterTree::Parameters(Data parameters[], FaultCode status[], const uint32_t count) const
+{
+    uint32_t index = 0;
+
+    while (index < count) {
+        const IProfileControl* control = Controller(parameters[index].Name());
+        uint32_t end = index + 1;
+
+        while ((end < count) && (Controller(parameters[end].Name()) == control)) {
+            end++;
+        }
+        if (control != nullptr) {
+            control->Parameters(&parameters[index], &status[index], end - index);
+        }
+
+        index = end;
+    }
+}
+
+void ParameterTree::Parameters(const Data parameters[], FaultCode status[], const uint32_t count) const
+{
+    uint32_t index = 0;
+
+    while (index < count) {
+        IProfileControl* control = Controller(parameters[index].Name());
+        uint32_t end = index + 1;
+
+        while ((end < count) && (Controller(parameters[end].Name()) == control)) {
+            end++;
+        }
+        if (control != nullptr) {
+            control->Parameters(&parameters[index], &status[index], end - index);
+        }
+
+        index = end;
+    }
+}
+
+/* static */ Variant ParameterTree::Empty(const Variant::ParamType type)
+{
+    Variant value;
+
+    switch (type) {
+    case Variant::ParamType::TypeInteger:
+        value = Variant(static_cast<int>(0));
+        break;
+    case Variant::ParamType::TypeUnsignedInteger:
+        value = Variant(static_cast<unsigned int>(0));
+        break;
+    case Variant::ParamType::TypeUnsignedLong:
+        value = Variant(static_cast<unsigned long>(0));
+        break;
+    case Variant::ParamType::TypeBoolean:
+        value = Variant(false);
+        break;
+    default:
+        value = Variant(string());
+        break;
+    }
+
+    return (value);
+}
+
+ParameterTree::Node* ParameterTree::Create(const string& segment, Node* parent)
+{
+    _nodes.emplace_back();
+
+    Node* node = &_nodes.back();
+    node->Segment = segment;
+    node->Type = Variant::ParamType::TypeNone;
+    node->Parameter = false;
+    node->Readable = false;
+    node->Instance = nullptr;
+    node->Entries = nullptr;
+    node->Control = nullptr;
+
+    if (segment != InstanceSegment) {
+        std::vector<Node*>::iterator index = std::lower_bound(parent->Index.begin(), parent->Index.end(), segment,
+            [](const Node* entry, const string& value) { return (entry->Segment < value); });
+
+        parent->Children.push_back(node);
+        parent->Index.insert(index, node);
+    } else {
+        ASSERT(parent->Instance == nullptr);
+        parent->Instance = node;
+    }
+
+    return (node);
+}
+
+ParameterTree::Node* ParameterTree::Insert(const string& path)
+{
+    Node* node = _root;
+    size_t start = 0;
+
+    while (start < path.length()) {
+        size_t end = path.find('.', start);
+        if (end == string::npos) {
+            end = path.length();
+        }
+
+        if (end > start) {
+            const string segment(path, start, end - start);
+
+            if (segment == InstanceSegment) {
+                node = (node->Instance != nullptr ? node->Instance : Create(segment, node));
+            } else {
+                Node* child = Child(node, segment.c_str(), static_cast<uint16_t>(segment.length()));
+                node = (child != nullptr ? child : Create(segment, node));
+            }
+        }
+
+        start = end + 1;
+    }
+
+    return (node);
+}
+
+/* static */ ParameterTree::Node* ParameterTree::Child(const Node* parent, const char segment[], const uint16_t length)
+{
+    Node* result = nullptr;
+    uint16_t low = 0;
+    uint16_t high = static_cast<uint16_t>(parent->Index.size());
+
+    while ((low < high) && (result == nullptr)) {
+        const uint16_t middle = (low + high) / 2;
+        const int compare = parent->Index[middle]->Segment.compare(0, string::npos, segment, length);
+
+        if (compare < 0) {
+            low = middle + 1;
+        } else if (compare > 0) {
+            high = middle;
+        } else {
+            result = parent->Index[middle];
+        }
+    }
+
+    return (result);
+}
+
+const ParameterTree::Node* ParameterTree::Walk(const string& name, const uint8_t depth) const
+{
+    const Node* node = _root;
+    const char* text = name.c_str();
+    const char* const end = text + name.length();
+    uint8_t level = 0;
+
+    while ((node != nullptr) && (text < end) && (level < depth)) {
+        const char* separator = static_cast<const char*>(::memchr(text, '.', end - text));
+        if (separator == nullptr) {
+            separator = end;
+        }
+
+        const uint16_t length = static_cast<uint16_t>(separator - text);
+        const char* position = text;
+
+        while ((position < separator) && (isdigit(*position) != 0)) {
+            position++;
+        }
+
+        if (length == 0) {
+            node = nullptr;
+        } else if ((position == separator) && (node->Instance != nullptr)) {
+            node = node->Instance;
+        } else {
+            node = Child(node, text, length);
+        }
+
+        text = (separator < end ? separator + 1 : end);
+        level++;
+    }
+
+    return (node);
+}
+
+void ParameterTree::Link(Node* node, IProfileControl* control, const uint8_t depth, const Resolver& resolver)
+{
+    if (depth == ProfileDepth) {
+        control = resolver(node->Segment);
+    }
+
+    node->Control = control;
+
+    for (Node* child : node->Children) {
+        Link(child, control, depth + 1, resolver);
+
+        if (child->Instance != nullptr) {
+            const string entries(child->Segment + EntriesSuffix);
+            const Node* counter = Child(node, entries.c_str(), static_cast<uint16_t>(entries.length()));
+
+            child->Entries = (((counter != nullptr) && (counter->Parameter == true)) ? counter : nullptr);
+        }
+    }
+
+    if (node->Instance != nullptr) {
+        Link(node->Instance, control, depth + 1, resolver);
+    }
+}
+
+uint32_t ParameterTree::Instances(const Node& table, string& path) const
+{
+    uint32_t count = 0;
+
+    if ((table.Entries != nullptr) && (table.Entries->Control != nullptr)) {
+        const size_t length = path.length();
+
+        path += table.Entries->Segment;
+
+        Data parameter(path, Variant(static_cast<int>(0)));
+        const FaultCode status = static_cast<const IProfileControl*>(table.Entries->Control)->Parameter(parameter);
+
+        path.resize(length);
+
+        if (status == FaultCode::NoFault) {
+            switch (parameter.Value().Type()) {
+            case Variant::ParamType::TypeInteger:
+                count = (parameter.Value().Integer() > 0 ? parameter.Value().Integer() : 0);
+                break;
+            case Variant::ParamType::TypeUnsignedInteger:
+                count = parameter.Value().UnsignedInteger();
+                break;
+            case Variant::ParamType::TypeUnsignedLong:
+                count = static_cast<uint32_t>(parameter.Value().UnsignedLong());
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    return (count);
+}
+
+void ParameterTree::Collect(const Node& object, string& path, Batch& batch, const uint32_t limit) const
+{
+    const size_t length = path.length();
+
+    for (const Node* child : object.Children) {
+        if (batch.Count() >= limit) {
+            break;
+        } else if (child->Parameter == true) {
+            if (child->Readable == true) {
+                path += child->Segment;
+                batch.Add(path, child->Initial);
+                path.resize(length);
+            }
+        } else {
+            path += child->Segment;
+            path += '.';
+            Collect(*child, path, batch, limit);
+            path.resize(length);
+
+            if (child->Instance != nullptr) {
+                Table(*child, path, batch, limit);
+            }
+        }
+    }
+}
+
+void ParameterTree::Table(const Node& table, string& path, Batch& batch, const uint32_t limit) const
+{
+    const size_t length = path.length();
+    const uint32_t count = Instances(table, path);
+    char number[12];
+
+    for (uint32_t instance = 1; (instance <= count) && (batch.Count() < limit); instance++) {
+        snprintf(number, sizeof(number), "%u.", instance);
+
+        path += table.Segment;
+        path += '.';
+        path += number;
+        Collect(*table.Instance, path, batch, limit);
+        path.resize(length);
+    }
+}
+
+}
@@ -0,0 +1,170 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include "IAdapter.h"
+#include "Utils.h"
+
+#include <deque>
+#include <functional>
+
+class TiXmlDocument;
+
+namespace Thunder {
+
+// The data model, compiled once at load time into a tree with one node per path segment.
+// Looking up a name walks its segments, a number matches the "{i}" of a table, and does not
+// allocate. Every node knows the profile controller that serves it, so requests are routed
+// without looking at the name again.
+class ParameterTree {
+public:
+    static constexpr const uint32_t MaxParameters = 2048; // Upper limit of a single wildcard expansion
+
+    using Resolver = std::function<IProfileControl*(const string& profile)>;
+
+    struct Node {
+        string Segment;
+        Variant::ParamType Type;
+        Variant Initial;            // An empty value of the parameter type
+        bool Parameter;
+        bool Readable;              // getIdx >= 1, part of a wildcard expansion
+        Node* Instance;             // The "{i}" node, if this object is a table
+        const Node* Entries;        // <Segment>NumberOfEntries next to a table, holds its instance count
+        IProfileControl* Control;
+        std::vector<Node*> Children; // In document order
+        std::vector<Node*> Index;    // Sorted on segment
+    };
+
+    // Flat storage for the parameters of a request. Slots are reused, once the storage has
+    // grown to the size of the requests seen, filling it in does not allocate.
+    class Batch {
+    public:
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+        Batch()
+            : _entries()
+            , _status()
+            , _count(0)
+        {
+        }
+        ~Batch() = default;
+
+    public:
+        void Clear()
+        {
+            _count = 0;
+        }
+        uint32_t Count() const
+        {
+            return (_count);
+        }
+        uint32_t Add(const string& name, const Variant& value)
+        {
+            if (_count == _entries.size()) {
+                _entries.emplace_back();
+                _status.emplace_back(FaultCode::NoFault);
+            }
+
+            _entries[_count].Name(name);
+            _entries[_count].Value(value);
+            _status[_count] = FaultCode::NoFault;
+
+            return (_count++);
+        }
+        Data* Entries()
+        {
+            return (_entries.data());
+        }
+        FaultCode* Status()
+        {
+            return (_status.data());
+        }
+        const Data& Entry(const uint32_t index) const
+        {
+            ASSERT(index < _count);
+            return (_entries[index]);
+        }
+        FaultCode Status(const uint32_t index) const
+        {
+            ASSERT(index < _count);
+            return (_status[index]);
+        }
+
+    private:
+        std::vector<Data> _entries;
+        std::vector<FaultCode> _status;
+        uint32_t _count;
+    };
+
+public:
+    ParameterTree(const ParameterTree&) = delete;
+    ParameterTree& operator=(const ParameterTree&) = delete;
+
+    ParameterTree();
+    ~ParameterTree() = default;
+
+public:
+    bool Compile(const TiXmlDocument& document, const Resolver& resolver);
+    void Clear();
+
+    bool IsEmpty() const
+    {
+        return (_parameters == 0);
+    }
+    uint32_t Parameters() const
+    {
+        return (_parameters);
+    }
+
+    // The parameter with this full name, nullptr if the data model does not have it.
+    const Node* Find(const string& name) const;
+
+    // The profile controller for a name, only the segments up to the profile are looked at.
+    IProfileControl* Controller(const string& name) const;
+
+    // Appends all readable parameters below the object "name" (ending in a '.') to the batch.
+    // Tables are expanded to their current instances, unless the name selects one.
+    uint32_t Expand(const string& name, Batch& batch) const;
+
+    // Bulk get/set, runs of entries served by the same controller go to it in a single call.
+    // Entries with a status other than NoFault are skipped.
+    void Parameters(Data parameters[], FaultCode status[], const uint32_t count) const;
+    void Parameters(const Data parameters[], FaultCode status[], const uint32_t count) const;
+
+private:
+    static Variant Empty(const Variant::ParamType type);
+    Node* Create(const string& segment, Node* parent);
+    Node* Insert(const string& path);
+    static Node* Child(const Node* parent, const char segment[], const uint16_t length);
+    const Node* Walk(const string& name, const uint8_t depth) const;
+    void Link(Node* node, IProfileControl* control, const uint8_t depth, const Resolver& resolver);
+    uint32_t Instances(const Node& table, string& path) const;
+    void Collect(const Node& object, string& path, Batch& batch, const uint32_t limit) const;
+    void Table(const Node& table, string& path, Batch& batch, const uint32_t limit) const;
+
+private:
+    std::deque<Node> _nodes;
+    Node* _root;
+    uint32_t _parameters;
+};
+
+}
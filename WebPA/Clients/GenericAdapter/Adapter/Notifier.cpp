@@ -136,14 +136,14 @@ std::string Notifier::Source()
     if ((notificationSource.empty() == true) || (notificationSource == UnknownParamValue)) {
 
         std::vector<std::string> parameterName = { DeviceMACParam };
-        std::map<std::vector<Data>, WebPAStatus> paramaters;
+        ParameterTree::Batch values;
+        Parameter::Results results;
         notificationSource = UnknownParamValue;
 
-        _parameter->Values(parameterName, paramaters);
-        if (paramaters.size() > 0) {
-            auto it = paramaters.begin();
-            if (it->first.size() > 0) {
-                std::string deviceMac = it->first[0].Value().String();
+        _parameter->Values(parameterName, values, results);
+        if (results.size() > 0) {
+            if ((results[0].Count > 0) && (values.Entry(results[0].Offset).Value().Type() == Variant::ParamType::TypeString)) {
+                std::string deviceMac = values.Entry(results[0].Offset).Value().String();
                 TRACE(Trace::Information, (_T("[%s] Calling MacToLower for MAC:  %s"), __FUNCTION__, deviceMac.c_str()));
 
                 StringToLower(deviceMac);
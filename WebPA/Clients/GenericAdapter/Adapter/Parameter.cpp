@@ -25,6 +25,7 @@ namespace WebPA {
 Parameter::Parameter(Handler* handler, DataModel* dataModel)
     : _dataModel(dataModel)
     , _handler(handler)
+    , _faults()
     , _adminLock()
 {
 }
@@ -32,120 +33,128 @@ Parameter::Parameter(Handler* handler, DataModel* dataModel)
 Parameter::~Parameter()
 {
 }
-void Parameter::Values(const std::vector<std::string>& parameterNames, std::map<std::vector<Data>, WebPAStatus>& parametersList) const
+void Parameter::Values(const std::vector<std::string>& parameterNames, ParameterTree::Batch& values, Results& results) const
 {
+    values.Clear();
+    results.clear();
+
     for (auto& name: parameterNames) {
-        std::vector<Data> parameters;
+        Result result;
+        result.Offset = values.Count();
+        result.Status = Resolve(name, values);
+        result.Length = values.Count() - result.Offset;
+        result.Count = 0;
+        results.push_back(result);
+    }
+
+    if (values.Count() > 0) {
+        _adminLock.Lock();
+        (static_cast<const Handler&>(*_handler)).Parameters(values.Entries(), values.Status(), values.Count());
+        _adminLock.Unlock();
+    }
+
+    for (uint32_t i = 0; i < results.size(); ++i) {
+        Result& result = results[i];
 
-        WebPAStatus ret = Values(name, parameters);
-        parametersList.insert(std::make_pair(parameters, ret));
-        if ((ret == WEBPA_SUCCESS) && (parameters.size() > 0)) {
-            TRACE(Trace::Information, (_T( "Parameter Name: %s return: %d"), name.c_str(), parameters.size()));
+        if (result.Status == WEBPA_SUCCESS) {
+            for (uint32_t index = result.Offset; index < (result.Offset + result.Length); ++index) {
+                if (values.Status(index) == FaultCode::NoFault) {
+                    result.Count++;
+                }
+            }
+            if (Utils::IsWildCardParam(parameterNames[i])) {
+                // Success, if there is at least one parameter
+                result.Status = (result.Count > 0 ? WEBPA_SUCCESS : WEBPA_FAILURE);
+            } else {
+                result.Status = Utils::ConvertFaultCodeToWPAStatus(values.Status(result.Offset));
+            }
+        }
+        if ((result.Status == WEBPA_SUCCESS) && (result.Count > 0)) {
+            TRACE(Trace::Information, (_T( "Parameter Name: %s return: %d"), parameterNames[i].c_str(), result.Count));
         } else {
-            TRACE(Trace::Information, (_T( "Parameter Name: %s return no value, so keeping empty values to get the status")));
+            TRACE(Trace::Information, (_T( "Parameter Name: %s return no value, so keeping empty values to get the status"), parameterNames[i].c_str()));
         }
     }
 }
 
 WebPAStatus Parameter::Values(const std::vector<Data>& parameters, std::vector<WebPAStatus>& status)
 {
-    WebPAStatus ret = WEBPA_SUCCESS;
-    for (uint16_t i = 0; i < parameters.size(); ++ i) {
-
-        ret = Values(parameters[i]);
-        status[i] = ret;
+    WebPAStatus ret = WEBPA_FAILURE;
 
+    if (status.size() < parameters.size()) {
+        status.resize(parameters.size(), WEBPA_FAILURE);
     }
-    return ret;
-}
 
-WebPAStatus Parameter::Values(const std::string& parameterName, std::vector<Data>& parameters) const
-{
-    WebPAStatus status = WEBPA_FAILURE; // Overall get status
+    if ((_dataModel->IsLoaded() == true) && (parameters.size() > 0)) {
+        const ParameterTree& tree = _dataModel->Tree();
 
-    int32_t dmHandle = _dataModel->DMHandle();
+        _faults.assign(parameters.size(), FaultCode::NoFault);
 
-    if (dmHandle) {
-        if (Utils::IsWildCardParam(parameterName)) { // It is a wildcard Param
-            /* Translate wildcard to list of parameters */
-            std::map<uint32_t, std::pair<std::string, std::string>> dmParamters;
-            DMStatus dmRet = _dataModel->Parameters(parameterName, dmParamters);
-            if (dmRet == DM_SUCCESS && dmParamters.size() > 0) {
-                for (auto&  dmParamter:  dmParamters) {
-                    Variant value(Utils::ConvertToParamType(dmParamter.second.second));
-                    Data param(dmParamter.second.first, value);
-
-                    _adminLock.Lock();
-                    WebPAStatus ret = Utils::ConvertFaultCodeToWPAStatus((static_cast<const Handler&>(*_handler)).Parameter(param));
-                    _adminLock.Unlock();
-
-                    // Fill Only if we can able to get Proper value
-                    if (WEBPA_SUCCESS == ret) {
-                        parameters.push_back(param);
-                        status = WEBPA_SUCCESS; //Set status as success, if there is atleast one parameter
-                    }
-                } // End of Wild card for loop
+        // Validate against the data model first, what is left goes to the profiles in one go.
+        for (uint16_t i = 0; i < parameters.size(); ++i) {
+            const ParameterTree::Node* node = tree.Find(parameters[i].Name());
+
+            if (node == nullptr) {
+                TRACE(Trace::Error, (_T(" Invalid Parameter name %s"), parameters[i].Name().c_str()));
+                status[i] = WEBPA_ERR_INVALID_PARAMETER_NAME;
+                _faults[i] = FaultCode::InvalidParameterName;
+            } else if (node->Type != parameters[i].Value().Type()) {
+                status[i] = WEBPA_ERR_INVALID_PARAMETER_TYPE;
+                _faults[i] = FaultCode::InvalidParameterType;
             } else {
-                TRACE(Trace::Error, (_T( " Wild card Param list is empty")));
-                status = WEBPA_FAILURE;
+                status[i] = WEBPA_SUCCESS;
             }
-            dmParamters.clear();
-
-        } else { // Not a wildcard Parameter Lets fill it
-            TRACE(Trace::Information, (_T( "Get Request for a Non-WildCard Parameter")));
-            std::string dataType;
-
-            if (_dataModel->IsValidParameter (parameterName, dataType)) {
-                TRACE(Trace::Information, (_T( "Valid Parameter..! ")));
-                Variant value(Utils::ConvertToParamType(dataType));
-                Data param(parameterName, value);
-
-                // Convert param.paramType to ParamVal.type
-                TRACE(Trace::Information, (_T( " Values parameterType is %d"), dataType));
-                _adminLock.Lock();
-                status = Utils::ConvertFaultCodeToWPAStatus((static_cast<const Handler&>(*_handler)).Parameter(param));
-                _adminLock.Unlock();
-                if (WEBPA_SUCCESS == status) {
-                    parameters.push_back(param);
-                } else {
-                    TRACE(Trace::Error, (_T( "Failed Get Param Values From Handler: for Param Name :-  %s"), parameterName));
-                }
-            } else {
-                TRACE(Trace::Error, (_T( "Invalid Parameter Name  :-  %s"), parameterName));
-                status = WEBPA_ERR_INVALID_PARAMETER_NAME;
+        }
+
+        _adminLock.Lock();
+        _handler->Parameters(parameters.data(), _faults.data(), static_cast<uint32_t>(parameters.size()));
+        _adminLock.Unlock();
+
+        for (uint16_t i = 0; i < parameters.size(); ++i) {
+            if (status[i] == WEBPA_SUCCESS) {
+                status[i] = Utils::ConvertFaultCodeToWPAStatus(_faults[i]);
+                TRACE(Trace::Information, (_T("handler::Parameter %d"), status[i]));
             }
         }
-    } else {
-        TRACE(Trace::Error, (_T( "Data base Handle is not Initialized %s"), parameterName));
+
+        ret = status[parameters.size() - 1];
     }
-    return status;
+    return ret;
 }
 
-WebPAStatus Parameter::Values(const Data& parameter)
+WebPAStatus Parameter::Resolve(const std::string& parameterName, ParameterTree::Batch& values) const
 {
-    WebPAStatus ret = WEBPA_FAILURE;
-
-    int32_t dmHandle = _dataModel->DMHandle();
+    WebPAStatus status = WEBPA_FAILURE;
 
-    if (dmHandle) {
+    if (_dataModel->IsLoaded() == true) {
+        const ParameterTree& tree = _dataModel->Tree();
 
-        std::string dataType;
-        if (_dataModel->IsValidParameter(parameter.Name(), dataType)) {
-            if (Utils::ConvertToParamType(dataType) == parameter.Value().Type()) {
+        if (Utils::IsWildCardParam(parameterName)) { // It is a wildcard Param
+            // The expansion asks the profiles for the number of instances of the tables in it
+            _adminLock.Lock();
+            const uint32_t count = tree.Expand(parameterName, values);
+            _adminLock.Unlock();
 
-                _adminLock.Lock();
-                ret = Utils::ConvertFaultCodeToWPAStatus(_handler->Parameter(parameter));
-                _adminLock.Unlock();
-                TRACE(Trace::Information, (_T("handler::Parameter %d"), ret));
+            if (count > 0) {
+                status = WEBPA_SUCCESS;
             } else {
-                ret = WEBPA_ERR_INVALID_PARAMETER_TYPE;
+                TRACE(Trace::Error, (_T( " Wild card Param list is empty")));
             }
         } else {
-            TRACE(Trace::Error, (_T(" Invalid Parameter name %s"), parameter.Name()));
-            ret = WEBPA_ERR_INVALID_PARAMETER_NAME;
+            const ParameterTree::Node* node = tree.Find(parameterName);
+
+            if (node != nullptr) {
+                values.Add(parameterName, node->Initial);
+                status = WEBPA_SUCCESS;
+            } else {
+                TRACE(Trace::Error, (_T( "Invalid Parameter Name  :-  %s"), parameterName.c_str()));
+                status = WEBPA_ERR_INVALID_PARAMETER_NAME;
+            }
         }
+    } else {
+        TRACE(Trace::Error, (_T( "Data base Handle is not Initialized %s"), parameterName.c_str()));
     }
-    return ret;
+    return status;
 }
 
 } // WebPA
@@ -35,6 +35,16 @@ typedef enum
 } WEBPA_SET_TYPE;
 
 class Parameter {
+public:
+    // The outcome of one requested name, its values are the entries [Offset, Offset + Length) of
+    // the batch, of which Count were read successfully.
+    struct Result {
+        uint32_t Offset;
+        uint32_t Length;
+        uint32_t Count;
+        WebPAStatus Status;
+    };
+    typedef std::vector<Result> Results;
 
 public:
     Parameter() = delete;
@@ -45,16 +55,17 @@ public:
     Parameter(Handler* handler, DataModel* dataModel);
     virtual ~Parameter();
 
-    void Values(const std::vector<std::string>& parameterNames, std::map<std::vector<Data>, WebPAStatus>& parametersList) const;
+    // All names are resolved (wildcards expanded) into the batch first, and then read in one go.
+    void Values(const std::vector<std::string>& parameterNames, ParameterTree::Batch& values, Results& results) const;
     WebPAStatus Values(const std::vector<Data>& parameters, std::vector<WebPAStatus>& status);
 
 private:
-    WebPAStatus Values(const std::string& parameterName, std::vector<Data>& parameters) const;
-    WebPAStatus Values(const Data& parameter);
+    WebPAStatus Resolve(const std::string& parameterName, ParameterTree::Batch& values) const;
 
 private:
     DataModel* _dataModel;
     Handler* _handler;
+    std::vector<FaultCode> _faults;
 
     mutable Core::CriticalSection _adminLock;
 };
@@ -18,6 +18,7 @@
  */
  
 #include "Handler.h"
+#include "ParameterTree.h"
 
 namespace Thunder {
 
@@ -47,6 +48,7 @@ void Handler::NotificationCallback::NotifyEvent(const EventId& eventId, const Ev
 
 Handler::Handler()
     : _systemLibraries()
+    , _tree(nullptr)
     , _signaled(false, true)
     , _adminLock()
 {
@@ -164,6 +166,32 @@ FaultCode Handler::Parameter(const Data& parameter)
     return ret;
 }
 
+void Handler::Parameters(Data parameters[], FaultCode status[], const uint32_t count) const
+{
+    if (_tree != nullptr) {
+        _tree->Parameters(parameters, status, count);
+    } else {
+        for (uint32_t index = 0; index < count; index++) {
+            if (status[index] == FaultCode::NoFault) {
+                status[index] = Parameter(parameters[index]);
+            }
+        }
+    }
+}
+
+void Handler::Parameters(const Data parameters[], FaultCode status[], const uint32_t count)
+{
+    if (_tree != nullptr) {
+        _tree->Parameters(parameters, status, count);
+    } else {
+        for (uint32_t index = 0; index < count; index++) {
+            if (status[index] == FaultCode::NoFault) {
+                status[index] = Parameter(parameters[index]);
+            }
+        }
+    }
+}
+
 FaultCode Handler::Attribute(Data& parameter) const
 {
     TRACE(Trace::Information, (string(__FUNCTION__)));
@@ -200,18 +228,6 @@ void Handler::FreeData(Data* parameter)
     }
 }
 
-std::vector<std::string> Handler::SplitParam(std::string parameter, char delimeter) const
-{
-    std::stringstream ss(parameter);
-    std::string str;
-    std::vector<std::string> splittedParams;
-    while (std::getline(ss, str, delimeter))
-    {
-       splittedParams.push_back(str);
-    }
-    return splittedParams;
-}
-
 void Handler::ConfigureProfileControllers()
 {
     for (auto& profileController: _systemProfileControllers) {
@@ -219,21 +235,38 @@ void Handler::ConfigureProfileControllers()
     }
 }
 
+void Handler::Tree(const ParameterTree* tree)
+{
+    _adminLock.Lock();
+    _tree = tree;
+    _adminLock.Unlock();
+}
+
+IProfileControl* Handler::Controller(const std::string& profile) const
+{
+    std::map<const std::string, SystemProfileController>::const_iterator index(_systemProfileControllers.find(profile));
+    return (index != _systemProfileControllers.end() ? index->second.control : nullptr);
+}
+
 IProfileControl* Handler::GetProfileController(const std::string& name) const
 {
-    TRACE(Trace::Information, (string(__FUNCTION__)));
     IProfileControl* pRet = nullptr;
 
-    std::vector<std::string> paramComponents = SplitParam(name, '.');
-    if (paramComponents.size() > 1) {
-        std::map<const std::string, SystemProfileController>::const_iterator index(_systemProfileControllers.find(paramComponents[1]));
-        if (_systemProfileControllers.end() != index) {
-            pRet = index->second.control;
-        } else {
-            TRACE(Trace::Information, (_T("Could not able to find Profile controller for %s"), name.c_str()));
+    if (_tree != nullptr) {
+        pRet = _tree->Controller(name);
+    } else {
+        // No data model (yet), the profile is the second segment of the name.
+        const std::size_t start = name.find('.');
+        if (start != std::string::npos) {
+            const std::size_t end = name.find('.', start + 1);
+            pRet = Controller(name.substr(start + 1, (end != std::string::npos ? end - start - 1 : std::string::npos)));
         }
     }
 
+    if (pRet == nullptr) {
+        TRACE(Trace::Information, (_T("Could not able to find Profile controller for %s"), name.c_str()));
+    }
+
     return pRet;
 }
 
@@ -28,6 +28,8 @@
 
 namespace Thunder {
 
+class ParameterTree;
+
 class NotificationHandler {
 public:
     NotificationHandler();
@@ -138,6 +140,10 @@ public:
     FaultCode Parameter(Data& value) const;
     FaultCode Parameter(const Data& value);
 
+    // Bulk access, entries with a status other than NoFault are skipped.
+    void Parameters(Data values[], FaultCode status[], const uint32_t count) const;
+    void Parameters(const Data values[], FaultCode status[], const uint32_t count);
+
     FaultCode Attribute(Data& value) const;
     FaultCode Attribute(const Data& value);
 
@@ -145,16 +151,20 @@ public:
     void ConfigureProfileControllers();
     uint32_t Configure(PluginHost::IShell* service);
 
+    // The compiled data model, once loaded requests are routed through it.
+    void Tree(const ParameterTree* tree);
+    IProfileControl* Controller(const std::string& profile) const;
+
 private:
     uint32_t Worker() override;
     IProfileControl* GetProfileController(const std::string& value) const;
-    std::vector<std::string> SplitParam(std::string parameter, char delimeter) const;
 
 private:
     std::string _configFile;
     std::list<Core::Library> _systemLibraries;
 
     std::map<const std::string, SystemProfileController> _systemProfileControllers;
+    const ParameterTree* _tree;
 
     NotificationCallback* _notificationCallback;
 
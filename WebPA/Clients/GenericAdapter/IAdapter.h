@@ -134,6 +134,26 @@ public:
     // Setter...
     virtual FaultCode Parameter(const Data& parameter) = 0;
 
+    // Bulk getter, all entries are served by this profile. Entries with a status other
+    // than NoFault are skipped. Profiles that can share work between entries override it.
+    virtual void Parameters(Data parameters[], FaultCode status[], const uint32_t count) const
+    {
+        for (uint32_t index = 0; index < count; index++) {
+            if (status[index] == FaultCode::NoFault) {
+                status[index] = Parameter(parameters[index]);
+            }
+        }
+    }
+    // Bulk setter...
+    virtual void Parameters(const Data parameters[], FaultCode status[], const uint32_t count)
+    {
+        for (uint32_t index = 0; index < count; index++) {
+            if (status[index] == FaultCode::NoFault) {
+                status[index] = Parameter(parameters[index]);
+            }
+        }
+    }
+
     virtual void SetCallback(ICallback* cb) = 0;
     virtual void CheckForUpdates() = 0;
 };
@@ -57,19 +57,75 @@ DeviceControl::~DeviceControl()
 FaultCode DeviceControl::Parameter(Data& parameter) const {
     TRACE(Trace::Information, (string(__FUNCTION__)));
 
+    FaultCode ret = FaultCode::Error;
+    std::string name;
+
+    _adminLock.Lock();
+    DeviceInfo* deviceInfo = DeviceInfo::Instance();
+    if (deviceInfo) {
+        ret = Parameter(*deviceInfo, parameter, name);
+    }
+    _adminLock.Unlock();
+
+    return ret;
+}
+
+FaultCode DeviceControl::Parameter(const Data& parameter) {
+    TRACE(Trace::Information, (string(__FUNCTION__)));
+
+    FaultCode ret = FaultCode::Error;
+    std::string name;
+
+    _adminLock.Lock();
+    DeviceInfo* deviceInfo = DeviceInfo::Instance();
+    if (deviceInfo) {
+        ret = Parameter(*deviceInfo, parameter, name);
+    }
+    _adminLock.Unlock();
+
+    return ret;
+}
+
+void DeviceControl::Parameters(Data parameters[], FaultCode status[], const uint32_t count) const {
+    TRACE(Trace::Information, (string(__FUNCTION__)));
+
+    // One lock and one lookup of the instance for the whole batch, the name buffer is reused.
+    std::string name;
+
+    _adminLock.Lock();
+    DeviceInfo* deviceInfo = DeviceInfo::Instance();
+    for (uint32_t index = 0; index < count; index++) {
+        if (status[index] == FaultCode::NoFault) {
+            status[index] = (deviceInfo != nullptr ? Parameter(*deviceInfo, parameters[index], name) : FaultCode::Error);
+        }
+    }
+    _adminLock.Unlock();
+}
+
+void DeviceControl::Parameters(const Data parameters[], FaultCode status[], const uint32_t count) {
+    TRACE(Trace::Information, (string(__FUNCTION__)));
+
+    std::string name;
+
+    _adminLock.Lock();
+    DeviceInfo* deviceInfo = DeviceInfo::Instance();
+    for (uint32_t index = 0; index < count; index++) {
+        if (status[index] == FaultCode::NoFault) {
+            status[index] = (deviceInfo != nullptr ? Parameter(*deviceInfo, parameters[index], name) : FaultCode::Error);
+        }
+    }
+    _adminLock.Unlock();
+}
+
+FaultCode DeviceControl::Parameter(DeviceInfo& deviceInfo, Data& parameter, std::string& name) const {
     FaultCode ret = FaultCode::Error;
     uint32_t instance = 0;
+
     for (auto& prefix : _prefixList) {
         if (parameter.Name().compare(0, prefix.length(), prefix) == 0) {
-            std::string name;
             if (Utils::MatchComponent(parameter.Name(), prefix, name, instance)) {
-                _adminLock.Lock();
-                DeviceInfo* deviceInfo = DeviceInfo::Instance();
-                if (deviceInfo) {
-                    bool changed;
-                    ret = deviceInfo->Parameter(name, parameter, changed);
-                }
-                _adminLock.Unlock();
+                bool changed;
+                ret = deviceInfo.Parameter(name, parameter, changed);
                 break;
             } else {
                 ret = FaultCode::InvalidParameterName;
@@ -80,22 +136,14 @@ FaultCode DeviceControl::Parameter(Data& parameter) const {
     return ret;
 }
 
-FaultCode DeviceControl::Parameter(const Data& parameter) {
-    TRACE(Trace::Information, (string(__FUNCTION__)));
-
+FaultCode DeviceControl::Parameter(DeviceInfo& deviceInfo, const Data& parameter, std::string& name) const {
     FaultCode ret = FaultCode::Error;
     uint32_t instance = 0;
 
     for (auto& prefix : _prefixList) {
         if (parameter.Name().compare(0, prefix.length(), prefix) == 0) {
-            std::string name;
             if (Utils::MatchComponent(parameter.Name(), prefix, name, instance)) {
-                _adminLock.Lock();
-                DeviceInfo* deviceInfo = DeviceInfo::Instance();
-                if (deviceInfo) {
-                     ret = deviceInfo->Parameter(name, parameter);
-                }
-                _adminLock.Unlock();
+                ret = deviceInfo.Parameter(name, parameter);
                 break;
             } else {
                 ret = FaultCode::InvalidParameterName;
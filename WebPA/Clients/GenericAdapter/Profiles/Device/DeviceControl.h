@@ -44,12 +44,19 @@ public:
     FaultCode Parameter(Data& parameter) const override;
     FaultCode Parameter(const Data& parameter) override;
 
+    void Parameters(Data parameters[], FaultCode status[], const uint32_t count) const override;
+    void Parameters(const Data parameters[], FaultCode status[], const uint32_t count) override;
+
     FaultCode Attribute(Data& parameter) const override;
     FaultCode Attribute(const Data& parameter) override;
 
     void SetCallback(IProfileControl::ICallback* cb) override;
     void CheckForUpdates() override;
 
+private:
+    FaultCode Parameter(DeviceInfo& deviceInfo, Data& parameter, std::string& name) const;
+    FaultCode Parameter(DeviceInfo& deviceInfo, const Data& parameter, std::string& name) const;
+
 private:
     NotifierMap _notifier;
     ParameterPrefixList _prefixList;
@@ -82,8 +82,11 @@ public:
 public:
     Variant& operator=(const Variant& RHS)
     {
-        _type = RHS._type;
-        Value(RHS._value);
+        if (this != &RHS) {
+            Clear();
+            _type = RHS._type;
+            Value(RHS._value);
+        }
         return (*this);
     }
 
@@ -144,17 +147,7 @@ public:
 
     virtual ~Variant()
     {
-        switch(_type)
-        {
-        case TypeString:
-            _value.typeString.~basic_string();
-            break;
-        case TypeBase64:
-            _value.typeBase64.~vector();
-            break;
-        default:
-            break;
-        }
+        Clear();
     }
 
 public:
@@ -223,6 +216,20 @@ public:
     }
 
 private:
+    void Clear()
+    {
+        switch(_type)
+        {
+        case TypeString:
+            _value.typeString.~basic_string();
+            break;
+        case TypeBase64:
+            _value.typeBase64.~vector();
+            break;
+        default:
+            break;
+        }
+    }
     void Value(const Value& value)
     {
         switch (_type)
@@ -366,10 +373,13 @@ public:
        return (_name < rhs._name);
     }
 
-    std::string Name() const {
+    const std::string& Name() const {
         return _name;
     }
-    Variant Value() const {
+    void Name(const std::string& name) {
+        _name = name;
+    }
+    const Variant& Value() const {
         return _value;
     }
     void Value(const Variant& value) {
@@ -0,0 +1,314 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays a get of every parameter of the data model against a stub profile: the way it was
+// done before (a walk of the XML document to validate, a split of the name to find the profile,
+// one call per parameter) against the compiled tree and a single bulk call.
+
+#include <ParameterTree.h>
+
+#include <tinyxml.h>
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace Thunder;
+
+namespace {
+
+constexpr uint32_t Instances = 3; // of every table
+constexpr uint16_t Rounds = 20;
+
+class StubProfile : public IProfileControl {
+public:
+    StubProfile(const StubProfile&) = delete;
+    StubProfile& operator=(const StubProfile&) = delete;
+
+    StubProfile()
+        : _calls(0)
+    {
+    }
+    ~StubProfile() override = default;
+
+public:
+    uint32_t Calls() const
+    {
+        return (_calls);
+    }
+    void Reset()
+    {
+        _calls = 0;
+    }
+
+    bool Initialize() override
+    {
+        return (true);
+    }
+    bool Deinitialize() override
+    {
+        return (true);
+    }
+    FaultCode Attribute(Data&) const override
+    {
+        return (FaultCode::MethodNotSupported);
+    }
+    FaultCode Attribute(const Data&) override
+    {
+        return (FaultCode::MethodNotSupported);
+    }
+    FaultCode Parameter(Data& parameter) const override
+    {
+        _calls++;
+        return (Fill(parameter));
+    }
+    FaultCode Parameter(const Data&) override
+    {
+        _calls++;
+        return (FaultCode::NoFault);
+    }
+    void Parameters(Data parameters[], FaultCode status[], const uint32_t count) const override
+    {
+        _calls++;
+
+        for (uint32_t index = 0; index < count; index++) {
+            if (status[index] == FaultCode::NoFault) {
+                status[index] = Fill(parameters[index]);
+            }
+        }
+    }
+    void SetCallback(ICallback*) override
+    {
+    }
+    void CheckForUpdates() override
+    {
+    }
+
+private:
+    static FaultCode Fill(Data& parameter)
+    {
+        const string& name = parameter.Name();
+        const size_t length = ::strlen("NumberOfEntries");
+
+        if ((name.length() > length) && (name.compare(name.length() - length, length, "NumberOfEntries") == 0)) {
+            parameter.Value(Variant(static_cast<unsigned int>(Instances)));
+        } else {
+            parameter.Value(Variant(string("stub")));
+        }
+
+        return (FaultCode::NoFault);
+    }
+
+private:
+    mutable uint32_t _calls;
+};
+
+// What DataModel::CheckforParameterMatch did: a recursive walk of the document for every name.
+bool Match(const TiXmlNode* parent, const string& name, string& object, string& type)
+{
+    bool match = false;
+
+    if (parent->Type() == TiXmlNode::TINYXML_ELEMENT) {
+        const TiXmlElement* element = parent->ToElement();
+        const char* base = element->Attribute("base");
+
+        if (base != nullptr) {
+            if (strcmp(parent->Value(), "object") == 0) {
+                object = base;
+            } else if ((strcmp(parent->Value(), "parameter") == 0) && ((object + base) == name)) {
+                type = parent->FirstChild()->FirstChild()->Value();
+                match = true;
+            }
+        }
+    }
+
+    for (const TiXmlNode* child = parent->FirstChild(); (child != nullptr) && (match == false); child = child->NextSibling()) {
+        match = Match(child, name, object, type);
+    }
+
+    return (match);
+}
+
+// Numbers are replaced by "{i}", the legacy code tried those combinations one walk at the time.
+string Template(const string& name)
+{
+    std::stringstream ss(name);
+    std::string segment;
+    string result;
+
+    while (std::getline(ss, segment, '.')) {
+        result += ((segment.empty() == false) && (segment.find_first_not_of("0123456789") == string::npos) ? "{i}" : segment);
+        result += '.';
+    }
+    result.resize(result.length() - 1);
+
+    return (result);
+}
+
+IProfileControl* Controller(const std::map<const string, IProfileControl*>& profiles, const string& name)
+{
+    std::stringstream ss(name);
+    std::string segment;
+    std::vector<string> segments;
+    IProfileControl* result = nullptr;
+
+    while (std::getline(ss, segment, '.')) {
+        segments.push_back(segment);
+    }
+    if (segments.size() > 1) {
+        std::map<const string, IProfileControl*>::const_iterator index(profiles.find(segments[1]));
+        if (index != profiles.end()) {
+            result = index->second;
+        }
+    }
+
+    return (result);
+}
+
+uint32_t Legacy(const TiXmlDocument& document, const std::map<const string, IProfileControl*>& profiles, const std::vector<string>& names, std::vector<string>& values)
+{
+    std::map<std::vector<Data>, WebPAStatus> response;
+
+    for (const string& name : names) {
+        std::vector<Data> parameters;
+        string object, type;
+        WebPAStatus status = WEBPA_ERR_INVALID_PARAMETER_NAME;
+
+        if ((Match(&document, name, object, type) == true) || (Match(&document, Template(name), object, type) == true)) {
+            Data parameter(name);
+            const IProfileControl* control = Controller(profiles, name);
+
+            status = (control != nullptr ? Utils::ConvertFaultCodeToWPAStatus(control->Parameter(parameter)) : WEBPA_SUCCESS);
+            if (status == WEBPA_SUCCESS) {
+                parameters.push_back(parameter);
+            }
+        }
+        response.insert(std::make_pair(parameters, status));
+    }
+
+    values.clear();
+    for (const auto& entry : response) {
+        for (const Data& parameter : entry.first) {
+            values.push_back(Utils::ConvertParamValueToString(parameter));
+        }
+    }
+
+    return (static_cast<uint32_t>(response.size()));
+}
+
+uint32_t Compiled(const ParameterTree& tree, ParameterTree::Batch& batch, const std::vector<string>& names)
+{
+    uint32_t found = 0;
+
+    batch.Clear();
+
+    for (const string& name : names) {
+        const ParameterTree::Node* node = tree.Find(name);
+
+        if (node != nullptr) {
+            batch.Add(name, node->Initial);
+            found++;
+        }
+    }
+
+    tree.Parameters(batch.Entries(), batch.Status(), batch.Count());
+
+    return (found);
+}
+
+double Microseconds(const std::chrono::steady_clock::time_point& start, const uint16_t rounds)
+{
+    return (std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds);
+}
+
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    const char* file = (argc > 1 ? argv[1] : DATA_MODEL_FILE);
+    TiXmlDocument document(file);
+    bool correct = document.LoadFile();
+
+    if (correct == false) {
+        printf("could not load the data model %s\n", file);
+    } else {
+        StubProfile stub;
+        std::map<const string, IProfileControl*> profiles;
+        ParameterTree tree;
+        ParameterTree::Batch batch;
+
+        // One stub serves every profile of the data model.
+        auto start = std::chrono::steady_clock::now();
+        correct = tree.Compile(document, [&stub, &profiles](const string& profile) {
+            profiles.emplace(profile, &stub);
+            return (&stub);
+        });
+        const double compile = Microseconds(start, 1);
+
+        // The whole model, as the cloud asks for it with "Device."
+        start = std::chrono::steady_clock::now();
+        for (uint16_t round = 0; round < Rounds; round++) {
+            batch.Clear();
+            tree.Expand(_T("Device."), batch);
+        }
+        const double expand = Microseconds(start, Rounds);
+
+        std::vector<string> names;
+        for (uint32_t index = 0; index < batch.Count(); index++) {
+            names.push_back(batch.Entry(index).Name());
+        }
+
+        // Sorted, so both answers come out in the same order.
+        std::sort(names.begin(), names.end());
+
+        std::vector<string> legacyValues;
+        stub.Reset();
+        start = std::chrono::steady_clock::now();
+        uint32_t legacy = Legacy(document, profiles, names, legacyValues);
+        const double before = Microseconds(start, 1);
+        const uint32_t legacyCalls = stub.Calls();
+
+        uint32_t compiled = 0;
+        stub.Reset();
+        start = std::chrono::steady_clock::now();
+        for (uint16_t round = 0; round < Rounds; round++) {
+            compiled = Compiled(tree, batch, names);
+        }
+        const double after = Microseconds(start, Rounds);
+        const uint32_t compiledCalls = stub.Calls() / Rounds;
+
+        correct = correct && (legacy == names.size()) && (compiled == names.size()) && (legacyValues.size() == batch.Count());
+
+        for (uint32_t index = 0; (index < batch.Count()) && (correct == true); index++) {
+            correct = (batch.Status(index) == FaultCode::NoFault) && (legacyValues[index] == Utils::ConvertParamValueToString(batch.Entry(index)));
+        }
+
+        printf("data model              : %u parameters, compiled in %.1f us\n", tree.Parameters(), compile);
+        printf("\"Device.\" expansion     : %u parameters in %.1f us\n", batch.Count(), expand);
+        printf("get by name, before     : %10.1f us/request, %u profile calls\n", before, legacyCalls);
+        printf("get by name, compiled   : %10.1f us/request, %u profile calls\n", after, compiledCalls);
+        printf("values                  : %s\n", (correct == true ? "identical" : "MISMATCH"));
+    }
+
+    Core::Singleton::Dispose();
+
+    return (correct == true ? 0 : 1);
+}
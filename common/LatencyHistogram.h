@@ -0,0 +1,305 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Only needs the core, the load generator of the testconsole uses it as well.
+#include <core/core.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace Thunder {
+namespace Plugin {
+
+    // Log-linear (HDR style) histogram for nanosecond latencies. Every power of two
+    // is split in 2^SubBucketBits linear steps, so the recorded value is never more
+    // than 1/2^SubBucketBits off, whatever its magnitude, in a fixed memory budget.
+    class LatencyHistogram {
+    public:
+        // Outcome of a one sided Mann-Whitney U test, "is current slower than baseline".
+        // Effect is Cliff's delta: -1 (always faster) .. 0 (same) .. +1 (always slower).
+        struct Comparison {
+            double u;
+            double z;
+            double p;
+            double effect;
+        };
+
+    public:
+        static constexpr uint8_t SubBucketBits = 5;
+        static constexpr uint32_t SubBuckets = (1 << SubBucketBits);
+        static constexpr uint32_t Buckets = ((64 - SubBucketBits) + 1) * SubBuckets;
+
+    public:
+        LatencyHistogram(LatencyHistogram&&) = default;
+        LatencyHistogram& operator=(LatencyHistogram&&) = default;
+        LatencyHistogram(const LatencyHistogram&) = default;
+        LatencyHistogram& operator=(const LatencyHistogram&) = default;
+
+        LatencyHistogram()
+            : _counts()
+            , _count(0)
+            , _min(~0)
+            , _max(0)
+            , _sum(0)
+            , _squares(0)
+        {
+            _counts.fill(0);
+        }
+        ~LatencyHistogram() = default;
+
+    public:
+        static uint64_t Now()
+        {
+            return (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count()));
+        }
+
+        static uint32_t Index(const uint64_t value)
+        {
+            uint32_t result = static_cast<uint32_t>(value);
+
+            if (value >= SubBuckets) {
+                const uint8_t msb = 63 - static_cast<uint8_t>(__builtin_clzll(value));
+                const uint8_t shift = msb - SubBucketBits;
+                result = ((shift + 1) * SubBuckets) + static_cast<uint32_t>((value >> shift) - SubBuckets);
+            }
+
+            return (result);
+        }
+        // Lowest value that maps onto the given bucket.
+        static uint64_t Lowest(const uint32_t index)
+        {
+            uint64_t result = index;
+
+            if (index >= SubBuckets) {
+                const uint8_t shift = static_cast<uint8_t>((index / SubBuckets) - 1);
+                result = static_cast<uint64_t>(SubBuckets + (index % SubBuckets)) << shift;
+            }
+
+            return (result);
+        }
+        // Highest value that maps onto the given bucket.
+        static uint64_t Highest(const uint32_t index)
+        {
+            const uint8_t shift = (index < SubBuckets ? 0 : static_cast<uint8_t>((index / SubBuckets) - 1));
+            return (Lowest(index) + ((static_cast<uint64_t>(1) << shift) - 1));
+        }
+
+        void Clear()
+        {
+            _counts.fill(0);
+            _count = 0;
+            _min = ~0;
+            _max = 0;
+            _sum = 0;
+            _squares = 0;
+        }
+        void Record(const uint64_t value, const uint64_t count = 1)
+        {
+            _counts[Index(value)] += count;
+            _count += count;
+            _sum += (value * count);
+            _squares += (static_cast<double>(value) * static_cast<double>(value) * static_cast<double>(count));
+
+            if (value < _min) {
+                _min = value;
+            }
+            if (value > _max) {
+                _max = value;
+            }
+        }
+        void Merge(const LatencyHistogram& other)
+        {
+            for (uint32_t index = 0; index < Buckets; index++) {
+                _counts[index] += other._counts[index];
+            }
+            _count += other._count;
+            _sum += other._sum;
+            _squares += other._squares;
+
+            if (other._min < _min) {
+                _min = other._min;
+            }
+            if (other._max > _max) {
+                _max = other._max;
+            }
+        }
+
+        // Drops the samples beyond the upper Tukey fence (Q3 + k * IQR), returns how many
+        // were dropped. k is in tenths, so the usual 1.5 is 15, and 0 keeps all samples.
+        // Mean and deviation are recomputed from the bucket midpoints.
+        uint64_t Reject(const uint16_t k)
+        {
+            uint64_t rejected = 0;
+
+            if ((_count > 0) && (k > 0)) {
+                const uint64_t q1 = Percentile(25.0);
+                const uint64_t q3 = Percentile(75.0);
+                const uint64_t fence = q3 + ((k * (q3 - q1)) / 10);
+
+                if (fence < _max) {
+                    uint64_t highest = 0;
+
+                    _count = 0;
+                    _sum = 0;
+                    _squares = 0;
+
+                    for (uint32_t index = 0; index < Buckets; index++) {
+                        if (_counts[index] != 0) {
+                            if (Lowest(index) > fence) {
+                                rejected += _counts[index];
+                                _counts[index] = 0;
+                            } else {
+                                const uint64_t value = (Lowest(index) + Highest(index)) / 2;
+                                _count += _counts[index];
+                                _sum += value * _counts[index];
+                                _squares += static_cast<double>(value) * static_cast<double>(value) * static_cast<double>(_counts[index]);
+                                highest = Highest(index);
+                            }
+                        }
+                    }
+
+                    if (highest < _max) {
+                        _max = highest;
+                    }
+                }
+            }
+
+            return (rejected);
+        }
+
+        // Mann-Whitney U on the bucketed samples, samples sharing a bucket count as ties.
+        // Uses the normal approximation with tie correction, fine from a few tens of samples.
+        static Comparison Compare(const LatencyHistogram& baseline, const LatencyHistogram& current)
+        {
+            Comparison result{ 0.0, 0.0, 1.0, 0.0 };
+
+            const double n1 = static_cast<double>(current._count);
+            const double n2 = static_cast<double>(baseline._count);
+
+            if ((n1 > 0) && (n2 > 0)) {
+                const double n = n1 + n2;
+                double below = 0.0;
+                double ties = 0.0;
+
+                for (uint32_t index = 0; index < Buckets; index++) {
+                    const double a = static_cast<double>(current._counts[index]);
+                    const double b = static_cast<double>(baseline._counts[index]);
+                    const double t = a + b;
+
+                    result.u += a * (below + (b / 2.0));
+                    below += b;
+                    ties += (t * t * t) - t;
+                }
+
+                const double mean = (n1 * n2) / 2.0;
+                const double variance = ((n1 * n2) / 12.0) * ((n + 1.0) - (ties / (n * (n - 1.0))));
+
+                result.effect = ((2.0 * result.u) / (n1 * n2)) - 1.0;
+
+                if (variance > 0.0) {
+                    result.z = (result.u - mean) / std::sqrt(variance);
+                    result.p = 0.5 * std::erfc(result.z / std::sqrt(2.0));
+                }
+            }
+
+            return (result);
+        }
+
+        uint64_t Count() const
+        {
+            return (_count);
+        }
+        uint64_t Count(const uint32_t index) const
+        {
+            ASSERT(index < Buckets);
+            return (_counts[index]);
+        }
+        uint64_t Min() const
+        {
+            return (_count == 0 ? 0 : _min);
+        }
+        uint64_t Max() const
+        {
+            return (_max);
+        }
+        uint64_t Mean() const
+        {
+            return (_count == 0 ? 0 : (_sum / _count));
+        }
+        uint64_t StdDev() const
+        {
+            uint64_t result = 0;
+
+            if (_count > 0) {
+                const double mean = static_cast<double>(_sum) / static_cast<double>(_count);
+                const double variance = (_squares / static_cast<double>(_count)) - (mean * mean);
+                result = (variance > 0 ? static_cast<uint64_t>(std::sqrt(variance)) : 0);
+            }
+
+            return (result);
+        }
+        // The value below which the given percentage (0..100) of the samples fall,
+        // reported as the upper bound of its bucket and clamped to the exact extremes.
+        uint64_t Percentile(const double percentage) const
+        {
+            uint64_t result = 0;
+
+            if (_count > 0) {
+                const double clamped = (percentage < 0.0 ? 0.0 : (percentage > 100.0 ? 100.0 : percentage));
+                uint64_t target = static_cast<uint64_t>(std::ceil((clamped / 100.0) * static_cast<double>(_count)));
+                uint64_t seen = 0;
+                uint32_t index = 0;
+
+                if (target == 0) {
+                    target = 1;
+                }
+
+                while ((index < Buckets) && ((seen + _counts[index]) < target)) {
+                    seen += _counts[index];
+                    index++;
+                }
+
+                result = (index < Buckets ? Highest(index) : _max);
+
+                if (result > _max) {
+                    result = _max;
+                }
+                if (result < _min) {
+                    result = _min;
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        std::array<uint64_t, Buckets> _counts;
+        uint64_t _count;
+        uint64_t _min;
+        uint64_t _max;
+        uint64_t _sum;
+        double _squares;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
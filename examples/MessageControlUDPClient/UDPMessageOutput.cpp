@@ -1,158 +1,552 @@
 #include "Module.h"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
 #include <iostream>
 #include <memory>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
 
 using namespace Thunder;
 
-class UDPMessageOutput : public Messaging::DirectOutput {
+namespace {
+
+    // Trace file layout: a FileHeader, followed by records of a RecordHeader plus the datagram
+    // exactly as it was received. Nothing is deserialized while receiving, that is left to the
+    // pretty printer (-r). Fields are in host byte order.
+    struct FileHeader {
+        char Magic[4];
+        uint16_t Version;
+        uint16_t Reserved;
+    };
+    struct RecordHeader {
+        uint32_t Length;
+        uint32_t Sequence; // gaps are datagrams lost in the kernel or in the receive ring
+        uint64_t TimeStamp; // receive time, Core::Time ticks
+    };
+
+    constexpr char FileMagic[4] = { 'T', 'M', 'S', 'G' };
+    constexpr uint16_t FileVersion = 1;
+
+    bool Format(const uint8_t dataFrame[], const uint16_t receivedSize, const bool abbreviated, string& line)
+    {
+        bool result = false;
+        Core::Messaging::MessageInfo information;
+
+        uint16_t length = information.Deserialize(dataFrame, receivedSize);
+
+        if (length != 0 && length <= receivedSize) {
+            if (information.Type() == Messaging::MessageType::TRACING || information.Type() == Messaging::MessageType::LOGGING) {
+                Messaging::TextMessage message;
+                message.Deserialize(dataFrame + length, receivedSize - length);
+
+                std::ostringstream output;
+                const Core::Time now(information.TimeStamp());
+
+                if (abbreviated == true) {
+                    string time(now.ToTimeOnly(true));
+                    output << '[' << time << "]:[" << information.Module() << "]:[" << information.Category()
+                           << "]: " << message.Data() << '\n';
+                } else {
+                    string time(now.ToRFC1123(true));
+                    output << '[' << time;
+
+                    if (information.Type() == Messaging::MessageType::TRACING) {
+                        const Core::Messaging::IStore::Tracing& trace = static_cast<const Core::Messaging::IStore::Tracing&>(information);
+                        output << Core::FileNameOnly(trace.FileName().c_str()) << ':' << trace.LineNumber()
+                               << "]:[" << trace.ClassName() << "]:[" << trace.Category();
+                    }
+
+                    output << "]: " << message.Data() << '\n';
+                }
+
+                line = output.str();
+                result = true;
+            }
+        }
+
+        return (result);
+    }
+}
+
+class UDPMessageOutput {
+public:
+    // Every counter has a single writing thread, atomic only to be read from the console.
+    struct Statistics {
+        std::atomic<uint64_t> Received;
+        std::atomic<uint64_t> KernelDrops; // dropped by the kernel, its receive buffer was full (SO_RXQ_OVFL)
+        std::atomic<uint64_t> RingDrops; // dropped because the writer did not keep up
+        std::atomic<uint64_t> Truncated;
+        std::atomic<uint64_t> Written;
+    };
+
 private:
-    class Channel : public Core::SocketDatagram {
+    static constexpr uint16_t Batch = 64;
+    static constexpr uint32_t ReceiveBuffer = 4 * 1024 * 1024;
+
+    // Single producer, single consumer ring of preallocated slots, each as large as the
+    // biggest datagram the message unit produces. The receiver reads the datagrams straight
+    // into the slots, the writer drains them; no locks and no allocations while running.
+    class Ring {
+    public:
+        static constexpr uint32_t Slots = 2048; // power of two
+
+        struct Slot {
+            uint8_t* Data;
+            uint16_t Length;
+            uint32_t Sequence;
+            uint64_t TimeStamp;
+        };
+
+    public:
+        Ring() = delete;
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+
+        explicit Ring(const uint16_t slotSize)
+            : _slotSize(slotSize)
+            , _buffer(new uint8_t[Slots * slotSize])
+            , _slots()
+            , _head(0)
+            , _tail(0)
+        {
+            for (uint32_t index = 0; index < Slots; index++) {
+                _slots[index] = { &(_buffer[index * slotSize]), 0, 0, 0 };
+            }
+        }
+        ~Ring() = default;
+
     public:
-        Channel(UDPMessageOutput& output, const string& binding, const uint16_t port)
-            : Core::SocketDatagram(false, Core::NodeId(binding.c_str(), port), Core::NodeId(), 0, Messaging::MessageUnit::Instance().DataSize())
-            , _output(output)
+        uint16_t SlotSize() const
+        {
+            return (_slotSize);
+        }
+
+        // Producer side
+        uint32_t Free() const
+        {
+            return (Slots - (_head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_acquire)));
+        }
+        Slot& Reserve(const uint32_t offset)
+        {
+            return (_slots[(_head.load(std::memory_order_relaxed) + offset) & (Slots - 1)]);
+        }
+        void Publish(const uint32_t count)
         {
-            Open(0);
+            _head.store(_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
         }
 
-        ~Channel() override
+        // Consumer side
+        uint32_t Available() const
+        {
+            return (_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed));
+        }
+        const Slot& Peek(const uint32_t offset) const
+        {
+            return (_slots[(_tail.load(std::memory_order_relaxed) + offset) & (Slots - 1)]);
+        }
+        void Consume(const uint32_t count)
         {
-            Close(Core::infinite);
+            _tail.store(_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
         }
 
-        Channel(const Channel&) = delete;
-        Channel& operator=(const Channel&) = delete;
+    private:
+        const uint16_t _slotSize;
+        std::unique_ptr<uint8_t[]> _buffer;
+        std::array<Slot, Slots> _slots;
+        alignas(64) std::atomic<uint32_t> _head;
+        alignas(64) std::atomic<uint32_t> _tail;
+    };
+
+    class Receiver : public Core::Thread {
+    public:
+        Receiver() = delete;
+        Receiver(const Receiver&) = delete;
+        Receiver& operator=(const Receiver&) = delete;
+
+        Receiver(UDPMessageOutput& parent, const int socket)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("Receiver"))
+            , _parent(parent)
+            , _socket(socket)
+            , _scratch(new uint8_t[parent._ring.SlotSize()])
+            , _sequence(0)
+            , _overflows(0)
+        {
+            ::memset(_messages, 0, sizeof(_messages));
+        }
+        ~Receiver() override
+        {
+            Stop();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+        }
 
-        uint16_t ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize) override
+    private:
+        uint32_t Worker() override
         {
-            uint16_t length = 0;
-            Core::Messaging::MessageInfo information;
-            Core::ProxyType<Messaging::TextMessage> message;
+            struct pollfd descriptor = { _socket, POLLIN, 0 };
+
+            // Wake up regularly, so a Stop() is picked up.
+            if ((::poll(&descriptor, 1, 100) > 0) && ((descriptor.revents & POLLIN) != 0)) {
+                Ring& ring(_parent._ring);
+                const uint32_t free = ring.Free();
+                const uint16_t batch = static_cast<uint16_t>(free < Batch ? (free == 0 ? Batch : free) : Batch);
+
+                for (uint16_t index = 0; index < batch; index++) {
+                    // With a full ring everything goes to a scratch buffer, only to be counted.
+                    _vectors[index].iov_base = (free == 0 ? _scratch.get() : ring.Reserve(index).Data);
+                    _vectors[index].iov_len = ring.SlotSize();
+                    _messages[index].msg_hdr.msg_iov = &(_vectors[index]);
+                    _messages[index].msg_hdr.msg_iovlen = 1;
+                    _messages[index].msg_hdr.msg_control = _control[index];
+                    _messages[index].msg_hdr.msg_controllen = sizeof(_control[index]);
+                    _messages[index].msg_hdr.msg_flags = 0;
+                }
+
+                const int received = ::recvmmsg(_socket, _messages, batch, MSG_DONTWAIT, nullptr);
+
+                if (received > 0) {
+                    const uint64_t now = Core::Time::Now().Ticks();
+                    Statistics& statistics(_parent._statistics);
+
+                    for (int index = 0; index < received; index++) {
+                        Lost(_messages[index].msg_hdr);
+
+                        if ((_messages[index].msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+                            statistics.Truncated++;
+                        }
+
+                        if (free == 0) {
+                            statistics.RingDrops++;
+                        } else {
+                            Ring::Slot& slot(ring.Reserve(index));
+                            slot.Length = static_cast<uint16_t>(std::min<uint32_t>(_messages[index].msg_len, ring.SlotSize()));
+                            slot.Sequence = _sequence;
+                            slot.TimeStamp = now;
+                        }
 
-            length = information.Deserialize(dataFrame, receivedSize);
+                        _sequence++;
+                    }
 
-            if (length != 0 && length <= receivedSize) {
-                if (information.Type() == Messaging::MessageType::TRACING || information.Type() == Messaging::MessageType::LOGGING) {
-                    message = Core::ProxyType<Messaging::TextMessage>::Create();
-                    length += message->Deserialize(dataFrame + length, receivedSize - length);
+                    statistics.Received += received;
 
-                    _output.Output(information, message.Origin());
+                    if (free != 0) {
+                        ring.Publish(received);
+                        _parent._writer.Signal();
+                    }
                 }
             }
 
-            return length;
+            return (0);
         }
-
-        uint16_t SendData(uint8_t*, const uint16_t) override
+        // The kernel reports the running total of datagrams it dropped for this socket. Skip
+        // as many sequence numbers, so the loss shows as a gap in the trace file as well.
+        void Lost(const struct msghdr& header)
         {
-            // Do not do anything here
-            return 0;
-        }
+            for (struct cmsghdr* control = CMSG_FIRSTHDR(&header); control != nullptr; control = CMSG_NXTHDR(const_cast<struct msghdr*>(&header), control)) {
+                if ((control->cmsg_level == SOL_SOCKET) && (control->cmsg_type == SO_RXQ_OVFL)) {
+                    uint32_t overflows;
+                    ::memcpy(&overflows, CMSG_DATA(control), sizeof(overflows));
 
-        void StateChange() override
-        {
-            if (IsOpen()) {
-                printf("Observing message socket\n");
-            } else {
-                printf("No longer observing message socket\n");
+                    if (overflows > _overflows) {
+                        _sequence += (overflows - _overflows);
+                        _parent._statistics.KernelDrops += (overflows - _overflows);
+                        _overflows = overflows;
+                    }
+                }
             }
         }
 
     private:
-        UDPMessageOutput& _output;
+        UDPMessageOutput& _parent;
+        const int _socket;
+        std::unique_ptr<uint8_t[]> _scratch;
+        struct mmsghdr _messages[Batch];
+        struct iovec _vectors[Batch];
+        uint8_t _control[Batch][CMSG_SPACE(sizeof(uint32_t))];
+        uint32_t _sequence;
+        uint32_t _overflows;
     };
 
-    class WorkerThread : public Core::Thread {
+    class Writer : public Core::Thread {
     public:
-        WorkerThread(Core::QueueType<string>& queue)
-            : Core::Thread(Core::Thread::DefaultStackSize(), _T("WorkerThread"))
-            , _lineQueue(queue)
+        Writer() = delete;
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        Writer(UDPMessageOutput& parent, FILE* file, const bool abbreviated)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("Writer"))
+            , _parent(parent)
+            , _file(file)
+            , _abbreviated(abbreviated)
+            , _signal(false, true)
         {
-            Run();
         }
-        ~WorkerThread() override
+        ~Writer() override
         {
-            Thread::Stop();
-            _lineQueue.Disable();
-            Wait(Core::Thread::STOPPED, Core::infinite);
+            Stop();
+            _signal.SetEvent();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
         }
 
-        WorkerThread(const WorkerThread&) = delete;
-        WorkerThread& operator=(const WorkerThread&) = delete;
+    public:
+        void Signal()
+        {
+            _signal.SetEvent();
+        }
 
     private:
         uint32_t Worker() override
         {
-            string line;
-            while (_lineQueue.Extract(line, Core::infinite) == true) {
-                std::cout << line << std::endl;
+            _signal.Lock(100);
+            _signal.ResetEvent();
+
+            Ring& ring(_parent._ring);
+            uint32_t available = ring.Available();
+
+            while (available > 0) {
+                for (uint32_t index = 0; index < available; index++) {
+                    const Ring::Slot& slot(ring.Peek(index));
+
+                    if (_file != nullptr) {
+                        const RecordHeader header = { slot.Length, slot.Sequence, slot.TimeStamp };
+                        ::fwrite(&header, sizeof(header), 1, _file);
+                        ::fwrite(slot.Data, slot.Length, 1, _file);
+                    } else {
+                        string line;
+                        if (Format(slot.Data, slot.Length, _abbreviated, line) == true) {
+                            ::fwrite(line.c_str(), line.length(), 1, stdout);
+                        }
+                    }
+                }
+
+                ring.Consume(available);
+                _parent._statistics.Written += available;
+
+                available = ring.Available();
             }
-            return (Core::infinite);
+
+            ::fflush(_file != nullptr ? _file : stdout);
+
+            return (0);
         }
 
     private:
-        Core::QueueType<string>& _lineQueue;
+        UDPMessageOutput& _parent;
+        FILE* _file;
+        const bool _abbreviated;
+        Core::Event _signal;
     };
 
 public:
-    UDPMessageOutput(const string& binding, uint16_t port, bool abbreviate)
-        : _newLineQueue(256)
-        , _update(_newLineQueue)
-        , _abbreviated(abbreviate)
-        , _channel(*this, binding, port)
+    UDPMessageOutput() = delete;
+    UDPMessageOutput(const UDPMessageOutput&) = delete;
+    UDPMessageOutput& operator=(const UDPMessageOutput&) = delete;
+
+    UDPMessageOutput(const string& binding, uint16_t port, bool abbreviate, const string& fileName)
+        : _statistics{ { 0 }, { 0 }, { 0 }, { 0 }, { 0 } }
+        , _ring(static_cast<uint16_t>(std::min<uint32_t>(Messaging::MessageUnit::Instance().DataSize(), 0xFFFF)))
+        , _file(nullptr)
+        , _socket(Open(binding, port))
+        , _writer(*this, (fileName.empty() == true ? nullptr : CreateFile(fileName)), abbreviate)
+        , _receiver(*this, _socket)
+    {
+        if (_socket != -1) {
+            printf("Observing message socket\n");
+            _writer.Run();
+            _receiver.Run();
+        }
+    }
+    ~UDPMessageOutput()
+    {
+        _receiver.Stop();
+        _receiver.Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+        _writer.Stop();
+        _writer.Signal();
+        _writer.Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+
+        if (_socket != -1) {
+            ::close(_socket);
+            printf("No longer observing message socket\n");
+        }
+        if (_file != nullptr) {
+            ::fclose(_file);
+        }
+    }
+
+public:
+    const Statistics& Counters() const
     {
+        return (_statistics);
     }
 
-    void Output(const Core::Messaging::MessageInfo& info, const Core::Messaging::IEvent* message) const
+private:
+    static int Open(const string& binding, const uint16_t port)
     {
-        std::ostringstream output;
+        union {
+            struct sockaddr_in v4;
+            struct sockaddr_in6 v6;
+        } address;
+        socklen_t length;
+        int family;
 
-        const Core::Time now(info.TimeStamp());
+        ::memset(&address, 0, sizeof(address));
 
-        if (_abbreviated == true) {
-            string time(now.ToTimeOnly(true));
-            output << '[' << time << "]:[" << info.Module() << "]:[" << info.Category()
-                << "]: " << message->Data() << std::endl;
+        if (::inet_pton(AF_INET, binding.c_str(), &address.v4.sin_addr) == 1) {
+            family = AF_INET;
+            address.v4.sin_family = AF_INET;
+            address.v4.sin_port = htons(port);
+            length = sizeof(address.v4);
+        } else if (::inet_pton(AF_INET6, binding.c_str(), &address.v6.sin6_addr) == 1) {
+            family = AF_INET6;
+            address.v6.sin6_family = AF_INET6;
+            address.v6.sin6_port = htons(port);
+            length = sizeof(address.v6);
         } else {
-            string time(now.ToRFC1123(true));
-            output << '[' << time;
+            printf("Invalid binding address [%s]\n", binding.c_str());
+            return (-1);
+        }
+
+        int result = ::socket(family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+        if (result != -1) {
+            const int enable = 1;
+            const int size = ReceiveBuffer;
+
+            // A large kernel buffer absorbs bursts, the overflow counter tells what it could not.
+            ::setsockopt(result, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+            ::setsockopt(result, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
 
-            if (info.Type() == Messaging::MessageType::TRACING) {
-                const Core::Messaging::IStore::Tracing& trace = static_cast<const Core::Messaging::IStore::Tracing&>(info);
-                output << Core::FileNameOnly(trace.FileName().c_str()) << ':' << trace.LineNumber()
-                       << "]:[" << trace.ClassName() << "]:[" << trace.Category();
+            if (::bind(result, reinterpret_cast<struct sockaddr*>(&address), length) != 0) {
+                printf("Could not bind to [%s:%d], error: %d\n", binding.c_str(), port, errno);
+                ::close(result);
+                result = -1;
             }
+        }
+
+        return (result);
+    }
+    FILE* CreateFile(const string& fileName)
+    {
+        _file = ::fopen(fileName.c_str(), "wb");
 
-            output << "]: " << message->Data() << std::endl;
+        if (_file == nullptr) {
+            printf("Could not create trace file [%s], writing to the console\n", fileName.c_str());
+        } else {
+            static char buffer[1024 * 1024];
+            ::setvbuf(_file, buffer, _IOFBF, sizeof(buffer));
+
+            const FileHeader header = { { FileMagic[0], FileMagic[1], FileMagic[2], FileMagic[3] }, FileVersion, 0 };
+            ::fwrite(&header, sizeof(header), 1, _file);
         }
 
-        const_cast<UDPMessageOutput*>(this)->_newLineQueue.Post(output.str());
+        return (_file);
     }
 
 private:
-    Core::QueueType<string> _newLineQueue;
-    WorkerThread _update;
-    bool _abbreviated;
-    Channel _channel;
+    Statistics _statistics;
+    Ring _ring;
+    FILE* _file;
+    int _socket;
+    Writer _writer;
+    Receiver _receiver;
 };
 
+// Offline pretty printer for files written by the receiver.
+static int PrettyPrint(const string& fileName, const bool abbreviate)
+{
+    FILE* file = ::fopen(fileName.c_str(), "rb");
+
+    if (file == nullptr) {
+        printf("Could not open trace file [%s]\n", fileName.c_str());
+        return (1);
+    }
+
+    FileHeader header;
+    if ((::fread(&header, sizeof(header), 1, file) != 1) || (::memcmp(header.Magic, FileMagic, sizeof(FileMagic)) != 0) || (header.Version != FileVersion)) {
+        printf("[%s] is not a trace file\n", fileName.c_str());
+        ::fclose(file);
+        return (1);
+    }
+
+    std::vector<uint8_t> data;
+    RecordHeader record;
+    uint64_t records = 0;
+    uint64_t gaps = 0;
+    uint64_t missing = 0;
+    uint32_t expected = 0;
+
+    while (::fread(&record, sizeof(record), 1, file) == 1) {
+        data.resize(record.Length);
+
+        if ((record.Length != 0) && (::fread(data.data(), record.Length, 1, file) != 1)) {
+            printf("Trace file [%s] is truncated\n", fileName.c_str());
+            break;
+        }
+
+        if ((records != 0) && (record.Sequence != expected)) {
+            gaps++;
+            missing += (record.Sequence - expected);
+            printf("--- %u message(s) lost ---\n", record.Sequence - expected);
+        }
+        expected = record.Sequence + 1;
+        records++;
+
+        string line;
+        if (Format(data.data(), static_cast<uint16_t>(record.Length), abbreviate, line) == true) {
+            ::fwrite(line.c_str(), line.length(), 1, stdout);
+        }
+    }
+
+    ::fclose(file);
+
+    printf("\n%" PRIu64 " messages, %" PRIu64 " gaps, %" PRIu64 " messages lost\n", records, gaps, missing);
+
+    return (0);
+}
+
 int main(int argc, char** argv)
 {
     ASSERT(argc >= 3);
 
+    if (string(argv[1]) == _T("-r")) {
+        bool abbreviate = false;
+        if (argc >= 4) {
+            std::istringstream(string(argv[3])) >> abbreviate;
+        }
+        return (PrettyPrint(argv[2], abbreviate));
+    }
+
     string binding(argv[1]);
     uint32_t port = std::stoi(argv[2]);
     bool abbreviate = false;
+    string fileName;
     if (argc >= 4) {
         std::istringstream(string(argv[3])) >> abbreviate;
     }
+    if (argc >= 5) {
+        fileName = argv[4];
+    }
 
-    UDPMessageOutput output(binding, port, abbreviate);
+    UDPMessageOutput output(binding, port, abbreviate, fileName);
 
     char element;
     do {
         printf("\n>");
         element = toupper(getchar());
+
+        if (element == 'S') {
+            const UDPMessageOutput::Statistics& counters(output.Counters());
+            printf("Received:     %" PRIu64 "\n", counters.Received.load());
+            printf("Written:      %" PRIu64 "\n", counters.Written.load());
+            printf("Kernel drops: %" PRIu64 "\n", counters.KernelDrops.load());
+            printf("Ring drops:   %" PRIu64 "\n", counters.RingDrops.load());
+            printf("Truncated:    %" PRIu64 "\n", counters.Truncated.load());
+        }
     } while (element != 'Q');
 
     std::cout << "Leaving app.\n";
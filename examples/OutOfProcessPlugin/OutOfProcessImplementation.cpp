@@ -276,6 +276,8 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
             , _compositerServerRPCConnection()
             , _type(SHOW)
             , _job(*this)
+            , _constructed(Core::Time::Now().Ticks())
+            , _marked(false)
         {
             TRACE(Trace::Information, (_T("Constructed the OutOfProcessImplementation")));
         }
@@ -334,6 +336,7 @@ POP_WARNING()
         }
         uint32_t Configure(PluginHost::IShell* service) override
         {
+            const uint64_t configuring = Core::Time::Now().Ticks();
             uint32_t result = Core::ERROR_NONE;
 
             TRACE(Trace::Information, (_T("Configuring: [%s]"), service->Callsign().c_str()));
@@ -373,8 +376,31 @@ POP_WARNING()
                 Run();
             }
 
+            // Only the first one is part of the activation.
+            if (_marked == false) {
+                _marked = true;
+                Mark(service->VolatilePath(), configuring, Core::Time::Now().Ticks());
+            }
+
             return (result);
         }
+        // Leaves the moments the framework can not see for the plugin, to build the startup profile.
+        void Mark(const string& volatilePath, const uint64_t configuring, const uint64_t configured) const
+        {
+            Plugin::Startup::Marks marks;
+            Core::File file(Plugin::Startup::Marks::FileName(volatilePath));
+
+            marks.Process = Core::ProcessInfo().Id();
+            marks.Started = Plugin::Startup::ProcessStarted();
+            marks.Loaded = Plugin::Startup::Loaded();
+            marks.Constructed = _constructed;
+            marks.Configuring = configuring;
+            marks.Configured = configured;
+
+            if (file.Create() == true) {
+                marks.IElement::ToFile(file);
+            }
+        }
         void CreateCompositerServerRPCConnection(const string& connection) {
             if (Core::WorkerPool::IsAvailable() == true) {
                 // If we are in the same process space as where a WorkerPool is registered (Main Process or
@@ -787,6 +813,8 @@ POP_WARNING()
 
         StateType _type;
         Core::WorkerPool::JobType<OutOfProcessImplementation&> _job;
+        const uint64_t _constructed;
+        bool _marked;
     };
 
     SERVICE_REGISTRATION(OutOfProcessImplementation, 1, 0)
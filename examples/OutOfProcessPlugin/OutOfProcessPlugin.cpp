@@ -53,6 +53,10 @@ namespace Plugin {
 
     static const char SampleData[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789=!";
 
+    // Kept over the activations, the plugin object itself is not.
+    static Core::CriticalSection startupLock;
+    static std::list<Startup::Activation> startupHistory;
+
     const string OutOfProcessPlugin::Initialize(PluginHost::IShell* service) /* override */
     {
         ASSERT(service != nullptr);
@@ -63,18 +67,44 @@ namespace Plugin {
         ASSERT(_connectionId == 0);
         ASSERT(_state == nullptr);
 
+        const uint64_t initialize = Core::Time::Now().Ticks();
+        uint64_t root = 0;
+        uint64_t configured = 0;
         string message;
+        Config config;
 
         _service = service;
         _service->AddRef();
 
+        config.FromString(_service->ConfigLine());
+
+        if (config.Prelaunch.Value() == true) {
+            std::vector<string> paths({ _service->ProxyStubPath() });
+            Core::JSON::ArrayType<Core::JSON::String>::Iterator index(config.PrelaunchPaths.Elements());
+
+            while (index.Next() == true) {
+                paths.push_back(index.Current().Value());
+            }
+
+            _prelauncher.Start(std::move(paths));
+        }
+
+        // Whatever is left from an earlier activation, does not belong to this one.
+        const string marks(Startup::Marks::FileName(_service->VolatilePath()));
+
+        Core::Directory(_service->VolatilePath().c_str()).CreatePath();
+        Core::File(marks).Destroy();
+
         _skipURL = static_cast<uint8_t>(_service->WebPrefix().length());
 
         _service->EnableWebServer(_T("UI"), EMPTY_STRING);
         _service->Register(static_cast<RPC::IRemoteConnection::INotification*>(_notification));
         _service->Register(static_cast<PluginHost::IPlugin::INotification*>(_notification));
 
+        Property<StartupData>(_T("startup"), &OutOfProcessPlugin::get_startup, nullptr, this);
+
         _browser = service->Root<Exchange::IBrowser>(_connectionId, Core::infinite, _T("OutOfProcessImplementation"));
+        root = Core::Time::Now().Ticks();
 
         if (_browser == nullptr) {
             message = _T("OutOfProcessPlugin could not be instantiated.");
@@ -139,6 +169,7 @@ namespace Plugin {
                 _state = stateControl;
 
                 _state->Configure(_service);
+                configured = Core::Time::Now().Ticks();
                 _state->Register(_notification);
 
                 PluginHost::IPlugin::INotification* sink = _browser->QueryInterface<PluginHost::IPlugin::INotification>();
@@ -161,6 +192,10 @@ namespace Plugin {
                 message = _T("OutOfProcessPlugin could not obtain state control.");
             }
         }
+
+        if (message.empty() == true) {
+            Profile(_service->Callsign(), initialize, root, configured, config.History.Value());
+        }
         
         return message;
     }
@@ -174,6 +209,9 @@ namespace Plugin {
             _service->Unregister(static_cast<PluginHost::IPlugin::INotification*>(_notification));
             _service->DisableWebServer();
 
+            Unregister(_T("startup"));
+            _prelauncher.Stop();
+
             if (_browser != nullptr) {
                 if (_browserresources != nullptr) {
                     Exchange::JBrowserResources::Unregister(*this);
@@ -279,8 +317,67 @@ namespace Plugin {
 
     /* virtual */ string OutOfProcessPlugin::Information() const
     {
-        // No additional info to report.
-        return (nullptr);
+        StartupData data;
+        string result;
+
+        Timeline(data);
+        data.ToString(result);
+
+        return (result);
+    }
+
+    void OutOfProcessPlugin::Profile(const string& callsign, const uint64_t initialize, const uint64_t root, const uint64_t configured, const uint8_t depth)
+    {
+        Startup::Marks marks;
+        Core::File file(Startup::Marks::FileName(_service->VolatilePath()));
+
+        if (file.Open(true) == true) {
+            marks.IElement::FromFile(file);
+            file.Destroy();
+        }
+
+        Startup::Activation activation(Startup::Profile(callsign, initialize, root, configured, Core::Time::Now().Ticks(), marks));
+        string phases;
+
+        for (const Startup::Phase& phase : activation.Phases) {
+            phases += (phases.empty() == true ? _T("") : _T(", ")) + phase.Name + _T(" ") + std::to_string(phase.Duration) + _T(" us");
+        }
+
+        TRACE(Trace::Information, (_T("Activation of [%s] %s took %d ms: %s"), callsign.c_str(), (activation.OutOfProcess == true ? _T("out of process") : _T("in process")), static_cast<uint32_t>(activation.Duration / Core::Time::TicksPerMillisecond), phases.c_str()));
+
+        startupLock.Lock();
+
+        startupHistory.push_back(std::move(activation));
+
+        while (startupHistory.size() > std::max(depth, static_cast<uint8_t>(1))) {
+            startupHistory.pop_front();
+        }
+
+        startupLock.Unlock();
+    }
+
+    void OutOfProcessPlugin::Timeline(StartupData& response) const
+    {
+        const Startup::Prelauncher::Statistics statistics(_prelauncher.Collect());
+
+        startupLock.Lock();
+
+        for (const Startup::Activation& activation : startupHistory) {
+            response.Activations.Add().Set(activation);
+        }
+
+        startupLock.Unlock();
+
+        response.Prelaunch.Files = statistics.Files;
+        response.Prelaunch.Bytes = statistics.Bytes;
+        response.Prelaunch.Duration = statistics.Duration;
+    }
+
+    uint32_t OutOfProcessPlugin::get_startup(StartupData& response) const
+    {
+        Timeline(response);
+
+        return (Core::ERROR_NONE);
     }
     /* virtual */ bool OutOfProcessPlugin::Attach(PluginHost::Channel& channel)
     {
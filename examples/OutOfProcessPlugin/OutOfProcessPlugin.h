@@ -21,6 +21,7 @@
 #define __OUTOFPROCESSTEST_H
 
 #include "Module.h"
+#include "Startup.h"
 #include <interfaces/IBrowser.h>
 #include <interfaces/IMemory.h>
 
@@ -108,7 +109,167 @@ namespace Plugin {
             OutOfProcessPlugin& _parent;
         };
 
+        class Config : public Core::JSON::Container {
+        public:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+            Config()
+                : Core::JSON::Container()
+                , Prelaunch(false)
+                , PrelaunchPaths()
+                , History(8)
+            {
+                Add(_T("prelaunch"), &Prelaunch);
+                Add(_T("prelaunchpaths"), &PrelaunchPaths);
+                Add(_T("history"), &History);
+            }
+            ~Config() override = default;
+
+        public:
+            Core::JSON::Boolean Prelaunch;
+            Core::JSON::ArrayType<Core::JSON::String> PrelaunchPaths;
+            Core::JSON::DecUInt8 History;
+        };
+
     public:
+        class PhaseData : public Core::JSON::Container {
+        public:
+            PhaseData& operator=(const PhaseData&) = delete;
+
+            PhaseData()
+                : Core::JSON::Container()
+                , Name()
+                , Start(0)
+                , Duration(0)
+            {
+                Add(_T("name"), &Name);
+                Add(_T("start"), &Start);
+                Add(_T("duration"), &Duration);
+            }
+            PhaseData(const PhaseData& copy)
+                : Core::JSON::Container()
+                , Name(copy.Name)
+                , Start(copy.Start)
+                , Duration(copy.Duration)
+            {
+                Add(_T("name"), &Name);
+                Add(_T("start"), &Start);
+                Add(_T("duration"), &Duration);
+            }
+            ~PhaseData() override = default;
+
+        public:
+            Core::JSON::String Name;
+            Core::JSON::DecUInt64 Start; // us after the start of the activation
+            Core::JSON::DecUInt64 Duration; // us
+        };
+
+        class ActivationData : public Core::JSON::Container {
+        public:
+            ActivationData& operator=(const ActivationData&) = delete;
+
+            ActivationData()
+                : Core::JSON::Container()
+                , Callsign()
+                , Time()
+                , OutOfProcess(false)
+                , Duration(0)
+                , Phases()
+            {
+                Init();
+            }
+            ActivationData(const ActivationData& copy)
+                : Core::JSON::Container()
+                , Callsign(copy.Callsign)
+                , Time(copy.Time)
+                , OutOfProcess(copy.OutOfProcess)
+                , Duration(copy.Duration)
+                , Phases(copy.Phases)
+            {
+                Init();
+            }
+            ~ActivationData() override = default;
+
+        public:
+            void Set(const Startup::Activation& activation)
+            {
+                Callsign = activation.Callsign;
+                Time = Core::Time(activation.Time).ToISO8601(true);
+                OutOfProcess = activation.OutOfProcess;
+                Duration = activation.Duration;
+
+                for (const Startup::Phase& phase : activation.Phases) {
+                    PhaseData& entry(Phases.Add());
+
+                    entry.Name = phase.Name;
+                    entry.Start = phase.Start;
+                    entry.Duration = phase.Duration;
+                }
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("time"), &Time);
+                Add(_T("outofprocess"), &OutOfProcess);
+                Add(_T("duration"), &Duration);
+                Add(_T("phases"), &Phases);
+            }
+
+        public:
+            Core::JSON::String Callsign;
+            Core::JSON::String Time;
+            Core::JSON::Boolean OutOfProcess;
+            Core::JSON::DecUInt64 Duration; // us
+            Core::JSON::ArrayType<PhaseData> Phases;
+        };
+
+        class StartupData : public Core::JSON::Container {
+        public:
+            class PrelaunchData : public Core::JSON::Container {
+            public:
+                PrelaunchData(const PrelaunchData&) = delete;
+                PrelaunchData& operator=(const PrelaunchData&) = delete;
+
+                PrelaunchData()
+                    : Core::JSON::Container()
+                    , Files(0)
+                    , Bytes(0)
+                    , Duration(0)
+                {
+                    Add(_T("files"), &Files);
+                    Add(_T("bytes"), &Bytes);
+                    Add(_T("duration"), &Duration);
+                }
+                ~PrelaunchData() override = default;
+
+            public:
+                Core::JSON::DecUInt32 Files;
+                Core::JSON::DecUInt64 Bytes;
+                Core::JSON::DecUInt64 Duration; // us
+            };
+
+        public:
+            StartupData(const StartupData&) = delete;
+            StartupData& operator=(const StartupData&) = delete;
+
+            StartupData()
+                : Core::JSON::Container()
+                , Activations()
+                , Prelaunch()
+            {
+                Add(_T("activations"), &Activations);
+                Add(_T("prelaunch"), &Prelaunch);
+            }
+            ~StartupData() override = default;
+
+        public:
+            Core::JSON::ArrayType<ActivationData> Activations;
+            PrelaunchData Prelaunch;
+        };
+
         class Data : public Core::JSON::Container {
 
         public:
@@ -168,6 +329,7 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
             , _state(nullptr)
             , _subscriber(nullptr)
             , _hidden(false)
+            , _prelauncher()
         {
         }
 POP_WARNING()
@@ -235,6 +397,10 @@ POP_WARNING()
         void Activated(const string& callsign, PluginHost::IShell* plugin);
         void Deactivated(const string& callsign, PluginHost::IShell* plugin);
 
+        void Profile(const string& callsign, const uint64_t initialize, const uint64_t root, const uint64_t configured, const uint8_t depth);
+        void Timeline(StartupData& response) const;
+        uint32_t get_startup(StartupData& response) const;
+
     private:
         Core::CriticalSection _adminLock;
         uint8_t _skipURL;
@@ -248,6 +414,7 @@ POP_WARNING()
         PluginHost::IStateControl* _state;
         PluginHost::Channel* _subscriber;
         bool _hidden;
+        Startup::Prelauncher _prelauncher;
     };
 }
 }
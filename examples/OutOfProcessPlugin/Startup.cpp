@@ -0,0 +1,179 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Startup.h"
+
+#ifdef __LINUX__
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace Thunder {
+namespace Plugin {
+namespace Startup {
+
+    namespace {
+
+        // Set when the dynamic loader initializes this library, in whatever process that is.
+        const uint64_t LoadedAt = Core::Time::Now().Ticks();
+
+        void Add(Activation& activation, const TCHAR name[], const uint64_t from, const uint64_t to)
+        {
+            if ((from != 0) && (to >= from) && (from >= activation.Time)) {
+                activation.Phases.push_back({ name, from - activation.Time, to - from });
+            }
+        }
+
+    }
+
+    uint64_t Loaded()
+    {
+        return (LoadedAt);
+    }
+
+    uint64_t ProcessStarted()
+    {
+        uint64_t result = 0;
+
+#ifdef __LINUX__
+        Core::File stat(string(_T("/proc/self/stat")));
+
+        if (stat.Open(true) == true) {
+            char buffer[1024];
+            const uint32_t length = stat.Read(reinterpret_cast<uint8_t*>(buffer), sizeof(buffer) - 1);
+
+            buffer[length] = '\0';
+
+            // The name (field 2) can hold spaces, the start time is the 20th field after it.
+            const char* position = ::strrchr(buffer, ')');
+            uint8_t field = 2;
+
+            while ((position != nullptr) && (field < 22)) {
+                position = ::strchr(position + 1, ' ');
+                field++;
+            }
+
+            struct timespec uptime;
+            const long hertz = ::sysconf(_SC_CLK_TCK);
+
+            if ((position != nullptr) && (hertz > 0) && (::clock_gettime(CLOCK_BOOTTIME, &uptime) == 0)) {
+                const uint64_t started = (::strtoull(position + 1, nullptr, 10) * 1000000ull) / static_cast<uint64_t>(hertz);
+                const uint64_t now = (static_cast<uint64_t>(uptime.tv_sec) * 1000000ull) + (uptime.tv_nsec / 1000);
+
+                if (now >= started) {
+                    result = Core::Time::Now().Ticks() - (now - started);
+                }
+            }
+        }
+#endif
+
+        return (result);
+    }
+
+    Activation Profile(const string& callsign, const uint64_t initialize, const uint64_t root, const uint64_t configured, const uint64_t done, const Marks& marks)
+    {
+        Activation result { callsign, initialize, (marks.Process.Value() != Core::ProcessInfo().Id()), done - initialize, {} };
+
+        if (marks.Constructed.Value() == 0) {
+            // Nothing from the implementation (remote, or it failed to write), only what is seen here.
+            Add(result, _T("activate"), initialize, root);
+            Add(result, _T("configure"), root, configured);
+        } else {
+            if (result.OutOfProcess == true) {
+                // Rounded to the clock ticks of the kernel, it can be seen to start before it was asked for.
+                const uint64_t started = std::min(std::max(marks.Started.Value(), initialize), marks.Loaded.Value());
+
+                if (marks.Started.Value() != 0) {
+                    Add(result, _T("spawn"), initialize, started);
+                    Add(result, _T("startup"), started, marks.Loaded.Value());
+                } else {
+                    Add(result, _T("spawn"), initialize, marks.Loaded.Value());
+                }
+                Add(result, _T("construct"), marks.Loaded.Value(), marks.Constructed.Value());
+            } else {
+                Add(result, _T("construct"), initialize, marks.Constructed.Value());
+            }
+
+            Add(result, _T("handover"), marks.Constructed.Value(), root);
+            Add(result, _T("prepare"), root, marks.Configuring.Value());
+            Add(result, _T("configure"), marks.Configuring.Value(), marks.Configured.Value());
+            Add(result, _T("return"), std::max(root, marks.Configured.Value()), configured);
+        }
+
+        Add(result, _T("initialize"), configured, done);
+
+        return (result);
+    }
+
+    void Prelauncher::Dispatch()
+    {
+        Statistics statistics { 0, 0, 0 };
+        std::vector<uint8_t> buffer(64 * 1024);
+        const uint64_t start = Core::Time::Now().Ticks();
+
+        _adminLock.Lock();
+        std::vector<string> paths(_paths);
+        _adminLock.Unlock();
+
+        for (const string& path : paths) {
+            Core::File entry(path);
+
+            if (entry.IsDirectory() == true) {
+                Core::Directory directory(path.c_str());
+
+                while (directory.Next() == true) {
+                    Core::File file(directory.Current());
+
+                    if (file.IsDirectory() == false) {
+                        Prefetch(directory.Current(), buffer, statistics);
+                    }
+                }
+            } else if (entry.Exists() == true) {
+                Prefetch(path, buffer, statistics);
+            }
+        }
+
+        statistics.Duration = Core::Time::Now().Ticks() - start;
+
+        TRACE(Trace::Information, (_T("Prelaunch read %d files, %d kB in %d ms"), statistics.Files, static_cast<uint32_t>(statistics.Bytes / 1024), static_cast<uint32_t>(statistics.Duration / Core::Time::TicksPerMillisecond)));
+
+        _adminLock.Lock();
+        _statistics = statistics;
+        _adminLock.Unlock();
+    }
+
+    /* static */ void Prelauncher::Prefetch(const string& fileName, std::vector<uint8_t>& buffer, Statistics& statistics)
+    {
+        Core::File file(fileName);
+
+        // Read once, so the loader of the host process finds it in the page cache.
+        if (file.Open(true) == true) {
+            uint32_t loaded;
+
+            while ((loaded = file.Read(buffer.data(), static_cast<uint32_t>(buffer.size()))) > 0) {
+                statistics.Bytes += loaded;
+            }
+
+            statistics.Files++;
+        }
+    }
+
+} // namespace Startup
+} // namespace Plugin
+} // namespace Thunder
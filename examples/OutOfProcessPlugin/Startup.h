@@ -0,0 +1,159 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+namespace Thunder {
+namespace Plugin {
+namespace Startup {
+
+    // Where an activation spends its time. The framework side only sees the start of Initialize, the
+    // return of Root() and of Configure(). What happens in between, in the host process, is marked
+    // there and left in a file for the framework side to pick up once Configure() returns. All
+    // times are wall clock ticks (us), the same on both sides of the process boundary.
+    class Marks : public Core::JSON::Container {
+    public:
+        Marks(const Marks&) = delete;
+        Marks& operator=(const Marks&) = delete;
+
+        Marks()
+            : Core::JSON::Container()
+            , Process(0)
+            , Started(0)
+            , Loaded(0)
+            , Constructed(0)
+            , Configuring(0)
+            , Configured(0)
+        {
+            Add(_T("process"), &Process);
+            Add(_T("started"), &Started);
+            Add(_T("loaded"), &Loaded);
+            Add(_T("constructed"), &Constructed);
+            Add(_T("configuring"), &Configuring);
+            Add(_T("configured"), &Configured);
+        }
+        ~Marks() override = default;
+
+    public:
+        static string FileName(const string& volatilePath)
+        {
+            return (volatilePath + _T("startup.json"));
+        }
+
+    public:
+        Core::JSON::DecUInt32 Process; // pid of the host
+        Core::JSON::DecUInt64 Started; // the host process, at the resolution of the kernel clock ticks (10 ms)
+        Core::JSON::DecUInt64 Loaded; // this library, in the host
+        Core::JSON::DecUInt64 Constructed;
+        Core::JSON::DecUInt64 Configuring;
+        Core::JSON::DecUInt64 Configured;
+    };
+
+    struct Phase {
+        string Name;
+        uint64_t Start; // us after the start of Initialize
+        uint64_t Duration; // us
+    };
+
+    struct Activation {
+        string Callsign;
+        uint64_t Time; // ticks, start of Initialize
+        bool OutOfProcess;
+        uint64_t Duration; // us, all of Initialize
+        std::vector<Phase> Phases;
+    };
+
+    // Taken where the plugin is initialized, the marks are those of the implementation.
+    Activation Profile(const string& callsign, const uint64_t initialize, const uint64_t root, const uint64_t configured, const uint64_t done, const Marks& marks);
+
+    // When this library was loaded into the current process.
+    uint64_t Loaded();
+
+    // When the current process was started, 0 if that is not known.
+    uint64_t ProcessStarted();
+
+    // Pre-reads the files a host process is going to load (the proxy stubs, the plugin libraries) in
+    // the page cache, while the system is busy with other things. The host processes of the plugins
+    // activated after that start warm instead of from flash.
+    class Prelauncher {
+    public:
+        struct Statistics {
+            uint32_t Files;
+            uint64_t Bytes;
+            uint64_t Duration; // us
+        };
+
+    public:
+        Prelauncher(Prelauncher&&) = delete;
+        Prelauncher(const Prelauncher&) = delete;
+        Prelauncher& operator=(Prelauncher&&) = delete;
+        Prelauncher& operator=(const Prelauncher&) = delete;
+
+        Prelauncher()
+            : _adminLock()
+            , _paths()
+            , _statistics({ 0, 0, 0 })
+            , _job(*this)
+        {
+        }
+        ~Prelauncher()
+        {
+            _job.Revoke();
+        }
+
+    public:
+        void Start(std::vector<string>&& paths)
+        {
+            _adminLock.Lock();
+            _paths = std::move(paths);
+            _adminLock.Unlock();
+
+            _job.Submit();
+        }
+        void Stop()
+        {
+            _job.Revoke();
+        }
+        Statistics Collect() const
+        {
+            _adminLock.Lock();
+            Statistics result(_statistics);
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+    private:
+        friend class Core::ThreadPool::JobType<Prelauncher&>;
+        void Dispatch();
+
+        static void Prefetch(const string& fileName, std::vector<uint8_t>& buffer, Statistics& statistics);
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        std::vector<string> _paths;
+        Statistics _statistics;
+        Core::WorkerPool::JobType<Prelauncher&> _job;
+    };
+
+} // namespace Startup
+} // namespace Plugin
+} // namespace Thunder
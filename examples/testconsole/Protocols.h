@@ -18,3 +18,4 @@
  */
 
 #include "../testserver/EchoProtocol.h"
+#include "../testserver/LoadGenerator.h"
@@ -145,16 +145,25 @@ Core::ProxyPoolType<ProvisioningClient::ProvisioningInfo> ProvisioningClient::_i
 
 /* static */ Thunder::Core::ProxyPoolType<Thunder::Web::Response> Thunder::TestSystem::JSONWebClient::_responseFactory(5);
 /* static */ Thunder::Core::ProxyPoolType<Thunder::TestSystem::CommandBody> Thunder::TestSystem::JSONWebClient::_commandBodyFactory(5);
+
+/* static */ Thunder::Core::ProxyPoolType<Thunder::Web::Response> Thunder::TestSystem::Load::WebChannel::_responseFactory(64);
+/* static */ Thunder::Core::ProxyPoolType<Thunder::Web::Request> Thunder::TestSystem::Load::WebChannel::_requestFactory(64);
+/* static */ Thunder::Core::ProxyPoolType<Thunder::Web::TextBody> Thunder::TestSystem::Load::WebChannel::_textBodyFactory(128);
 const uint8_t STRESS_ENGINES = 10;
 
 class ConsoleOptions : public Thunder::Core::Options {
 public:
     ConsoleOptions(int argumentCount, TCHAR* arguments[])
-        : Thunder::Core::Options(argumentCount, arguments, _T("v:hsp:d"))
+        : Thunder::Core::Options(argumentCount, arguments, _T("v:hsp:dr:c:t:l:o:"))
         , LogLevel()
         , SSL(false)
         , Port(80)
         , Version(1)
+        , Rate(1000)
+        , Connections(4)
+        , Threads(2)
+        , Duration(10)
+        , Output(_T("loadtest.json"))
     {
         Parse();
     }
@@ -168,6 +177,13 @@ public:
     uint16_t Port;
     uint16_t Version;
 
+    // Load test [L] settings
+    uint32_t Rate; // requests/s, over all threads
+    uint16_t Connections; // over all threads
+    uint16_t Threads;
+    uint16_t Duration; // s, per protocol
+    string Output;
+
 private:
     virtual void Option(const TCHAR option, const TCHAR* argument)
     {
@@ -184,6 +200,21 @@ private:
         case 'v':
             Version = atoi(argument);
             break;
+        case 'r':
+            Rate = atoi(argument);
+            break;
+        case 'c':
+            Connections = atoi(argument);
+            break;
+        case 't':
+            Threads = atoi(argument);
+            break;
+        case 'l':
+            Duration = atoi(argument);
+            break;
+        case 'o':
+            Output = argument;
+            break;
         case 'h':
         default:
             RequestUsage(true);
@@ -604,6 +635,35 @@ POP_WARNING()
                 stressEngines[0]->DirectFire(10000);
                 break;
             }
+            case 'L': {
+                // Open loop load test over every echo protocol, one after the other.
+                const uint16_t threads = std::max<uint16_t>(1, options.Threads);
+                const uint16_t connections = std::max<uint16_t>(threads, options.Connections);
+                const uint32_t duration = options.Duration * 1000;
+                Thunder::TestSystem::Load::Reports reports;
+
+                Thunder::TestSystem::Load::Execute<Thunder::TestSystem::Load::TextChannel>(options.Command(), threads, connections, options.Rate, duration, reports.Runs.Add());
+                Thunder::TestSystem::Load::Execute<Thunder::TestSystem::Load::JSONChannel>(options.Command(), threads, connections, options.Rate, duration, reports.Runs.Add());
+                Thunder::TestSystem::Load::Execute<Thunder::TestSystem::Load::WebSocketChannel>(options.Command(), threads, connections, options.Rate, duration, reports.Runs.Add());
+                Thunder::TestSystem::Load::Execute<Thunder::TestSystem::Load::WebChannel>(options.Command(), threads, connections, options.Rate, duration, reports.Runs.Add());
+
+                auto index(reports.Runs.Elements());
+                while (index.Next() == true) {
+                    const Thunder::TestSystem::Load::Report& run(index.Current());
+                    printf("%-10s sent: %8" PRIu64 " received: %8" PRIu64 " dropped: %6" PRIu64 " expired: %6" PRIu64 " achieved: %6u/s p50: %6" PRIu64 "us p99: %6" PRIu64 "us p99.9: %6" PRIu64 "us max: %6" PRIu64 "us\n",
+                        run.Protocol.Value().c_str(), run.Sent.Value(), run.Received.Value(), run.Dropped.Value(), run.Expired.Value(),
+                        run.Achieved.Value(), run.P50.Value(), run.P99.Value(), run.P999.Value(), run.Max.Value());
+                }
+
+                Core::File file(options.Output);
+                if (file.Create() == true) {
+                    reports.IElement::ToFile(file);
+                    printf("Load test report written to [%s]\n", file.Name().c_str());
+                } else {
+                    printf(_T("Error [%d] creating file [%s]\n"), file.ErrorCode(), file.Name().c_str());
+                }
+                break;
+            }
             case 'D': {
                 Core::File file("F:/windows/TestArea/download/test.lib");
                 if (file.Create() == true) {
@@ -0,0 +1,668 @@
+ /*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOADGENERATOR_H
+#define __LOADGENERATOR_H
+
+#include "EchoProtocol.h"
+
+#include <LatencyHistogram.h>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Thunder {
+namespace TestSystem {
+namespace Load {
+
+    // -----------------------------------------------------------------------------------------------
+    // Open loop load generation against the echo servers of the testserver. Requests are fired on a
+    // fixed schedule, whether or not earlier requests have been answered. Latency is measured from
+    // the time a request was *scheduled*, not from the time it was actually sent, so a stalled
+    // sender or server is charged to every request it delayed (coordinated omission correction).
+    // -----------------------------------------------------------------------------------------------
+    inline uint64_t Now()
+    {
+        return (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count()));
+    }
+
+    using Histogram = Plugin::LatencyHistogram;
+
+    struct Statistics {
+        uint64_t Sent;
+        uint64_t Received;
+        uint64_t Dropped;
+        uint64_t Expired;
+    };
+
+    // Keeps the scheduled time of every request in flight on a connection. The echo servers
+    // answer in order, so the oldest stamp always belongs to the next response.
+    class Tracker {
+    private:
+        static constexpr uint32_t Capacity = 4096;
+
+    public:
+        Tracker(const Tracker&) = delete;
+        Tracker& operator=(const Tracker&) = delete;
+
+        Tracker()
+            : _lock()
+            , _stamps()
+            , _head(0)
+            , _tail(0)
+            , _statistics()
+            , _latency()
+        {
+        }
+        ~Tracker() = default;
+
+    public:
+        // Too many requests in flight means the server is not keeping up; the request is not
+        // sent but counted, so the sender never blocks and the schedule is kept. It is charged
+        // the time the oldest request in flight has been waiting, what the server is behind,
+        // so a saturated server does not look faster by the requests it never saw.
+        bool Stamp(const uint64_t scheduled)
+        {
+            bool result = false;
+
+            _lock.Lock();
+            if ((_head - _tail) < Capacity) {
+                _stamps[_head % Capacity] = scheduled;
+                _head++;
+                _statistics.Sent++;
+                result = true;
+            } else {
+                _latency.Record(Now() - _stamps[_tail % Capacity]);
+                _statistics.Dropped++;
+            }
+            _lock.Unlock();
+
+            return (result);
+        }
+        void Completed()
+        {
+            const uint64_t now = Now();
+
+            _lock.Lock();
+            if (_tail != _head) {
+                _latency.Record(now - _stamps[_tail % Capacity]);
+                _tail++;
+                _statistics.Received++;
+            }
+            _lock.Unlock();
+        }
+        uint32_t Outstanding() const
+        {
+            _lock.Lock();
+            uint32_t result = static_cast<uint32_t>(_head - _tail);
+            _lock.Unlock();
+
+            return (result);
+        }
+        // Requests never answered are accounted with the time they have been waiting so far,
+        // a lower bound of their real latency, instead of silently leaving them out.
+        void Expire()
+        {
+            const uint64_t now = Now();
+
+            _lock.Lock();
+            while (_tail != _head) {
+                _latency.Record(now - _stamps[_tail % Capacity]);
+                _tail++;
+                _statistics.Expired++;
+            }
+            _lock.Unlock();
+        }
+        void Collect(Histogram& latency, Statistics& statistics) const
+        {
+            _lock.Lock();
+            latency.Merge(_latency);
+            statistics.Sent += _statistics.Sent;
+            statistics.Received += _statistics.Received;
+            statistics.Dropped += _statistics.Dropped;
+            statistics.Expired += _statistics.Expired;
+            _lock.Unlock();
+        }
+
+    private:
+        mutable Core::CriticalSection _lock;
+        std::array<uint64_t, Capacity> _stamps;
+        uint64_t _head;
+        uint64_t _tail;
+        Statistics _statistics;
+        Histogram _latency;
+    };
+
+    // -----------------------------------------------------------------------------------------------
+    // Channels: one connection to one of the echo servers, firing pre-built requests.
+    // -----------------------------------------------------------------------------------------------
+    class TextChannel : public Core::StreamTextType<Core::SocketStream, Core::TerminatorCarriageReturn>, public Tracker {
+    private:
+        typedef Core::StreamTextType<Core::SocketStream, Core::TerminatorCarriageReturn> BaseClass;
+
+    public:
+        static constexpr uint16_t Port = 12348;
+
+        TextChannel() = delete;
+        TextChannel(const TextChannel&) = delete;
+        TextChannel& operator=(const TextChannel&) = delete;
+
+        TextChannel(const Core::NodeId& remoteNode)
+            : BaseClass(false, remoteNode.AnyInterface(), remoteNode, 1024, 1024)
+            , Tracker()
+            , _message()
+        {
+            // The stress server validates what it receives, so send a well formed message.
+            StressTextFactory factory;
+            _message = factory.GenerateData();
+        }
+        ~TextChannel() override
+        {
+            Close(Core::infinite);
+        }
+
+        static const TCHAR* Name()
+        {
+            return (_T("text"));
+        }
+
+    public:
+        void Fire(const uint64_t scheduled)
+        {
+            if (Stamp(scheduled) == true) {
+                Submit(_message);
+            }
+        }
+        void Received(string&) override
+        {
+            Completed();
+        }
+        void Send(const string&) override
+        {
+        }
+        void StateChange() override
+        {
+        }
+
+    private:
+        string _message;
+    };
+
+    class JSONChannel : public Core::StreamJSONType<Core::SocketStream, JSONObjectFactory<Core::JSON::IElement>&, Core::JSON::IElement>, public Tracker {
+    private:
+        typedef Core::StreamJSONType<Core::SocketStream, JSONObjectFactory<Core::JSON::IElement>&, Core::JSON::IElement> BaseClass;
+        typedef Web::JSONBodyType<Core::JSONRPC::Message> Message;
+
+    public:
+        static constexpr uint16_t Port = 12342;
+
+        JSONChannel() = delete;
+        JSONChannel(const JSONChannel&) = delete;
+        JSONChannel& operator=(const JSONChannel&) = delete;
+
+        JSONChannel(const Core::NodeId& remoteNode)
+            : BaseClass(5, JSONObjectFactory<Core::JSON::IElement>::Instance(), false, remoteNode.AnyInterface(), remoteNode, 1024, 1024)
+            , Tracker()
+            , _messages(8)
+            , _identifier(0)
+        {
+        }
+        ~JSONChannel() override
+        {
+            this->Close(Core::infinite);
+        }
+
+        static const TCHAR* Name()
+        {
+            return (_T("json"));
+        }
+
+    public:
+        void Fire(const uint64_t scheduled)
+        {
+            if (Stamp(scheduled) == true) {
+                // The server side factory only produces JSONRPC messages, so that is what is echoed.
+                Core::ProxyType<Message> message(_messages.Element());
+                message->Clear();
+                message->Id = _identifier++;
+                message->Designator = _T("LoadTest.1.echo");
+                this->Submit(Core::ProxyType<Core::JSON::IElement>(message));
+            }
+        }
+        void Received(Core::ProxyType<Core::JSON::IElement>&) override
+        {
+            Completed();
+        }
+        void Send(Core::ProxyType<Core::JSON::IElement>&) override
+        {
+        }
+        void StateChange() override
+        {
+        }
+        bool IsIdle() const override
+        {
+            return (true);
+        }
+
+    private:
+        Core::ProxyPoolType<Message> _messages;
+        uint32_t _identifier;
+    };
+
+    class WebSocketChannel : public Core::StreamTextType<Web::WebSocketClientType<Core::SocketStream>, Core::TerminatorCarriageReturn>, public Tracker {
+    private:
+        typedef Core::StreamTextType<Web::WebSocketClientType<Core::SocketStream>, Core::TerminatorCarriageReturn> BaseClass;
+
+    public:
+        static constexpr uint16_t Port = 12345;
+
+        WebSocketChannel() = delete;
+        WebSocketChannel(const WebSocketChannel&) = delete;
+        WebSocketChannel& operator=(const WebSocketChannel&) = delete;
+
+        WebSocketChannel(const Core::NodeId& remoteNode)
+            : BaseClass(_T("/"), _T("echo"), _T(""), _T(""), false, true, false, remoteNode.AnyInterface(), remoteNode, 1024, 1024)
+            , Tracker()
+            , _message(_T("theTHEquickQUICKbrownBROWNfoxFOXjumpsJUMPSoverOVERlazyLAZYdogDOG!"))
+        {
+        }
+        ~WebSocketChannel() override
+        {
+            Close(Core::infinite);
+        }
+
+        static const TCHAR* Name()
+        {
+            return (_T("websocket"));
+        }
+
+    public:
+        void Fire(const uint64_t scheduled)
+        {
+            if (Stamp(scheduled) == true) {
+                Submit(_message);
+            }
+        }
+        void Received(string&) override
+        {
+            Completed();
+        }
+        void Send(const string&) override
+        {
+        }
+        void StateChange() override
+        {
+        }
+
+    private:
+        const string _message;
+    };
+
+    class WebChannel : public Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&>, public Tracker {
+    private:
+        typedef Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&> BaseClass;
+
+        // Requests, responses and their bodies are recycled through these pools, so a running
+        // load test does not allocate per request.
+        static Core::ProxyPoolType<Web::Response> _responseFactory;
+        static Core::ProxyPoolType<Web::Request> _requestFactory;
+        static Core::ProxyPoolType<Web::TextBody> _textBodyFactory;
+
+    public:
+        static constexpr uint16_t Port = 12343;
+
+        WebChannel() = delete;
+        WebChannel(const WebChannel&) = delete;
+        WebChannel& operator=(const WebChannel&) = delete;
+
+        WebChannel(const Core::NodeId& remoteNode)
+            : BaseClass(5, _responseFactory, false, remoteNode.AnyInterface(), remoteNode, 2048, 2048)
+            , Tracker()
+        {
+        }
+        ~WebChannel() override
+        {
+            Close(Core::infinite);
+        }
+
+        static const TCHAR* Name()
+        {
+            return (_T("http"));
+        }
+
+    public:
+        void Fire(const uint64_t scheduled)
+        {
+            if (Stamp(scheduled) == true) {
+                Core::ProxyType<Web::Request> request(_requestFactory.Element());
+                Core::ProxyType<Web::TextBody> body(_textBodyFactory.Element());
+
+                request->Clear();
+                request->Verb = Web::Request::HTTP_GET;
+                *body = _T("LoadTest");
+                request->Body<Web::TextBody>(body);
+
+                Submit(request);
+            }
+        }
+        void LinkBody(Core::ProxyType<Web::Response>& element) override
+        {
+            element->Body<Web::TextBody>(_textBodyFactory.Element());
+        }
+        void Received(Core::ProxyType<Web::Response>&) override
+        {
+            Completed();
+        }
+        void Send(const Core::ProxyType<Web::Request>&) override
+        {
+        }
+        void StateChange() override
+        {
+        }
+    };
+
+    // -----------------------------------------------------------------------------------------------
+    // A thread firing requests at a fixed rate, round robin over its own set of connections.
+    // -----------------------------------------------------------------------------------------------
+    template <typename CHANNEL>
+    class GeneratorType : public Core::Thread {
+    public:
+        GeneratorType() = delete;
+        GeneratorType(const GeneratorType<CHANNEL>&) = delete;
+        GeneratorType<CHANNEL>& operator=(const GeneratorType<CHANNEL>&) = delete;
+
+        GeneratorType(const Core::NodeId& remoteNode, const uint16_t connections, const uint32_t rate)
+            : Core::Thread(0, _T("LoadGenerator"))
+            , _channels()
+            , _interval(rate == 0 ? 0 : (1000000000ULL / rate))
+            , _duration(0)
+            , _lag()
+            , _done(false, true)
+        {
+            for (uint16_t index = 0; index < connections; index++) {
+                _channels.emplace_back(new CHANNEL(remoteNode));
+
+                if (_channels.back()->Open(1000) != Core::ERROR_NONE) {
+                    printf("Could not open %s connection %d to %s\n", CHANNEL::Name(), index, remoteNode.QualifiedName().c_str());
+                    _channels.pop_back();
+                }
+            }
+        }
+        ~GeneratorType() override
+        {
+            Stop();
+            Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, Core::infinite);
+            _channels.clear();
+        }
+
+    public:
+        bool IsValid() const
+        {
+            return ((_channels.empty() == false) && (_interval != 0));
+        }
+        void Start(const uint32_t durationMs)
+        {
+            _duration = static_cast<uint64_t>(durationMs) * 1000000ULL;
+            _done.ResetEvent();
+            Run();
+        }
+        bool WaitForCompletion(const uint32_t waitTime) const
+        {
+            return (_done.Lock(waitTime) == Core::ERROR_NONE);
+        }
+        uint16_t Connections() const
+        {
+            return (static_cast<uint16_t>(_channels.size()));
+        }
+        uint32_t Outstanding() const
+        {
+            uint32_t result = 0;
+            for (const auto& channel : _channels) {
+                result += channel->Outstanding();
+            }
+            return (result);
+        }
+        void Collect(Histogram& latency, Histogram& lag, Statistics& statistics)
+        {
+            lag.Merge(_lag);
+            for (auto& channel : _channels) {
+                channel->Expire();
+                channel->Collect(latency, statistics);
+            }
+        }
+
+    private:
+        uint32_t Worker() override
+        {
+            const uint64_t start = Now();
+            const uint64_t end = start + _duration;
+            const size_t connections = _channels.size();
+            uint64_t sequence = 0;
+            uint64_t scheduled = start;
+
+            while ((scheduled < end) && (IsRunning() == true)) {
+                uint64_t now = Now();
+
+                if (now < scheduled) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(scheduled - now));
+                    now = Now();
+                }
+
+                // How late the request leaves compared to its schedule; part of its latency.
+                _lag.Record(now - scheduled);
+
+                _channels[sequence % connections]->Fire(scheduled);
+
+                sequence++;
+                scheduled = start + (sequence * _interval);
+            }
+
+            _done.SetEvent();
+
+            Block();
+
+            return (Core::infinite);
+        }
+
+    private:
+        std::vector<std::unique_ptr<CHANNEL>> _channels;
+        const uint64_t _interval;
+        uint64_t _duration;
+        Histogram _lag;
+        mutable Core::Event _done;
+    };
+
+    class Report : public Core::JSON::Container {
+    public:
+        Report& operator=(const Report&) = delete;
+        Report()
+            : Core::JSON::Container()
+        {
+            Init();
+        }
+        Report(const Report& copy)
+            : Core::JSON::Container()
+            , Protocol(copy.Protocol)
+            , Threads(copy.Threads)
+            , Connections(copy.Connections)
+            , Rate(copy.Rate)
+            , Achieved(copy.Achieved)
+            , Duration(copy.Duration)
+            , Sent(copy.Sent)
+            , Received(copy.Received)
+            , Dropped(copy.Dropped)
+            , Expired(copy.Expired)
+            , Mean(copy.Mean)
+            , P50(copy.P50)
+            , P90(copy.P90)
+            , P99(copy.P99)
+            , P999(copy.P999)
+            , Max(copy.Max)
+            , LagP99(copy.LagP99)
+        {
+            Init();
+        }
+        ~Report() override = default;
+
+    private:
+        void Init()
+        {
+            Add(_T("protocol"), &Protocol);
+            Add(_T("threads"), &Threads);
+            Add(_T("connections"), &Connections);
+            Add(_T("rate"), &Rate);
+            Add(_T("achieved"), &Achieved);
+            Add(_T("duration"), &Duration);
+            Add(_T("sent"), &Sent);
+            Add(_T("received"), &Received);
+            Add(_T("dropped"), &Dropped);
+            Add(_T("expired"), &Expired);
+            Add(_T("mean"), &Mean);
+            Add(_T("p50"), &P50);
+            Add(_T("p90"), &P90);
+            Add(_T("p99"), &P99);
+            Add(_T("p999"), &P999);
+            Add(_T("max"), &Max);
+            Add(_T("lagp99"), &LagP99);
+        }
+
+    public:
+        Core::JSON::String Protocol;
+        Core::JSON::DecUInt16 Threads;
+        Core::JSON::DecUInt16 Connections; // in total
+        Core::JSON::DecUInt32 Rate; // requests/s, target
+        Core::JSON::DecUInt32 Achieved; // responses/s
+        Core::JSON::DecUInt32 Duration; // ms
+        Core::JSON::DecUInt64 Sent;
+        Core::JSON::DecUInt64 Received;
+        Core::JSON::DecUInt64 Dropped; // not sent, too many in flight
+        Core::JSON::DecUInt64 Expired; // sent, never answered
+        Core::JSON::DecUInt64 Mean; // latencies in us, from the scheduled send time
+        Core::JSON::DecUInt64 P50;
+        Core::JSON::DecUInt64 P90;
+        Core::JSON::DecUInt64 P99;
+        Core::JSON::DecUInt64 P999;
+        Core::JSON::DecUInt64 Max;
+        Core::JSON::DecUInt64 LagP99; // us the sender ran behind its schedule
+    };
+
+    class Reports : public Core::JSON::Container {
+    public:
+        Reports(const Reports&) = delete;
+        Reports& operator=(const Reports&) = delete;
+        Reports()
+            : Core::JSON::Container()
+            , Runs()
+        {
+            Add(_T("runs"), &Runs);
+        }
+        ~Reports() override = default;
+
+    public:
+        Core::JSON::ArrayType<Report> Runs;
+    };
+
+    // Spreads the target rate, and the connections, over the given number of threads, each driving
+    // its own connections. What does not divide evenly goes to the first threads; there are never
+    // more threads than requests per second, a generator without a rate would not fire at all.
+    template <typename CHANNEL>
+    void Execute(const string& host, const uint16_t threads, const uint16_t connections, const uint32_t rate, const uint32_t durationMs, Report& report)
+    {
+        const Core::NodeId remoteNode(host.c_str(), CHANNEL::Port);
+        const uint16_t used = static_cast<uint16_t>(std::max<uint32_t>(1, std::min<uint32_t>(threads, rate)));
+        std::vector<std::unique_ptr<GeneratorType<CHANNEL>>> generators;
+        uint32_t opened = 0;
+
+        if (used < threads) {
+            printf("Load test [%s]: %d requests/s keeps only %d of the %d threads busy\n", CHANNEL::Name(), rate, used, threads);
+        }
+
+        for (uint16_t index = 0; index < used; index++) {
+            const uint16_t channels = std::max<uint16_t>(1, (connections / used) + (index < (connections % used) ? 1 : 0));
+            const uint32_t share = (rate / used) + (index < (rate % used) ? 1 : 0);
+
+            generators.emplace_back(new GeneratorType<CHANNEL>(remoteNode, channels, share));
+
+            if (generators.back()->IsValid() == false) {
+                generators.pop_back();
+            } else {
+                opened += generators.back()->Connections();
+            }
+        }
+
+        Histogram latency;
+        Histogram lag;
+        Statistics statistics{};
+
+        if (generators.empty() == false) {
+            printf("Load test [%s]: %d requests/s over %d threads for %d ms\n", CHANNEL::Name(), rate, static_cast<uint32_t>(generators.size()), durationMs);
+
+            for (auto& generator : generators) {
+                generator->Start(durationMs);
+            }
+            for (auto& generator : generators) {
+                generator->WaitForCompletion(Core::infinite);
+            }
+
+            // Give the responses in flight a moment to come in.
+            const uint64_t drained = Now() + 2000000000ULL;
+            uint32_t outstanding;
+            do {
+                outstanding = 0;
+                for (auto& generator : generators) {
+                    outstanding += generator->Outstanding();
+                }
+                if (outstanding != 0) {
+                    SleepMs(10);
+                }
+            } while ((outstanding != 0) && (Now() < drained));
+
+            for (auto& generator : generators) {
+                generator->Collect(latency, lag, statistics);
+            }
+        }
+
+        report.Protocol = CHANNEL::Name();
+        report.Threads = static_cast<uint16_t>(generators.size());
+        report.Connections = static_cast<uint16_t>(opened);
+        report.Rate = rate;
+        report.Achieved = (durationMs == 0 ? 0 : static_cast<uint32_t>((statistics.Received * 1000) / durationMs));
+        report.Duration = durationMs;
+        report.Sent = statistics.Sent;
+        report.Received = statistics.Received;
+        report.Dropped = statistics.Dropped;
+        report.Expired = statistics.Expired;
+        report.Mean = latency.Mean() / 1000;
+        report.P50 = latency.Percentile(50.0) / 1000;
+        report.P90 = latency.Percentile(90.0) / 1000;
+        report.P99 = latency.Percentile(99.0) / 1000;
+        report.P999 = latency.Percentile(99.9) / 1000;
+        report.Max = latency.Max() / 1000;
+        report.LagP99 = lag.Percentile(99.0) / 1000;
+    }
+
+} // namespace Load
+}
+} // Namespace Thunder.TestSystem
+
+#endif
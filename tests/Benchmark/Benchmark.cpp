@@ -21,9 +21,11 @@
 #include <qa_interfaces/json/JBenchmark.h>
 
 #include <algorithm>
+#include <cctype>
 #include <cinttypes>
 #include <cmath>
 #include <cstdio>
+#include <thread>
 
 namespace Thunder {
 namespace BenchmarkMemory {
@@ -93,94 +95,123 @@ namespace Plugin {
 
     namespace {
 
-        struct LatencyAccumulator {
-            std::vector<uint64_t> samplesUs;
+        static void Summarize(Benchmark::Measurement& cell, const string& apiName)
+        {
+            cell.result.apiName = apiName;
+            cell.result.iterations = static_cast<uint32_t>(cell.histogram.Count());
+            cell.result.roundTrip.minNs = cell.histogram.Min();
+            cell.result.roundTrip.avgNs = cell.histogram.Mean();
+            cell.result.roundTrip.maxNs = cell.histogram.Max();
+            cell.result.roundTrip.stddevNs = cell.histogram.StdDev();
+            cell.result.passed = (cell.errors == 0);
+        }
 
-            void Record(uint64_t us)
-            {
-                samplesUs.push_back(us);
-            }
+        // Calls fn iterations times from each of the given number of threads, released
+        // at the same time, and records every call in nanoseconds. A caller stops at its
+        // first failing call, which fails the cell. The warmup calls are not recorded.
+        template<typename CALLABLE>
+        Benchmark::Measurement Measure(
+            const string& apiName, const uint32_t size, const uint8_t threads, const uint32_t iterations, const uint32_t warmup,
+            Exchange::IMemory* memory, CALLABLE&& fn)
+        {
+            ASSERT(memory != nullptr);
+            ASSERT(threads > 0);
 
-            QualityAssurance::IBenchmark::RoundTripStats Stats() const
-            {
-                QualityAssurance::IBenchmark::RoundTripStats stats{};
-                if (samplesUs.empty()) return stats;
+            struct Caller {
+                LatencyHistogram histogram;
+                uint32_t errors;
+                uint32_t failure;
+            };
 
-                uint64_t sum = 0;
-                uint64_t minVal = UINT64_MAX;
-                uint64_t maxVal = 0;
+            Benchmark::Measurement cell{};
+            cell.size = size;
+            cell.threads = threads;
 
-                for (auto v : samplesUs) {
-                    sum += v;
-                    if (v < minVal) minVal = v;
-                    if (v > maxVal) maxVal = v;
+            cell.result.memory.residentBefore = memory->Resident();
+            cell.result.memory.allocatedBefore = memory->Allocated();
+
+            std::vector<Caller> callers(threads);
+
+            for (uint32_t i = 0; i < warmup; i++) {
+                if (fn() != Core::ERROR_NONE) {
+                    break;
                 }
+            }
 
-                uint64_t avg = sum / samplesUs.size();
+            auto run = [&fn, iterations](Caller& caller) {
+                caller.errors = 0;
+                caller.failure = Core::ERROR_NONE;
 
-                double variance = 0.0;
-                for (auto v : samplesUs) {
-                    double diff = static_cast<double>(v) - static_cast<double>(avg);
-                    variance += diff * diff;
+                for (uint32_t i = 0; i < iterations; i++) {
+                    const uint64_t begin = LatencyHistogram::Now();
+                    const uint32_t hr = fn();
+                    const uint64_t end = LatencyHistogram::Now();
+
+                    if (hr != Core::ERROR_NONE) {
+                        caller.errors++;
+                        caller.failure = hr;
+                        break;
+                    }
+                    caller.histogram.Record(end - begin);
+                }
+            };
+
+            uint64_t begin = 0;
+
+            if (threads == 1) {
+                begin = LatencyHistogram::Now();
+                run(callers[0]);
+            } else {
+                Core::Event start(false, true);
+                std::vector<std::thread> pool;
+                pool.reserve(threads);
+
+                for (auto& caller : callers) {
+                    pool.emplace_back([&start, &run, &caller]() {
+                        start.Lock(Core::infinite);
+                        run(caller);
+                    });
                 }
-                variance /= samplesUs.size();
 
-                // Convert µs to ns for the interface
-                stats.minNs = minVal * 1000;
-                stats.avgNs = avg * 1000;
-                stats.maxNs = maxVal * 1000;
-                stats.stddevNs = static_cast<uint64_t>(std::sqrt(variance)) * 1000;
+                begin = LatencyHistogram::Now();
+                start.SetEvent();
 
-                return stats;
+                for (auto& thread : pool) {
+                    thread.join();
+                }
             }
-        };
 
-        template<typename CALLABLE>
-        QualityAssurance::IBenchmark::BenchmarkResult MeasurePayloadMethod(
-            const string& apiName, uint32_t iterations, Exchange::IMemory* memory, CALLABLE&& fn)
-        {
-            ASSERT(memory != nullptr);
+            cell.elapsedNs = LatencyHistogram::Now() - begin;
 
-            uint64_t residentBefore = memory->Resident();
-            uint64_t allocatedBefore = memory->Allocated();
-
-            LatencyAccumulator acc;
-            uint32_t completedIterations = 0;
-
-            // Single pass: time each call individually, derive avg from the sum
-            Core::StopWatch batchTimer;
-            for (uint32_t i = 0; i < iterations; i++) {
-                Core::StopWatch timer;
-                uint32_t hr = fn();
-                uint64_t elapsedUs = timer.Elapsed();
-                if (hr != Core::ERROR_NONE) {
-                    SYSLOG(Logging::Error, (_T("COM-RPC call '%s' failed on iteration %u with error 0x%08X"),
-                        apiName.c_str(), i, hr));
-                    break;
+            cell.result.memory.residentAfter = memory->Resident();
+            cell.result.memory.allocatedAfter = memory->Allocated();
+
+            for (const auto& caller : callers) {
+                cell.histogram.Merge(caller.histogram);
+                cell.errors += caller.errors;
+
+                if (caller.errors != 0) {
+                    SYSLOG(Logging::Error, (_T("COM-RPC call '%s' failed after %" PRIu64 " calls with error 0x%08X"),
+                        apiName.c_str(), caller.histogram.Count(), caller.failure));
                 }
-                acc.Record(elapsedUs);
-                completedIterations++;
-            }
-            uint64_t totalBatchUs = batchTimer.Elapsed();
-
-            uint64_t residentAfter = memory->Resident();
-            uint64_t allocatedAfter = memory->Allocated();
-
-            QualityAssurance::IBenchmark::BenchmarkResult result{};
-            result.apiName = apiName;
-            result.iterations = completedIterations;
-            result.roundTrip = acc.Stats();
-            // Override avgNs with batch-derived value for better precision
-            if (completedIterations > 0) {
-                result.roundTrip.avgNs = (totalBatchUs * 1000) / completedIterations;
             }
-            result.memory.residentBefore = residentBefore;
-            result.memory.residentAfter = residentAfter;
-            result.memory.allocatedBefore = allocatedBefore;
-            result.memory.allocatedAfter = allocatedAfter;
-            result.passed = (completedIterations == iterations);
 
-            return result;
+            Summarize(cell, apiName);
+
+            return (cell);
+        }
+
+        template<typename CALLABLE>
+        Benchmark::Measurement MeasurePayloadMethod(
+            const string& apiName, uint32_t iterations, uint32_t warmup, Exchange::IMemory* memory, CALLABLE&& fn)
+        {
+            return (Measure(apiName, 0, 1, iterations, warmup, memory, std::forward<CALLABLE>(fn)));
+        }
+
+        bool IsValidName(const string& name)
+        {
+            return ((name.empty() == false) && (std::all_of(name.begin(), name.end(),
+                [](const TCHAR c) { return ((::isalnum(c) != 0) || (c == '-') || (c == '_')); })));
         }
 
     } // anonymous namespace
@@ -196,6 +227,8 @@ namespace Plugin {
         _service = service;
         _service->AddRef();
 
+        _config.FromString(_service->ConfigLine());
+
         _service->Register(&_notification);
 
         _benchmark = _service->Root<QualityAssurance::IBenchmark>(_connectionId, 2000, _T("BenchmarkImplementation"));
@@ -305,23 +338,7 @@ namespace Plugin {
                     return Core::ERROR_BAD_REQUEST;
                 }
 
-                _adminLock.Lock();
-                _results.clear();
-                _adminLock.Unlock();
-
-                RunPayloadBenchmarks(params.Iterations);
-                ApplyThresholds();
-
-                QualityAssurance::JBenchmark::Event::PerformanceCheckCompleted(*this);
-
-                _adminLock.Lock();
-                bool allPassed = std::all_of(_results.begin(), _results.end(),
-                    [](const QualityAssurance::IBenchmark::BenchmarkResult& r) { return r.passed; });
-                _adminLock.Unlock();
-
-                TRACE(Trace::Information, (_T("Benchmark completed: %u iterations via COM-RPC proxy"),
-                    static_cast<uint32_t>(params.Iterations)));
-                return allPassed ? Core::ERROR_NONE : Core::ERROR_GENERAL;
+                return (Trigger(params.Iterations.Value()));
             });
 
         // Method: 'CollectData' — returns shell-side results
@@ -330,12 +347,66 @@ namespace Plugin {
                 _adminLock.Lock();
                 report.Set(true);
                 for (const auto& r : _results) {
-                    report.Add() = r;
+                    report.Add() = r.result;
+                }
+                for (const auto& r : _matrix) {
+                    report.Add() = r.result;
                 }
                 _adminLock.Unlock();
                 return Core::ERROR_NONE;
             });
 
+        // Method: 'Matrix' — runs the payload size x caller thread matrix
+        PluginHost::JSONRPC::Register<MatrixParamsData, ReportData>(_T("Matrix"),
+            [this](const MatrixParamsData& params, ReportData& report) -> uint32_t {
+                const uint32_t iterations = (params.Iterations.IsSet() == true ? params.Iterations.Value() : _config.Matrix.Iterations.Value());
+                const uint8_t threads = (params.Threads.IsSet() == true ? params.Threads.Value() : _config.Matrix.Threads.Value());
+
+                if ((iterations == 0) || (threads == 0)) {
+                    return Core::ERROR_BAD_REQUEST;
+                }
+
+                RunMatrix(iterations, threads);
+                ExportReport();
+                FillReport(report);
+
+                return Core::ERROR_NONE;
+            });
+
+        // Method: 'Baseline' — runs the API suite and stores it under a name in the persistent path
+        PluginHost::JSONRPC::Register<BaselineParamsData, void>(_T("Baseline"),
+            [this](const BaselineParamsData& params) -> uint32_t {
+                if ((IsValidName(params.Name.Value()) == false) || (params.Iterations.Value() == 0)) {
+                    return Core::ERROR_BAD_REQUEST;
+                }
+
+                return (SaveBaseline(params.Name.Value(), params.Iterations.Value()));
+            });
+
+        // Method: 'Verify' — reruns the API suite and judges every API against a named baseline
+        PluginHost::JSONRPC::Register<BaselineParamsData, VerifyResultData>(_T("Verify"),
+            [this](const BaselineParamsData& params, VerifyResultData& response) -> uint32_t {
+                if ((IsValidName(params.Name.Value()) == false) || (params.Iterations.Value() == 0)) {
+                    return Core::ERROR_BAD_REQUEST;
+                }
+
+                uint32_t result = Verify(params.Name.Value(), params.Iterations.Value());
+
+                if (result == Core::ERROR_NONE) {
+                    response.Name = params.Name.Value();
+                    FillVerdicts(response);
+                }
+
+                return (result);
+            });
+
+        // Method: 'Report' — percentiles of the last runs, as exported to the persistent path
+        PluginHost::JSONRPC::Register<void, ReportData>(_T("Report"),
+            [this](ReportData& report) -> uint32_t {
+                FillReport(report);
+                return Core::ERROR_NONE;
+            });
+
         // Property: 'LatencyThreshold' — max allowed latency deviation in millipercent
         PluginHost::JSONRPC::Property<Core::JSON::DecUInt32>(_T("LatencyThreshold"),
             &Benchmark::GetLatencyThreshold, &Benchmark::SetLatencyThreshold, this);
@@ -349,6 +420,10 @@ namespace Plugin {
     {
         PluginHost::JSONRPC::Unregister(_T("Trigger"));
         PluginHost::JSONRPC::Unregister(_T("CollectData"));
+        PluginHost::JSONRPC::Unregister(_T("Matrix"));
+        PluginHost::JSONRPC::Unregister(_T("Report"));
+        PluginHost::JSONRPC::Unregister(_T("Baseline"));
+        PluginHost::JSONRPC::Unregister(_T("Verify"));
         PluginHost::JSONRPC::Unregister(_T("LatencyThreshold"));
         PluginHost::JSONRPC::Unregister(_T("MemoryThreshold"));
     }
@@ -357,21 +432,23 @@ namespace Plugin {
     {
         ASSERT(_payloadProxy != nullptr);
 
-        auto addResult = [this](QualityAssurance::IBenchmark::BenchmarkResult&& r) {
+        const uint32_t warmup = _config.Regression.Warmup.Value();
+
+        auto addResult = [this](Measurement&& r) {
             _adminLock.Lock();
             _results.push_back(std::move(r));
             _adminLock.Unlock();
         };
 
-        addResult(MeasurePayloadMethod("SendUint32", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendUint32", iterations, warmup, _memory, [this]() -> uint32_t {
             return _payloadProxy->SendUint32(42);
         }));
 
-        addResult(MeasurePayloadMethod("SendUint64", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendUint64", iterations, warmup, _memory, [this]() -> uint32_t {
             return _payloadProxy->SendUint64(UINT64_C(123456789));
         }));
 
-        addResult(MeasurePayloadMethod("GetPayloadTypes", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("GetPayloadTypes", iterations, warmup, _memory, [this]() -> uint32_t {
             QualityAssurance::IBenchmarkPayload::IPayloadTypeIterator* iter = nullptr;
             uint32_t hr = _payloadProxy->GetPayloadTypes(iter);
             if (iter != nullptr) {
@@ -380,11 +457,11 @@ namespace Plugin {
             return hr;
         }));
 
-        addResult(MeasurePayloadMethod("SendString", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendString", iterations, warmup, _memory, [this]() -> uint32_t {
             return _payloadProxy->SendString(_T("benchmark_payload_string"));
         }));
 
-        addResult(MeasurePayloadMethod("SendSampleData", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendSampleData", iterations, warmup, _memory, [this]() -> uint32_t {
             QualityAssurance::IBenchmarkPayload::SampleData data;
             data.id = 1;
             data.value = 100;
@@ -392,21 +469,21 @@ namespace Plugin {
             return _payloadProxy->SendSampleData(data);
         }));
 
-        addResult(MeasurePayloadMethod("SendNoPayload", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendNoPayload", iterations, warmup, _memory, [this]() -> uint32_t {
             return _payloadProxy->SendNoPayload();
         }));
 
-        addResult(MeasurePayloadMethod("SendReceiveUint32", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendReceiveUint32", iterations, warmup, _memory, [this]() -> uint32_t {
             uint32_t out = 0;
             return _payloadProxy->SendReceiveUint32(42, out);
         }));
 
-        addResult(MeasurePayloadMethod("SendReceiveString", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendReceiveString", iterations, warmup, _memory, [this]() -> uint32_t {
             string out;
             return _payloadProxy->SendReceiveString(_T("benchmark_roundtrip"), out);
         }));
 
-        addResult(MeasurePayloadMethod("SendReceiveSampleData", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendReceiveSampleData", iterations, warmup, _memory, [this]() -> uint32_t {
             QualityAssurance::IBenchmarkPayload::SampleData in;
             in.id = 1;
             in.value = 200;
@@ -415,23 +492,132 @@ namespace Plugin {
             return _payloadProxy->SendReceiveSampleData(in, out);
         }));
 
-        addResult(MeasurePayloadMethod("SendUint32Vector", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendUint32Vector", iterations, warmup, _memory, [this]() -> uint32_t {
             const std::vector<uint32_t> data = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
             return _payloadProxy->SendUint32Vector(data);
         }));
 
-        addResult(MeasurePayloadMethod("SendReceiveUint32Vector", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("SendReceiveUint32Vector", iterations, warmup, _memory, [this]() -> uint32_t {
             const std::vector<uint32_t> input = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
             std::vector<uint32_t> output;
             return _payloadProxy->SendReceiveUint32Vector(input, output);
         }));
 
-        addResult(MeasurePayloadMethod("Add", iterations, _memory, [this]() -> uint32_t {
+        addResult(MeasurePayloadMethod("Add", iterations, warmup, _memory, [this]() -> uint32_t {
             uint32_t result = 0;
             return _payloadProxy->Add(17, 25, result);
         }));
     }
 
+    void Benchmark::RunMatrix(const uint32_t iterations, const uint8_t maxThreads)
+    {
+        ASSERT(_payloadProxy != nullptr);
+
+        std::vector<uint32_t> sizes;
+        auto index = _config.Matrix.Sizes.Elements();
+        while (index.Next() == true) {
+            sizes.push_back(index.Current().Value());
+        }
+        if (sizes.empty() == true) {
+            // The vector length prefix of the proxy limits a single call to 64K elements.
+            sizes = { 4, 64, 1024, 16384, 262140 };
+        }
+
+        // Wider than the thread count, doubling past 128 must not wrap to 0.
+        std::vector<uint8_t> levels;
+        for (uint16_t threads = 1; threads < maxThreads; threads *= 2) {
+            levels.push_back(static_cast<uint8_t>(threads));
+        }
+        levels.push_back(maxThreads);
+
+        std::vector<Measurement> matrix;
+
+        for (const uint32_t size : sizes) {
+            const std::vector<uint32_t> payload(std::max<uint32_t>(1, size / sizeof(uint32_t)), 0x5A5A5A5A);
+            const uint32_t bytes = static_cast<uint32_t>(payload.size() * sizeof(uint32_t));
+
+            for (const uint8_t threads : levels) {
+                matrix.push_back(Measure(_T("SendUint32Vector"), bytes, threads, iterations, _config.Regression.Warmup.Value(), _memory, [this, &payload]() -> uint32_t {
+                    return _payloadProxy->SendUint32Vector(payload);
+                }));
+
+                const Measurement& cell = matrix.back();
+                TRACE(Trace::Information, (_T("Matrix [%u bytes x %u threads]: p50 %" PRIu64 "ns, p99 %" PRIu64 "ns, p99.9 %" PRIu64 "ns"),
+                    bytes, threads, cell.histogram.Percentile(50.0), cell.histogram.Percentile(99.0), cell.histogram.Percentile(99.9)));
+            }
+        }
+
+        _adminLock.Lock();
+        _matrix = std::move(matrix);
+        _adminLock.Unlock();
+    }
+
+    void Benchmark::FillReport(ReportData& report) const
+    {
+        report.Mode = _config.Root.Mode.Value();
+#ifdef THUNDER_VERSION
+        report.Version = Core::NumberType<uint32_t>(THUNDER_VERSION).Text();
+#endif
+        report.Timestamp = Core::Time::Now().ToISO8601(true);
+
+        auto add = [&report](const Measurement& entry) {
+            CellData& cell = report.Cells.Add();
+            const uint64_t calls = entry.histogram.Count();
+
+            cell.Api = entry.result.apiName;
+            cell.Size = entry.size;
+            cell.Threads = entry.threads;
+            cell.Calls = calls;
+            cell.Errors = entry.errors;
+            cell.Elapsed = entry.elapsedNs;
+            cell.Throughput = (entry.elapsedNs == 0 ? 0 : ((calls * 1000000000ULL) / entry.elapsedNs));
+            cell.Bandwidth = (entry.elapsedNs == 0 ? 0 : static_cast<uint64_t>((static_cast<double>(calls) * entry.size * 1000000000.0) / entry.elapsedNs));
+            cell.Min = entry.histogram.Min();
+            cell.Mean = entry.histogram.Mean();
+            cell.Max = entry.histogram.Max();
+            cell.StdDev = entry.histogram.StdDev();
+            cell.P50 = entry.histogram.Percentile(50.0);
+            cell.P90 = entry.histogram.Percentile(90.0);
+            cell.P99 = entry.histogram.Percentile(99.0);
+            cell.P999 = entry.histogram.Percentile(99.9);
+        };
+
+        _adminLock.Lock();
+        report.Cells.Set(true);
+        for (const auto& entry : _results) {
+            add(entry);
+        }
+        for (const auto& entry : _matrix) {
+            add(entry);
+        }
+        _adminLock.Unlock();
+    }
+
+    void Benchmark::ExportReport() const
+    {
+        ASSERT(_service != nullptr);
+
+        const string path = _service->PersistentPath();
+
+        if ((Core::File(path).IsDirectory() == false) && (Core::Directory(path.c_str()).CreatePath() == false)) {
+            TRACE(Trace::Error, (_T("Failed to create persistent storage folder [%s]"), path.c_str()));
+        } else {
+            // One file per mode, so in-process, out-of-process and container runs can be compared.
+            Core::File file(path + _config.Report.Value() + '_' + _config.Root.Mode.Value() + _T(".json"));
+
+            if (file.Create() == false) {
+                TRACE(Trace::Error, (_T("Failed to create benchmark report [%s]"), file.Name().c_str()));
+            } else {
+                ReportData report;
+                FillReport(report);
+
+                if (report.IElement::ToFile(file) == false) {
+                    TRACE(Trace::Error, (_T("Failed to write benchmark report [%s]"), file.Name().c_str()));
+                }
+            }
+        }
+    }
+
     void Benchmark::ApplyThresholds()
     {
         _adminLock.Lock();
@@ -439,98 +625,367 @@ namespace Plugin {
 
         if (hasThresholds && _baselines.empty()) {
             // First run with thresholds: store as baseline
-            for (auto& r : _results) {
-                _baselines[r.apiName] = r;
+            for (auto& entry : _results) {
+                if (entry.result.passed == true) {
+                    LatencyHistogram& baseline = (_baselines[entry.result.apiName] = entry.histogram);
+                    baseline.Reject(_config.Regression.Fence.Value());
+                }
                 // Preserve passed=false from COM-RPC call failures
             }
         } else if (hasThresholds) {
             // Subsequent runs: compare against baseline
-            for (auto& r : _results) {
-                if (r.passed == false) {
-                    // COM-RPC call failed during measurement; don't override
-                    continue;
+            Judge(_maxLatencyDeviationPct > 0);
+        } else {
+            // No thresholds: mark as passed only if COM-RPC calls succeeded
+            for (auto& entry : _results) {
+                if (entry.result.passed != false) {
+                    entry.result.passed = true;
                 }
-                r.failureReason.Clear();
-                bool latencyFailed = false;
+            }
+        }
+        _adminLock.Unlock();
+    }
+
+    // Called with the _adminLock taken.
+    void Benchmark::Judge(const bool latency)
+    {
+        _verdicts.clear();
+
+        for (auto& entry : _results) {
+            QualityAssurance::IBenchmark::BenchmarkResult& r = entry.result;
+            if (r.passed == false) {
+                // COM-RPC call failed during measurement; don't override
+                continue;
+            }
+            r.failureReason.Clear();
+
+            auto baseline = _baselines.find(r.apiName);
+            if (baseline != _baselines.end()) {
+                Verdict verdict{};
+                verdict.api = r.apiName;
+
+                bool latencyFailed = (Regressed(baseline->second, entry.histogram, verdict) && latency);
                 bool memoryFailed = false;
 
-                auto baseline = _baselines.find(r.apiName);
-                if (baseline != _baselines.end()) {
-                    // Latency check (threshold is in millipercent: 1000 = 1%)
-                    if (_maxLatencyDeviationPct > 0 && baseline->second.roundTrip.avgNs > 0) {
-                        double baselineAvg = static_cast<double>(baseline->second.roundTrip.avgNs);
-                        double currentAvg = static_cast<double>(r.roundTrip.avgNs);
-                        double deviationMillipct = ((currentAvg - baselineAvg) / baselineAvg) * 100000.0;
-                        if (deviationMillipct > static_cast<double>(_maxLatencyDeviationPct)) {
-                            latencyFailed = true;
-                        }
+                // Memory check
+                if (_maxMemoryGrowthBytes > 0) {
+                    int64_t growth = static_cast<int64_t>(r.memory.residentAfter) - static_cast<int64_t>(r.memory.residentBefore);
+                    if (growth > 0 && static_cast<uint64_t>(growth) > _maxMemoryGrowthBytes) {
+                        memoryFailed = true;
                     }
-                    // Memory check
-                    if (_maxMemoryGrowthBytes > 0) {
-                        int64_t growth = static_cast<int64_t>(r.memory.residentAfter) - static_cast<int64_t>(r.memory.residentBefore);
-                        if (growth > 0 && static_cast<uint64_t>(growth) > _maxMemoryGrowthBytes) {
-                            memoryFailed = true;
+                }
+
+                if (latencyFailed && memoryFailed) {
+                    r.passed = false;
+                    r.failureReason = QualityAssurance::IBenchmark::LATENCY_AND_MEMORY_THRESHOLD_EXCEEDED;
+                } else if (latencyFailed) {
+                    r.passed = false;
+                    r.failureReason = QualityAssurance::IBenchmark::LATENCY_THRESHOLD_EXCEEDED;
+                } else if (memoryFailed) {
+                    r.passed = false;
+                    r.failureReason = QualityAssurance::IBenchmark::MEMORY_THRESHOLD_EXCEEDED;
+                }
+
+                verdict.passed = r.passed;
+                _verdicts.push_back(verdict);
+            }
+        }
+    }
+
+    // A regression is a statistically significant shift to slower calls (Mann-Whitney),
+    // large enough to matter (Cliff's delta) and, if a latency threshold is set, a median
+    // that moved beyond it. Outliers are rejected from the current run before comparing.
+    bool Benchmark::Regressed(const LatencyHistogram& baseline, const LatencyHistogram& current, Verdict& verdict) const
+    {
+        LatencyHistogram filtered(current);
+        verdict.rejected = filtered.Reject(_config.Regression.Fence.Value());
+        verdict.comparison = LatencyHistogram::Compare(baseline, filtered);
+        verdict.baseline = baseline.Percentile(50.0);
+        verdict.current = filtered.Percentile(50.0);
+        verdict.deviation = (verdict.baseline == 0 ? 0 : static_cast<int32_t>(
+            ((static_cast<double>(verdict.current) - static_cast<double>(verdict.baseline)) / static_cast<double>(verdict.baseline)) * 100000.0));
+
+        const bool significant = ((verdict.comparison.p * 1000.0) < static_cast<double>(_config.Regression.Significance.Value()));
+        const bool relevant = ((verdict.comparison.effect * 1000.0) >= static_cast<double>(_config.Regression.Effect.Value()));
+        const bool beyond = ((_maxLatencyDeviationPct == 0) || (verdict.deviation > static_cast<int32_t>(_maxLatencyDeviationPct)));
+
+        return (significant && relevant && beyond);
+    }
+
+    string Benchmark::BaselineFile(const string& name) const
+    {
+        ASSERT(_service != nullptr);
+        return (_service->PersistentPath() + _T("baseline_") + name + _T(".json"));
+    }
+
+    uint32_t Benchmark::SaveBaseline(const string& name, const uint32_t iterations)
+    {
+        ASSERT(_service != nullptr);
+
+        uint32_t result = Core::ERROR_NONE;
+        const string path = _service->PersistentPath();
+
+        if ((Core::File(path).IsDirectory() == false) && (Core::Directory(path.c_str()).CreatePath() == false)) {
+            TRACE(Trace::Error, (_T("Failed to create persistent storage folder [%s]"), path.c_str()));
+            result = Core::ERROR_WRITE_ERROR;
+        } else {
+            _adminLock.Lock();
+            _results.clear();
+            _adminLock.Unlock();
+
+            RunPayloadBenchmarks(iterations);
+
+            BaselineData data;
+            data.Name = name;
+            data.Mode = _config.Root.Mode.Value();
+            data.Timestamp = Core::Time::Now().ToISO8601(true);
+
+            _adminLock.Lock();
+            _baselines.clear();
+            _verdicts.clear();
+
+            for (const auto& entry : _results) {
+                if (entry.result.passed == false) {
+                    TRACE(Trace::Error, (_T("Not adding failing API '%s' to baseline '%s'"), entry.result.apiName.c_str(), name.c_str()));
+                } else {
+                    LatencyHistogram& baseline = (_baselines[entry.result.apiName] = entry.histogram);
+                    baseline.Reject(_config.Regression.Fence.Value());
+
+                    BaselineData::ApiData& api = data.Apis.Add();
+                    api.Api = entry.result.apiName;
+                    api.Indices.Set(true);
+                    api.Counts.Set(true);
+
+                    for (uint32_t index = 0; index < LatencyHistogram::Buckets; index++) {
+                        if (baseline.Count(index) != 0) {
+                            api.Indices.Add() = static_cast<uint16_t>(index);
+                            api.Counts.Add() = baseline.Count(index);
                         }
                     }
+                }
+            }
+            _adminLock.Unlock();
+
+            Core::File file(BaselineFile(name));
 
-                    if (latencyFailed && memoryFailed) {
-                        r.passed = false;
-                        r.failureReason = QualityAssurance::IBenchmark::LATENCY_AND_MEMORY_THRESHOLD_EXCEEDED;
-                    } else if (latencyFailed) {
-                        r.passed = false;
-                        r.failureReason = QualityAssurance::IBenchmark::LATENCY_THRESHOLD_EXCEEDED;
-                    } else if (memoryFailed) {
-                        r.passed = false;
-                        r.failureReason = QualityAssurance::IBenchmark::MEMORY_THRESHOLD_EXCEEDED;
+            if ((file.Create() == false) || (data.IElement::ToFile(file) == false)) {
+                TRACE(Trace::Error, (_T("Failed to write baseline [%s]"), file.Name().c_str()));
+                result = Core::ERROR_WRITE_ERROR;
+            } else {
+                TRACE(Trace::Information, (_T("Baseline '%s' stored in [%s]"), name.c_str(), file.Name().c_str()));
+            }
+        }
+
+        return (result);
+    }
+
+    uint32_t Benchmark::LoadBaseline(const string& name, std::map<string, LatencyHistogram>& baselines) const
+    {
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+        Core::File file(BaselineFile(name));
+
+        if (file.Open(true) == true) {
+            BaselineData data;
+            Core::OptionalType<Core::JSON::Error> error;
+            data.IElement::FromFile(file, error);
+
+            if (error.IsSet() == true) {
+                SYSLOG(Logging::ParsingError, (_T("Parsing baseline '%s' failed with %s"), name.c_str(), ErrorDisplayMessage(error.Value()).c_str()));
+                result = Core::ERROR_PARSE_FAILURE;
+            } else {
+                auto apis = data.Apis.Elements();
+
+                while (apis.Next() == true) {
+                    LatencyHistogram& histogram = baselines[apis.Current().Api.Value()];
+                    auto indices = apis.Current().Indices.Elements();
+                    auto counts = apis.Current().Counts.Elements();
+
+                    while ((indices.Next() == true) && (counts.Next() == true)) {
+                        if (indices.Current().Value() < LatencyHistogram::Buckets) {
+                            histogram.Record(LatencyHistogram::Lowest(indices.Current().Value()), counts.Current().Value());
+                        }
                     }
                 }
-            }
-        } else {
-            // No thresholds: mark as passed only if COM-RPC calls succeeded
-            for (auto& r : _results) {
-                if (r.passed != false) {
-                    r.passed = true;
+
+                if (data.Mode.Value() != _config.Root.Mode.Value()) {
+                    TRACE(Trace::Warning, (_T("Baseline '%s' was taken in mode %s, running in mode %s"),
+                        name.c_str(), data.Mode.Value().c_str(), _config.Root.Mode.Value().c_str()));
                 }
+
+                result = Core::ERROR_NONE;
             }
         }
+
+        return (result);
+    }
+
+    uint32_t Benchmark::Verify(const string& name, const uint32_t iterations)
+    {
+        std::map<string, LatencyHistogram> baselines;
+        uint32_t result = LoadBaseline(name, baselines);
+
+        if (result == Core::ERROR_NONE) {
+            _adminLock.Lock();
+            _results.clear();
+            _adminLock.Unlock();
+
+            RunPayloadBenchmarks(iterations);
+
+            // The verified baseline also becomes the reference for threshold checks of Trigger.
+            _adminLock.Lock();
+            _baselines = std::move(baselines);
+            Judge(true);
+            _adminLock.Unlock();
+
+            ExportReport();
+        }
+
+        return (result);
+    }
+
+    void Benchmark::FillVerdicts(VerifyResultData& result) const
+    {
+        bool passed = true;
+
+        _adminLock.Lock();
+        result.Verdicts.Set(true);
+        for (const Verdict& verdict : _verdicts) {
+            VerdictData& entry = result.Verdicts.Add();
+            entry.Api = verdict.api;
+            entry.Passed = verdict.passed;
+            entry.Baseline = verdict.baseline;
+            entry.Current = verdict.current;
+            entry.Deviation = verdict.deviation;
+            entry.Effect = static_cast<int16_t>(std::lround(verdict.comparison.effect * 1000.0));
+            entry.PValue = static_cast<uint32_t>(std::lround(verdict.comparison.p * 1000000.0));
+            entry.Rejected = verdict.rejected;
+            passed = passed && verdict.passed;
+        }
+        for (const auto& entry : _results) {
+            passed = passed && entry.result.passed;
+        }
         _adminLock.Unlock();
+
+        result.Passed = passed;
     }
 
-    uint32_t Benchmark::GetLatencyThreshold(Core::JSON::DecUInt32& value) const
+    Core::hresult Benchmark::Trigger(const uint32_t iterations)
     {
+        ASSERT(_benchmark != nullptr);
+
         _adminLock.Lock();
-        value = _maxLatencyDeviationPct;
+        _results.clear();
+        _adminLock.Unlock();
+
+        RunPayloadBenchmarks(iterations);
+        ApplyThresholds();
+        ExportReport();
+
+        _adminLock.Lock();
+        bool allPassed = std::all_of(_results.begin(), _results.end(),
+            [](const Measurement& r) { return r.result.passed; });
         _adminLock.Unlock();
+
+        // Let the implementation relay PerformanceCheckCompleted to all registered sinks.
+        _benchmark->Trigger(iterations);
+
+        TRACE(Trace::Information, (_T("Benchmark completed: %u iterations via COM-RPC proxy"), iterations));
+        return allPassed ? Core::ERROR_NONE : Core::ERROR_GENERAL;
+    }
+
+    Core::hresult Benchmark::CollectData(IBenchmarkResultIterator*& report) const
+    {
+        std::vector<BenchmarkResult> results;
+
+        _adminLock.Lock();
+        results.reserve(_results.size() + _matrix.size());
+        for (const auto& entry : _results) {
+            results.push_back(entry.result);
+        }
+        for (const auto& entry : _matrix) {
+            results.push_back(entry.result);
+        }
+        _adminLock.Unlock();
+
+        using Iterator = RPC::IteratorType<IBenchmarkResultIterator>;
+        report = Core::ServiceType<Iterator>::Create<IBenchmarkResultIterator>(results);
+
         return Core::ERROR_NONE;
     }
 
-    uint32_t Benchmark::SetLatencyThreshold(const Core::JSON::DecUInt32& value)
+    Core::hresult Benchmark::Register(IBenchmark::INotification* sink)
+    {
+        ASSERT(_benchmark != nullptr);
+        return (_benchmark->Register(sink));
+    }
+
+    Core::hresult Benchmark::Unregister(IBenchmark::INotification* sink)
+    {
+        ASSERT(_benchmark != nullptr);
+        return (_benchmark->Unregister(sink));
+    }
+
+    Core::hresult Benchmark::LatencyThreshold(const uint32_t maxLatencyDeviationPct)
     {
         _adminLock.Lock();
-        _maxLatencyDeviationPct = value;
+        _maxLatencyDeviationPct = maxLatencyDeviationPct;
         _baselines.clear();
         _adminLock.Unlock();
-        TRACE(Trace::Information, (_T("Latency threshold set: %u millipercent"), static_cast<uint32_t>(value)));
+        TRACE(Trace::Information, (_T("Latency threshold set: %u millipercent"), maxLatencyDeviationPct));
         return Core::ERROR_NONE;
     }
 
-    uint32_t Benchmark::GetMemoryThreshold(Core::JSON::DecUInt64& value) const
+    Core::hresult Benchmark::LatencyThreshold(uint32_t& maxLatencyDeviationPct) const
     {
         _adminLock.Lock();
-        value = _maxMemoryGrowthBytes;
+        maxLatencyDeviationPct = _maxLatencyDeviationPct;
         _adminLock.Unlock();
         return Core::ERROR_NONE;
     }
 
-    uint32_t Benchmark::SetMemoryThreshold(const Core::JSON::DecUInt64& value)
+    Core::hresult Benchmark::MemoryThreshold(const uint64_t maxMemoryGrowthBytes)
     {
         _adminLock.Lock();
-        _maxMemoryGrowthBytes = value;
+        _maxMemoryGrowthBytes = maxMemoryGrowthBytes;
         _baselines.clear();
         _adminLock.Unlock();
-        TRACE(Trace::Information, (_T("Memory threshold set: %" PRIu64 " bytes"), static_cast<uint64_t>(value)));
+        TRACE(Trace::Information, (_T("Memory threshold set: %" PRIu64 " bytes"), maxMemoryGrowthBytes));
         return Core::ERROR_NONE;
     }
 
+    Core::hresult Benchmark::MemoryThreshold(uint64_t& maxMemoryGrowthBytes) const
+    {
+        _adminLock.Lock();
+        maxMemoryGrowthBytes = _maxMemoryGrowthBytes;
+        _adminLock.Unlock();
+        return Core::ERROR_NONE;
+    }
+
+    uint32_t Benchmark::GetLatencyThreshold(Core::JSON::DecUInt32& value) const
+    {
+        _adminLock.Lock();
+        value = _maxLatencyDeviationPct;
+        _adminLock.Unlock();
+        return Core::ERROR_NONE;
+    }
+
+    uint32_t Benchmark::SetLatencyThreshold(const Core::JSON::DecUInt32& value)
+    {
+        return (LatencyThreshold(value.Value()));
+    }
+
+    uint32_t Benchmark::GetMemoryThreshold(Core::JSON::DecUInt64& value) const
+    {
+        _adminLock.Lock();
+        value = _maxMemoryGrowthBytes;
+        _adminLock.Unlock();
+        return Core::ERROR_NONE;
+    }
+
+    uint32_t Benchmark::SetMemoryThreshold(const Core::JSON::DecUInt64& value)
+    {
+        return (MemoryThreshold(value.Value()));
+    }
+
 }
 }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "Module.h"
+#include <LatencyHistogram.h>
 #include <qa_interfaces/IBenchmark.h>
 #include <interfaces/IMemory.h>
 #include <qa_interfaces/IBenchmarkPayload.h>
@@ -29,7 +30,380 @@
 namespace Thunder {
 namespace Plugin {
 
-    class Benchmark : public PluginHost::IPlugin, public PluginHost::JSONRPC {
+    class Benchmark : public PluginHost::IPlugin, public PluginHost::JSONRPC, public QualityAssurance::IBenchmark {
+    private:
+        class Config : public Core::JSON::Container {
+        public:
+            class RootConfig : public Core::JSON::Container {
+            public:
+                RootConfig(const RootConfig&) = delete;
+                RootConfig& operator=(const RootConfig&) = delete;
+                RootConfig()
+                    : Core::JSON::Container()
+                    , Mode(_T("Local"))
+                {
+                    Add(_T("mode"), &Mode);
+                }
+                ~RootConfig() = default;
+
+            public:
+                Core::JSON::String Mode;
+            };
+
+            class MatrixConfig : public Core::JSON::Container {
+            public:
+                MatrixConfig(const MatrixConfig&) = delete;
+                MatrixConfig& operator=(const MatrixConfig&) = delete;
+                MatrixConfig()
+                    : Core::JSON::Container()
+                    , Sizes()
+                    , Threads(4)
+                    , Iterations(1000)
+                {
+                    Add(_T("sizes"), &Sizes);
+                    Add(_T("threads"), &Threads);
+                    Add(_T("iterations"), &Iterations);
+                }
+                ~MatrixConfig() = default;
+
+            public:
+                Core::JSON::ArrayType<Core::JSON::DecUInt32> Sizes;
+                Core::JSON::DecUInt8 Threads;
+                Core::JSON::DecUInt32 Iterations;
+            };
+
+            class RegressionConfig : public Core::JSON::Container {
+            public:
+                RegressionConfig(const RegressionConfig&) = delete;
+                RegressionConfig& operator=(const RegressionConfig&) = delete;
+                RegressionConfig()
+                    : Core::JSON::Container()
+                    , Warmup(100)
+                    , Fence(30)
+                    , Significance(10)
+                    , Effect(147)
+                {
+                    Add(_T("warmup"), &Warmup);
+                    Add(_T("fence"), &Fence);
+                    Add(_T("significance"), &Significance);
+                    Add(_T("effect"), &Effect);
+                }
+                ~RegressionConfig() = default;
+
+            public:
+                Core::JSON::DecUInt32 Warmup; // untimed calls before every measurement
+                Core::JSON::DecUInt16 Fence; // Tukey k for outlier rejection, in tenths (15 is 1.5), 0 keeps all samples
+                Core::JSON::DecUInt16 Significance; // p-value, in per mille
+                Core::JSON::DecUInt16 Effect; // minimal Cliff's delta, in per mille
+            };
+
+        public:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+            Config()
+                : Core::JSON::Container()
+                , Root()
+                , Matrix()
+                , Regression()
+                , Report(_T("benchmark"))
+            {
+                Add(_T("root"), &Root);
+                Add(_T("matrix"), &Matrix);
+                Add(_T("regression"), &Regression);
+                Add(_T("report"), &Report);
+            }
+            ~Config() = default;
+
+        public:
+            RootConfig Root;
+            MatrixConfig Matrix;
+            RegressionConfig Regression;
+            Core::JSON::String Report;
+        };
+
+        class BaselineData : public Core::JSON::Container {
+        public:
+            class ApiData : public Core::JSON::Container {
+            public:
+                ApiData& operator=(const ApiData&) = delete;
+                ApiData()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+                ApiData(const ApiData& other)
+                    : Core::JSON::Container()
+                    , Api(other.Api)
+                    , Indices(other.Indices)
+                    , Counts(other.Counts)
+                {
+                    Init();
+                }
+                ~ApiData() override = default;
+
+            private:
+                void Init()
+                {
+                    Add(_T("api"), &Api);
+                    Add(_T("indices"), &Indices);
+                    Add(_T("counts"), &Counts);
+                }
+
+            public:
+                Core::JSON::String Api;
+                Core::JSON::ArrayType<Core::JSON::DecUInt16> Indices; // non-empty histogram buckets
+                Core::JSON::ArrayType<Core::JSON::DecUInt64> Counts;
+            };
+
+        public:
+            BaselineData(const BaselineData&) = delete;
+            BaselineData& operator=(const BaselineData&) = delete;
+            BaselineData()
+                : Core::JSON::Container()
+                , Name()
+                , Mode()
+                , Timestamp()
+                , Apis()
+            {
+                Add(_T("name"), &Name);
+                Add(_T("mode"), &Mode);
+                Add(_T("timestamp"), &Timestamp);
+                Add(_T("apis"), &Apis);
+            }
+            ~BaselineData() override = default;
+
+        public:
+            Core::JSON::String Name;
+            Core::JSON::String Mode;
+            Core::JSON::String Timestamp;
+            Core::JSON::ArrayType<ApiData> Apis;
+        };
+
+    public:
+        // One measured cell: an API (or a payload size of the matrix) called from a
+        // number of concurrent threads, with its full latency distribution.
+        struct Measurement {
+            QualityAssurance::IBenchmark::BenchmarkResult result;
+            LatencyHistogram histogram;
+            uint32_t size;
+            uint8_t threads;
+            uint32_t errors;
+            uint64_t elapsedNs;
+        };
+
+        struct Verdict {
+            string api;
+            bool passed;
+            uint64_t baseline;
+            uint64_t current;
+            int32_t deviation;
+            uint64_t rejected;
+            LatencyHistogram::Comparison comparison;
+        };
+
+        class CellData : public Core::JSON::Container {
+        public:
+            CellData& operator=(const CellData&) = delete;
+            CellData()
+                : Core::JSON::Container()
+            {
+                Init();
+            }
+            CellData(const CellData& other)
+                : Core::JSON::Container()
+                , Api(other.Api)
+                , Size(other.Size)
+                , Threads(other.Threads)
+                , Calls(other.Calls)
+                , Errors(other.Errors)
+                , Elapsed(other.Elapsed)
+                , Throughput(other.Throughput)
+                , Bandwidth(other.Bandwidth)
+                , Min(other.Min)
+                , Mean(other.Mean)
+                , Max(other.Max)
+                , StdDev(other.StdDev)
+                , P50(other.P50)
+                , P90(other.P90)
+                , P99(other.P99)
+                , P999(other.P999)
+            {
+                Init();
+            }
+            ~CellData() override = default;
+
+        private:
+            void Init()
+            {
+                Add(_T("api"), &Api);
+                Add(_T("size"), &Size);
+                Add(_T("threads"), &Threads);
+                Add(_T("calls"), &Calls);
+                Add(_T("errors"), &Errors);
+                Add(_T("elapsed"), &Elapsed);
+                Add(_T("throughput"), &Throughput);
+                Add(_T("bandwidth"), &Bandwidth);
+                Add(_T("min"), &Min);
+                Add(_T("mean"), &Mean);
+                Add(_T("max"), &Max);
+                Add(_T("stddev"), &StdDev);
+                Add(_T("p50"), &P50);
+                Add(_T("p90"), &P90);
+                Add(_T("p99"), &P99);
+                Add(_T("p999"), &P999);
+            }
+
+        public:
+            Core::JSON::String Api;
+            Core::JSON::DecUInt32 Size; // bytes
+            Core::JSON::DecUInt8 Threads;
+            Core::JSON::DecUInt64 Calls;
+            Core::JSON::DecUInt32 Errors;
+            Core::JSON::DecUInt64 Elapsed; // ns, wall clock of the cell
+            Core::JSON::DecUInt64 Throughput; // calls/s
+            Core::JSON::DecUInt64 Bandwidth; // bytes/s
+            Core::JSON::DecUInt64 Min; // ns
+            Core::JSON::DecUInt64 Mean;
+            Core::JSON::DecUInt64 Max;
+            Core::JSON::DecUInt64 StdDev;
+            Core::JSON::DecUInt64 P50;
+            Core::JSON::DecUInt64 P90;
+            Core::JSON::DecUInt64 P99;
+            Core::JSON::DecUInt64 P999;
+        };
+
+        class ReportData : public Core::JSON::Container {
+        public:
+            ReportData(const ReportData&) = delete;
+            ReportData& operator=(const ReportData&) = delete;
+            ReportData()
+                : Core::JSON::Container()
+                , Mode()
+                , Version()
+                , Timestamp()
+                , Cells()
+            {
+                Add(_T("mode"), &Mode);
+                Add(_T("version"), &Version);
+                Add(_T("timestamp"), &Timestamp);
+                Add(_T("cells"), &Cells);
+            }
+            ~ReportData() override = default;
+
+        public:
+            Core::JSON::String Mode;
+            Core::JSON::String Version;
+            Core::JSON::String Timestamp;
+            Core::JSON::ArrayType<CellData> Cells;
+        };
+
+        class VerdictData : public Core::JSON::Container {
+        public:
+            VerdictData& operator=(const VerdictData&) = delete;
+            VerdictData()
+                : Core::JSON::Container()
+            {
+                Init();
+            }
+            VerdictData(const VerdictData& other)
+                : Core::JSON::Container()
+                , Api(other.Api)
+                , Passed(other.Passed)
+                , Baseline(other.Baseline)
+                , Current(other.Current)
+                , Deviation(other.Deviation)
+                , Effect(other.Effect)
+                , PValue(other.PValue)
+                , Rejected(other.Rejected)
+            {
+                Init();
+            }
+            ~VerdictData() override = default;
+
+        private:
+            void Init()
+            {
+                Add(_T("api"), &Api);
+                Add(_T("passed"), &Passed);
+                Add(_T("baseline"), &Baseline);
+                Add(_T("current"), &Current);
+                Add(_T("deviation"), &Deviation);
+                Add(_T("effect"), &Effect);
+                Add(_T("pvalue"), &PValue);
+                Add(_T("rejected"), &Rejected);
+            }
+
+        public:
+            Core::JSON::String Api;
+            Core::JSON::Boolean Passed;
+            Core::JSON::DecUInt64 Baseline; // median, ns
+            Core::JSON::DecUInt64 Current; // median, ns
+            Core::JSON::DecSInt32 Deviation; // of the median, millipercent
+            Core::JSON::DecSInt16 Effect; // Cliff's delta, per mille
+            Core::JSON::DecUInt32 PValue; // parts per million
+            Core::JSON::DecUInt64 Rejected; // outliers dropped from the current run
+        };
+
+        class VerifyResultData : public Core::JSON::Container {
+        public:
+            VerifyResultData(const VerifyResultData&) = delete;
+            VerifyResultData& operator=(const VerifyResultData&) = delete;
+            VerifyResultData()
+                : Core::JSON::Container()
+                , Name()
+                , Passed()
+                , Verdicts()
+            {
+                Add(_T("name"), &Name);
+                Add(_T("passed"), &Passed);
+                Add(_T("verdicts"), &Verdicts);
+            }
+            ~VerifyResultData() override = default;
+
+        public:
+            Core::JSON::String Name;
+            Core::JSON::Boolean Passed;
+            Core::JSON::ArrayType<VerdictData> Verdicts;
+        };
+
+        class BaselineParamsData : public Core::JSON::Container {
+        public:
+            BaselineParamsData(const BaselineParamsData&) = delete;
+            BaselineParamsData& operator=(const BaselineParamsData&) = delete;
+            BaselineParamsData()
+                : Core::JSON::Container()
+                , Name()
+                , Iterations()
+            {
+                Add(_T("name"), &Name);
+                Add(_T("iterations"), &Iterations);
+            }
+            ~BaselineParamsData() override = default;
+
+        public:
+            Core::JSON::String Name;
+            Core::JSON::DecUInt32 Iterations;
+        };
+
+        class MatrixParamsData : public Core::JSON::Container {
+        public:
+            MatrixParamsData(const MatrixParamsData&) = delete;
+            MatrixParamsData& operator=(const MatrixParamsData&) = delete;
+            MatrixParamsData()
+                : Core::JSON::Container()
+                , Iterations()
+                , Threads()
+            {
+                Add(_T("iterations"), &Iterations);
+                Add(_T("threads"), &Threads);
+            }
+            ~MatrixParamsData() override = default;
+
+        public:
+            Core::JSON::DecUInt32 Iterations;
+            Core::JSON::DecUInt8 Threads;
+        };
+
     private:
         class Notification : public RPC::IRemoteConnection::INotification {
         public:
@@ -104,6 +478,7 @@ namespace Plugin {
             , _payloadProxy(nullptr)
             , _maxLatencyDeviationPct(0)
             , _maxMemoryGrowthBytes(0)
+            , _config()
         {
         }
 
@@ -112,7 +487,7 @@ namespace Plugin {
         BEGIN_INTERFACE_MAP(Benchmark)
             INTERFACE_ENTRY(PluginHost::IPlugin)
             INTERFACE_ENTRY(PluginHost::IDispatcher)
-            INTERFACE_AGGREGATE(QualityAssurance::IBenchmark, _benchmark)
+            INTERFACE_ENTRY(QualityAssurance::IBenchmark)
             INTERFACE_AGGREGATE(Exchange::IMemory, _memory)
         END_INTERFACE_MAP
 
@@ -121,13 +496,35 @@ namespace Plugin {
         void Deinitialize(PluginHost::IShell* service) override;
         string Information() const override;
 
+        //   IBenchmark methods
+        //   Measurements are taken here, on the calling side of the IBenchmarkPayload proxy,
+        //   so the results are stored here as well. The implementation only relays events.
+        Core::hresult Trigger(const uint32_t iterations) override;
+        Core::hresult CollectData(IBenchmarkResultIterator*& report) const override;
+        Core::hresult Register(IBenchmark::INotification* sink) override;
+        Core::hresult Unregister(IBenchmark::INotification* sink) override;
+        Core::hresult LatencyThreshold(const uint32_t maxLatencyDeviationPct) override;
+        Core::hresult LatencyThreshold(uint32_t& maxLatencyDeviationPct) const override;
+        Core::hresult MemoryThreshold(const uint64_t maxMemoryGrowthBytes) override;
+        Core::hresult MemoryThreshold(uint64_t& maxMemoryGrowthBytes) const override;
+
     private:
         void Deactivated(RPC::IRemoteConnection* connection);
         void BenchmarkCompleted();
         void RegisterJsonRpcHandlers();
         void UnregisterJsonRpcHandlers();
         void RunPayloadBenchmarks(uint32_t iterations);
+        void RunMatrix(const uint32_t iterations, const uint8_t maxThreads);
         void ApplyThresholds();
+        void Judge(const bool latency);
+        bool Regressed(const LatencyHistogram& baseline, const LatencyHistogram& current, Verdict& verdict) const;
+        uint32_t SaveBaseline(const string& name, const uint32_t iterations);
+        uint32_t LoadBaseline(const string& name, std::map<string, LatencyHistogram>& baselines) const;
+        uint32_t Verify(const string& name, const uint32_t iterations);
+        void FillReport(ReportData& report) const;
+        void FillVerdicts(VerifyResultData& result) const;
+        void ExportReport() const;
+        string BaselineFile(const string& name) const;
 
         uint32_t GetLatencyThreshold(Core::JSON::DecUInt32& value) const;
         uint32_t SetLatencyThreshold(const Core::JSON::DecUInt32& value);
@@ -143,10 +540,13 @@ namespace Plugin {
         Core::SinkType<BenchmarkNotification> _benchmarkNotification;
         QualityAssurance::IBenchmarkPayload* _payloadProxy;
         mutable Core::CriticalSection _adminLock;
-        std::vector<QualityAssurance::IBenchmark::BenchmarkResult> _results;
-        std::map<string, QualityAssurance::IBenchmark::BenchmarkResult> _baselines;
+        std::vector<Measurement> _results;
+        std::vector<Measurement> _matrix;
+        std::map<string, LatencyHistogram> _baselines;
+        std::vector<Verdict> _verdicts;
         uint32_t _maxLatencyDeviationPct;
         uint64_t _maxMemoryGrowthBytes;
+        Config _config;
     };
 
 } // namespace Plugin
@@ -39,6 +39,8 @@ namespace Plugin {
         BenchmarkImplementation()
             : _adminLock()
             , _notifications()
+            , _maxLatencyDeviationPct(0)
+            , _maxMemoryGrowthBytes(0)
         {
         }
 
@@ -75,7 +77,7 @@ namespace Plugin {
 
         Core::hresult CollectData(IBenchmarkResultIterator*& report) const override
         {
-            // Results are stored on the plugin shell side.
+            // Results are stored on the plugin shell side, which answers CollectData itself.
             std::vector<BenchmarkResult> empty;
             using Iterator = RPC::IteratorType<IBenchmarkResultIterator>;
             report = Core::ServiceType<Iterator>::Create<IBenchmarkResultIterator>(empty);
@@ -107,27 +109,38 @@ namespace Plugin {
             return Core::ERROR_NONE;
         }
 
-        Core::hresult LatencyThreshold(const uint32_t /* maxLatencyDeviationPct */) override
+        // Thresholds are applied on the plugin shell side, which exposes IBenchmark to
+        // clients. They are kept here as well so direct users of this object read back
+        // what they have set.
+        Core::hresult LatencyThreshold(const uint32_t maxLatencyDeviationPct) override
         {
-            // Thresholds are managed on the plugin shell side.
+            _adminLock.Lock();
+            _maxLatencyDeviationPct = maxLatencyDeviationPct;
+            _adminLock.Unlock();
             return Core::ERROR_NONE;
         }
 
         Core::hresult LatencyThreshold(uint32_t& maxLatencyDeviationPct) const override
         {
-            maxLatencyDeviationPct = 0;
+            _adminLock.Lock();
+            maxLatencyDeviationPct = _maxLatencyDeviationPct;
+            _adminLock.Unlock();
             return Core::ERROR_NONE;
         }
 
-        Core::hresult MemoryThreshold(const uint64_t /* maxMemoryGrowthBytes */) override
+        Core::hresult MemoryThreshold(const uint64_t maxMemoryGrowthBytes) override
         {
-            // Thresholds are managed on the plugin shell side.
+            _adminLock.Lock();
+            _maxMemoryGrowthBytes = maxMemoryGrowthBytes;
+            _adminLock.Unlock();
             return Core::ERROR_NONE;
         }
 
         Core::hresult MemoryThreshold(uint64_t& maxMemoryGrowthBytes) const override
         {
-            maxMemoryGrowthBytes = 0;
+            _adminLock.Lock();
+            maxMemoryGrowthBytes = _maxMemoryGrowthBytes;
+            _adminLock.Unlock();
             return Core::ERROR_NONE;
         }
 
@@ -241,6 +254,8 @@ namespace Plugin {
     private:
         mutable Core::CriticalSection _adminLock;
         std::vector<IBenchmark::INotification*> _notifications;
+        uint32_t _maxLatencyDeviationPct;
+        uint64_t _maxMemoryGrowthBytes;
     };
 
     SERVICE_REGISTRATION(BenchmarkImplementation, 1, 0)
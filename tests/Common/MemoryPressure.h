@@ -0,0 +1,469 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Self contained on purpose (no Module.h), it is shared by the TestUtility and TestAutomationMemory
+// plugins. Both build MemoryPressure.cpp next to it as well, it holds the enum conversion.
+#include <core/core.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <vector>
+
+namespace Thunder {
+
+// Drives the hosting process towards memory pressure in a scripted way, one step per
+// interval on its own thread, and observes how the system reacts: the resident size of
+// the process, cgroup v2 memory.current/memory.high and the pressure stall information.
+class MemoryPressure : public Core::Thread {
+public:
+    enum pattern : uint8_t {
+        STEADY, // grow a step every interval up to the target, then hold
+        SAWTOOTH, // grow up to the target, release everything, repeat
+        FRAGMENT // interleave small and medium blocks with a large one, release every other small block
+    };
+
+    struct Settings {
+        pattern Pattern;
+        uint32_t Target; // KB
+        uint32_t Step; // KB per step
+        uint32_t Interval; // ms between steps
+        uint16_t Cycles; // SAWTOOTH only, 0 repeats until stopped
+        bool Touch; // write every page so it becomes resident
+        bool Lock; // mlock every block
+        uint32_t High; // KB, cgroup memory.high while running, 0 leaves it untouched
+    };
+
+    // Pressure stall information, avg10 in 1/100 percent, totals in us.
+    struct Stall {
+        uint32_t Some;
+        uint32_t Full;
+        uint64_t SomeTotal;
+        uint64_t FullTotal;
+    };
+
+    struct Report {
+        bool Running;
+        uint32_t Allocated; // KB held by the engine
+        uint32_t Locked; // KB
+        uint32_t Steps;
+        uint16_t Cycles;
+        uint32_t Failures; // failed allocations and locks
+        uint32_t Size; // KB
+        uint32_t Resident; // KB
+        uint32_t PeakResident; // KB
+        uint64_t Current; // bytes, cgroup memory.current, 0 if unknown
+        uint64_t High; // bytes, cgroup memory.high, ~0 for "max", 0 if unknown
+        bool Observed; // Pressure is valid
+        Stall Pressure;
+        uint32_t LatencyP50; // us per step
+        uint32_t LatencyP99;
+        uint32_t LatencyMax;
+    };
+
+private:
+    static constexpr uint16_t LatencySamples = 1024;
+    static constexpr uint32_t SmallBlock = 2; // KB
+    static constexpr uint32_t MediumBlock = 30; // KB, stays below the mmap threshold, so on the heap
+
+    struct Block {
+        void* Address;
+        uint32_t Size; // KB
+        bool Locked;
+    };
+
+public:
+    MemoryPressure(const MemoryPressure&) = delete;
+    MemoryPressure& operator=(const MemoryPressure&) = delete;
+
+    MemoryPressure()
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("MemoryPressure"))
+        , _lock()
+        , _process()
+        , _settings()
+        , _blocks()
+        , _latencies()
+        , _cgroup()
+        , _previousHigh()
+        , _allocated(0)
+        , _locked(0)
+        , _steps(0)
+        , _cycles(0)
+        , _failures(0)
+        , _peakResident(0)
+        , _pageSize(static_cast<uint32_t>(::getpagesize()))
+    {
+        _latencies.reserve(LatencySamples);
+    }
+    ~MemoryPressure() override
+    {
+        Stop();
+    }
+
+public:
+    uint32_t Start(const Settings& settings)
+    {
+        uint32_t result = Core::ERROR_NONE;
+
+        if ((settings.Target == 0) || (settings.Step == 0) || (settings.Interval == 0) || (settings.Step > settings.Target)) {
+            result = Core::ERROR_BAD_REQUEST;
+        } else if (IsRunning() == true) {
+            result = Core::ERROR_INPROGRESS;
+        } else {
+            Stop();
+
+            _lock.Lock();
+
+            _settings = settings;
+            _latencies.clear();
+            _steps = 0;
+            _cycles = 0;
+            _failures = 0;
+            _peakResident = 0;
+            _cgroup = CGroup();
+
+            if ((_settings.High != 0) && (_cgroup.empty() == false)) {
+                std::ifstream current(_cgroup + _T("/memory.high"));
+                if ((current.is_open() == false) || (!std::getline(current, _previousHigh)) || (WriteValue(_cgroup + _T("/memory.high"), std::to_string(static_cast<uint64_t>(_settings.High) << 10)) == false)) {
+                    // Usually no permission, run without the limit rather than not at all.
+                    _previousHigh.clear();
+                    _failures++;
+                }
+            }
+
+            _lock.Unlock();
+
+            Run();
+        }
+
+        return (result);
+    }
+    void Stop()
+    {
+        Block();
+        Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+        _lock.Lock();
+
+        Release();
+
+        if (_previousHigh.empty() == false) {
+            WriteValue(_cgroup + _T("/memory.high"), _previousHigh);
+            _previousHigh.clear();
+        }
+
+        _lock.Unlock();
+    }
+    void Snapshot(Report& report) const
+    {
+        std::vector<uint32_t> latencies;
+
+        _lock.Lock();
+        report.Running = IsRunning();
+        report.Allocated = _allocated;
+        report.Locked = _locked;
+        report.Steps = _steps;
+        report.Cycles = _cycles;
+        report.Failures = _failures;
+        report.PeakResident = _peakResident;
+        latencies = _latencies;
+        const string cgroup(_cgroup.empty() == true ? CGroup() : _cgroup);
+        _lock.Unlock();
+
+        report.Size = static_cast<uint32_t>(_process.Allocated() >> 10);
+        report.Resident = static_cast<uint32_t>(_process.Resident() >> 10);
+        report.PeakResident = std::max(report.PeakResident, report.Resident);
+
+        report.Current = 0;
+        report.High = 0;
+        report.Observed = false;
+        report.Pressure = { 0, 0, 0, 0 };
+
+        if (cgroup.empty() == false) {
+            ReadValue(cgroup + _T("/memory.current"), report.Current);
+            ReadValue(cgroup + _T("/memory.high"), report.High);
+            report.Observed = ReadStall(cgroup + _T("/memory.pressure"), report.Pressure);
+        }
+        if (report.Observed == false) {
+            // No cgroup v2 (or no PSI on it), fall back to the system wide figures.
+            report.Observed = ReadStall(_T("/proc/pressure/memory"), report.Pressure);
+        }
+
+        report.LatencyP50 = Percentile(latencies, 50);
+        report.LatencyP99 = Percentile(latencies, 99);
+        report.LatencyMax = (latencies.empty() == true ? 0 : *std::max_element(latencies.begin(), latencies.end()));
+    }
+
+private:
+    uint32_t Worker() override
+    {
+        const auto start = std::chrono::steady_clock::now();
+        bool completed = false;
+
+        _lock.Lock();
+
+        const uint32_t room = (_allocated < _settings.Target ? (_settings.Target - _allocated) : 0);
+
+        switch (_settings.Pattern) {
+        case STEADY:
+            if (room > 0) {
+                Grow(std::min(room, _settings.Step));
+            }
+            break;
+        case SAWTOOTH:
+            if (room > 0) {
+                Grow(std::min(room, _settings.Step));
+            } else {
+                Release();
+                _cycles++;
+                completed = ((_settings.Cycles != 0) && (_cycles >= _settings.Cycles));
+            }
+            break;
+        case FRAGMENT:
+            if (room > 0) {
+                Fragment(std::min(room, _settings.Step));
+            }
+            break;
+        }
+
+        _steps++;
+
+        const uint32_t duration = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        if (_latencies.size() < LatencySamples) {
+            _latencies.push_back(duration);
+        } else {
+            _latencies[_steps % LatencySamples] = duration;
+        }
+
+        const uint32_t resident = static_cast<uint32_t>(_process.Resident() >> 10);
+        if (resident > _peakResident) {
+            _peakResident = resident;
+        }
+
+        _lock.Unlock();
+
+        if (completed == true) {
+            Block();
+        }
+
+        return (completed == true ? Core::infinite : _settings.Interval);
+    }
+
+    bool Allocate(const uint32_t size)
+    {
+        const size_t bytes = static_cast<size_t>(size) << 10;
+        uint8_t* address = static_cast<uint8_t*>(::malloc(bytes));
+
+        if (address != nullptr) {
+            bool locked = false;
+
+            if (_settings.Touch == true) {
+                // One write per page is enough to have it backed by physical memory.
+                for (size_t offset = 0; offset < bytes; offset += _pageSize) {
+                    address[offset] = static_cast<uint8_t>(offset);
+                }
+            }
+            if (_settings.Lock == true) {
+                locked = (::mlock(address, bytes) == 0);
+                if (locked == true) {
+                    _locked += size;
+                } else {
+                    // Most likely RLIMIT_MEMLOCK, keep the block unlocked.
+                    _failures++;
+                }
+            }
+
+            _blocks.push_back({ address, size, locked });
+            _allocated += size;
+        } else {
+            _failures++;
+        }
+
+        return (address != nullptr);
+    }
+    void Grow(const uint32_t size)
+    {
+        Allocate(size);
+    }
+    // Half of the step in one large (mmapped) block, the other half in interleaved small
+    // and medium heap blocks of which every other small one is released again. The holes
+    // left behind can not be returned to the system, so size and resident keep growing
+    // beyond what is actually held.
+    void Fragment(const uint32_t size)
+    {
+        const uint32_t large = size / 2;
+        uint32_t remaining = size - large;
+
+        if ((large == 0) || (Allocate(large) == true)) {
+            std::list<std::list<Block>::iterator> holes;
+            bool release = false;
+
+            while (remaining >= (SmallBlock + MediumBlock)) {
+                if (Allocate(SmallBlock) == false) {
+                    break;
+                }
+                if (release == true) {
+                    holes.push_back(std::prev(_blocks.end()));
+                }
+                release = !release;
+
+                if (Allocate(MediumBlock) == false) {
+                    break;
+                }
+                remaining -= (SmallBlock + MediumBlock);
+            }
+
+            for (auto& hole : holes) {
+                Free(*hole);
+                _blocks.erase(hole);
+            }
+        }
+    }
+    void Free(const Block& block)
+    {
+        if (block.Locked == true) {
+            ::munlock(block.Address, static_cast<size_t>(block.Size) << 10);
+            _locked -= block.Size;
+        }
+        ::free(block.Address);
+        _allocated -= block.Size;
+    }
+    void Release()
+    {
+        for (const Block& block : _blocks) {
+            Free(block);
+        }
+        _blocks.clear();
+
+        ASSERT(_allocated == 0);
+        ASSERT(_locked == 0);
+    }
+
+    static uint32_t Percentile(std::vector<uint32_t>& samples, const uint8_t percentage)
+    {
+        uint32_t result = 0;
+
+        if (samples.empty() == false) {
+            const size_t index = std::min(samples.size() - 1, (samples.size() * percentage) / 100);
+            std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+            result = samples[index];
+        }
+
+        return (result);
+    }
+    // The cgroup v2 directory of this process, empty if it is not on the unified hierarchy.
+    static string CGroup()
+    {
+        string result;
+        std::ifstream file(_T("/proc/self/cgroup"));
+        string line;
+
+        while ((result.empty() == true) && (std::getline(file, line))) {
+            if (line.compare(0, 3, _T("0::")) == 0) {
+                result = _T("/sys/fs/cgroup") + line.substr(3);
+
+                if (Core::File(result + _T("/memory.current")).Exists() == false) {
+                    result.clear();
+                }
+            }
+        }
+
+        return (result);
+    }
+    static bool ReadValue(const string& fileName, uint64_t& value)
+    {
+        std::ifstream file(fileName);
+        string text;
+        bool result = false;
+
+        if (std::getline(file, text)) {
+            if (text == _T("max")) {
+                value = ~0;
+                result = true;
+            } else if (text.empty() == false) {
+                value = std::strtoull(text.c_str(), nullptr, 10);
+                result = true;
+            }
+        }
+
+        return (result);
+    }
+    static bool WriteValue(const string& fileName, const string& value)
+    {
+        std::ofstream file(fileName);
+        file << value;
+        file.flush();
+
+        return (file.good());
+    }
+    // Lines look like: "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456"
+    static bool ReadStall(const string& fileName, Stall& stall)
+    {
+        std::ifstream file(fileName);
+        string line;
+        uint8_t found = 0;
+
+        while (std::getline(file, line)) {
+            char kind[8];
+            float avg10, avg60, avg300;
+            unsigned long long total;
+
+            if (::sscanf(line.c_str(), "%7s avg10=%f avg60=%f avg300=%f total=%llu", kind, &avg10, &avg60, &avg300, &total) == 5) {
+                if (::strcmp(kind, "some") == 0) {
+                    stall.Some = static_cast<uint32_t>(avg10 * 100);
+                    stall.SomeTotal = total;
+                    found++;
+                } else if (::strcmp(kind, "full") == 0) {
+                    stall.Full = static_cast<uint32_t>(avg10 * 100);
+                    stall.FullTotal = total;
+                    found++;
+                }
+            }
+        }
+
+        return (found > 0);
+    }
+
+private:
+    mutable Core::CriticalSection _lock;
+    Core::ProcessInfo _process;
+    Settings _settings;
+    std::list<Block> _blocks;
+    std::vector<uint32_t> _latencies;
+    string _cgroup;
+    string _previousHigh;
+    uint32_t _allocated; // KB
+    uint32_t _locked; // KB
+    uint32_t _steps;
+    uint16_t _cycles;
+    uint32_t _failures;
+    uint32_t _peakResident; // KB
+    const uint32_t _pageSize;
+};
+
+} // namespace Thunder
@@ -18,6 +18,7 @@
  */
  
 #include "TestAutomationMemory.h"
+#include <interfaces/IConfiguration.h>
 
 
 namespace Thunder {
@@ -106,6 +107,12 @@ namespace Plugin {
         if (_memoryTestInterface == nullptr) {
             result = _T("Couldn't create TestAutomationMemory instance");
         } else {
+            Exchange::IConfiguration* configuration = _memoryTestInterface->QueryInterface<Exchange::IConfiguration>();
+            if (configuration != nullptr) {
+                configuration->Configure(_service);
+                configuration->Release();
+            }
+
             QualityAssurance::JMemory::Register(*this, _memoryTestInterface);
 
             // If we are configured to run OOP, the _connectionId != 0!
@@ -19,11 +19,69 @@
 #include <memory>
 #include "Module.h"
 #include <qa_interfaces/ITestAutomation.h>
+#include <interfaces/IConfiguration.h>
+
+#include <MemoryPressure.h>
 
 namespace Thunder {
+
 namespace Plugin {
 
-    class TestAutomationMemoryImplementation : public QualityAssurance::IMemory {
+    class TestAutomationMemoryImplementation : public QualityAssurance::IMemory, public Exchange::IConfiguration {
+    private:
+        class Config : public Core::JSON::Container {
+        public:
+            class PressureConfig : public Core::JSON::Container {
+            public:
+                PressureConfig(const PressureConfig&) = delete;
+                PressureConfig& operator=(const PressureConfig&) = delete;
+
+                PressureConfig()
+                    : Core::JSON::Container()
+                    , Pattern(MemoryPressure::pattern::STEADY)
+                    , Step(1024)
+                    , Interval(100)
+                    , Cycles(0)
+                    , Touch(true)
+                    , Lock(false)
+                    , High(0)
+                {
+                    Add(_T("pattern"), &Pattern);
+                    Add(_T("step"), &Step);
+                    Add(_T("interval"), &Interval);
+                    Add(_T("cycles"), &Cycles);
+                    Add(_T("touch"), &Touch);
+                    Add(_T("lock"), &Lock);
+                    Add(_T("high"), &High);
+                }
+                ~PressureConfig() override = default;
+
+            public:
+                Core::JSON::EnumType<MemoryPressure::pattern> Pattern;
+                Core::JSON::DecUInt32 Step; // KB
+                Core::JSON::DecUInt32 Interval; // ms
+                Core::JSON::DecUInt16 Cycles;
+                Core::JSON::Boolean Touch;
+                Core::JSON::Boolean Lock;
+                Core::JSON::DecUInt32 High; // KB
+            };
+
+        public:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+            Config()
+                : Core::JSON::Container()
+                , Pressure()
+            {
+                Add(_T("pressure"), &Pressure);
+            }
+            ~Config() override = default;
+
+        public:
+            PressureConfig Pressure;
+        };
+
     public:
         TestAutomationMemoryImplementation(const TestAutomationMemoryImplementation&) = delete;
         TestAutomationMemoryImplementation& operator=(const TestAutomationMemoryImplementation&) = delete;
@@ -33,20 +91,63 @@ namespace Plugin {
         TestAutomationMemoryImplementation()
         : _adminLock{}
         , _memoryAllocationData{nullptr}
+        , _pressure{}
+        , _settings{}
+        , _scripted{false}
         {
         }
         ~TestAutomationMemoryImplementation() override = default;
 
         BEGIN_INTERFACE_MAP(TestAutomationMemoryImplementation)
             INTERFACE_ENTRY(QualityAssurance::IMemory)
+            INTERFACE_ENTRY(Exchange::IConfiguration)
         END_INTERFACE_MAP
 
+        // IConfiguration Methods
+        uint32_t Configure(PluginHost::IShell* service) override
+        {
+            Config config;
+            config.FromString(service->ConfigLine());
+
+            _adminLock.Lock();
+
+            // Without a pressure block AllocateMemory keeps doing a single bulk allocation.
+            _scripted = config.Pressure.IsSet();
+            _settings.Pattern = config.Pressure.Pattern.Value();
+            _settings.Target = 0;
+            _settings.Step = config.Pressure.Step.Value();
+            _settings.Interval = config.Pressure.Interval.Value();
+            _settings.Cycles = config.Pressure.Cycles.Value();
+            _settings.Touch = config.Pressure.Touch.Value();
+            _settings.Lock = config.Pressure.Lock.Value();
+            _settings.High = config.Pressure.High.Value();
+
+            _adminLock.Unlock();
+
+            return (Core::ERROR_NONE);
+        }
+
         // IMemory Methods
         Core::hresult AllocateMemory(const uint32_t memorySize) override
         {
             uint32_t result = Core::ERROR_NONE;
             _adminLock.Lock();
-            if (memorySize > 0 && _memoryAllocationData == nullptr)
+            if ((memorySize > 0) && (_scripted == true)) {
+                MemoryPressure::Settings settings(_settings);
+                settings.Target = memorySize * 1024;
+                settings.Step = std::min(settings.Step, settings.Target);
+
+                result = _pressure.Start(settings);
+                _adminLock.Unlock();
+
+                if (result == Core::ERROR_NONE) {
+                    TRACE(Trace::Information, (_T("Memory Pressure Started: %u MB"), memorySize));
+                } else {
+                    TRACE(Trace::Information, (_T("Memory Pressure Not Started: %u"), result));
+                    result = Core::ERROR_GENERAL;
+                }
+            }
+            else if (memorySize > 0 && _memoryAllocationData == nullptr)
             {
                 const size_t totalBytes = memorySize * (1024 * 1024);
 
@@ -77,6 +178,20 @@ namespace Plugin {
         
         Core::hresult FreeAllocatedMemory() override
         {
+            _adminLock.Lock();
+
+            if (_scripted == true) {
+                MemoryPressure::Report report;
+                _pressure.Snapshot(report);
+                _pressure.Stop();
+
+                TRACE(Trace::Information, (_T("Memory Pressure Stopped: %u steps, %u failures, resident peak %u KB, step latency p50 %u us, p99 %u us, max %u us"),
+                    report.Steps, report.Failures, report.PeakResident, report.LatencyP50, report.LatencyP99, report.LatencyMax));
+                if (report.Observed == true) {
+                    TRACE(Trace::Information, (_T("Memory Pressure Stall: some %u.%02u%%, full %u.%02u%% (avg10)"),
+                        report.Pressure.Some / 100, report.Pressure.Some % 100, report.Pressure.Full / 100, report.Pressure.Full % 100));
+                }
+            }
             if (_memoryAllocationData != nullptr) {
                 TRACE(Trace::Information, (_T("Memory Allocation Cleared!!!")));
                 delete[] _memoryAllocationData;
@@ -86,6 +201,8 @@ namespace Plugin {
                 TRACE(Trace::Information, (_T("No Memory Allocated Yet!!!")));
             }
 
+            _adminLock.Unlock();
+
             return Core::ERROR_NONE;
         
         }
@@ -93,6 +210,9 @@ namespace Plugin {
     private:
         mutable Core::CriticalSection _adminLock;
         char* _memoryAllocationData;
+        MemoryPressure _pressure;
+        MemoryPressure::Settings _settings;
+        bool _scripted;
 
     };
 
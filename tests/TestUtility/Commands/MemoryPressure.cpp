@@ -0,0 +1,232 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../CommandCore/TestCommandBase.h"
+#include "../CommandCore/TestCommandController.h"
+#include <MemoryPressure.h>
+
+namespace Thunder {
+
+class MemoryPressureCommand : public TestCommandBase {
+public:
+    MemoryPressureCommand(const MemoryPressureCommand&) = delete;
+    MemoryPressureCommand& operator=(const MemoryPressureCommand&) = delete;
+
+private:
+    class Parameters : public Core::JSON::Container {
+    public:
+        Parameters(const Parameters&) = delete;
+        Parameters& operator=(const Parameters&) = delete;
+
+        Parameters()
+            : Core::JSON::Container()
+            , Action()
+            , Pattern(MemoryPressure::pattern::STEADY)
+            , Target(0)
+            , Step(1024)
+            , Interval(100)
+            , Cycles(0)
+            , Touch(true)
+            , Lock(false)
+            , High(0)
+        {
+            Add(_T("action"), &Action);
+            Add(_T("pattern"), &Pattern);
+            Add(_T("target"), &Target);
+            Add(_T("step"), &Step);
+            Add(_T("interval"), &Interval);
+            Add(_T("cycles"), &Cycles);
+            Add(_T("touch"), &Touch);
+            Add(_T("lock"), &Lock);
+            Add(_T("high"), &High);
+        }
+        ~Parameters() override = default;
+
+    public:
+        Core::JSON::String Action; // start, stop or status (default)
+        Core::JSON::EnumType<MemoryPressure::pattern> Pattern;
+        Core::JSON::DecUInt32 Target;
+        Core::JSON::DecUInt32 Step;
+        Core::JSON::DecUInt32 Interval;
+        Core::JSON::DecUInt16 Cycles;
+        Core::JSON::Boolean Touch;
+        Core::JSON::Boolean Lock;
+        Core::JSON::DecUInt32 High;
+    };
+
+    class Response : public Core::JSON::Container {
+    public:
+        Response(const Response&) = delete;
+        Response& operator=(const Response&) = delete;
+
+        Response()
+            : Core::JSON::Container()
+        {
+            Add(_T("result"), &Result);
+            Add(_T("running"), &Running);
+            Add(_T("allocated"), &Allocated);
+            Add(_T("locked"), &Locked);
+            Add(_T("steps"), &Steps);
+            Add(_T("cycles"), &Cycles);
+            Add(_T("failures"), &Failures);
+            Add(_T("size"), &Size);
+            Add(_T("resident"), &Resident);
+            Add(_T("peakresident"), &PeakResident);
+            Add(_T("cgroupcurrent"), &Current);
+            Add(_T("cgrouphigh"), &High);
+            Add(_T("pressuresome"), &Some);
+            Add(_T("pressurefull"), &Full);
+            Add(_T("latencyp50"), &LatencyP50);
+            Add(_T("latencyp99"), &LatencyP99);
+            Add(_T("latencymax"), &LatencyMax);
+        }
+        ~Response() override = default;
+
+    public:
+        void Set(const uint32_t result, const MemoryPressure::Report& report)
+        {
+            Result = result;
+            Running = report.Running;
+            Allocated = report.Allocated;
+            Locked = report.Locked;
+            Steps = report.Steps;
+            Cycles = report.Cycles;
+            Failures = report.Failures;
+            Size = report.Size;
+            Resident = report.Resident;
+            PeakResident = report.PeakResident;
+            if (report.Current != 0) {
+                Current = report.Current;
+            }
+            if (report.High != 0) {
+                High = report.High;
+            }
+            if (report.Observed == true) {
+                Some = report.Pressure.Some;
+                Full = report.Pressure.Full;
+            }
+            LatencyP50 = report.LatencyP50;
+            LatencyP99 = report.LatencyP99;
+            LatencyMax = report.LatencyMax;
+        }
+
+    public:
+        Core::JSON::DecUInt32 Result;
+        Core::JSON::Boolean Running;
+        Core::JSON::DecUInt32 Allocated; // KB
+        Core::JSON::DecUInt32 Locked; // KB
+        Core::JSON::DecUInt32 Steps;
+        Core::JSON::DecUInt16 Cycles;
+        Core::JSON::DecUInt32 Failures;
+        Core::JSON::DecUInt32 Size; // KB
+        Core::JSON::DecUInt32 Resident; // KB
+        Core::JSON::DecUInt32 PeakResident; // KB
+        Core::JSON::DecUInt64 Current; // bytes
+        Core::JSON::DecUInt64 High; // bytes
+        Core::JSON::DecUInt32 Some; // avg10, 1/100 %
+        Core::JSON::DecUInt32 Full; // avg10, 1/100 %
+        Core::JSON::DecUInt32 LatencyP50; // us per step
+        Core::JSON::DecUInt32 LatencyP99;
+        Core::JSON::DecUInt32 LatencyMax;
+    };
+
+public:
+    using Parameter = JsonData::TestUtility::ParameterInfo;
+
+    MemoryPressureCommand()
+        : TestCommandBase(TestCommandBase::DescriptionBuilder("Applies scripted memory pressure and reports resident size, cgroup and PSI figures"),
+              TestCommandBase::SignatureBuilder("pressure", JsonData::TestUtility::TypeType::OBJECT, "memory, cgroup and pressure statistics")
+                  .InputParameter("action", JsonData::TestUtility::TypeType::STRING, "start, stop or status")
+                  .InputParameter("pattern", JsonData::TestUtility::TypeType::STRING, "steady, sawtooth or fragment")
+                  .InputParameter("target", JsonData::TestUtility::TypeType::NUMBER, "peak allocation in kB")
+                  .InputParameter("step", JsonData::TestUtility::TypeType::NUMBER, "allocation per step in kB")
+                  .InputParameter("interval", JsonData::TestUtility::TypeType::NUMBER, "time between steps in ms")
+                  .InputParameter("cycles", JsonData::TestUtility::TypeType::NUMBER, "sawtooth cycles, 0 runs until stopped")
+                  .InputParameter("touch", JsonData::TestUtility::TypeType::BOOLEAN, "write every page to make it resident")
+                  .InputParameter("lock", JsonData::TestUtility::TypeType::BOOLEAN, "mlock the allocated memory")
+                  .InputParameter("high", JsonData::TestUtility::TypeType::NUMBER, "cgroup memory.high in kB while running"))
+        , _engine()
+        , _name(_T("MemoryPressure"))
+    {
+        TestCore::TestCommandController::Instance().Announce(this);
+    }
+
+    ~MemoryPressureCommand() override
+    {
+        TestCore::TestCommandController::Instance().Revoke(this);
+    }
+
+public:
+    // ICommand methods
+    string Execute(const string& params) final
+    {
+        Parameters input;
+        uint32_t result = Core::ERROR_NONE;
+
+        if (input.FromString(params) == false) {
+            result = Core::ERROR_BAD_REQUEST;
+        } else if (input.Action.Value() == _T("start")) {
+            MemoryPressure::Settings settings;
+
+            settings.Pattern = input.Pattern.Value();
+            settings.Target = input.Target.Value();
+            settings.Step = input.Step.Value();
+            settings.Interval = input.Interval.Value();
+            settings.Cycles = input.Cycles.Value();
+            settings.Touch = input.Touch.Value();
+            settings.Lock = input.Lock.Value();
+            settings.High = input.High.Value();
+
+            result = _engine.Start(settings);
+        } else if (input.Action.Value() == _T("stop")) {
+            _engine.Stop();
+        }
+
+        MemoryPressure::Report report;
+        _engine.Snapshot(report);
+
+        SYSLOG(Logging::Notification, (_T("*** Pressure: allocated %u Kb, resident %u Kb (peak %u Kb), step p99 %u us ***"),
+            report.Allocated, report.Resident, report.PeakResident, report.LatencyP99));
+
+        Response response;
+        string jsonResponse;
+        response.Set(result, report);
+        response.ToString(jsonResponse);
+
+        return jsonResponse;
+    }
+
+    string Name() const final
+    {
+        return _name;
+    }
+
+private:
+    BEGIN_INTERFACE_MAP(MemoryPressureCommand)
+    INTERFACE_ENTRY(QualityAssurance::ITestUtility::ICommand)
+    END_INTERFACE_MAP
+
+private:
+    MemoryPressure _engine;
+    const string _name;
+};
+
+static MemoryPressureCommand* _singleton(Core::ServiceType<MemoryPressureCommand>::Create<MemoryPressureCommand>());
+
+} // namespace Thunder